@@ -0,0 +1,162 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>              // size_t
+#include <cstdint>              // Tipos enteros de tamao fijo
+#include <vector>               // Biblioteca para usar el contenedor dinmico std::vector
+#include <glm.hpp>              // Biblioteca para operaciones con vectores y matrices en 3D
+#include <gtc/quaternion.hpp>   // quat
+#include "Job_System.hpp"
+#include "Transform_Hierarchy.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Animation_System
+     * @brief Animadores procedurales que escriben directamente en las transformaciones locales de una
+     * Transform_Hierarchy.
+     *
+     * Hay cuatro tipos de animadores, cada uno con sus datos en su propia estructura de arrays:
+     *
+     *   - Giro: la rotacin del nodo es su rotacin de reposo compuesta con un giro sobre un eje.
+     *   - rbita: la traslacin del nodo recorre una circunferencia alrededor de su traslacin de reposo.
+     *   - Vaivn: la traslacin del nodo oscila a lo largo de un vector alrededor de su traslacin de reposo.
+     *   - Pista: la traslacin y la rotacin se interpolan entre fotogramas clave, en bucle.
+     *
+     * Los giros, rbitas y vaivenes avanzan un ngulo (fase) que se mantiene en [-pi, pi] y se
+     * evalan de cuatro en cuatro con SSE, con el seno y el coseno de los cuatro carriles calculados
+     * a la vez. Cada tipo se reparte en tramos entre los hilos del Job_System y los tipos se evalan
+     * uno detrs de otro, as que un nodo puede tener un animador de cada tipo, pero no dos del mismo
+     * (los tramos de un mismo tipo escriben a la vez). La rbita, el vaivn y la pista escriben la
+     * traslacin, as que si un nodo tiene varios gana el ltimo (vaivn y despus pista); para
+     * combinarlos se cuelga un nodo del otro.
+     */
+    class Animation_System
+    {
+    public:
+
+        static constexpr std::size_t SIMD_WIDTH          = 4;      ///< Animadores que se evalan a la vez
+        static constexpr std::size_t ANIMATORS_PER_RANGE = 1024;   ///< Tamao mnimo de los tramos
+
+    private:
+
+        using Node = Transform_Hierarchy::Node;
+
+        // Cada grupo guarda sus arrays de float rellenos hasta un mltiplo de SIMD_WIDTH:
+
+        struct Spin_Group
+        {
+            std::vector<Node>  nodes;
+            std::vector<float> rest_w, rest_x, rest_y, rest_z;     ///< Rotacin de reposo
+            std::vector<float> axis_x, axis_y, axis_z;             ///< Eje de giro unitario
+            std::vector<float> speed, phase;
+        };
+
+        struct Orbit_Group
+        {
+            std::vector<Node>  nodes;
+            std::vector<float> center_x, center_y, center_z;       ///< Traslacin de reposo
+            std::vector<float> u_x, u_y, u_z;                      ///< Posicin relativa con fase 0
+            std::vector<float> v_x, v_y, v_z;                      ///< Posicin relativa con fase pi/2
+            std::vector<float> speed, phase;
+        };
+
+        struct Bob_Group
+        {
+            std::vector<Node>  nodes;
+            std::vector<float> rest_x, rest_y, rest_z;             ///< Traslacin de reposo
+            std::vector<float> offset_x, offset_y, offset_z;       ///< Desplazamiento mximo
+            std::vector<float> speed, phase;
+        };
+
+        struct Track_Group
+        {
+            std::vector<Node>          nodes;
+            std::vector<std::uint32_t> first_keys;                 ///< Primer fotograma de cada pista en keys
+            std::vector<std::uint32_t> key_counts;
+            std::vector<float>         speed, time;
+            std::vector<Keyframe>      keys;                       ///< Fotogramas de todas las pistas, ordenados por tiempo en cada una
+        };
+
+        Job_System & job_system;
+
+        Spin_Group  spins;
+        Orbit_Group orbits;
+        Bob_Group   bobs;
+        Track_Group tracks;
+
+    public:
+
+        /**
+         * @brief Crea un sistema sin animadores.
+         * @param job_system Hilos entre los que se reparte la evaluacin.
+         */
+        Animation_System(Job_System & job_system);
+
+        /**
+         * @brief Aade un giro. La rotacin actual del nodo pasa a ser su rotacin de reposo.
+         * @param axis Eje de giro en el espacio del padre.
+         * @param speed Radianes por unidad de tiempo.
+         * @param phase ngulo inicial en radianes.
+         */
+        void add_spin(const Transform_Hierarchy & transforms, Node node, const glm::vec3 & axis, float speed, float phase = 0.f);
+
+        /**
+         * @brief Aade una rbita alrededor de la traslacin actual del nodo.
+         *
+         * Con fase 0 el nodo est en la direccin axis  Z (axis  X si el eje es Z) y avanza girando
+         * alrededor del eje segn la regla de la mano derecha.
+         *
+         * @param axis Eje de la rbita en el espacio del padre.
+         * @param radius Radio de la rbita.
+         * @param speed Radianes por unidad de tiempo.
+         * @param phase ngulo inicial en radianes.
+         */
+        void add_orbit(const Transform_Hierarchy & transforms, Node node, const glm::vec3 & axis, float radius, float speed, float phase = 0.f);
+
+        /**
+         * @brief Aade un vaivn alrededor de la traslacin actual del nodo: rest + sin(fase) * offset.
+         * @param offset Desplazamiento mximo en el espacio del padre.
+         * @param speed Radianes por unidad de tiempo.
+         * @param phase ngulo inicial en radianes.
+         */
+        void add_bob(const Transform_Hierarchy & transforms, Node node, const glm::vec3 & offset, float speed, float phase = 0.f);
+
+        /**
+         * @brief Aade una pista de fotogramas clave, que se repite al llegar al ltimo.
+         * @param keys Fotogramas ordenados por tiempo; se copian.
+         * @param key_count Nmero de fotogramas (al menos uno).
+         * @param speed Tiempo de la pista que avanza por unidad de tiempo.
+         */
+        void add_track(Node node, const Keyframe * keys, std::size_t key_count, float speed = 1.f);
+
+        /**
+         * @brief Avanza todos los animadores y escribe sus transformaciones locales en la jerarqua.
+         *
+         * Los nodos quedan marcados, as que despus hay que llamar a Transform_Hierarchy::update().
+         *
+         * @param step Tiempo que avanzan los animadores.
+         */
+        void update(Transform_Hierarchy & transforms, float step);
+
+        /**
+         * @brief Nmero total de animadores.
+         */
+        std::size_t size() const
+        {
+            return spins.nodes.size() + orbits.nodes.size() + bobs.nodes.size() + tracks.nodes.size();
+        }
+
+    private:
+
+        void update_spins (Transform_Hierarchy & transforms, float step);
+        void update_orbits(Transform_Hierarchy & transforms, float step);
+        void update_bobs  (Transform_Hierarchy & transforms, float step);
+        void update_tracks(Transform_Hierarchy & transforms, float step);
+
+    };
+
+}
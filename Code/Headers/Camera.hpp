@@ -90,6 +90,26 @@ namespace udit
          */
         glm::mat4 get_view_matrix() const;
 
+        /**
+         * @brief Obtiene la posicin de la cmara en el espacio del mundo.
+         *
+         * @return glm::vec3 La posicin de la cmara.
+         */
+        glm::vec3 get_position() const
+        {
+            return position;
+        }
+
+        /**
+         * @brief Obtiene la direccin en la que mira la cmara.
+         *
+         * @return glm::vec3 El vector unitario hacia delante.
+         */
+        glm::vec3 get_front() const
+        {
+            return front;
+        }
+
         /**
          * @brief Establece la velocidad de movimiento de la cmara.
          *
@@ -0,0 +1,78 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Ring_Buffer.hpp"
+
+namespace udit
+{
+
+    /**
+     * @struct Camera_Data
+     * @brief Contenido del bloque de uniforms "Camera" con la distribucin std140.
+     *
+     * Debe coincidir con la declaracin del bloque en los shaders:
+     *
+     *     layout (std140) uniform Camera
+     *     {
+     *         mat4 view_matrix;
+     *         mat4 projection_matrix;
+     *         mat4 view_projection_matrix;
+     *         vec4 camera_position;
+     *     };
+     *
+     * En std140 las matrices se guardan por columnas de vec4 y un vec4 ocupa 16 bytes, igual que en
+     * glm, por lo que la estructura se puede copiar tal cual al buffer.
+     */
+    struct Camera_Data
+    {
+        glm::mat4 view_matrix;
+        glm::mat4 projection_matrix;
+        glm::mat4 view_projection_matrix;
+        glm::vec4 camera_position;            ///< Posicin de la cmara (w = 1)
+    };
+
+    /**
+     * @class Camera_Buffer
+     * @brief Buffer de uniforms con los datos de la cmara, escrito una vez por frame.
+     *
+     * Todos los programas que declaran el bloque "Camera" lo leen del mismo punto de enlace, de
+     * modo que la vista y la proyeccin se suben una sola vez por frame en lugar de una vez por
+     * programa. Los datos se escriben en un Ring_Buffer para no esperar a que la GPU termine de
+     * leer los del frame anterior.
+     */
+    class Camera_Buffer
+    {
+    public:
+
+        static constexpr GLuint BINDING = 0;      ///< Punto de enlace de GL_UNIFORM_BUFFER del bloque
+        static constexpr char   BLOCK_NAME[] = "Camera";
+
+    private:
+
+        Ring_Buffer ring;
+
+    public:
+
+        /**
+         * @brief Crea el buffer.
+         */
+        Camera_Buffer();
+
+        /**
+         * @brief Escribe los datos de la cmara del frame y vincula el bloque a su punto de enlace.
+         * @param data Datos de la cmara.
+         */
+        void upload(const Camera_Data & data);
+
+        /**
+         * @brief Marca el final de los dibujos que leen los datos del frame.
+         */
+        void end_frame();
+
+    };
+
+}
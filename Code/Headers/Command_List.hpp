@@ -0,0 +1,227 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cassert>       // assert
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <cstring>       // memcpy
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+
+namespace udit
+{
+
+    /**
+     * @class Command_List
+     * @brief Lista de comandos de dibujo grabada en un flujo compacto de bytes.
+     *
+     * Grabar una lista no llama a ninguna API grfica, por lo que varios hilos pueden grabar listas
+     * distintas a la vez. Despus el hilo que posee el contexto las reproduce en orden con
+     * for_each(), traduciendo cada comando a llamadas de la API. Los ids y los valores enumerados
+     * de los comandos son los de la API que reproduce la lista.
+     *
+     * Cada comando se guarda como un byte con su tipo seguido de los bytes de sus datos, sin relleno.
+     * Vaciar la lista conserva la memoria reservada, de modo que tras los primeros frames grabar
+     * no pide memoria.
+     */
+    class Command_List
+    {
+    public:
+
+        enum class Command_Type : std::uint8_t
+        {
+            BIND_PROGRAM,
+            BIND_TEXTURE,
+            BIND_VERTEX_ARRAY,
+            SET_BLEND,
+            SET_CULL_FACE,
+            SET_POLYGON_MODE,
+            BIND_INSTANCES,
+            DRAW_INDEXED,
+            MULTI_DRAW_INDEXED_INDIRECT,
+            ISSUE_OCCLUSION_QUERIES,
+            BEGIN_CONDITIONAL_RENDER,
+            END_CONDITIONAL_RENDER,
+        };
+
+        // Datos de cada comando:
+
+        struct Bind_Program
+        {
+            static constexpr Command_Type TYPE = Command_Type::BIND_PROGRAM;
+
+            std::uint32_t program_id;
+        };
+
+        struct Bind_Texture
+        {
+            static constexpr Command_Type TYPE = Command_Type::BIND_TEXTURE;
+
+            std::uint32_t unit;
+            std::uint32_t target;
+            std::uint32_t texture_id;
+        };
+
+        struct Bind_Vertex_Array
+        {
+            static constexpr Command_Type TYPE = Command_Type::BIND_VERTEX_ARRAY;
+
+            std::uint32_t vertex_array_id;
+        };
+
+        struct Set_Blend
+        {
+            static constexpr Command_Type TYPE = Command_Type::SET_BLEND;
+
+            bool enabled;                     ///< Blending alfa estndar (origen * a + destino * (1 - a))
+        };
+
+        struct Set_Cull_Face
+        {
+            static constexpr Command_Type TYPE = Command_Type::SET_CULL_FACE;
+
+            bool enabled;
+        };
+
+        struct Set_Polygon_Mode
+        {
+            static constexpr Command_Type TYPE = Command_Type::SET_POLYGON_MODE;
+
+            std::uint32_t mode;
+        };
+
+        struct Bind_Instances
+        {
+            static constexpr Command_Type TYPE = Command_Type::BIND_INSTANCES;
+
+            std::uint32_t first_instance;     ///< Primer registro de los datos por instancia del frame
+        };
+
+        struct Draw_Indexed
+        {
+            static constexpr Command_Type TYPE = Command_Type::DRAW_INDEXED;
+
+            std::uint32_t index_count;
+            std::uint32_t first_index;
+            std::int32_t  base_vertex;
+            std::uint32_t instance_count;
+        };
+
+        struct Multi_Draw_Indexed_Indirect
+        {
+            static constexpr Command_Type TYPE = Command_Type::MULTI_DRAW_INDEXED_INDIRECT;
+
+            std::uint32_t first_command;      ///< Primer comando del buffer indirecto del frame
+            std::uint32_t command_count;
+        };
+
+        struct Issue_Occlusion_Queries
+        {
+            static constexpr Command_Type TYPE = Command_Type::ISSUE_OCCLUSION_QUERIES;
+        };
+
+        struct Begin_Conditional_Render
+        {
+            static constexpr Command_Type TYPE = Command_Type::BEGIN_CONDITIONAL_RENDER;
+
+            std::uint32_t query_id;           ///< Consulta de oclusin de la que depende el dibujo
+        };
+
+        struct End_Conditional_Render
+        {
+            static constexpr Command_Type TYPE = Command_Type::END_CONDITIONAL_RENDER;
+        };
+
+    private:
+
+        std::vector<std::uint8_t> bytes;
+
+    public:
+
+        /**
+         * @brief Vaca la lista conservando la memoria reservada.
+         */
+        void clear()
+        {
+            bytes.clear();
+        }
+
+        /**
+         * @brief Indica si la lista no tiene comandos.
+         */
+        bool empty() const
+        {
+            return bytes.empty();
+        }
+
+        /**
+         * @brief Aade un comando al final de la lista.
+         * @param command Datos del comando (uno de los tipos anidados de Command_List).
+         */
+        template< typename COMMAND >
+        void record(const COMMAND & command)
+        {
+            const std::size_t offset = bytes.size();
+
+            bytes.resize(offset + 1 + sizeof(COMMAND));
+            bytes[offset] = static_cast<std::uint8_t>(COMMAND::TYPE);
+
+            std::memcpy(bytes.data() + offset + 1, &command, sizeof(COMMAND));
+        }
+
+        /**
+         * @brief Recorre los comandos en el orden en que se grabaron.
+         *
+         * @param visitor Objeto con un operator() para cada tipo de comando.
+         */
+        template< typename VISITOR >
+        void for_each(VISITOR && visitor) const
+        {
+            const std::uint8_t * command = bytes.data();
+            const std::uint8_t * end     = command + bytes.size();
+
+            while (command < end)
+            {
+                const Command_Type type = static_cast<Command_Type>(*command++);
+
+                switch (type)
+                {
+                    case Command_Type::BIND_PROGRAM:                command = visit< Bind_Program                >(command, visitor); break;
+                    case Command_Type::BIND_TEXTURE:                command = visit< Bind_Texture                >(command, visitor); break;
+                    case Command_Type::BIND_VERTEX_ARRAY:           command = visit< Bind_Vertex_Array           >(command, visitor); break;
+                    case Command_Type::SET_BLEND:                   command = visit< Set_Blend                   >(command, visitor); break;
+                    case Command_Type::SET_CULL_FACE:               command = visit< Set_Cull_Face               >(command, visitor); break;
+                    case Command_Type::SET_POLYGON_MODE:            command = visit< Set_Polygon_Mode            >(command, visitor); break;
+                    case Command_Type::BIND_INSTANCES:              command = visit< Bind_Instances              >(command, visitor); break;
+                    case Command_Type::DRAW_INDEXED:                command = visit< Draw_Indexed                >(command, visitor); break;
+                    case Command_Type::MULTI_DRAW_INDEXED_INDIRECT: command = visit< Multi_Draw_Indexed_Indirect >(command, visitor); break;
+                    case Command_Type::ISSUE_OCCLUSION_QUERIES:     command = visit< Issue_Occlusion_Queries     >(command, visitor); break;
+                    case Command_Type::BEGIN_CONDITIONAL_RENDER:    command = visit< Begin_Conditional_Render    >(command, visitor); break;
+                    case Command_Type::END_CONDITIONAL_RENDER:      command = visit< End_Conditional_Render      >(command, visitor); break;
+                    default: assert(false); return;
+                }
+            }
+        }
+
+    private:
+
+        /**
+         * @brief Lee los datos de un comando (sin alinear), se los pasa al visitante y devuelve el
+         * comienzo del siguiente comando.
+         */
+        template< typename COMMAND, typename VISITOR >
+        static const std::uint8_t * visit(const std::uint8_t * data, VISITOR & visitor)
+        {
+            COMMAND command;
+
+            std::memcpy(&command, data, sizeof(COMMAND));
+
+            visitor(command);
+
+            return data + sizeof(COMMAND);
+        }
+
+    };
+
+}
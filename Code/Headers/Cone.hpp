@@ -5,6 +5,7 @@
 
 #include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
 #include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include "Mesh_Arena.hpp"
 
 namespace udit
 {
@@ -14,37 +15,22 @@ namespace udit
      * @brief Clase que representa un cono 3D en OpenGL.
      *
      * Esta clase genera un cono 3D mediante la creacin de vrtices, colores, coordenadas UV
-     * e ndices para la malla. Adems, gestiona los buffers de OpenGL (VAO, VBO, EBO) necesarios
-     * para su renderizacin.
+     * e ndices para la malla. La geometra se guarda en la arena de mallas compartida, de la que
+     * el cono ocupa un rango de vrtices y otro de ndices.
      */
     class Cone
     {
     private:
 
-        // ndices para indexar el array vbo_ids:
-        // Se definen los ndices para los buffers de OpenGL que se usarn:
-        // - COORDINATES_VBO: Para los vrtices
-        // - COLORS_VBO: Para los colores
-        // - UVS_VBO: Para las coordenadas UV
-        // - INDICES_EBO: Para los ndices que definen los tringulos de la malla
-        enum
-        {
-            COORDINATES_VBO,  ///< VBO que almacena las coordenadas de los vrtices
-            COLORS_VBO,       ///< VBO que almacena los colores de los vrtices
-            UVS_VBO,          ///< VBO que almacena las coordenadas UV de los vrtices
-            INDICES_EBO,      ///< EBO que almacena los ndices para los tringulos de la malla
-            VBO_COUNT         ///< Cantidad de VBOs utilizados
-        };
-
         // Arrays dinmicos para almacenar los datos del cono:
         // Se utilizan vectores dinmicos para almacenar las coordenadas, colores, ndices y coordenadas UV
         std::vector<GLfloat> coordinates;  ///< Coordenadas (X, Y, Z) de los vrtices
         std::vector<GLfloat> colors;      ///< Colores de cada vrtice
-        std::vector<GLubyte> indices;     ///< ndices que definen los tringulos del cono
+        std::vector<GLuint>  indices;     ///< ndices que definen los tringulos del cono
         std::vector<GLfloat> uvs;         ///< Coordenadas UV para mapear texturas
 
-        GLuint vbo_ids[VBO_COUNT];        ///< Array que guarda los IDs de los VBOs
-        GLuint vao_id;                    ///< ID del VAO (Vertex Array Object) que organiza los VBOs
+        Mesh_Arena & arena;               ///< Arena en la que se guarda la geometra del cono
+        Mesh         mesh;                ///< Rango que ocupa el cono dentro de la arena
 
     public:
 
@@ -55,26 +41,34 @@ namespace udit
          * segmentos radiales definen cuntos segmentos tiene la base del cono, mientras que el radio
          * y la altura definen las dimensiones del cono.
          *
+         * @param arena Arena de mallas en la que se guarda la geometra.
          * @param radial_segments Nmero de segmentos radiales en la base del cono.
          * @param radius El radio de la base del cono.
          * @param height La altura del cono.
          */
-        Cone(int radial_segments, float radius, float height);
+        Cone(Mesh_Arena & arena, int radial_segments, float radius, float height);
 
         /**
          * @brief Destructor de la clase Cone.
          *
-         * Elimina los recursos de OpenGL utilizados por el cono, como los buffers (VAO, VBO y EBO).
+         * Devuelve a la arena de mallas el espacio que ocupaba la geometra del cono.
          */
         ~Cone();
 
         /**
          * @brief Renderiza el cono en la escena.
          *
-         * Este mtodo usa los buffers de OpenGL configurados para dibujar el cono en la escena.
+         * Este mtodo dibuja el rango de la arena que ocupa el cono.
          */
         void render();
 
+        /**
+         * @brief Devuelve la descripcin de la malla del cono para la cola de render.
+         *
+         * @return Mesh El rango de la arena y el estado de rasterizacin con el que se dibuja el cono.
+         */
+        Mesh get_mesh() const;
+
     };
 
 }
@@ -6,6 +6,7 @@
 #define CUBE_HEADER
 
 #include <glad/glad.h>
+#include "Mesh_Arena.hpp"
 
 namespace udit
 {
@@ -14,34 +15,26 @@ namespace udit
     {
     private:
 
-        // ndices para indexar el array vbo_ids:
-
-        enum
-        {
-            COORDINATES_VBO,
-            COLORS_VBO,
-            INDICES_EBO,
-            VBO_COUNT
-        };
-
         // Arrays de datos del cubo base:
 
         static const GLfloat coordinates[];
         static const GLfloat colors[];
-        static const GLubyte indices[];
+        static const GLuint  indices[];
 
     private:
 
-        GLuint vbo_ids[VBO_COUNT];      // Ids de los VBOs que se usan
-        GLuint vao_id;                  // Id del VAO del cubo
+        Mesh_Arena & arena;             // Arena de mallas en la que se guarda la geometra
+        Mesh         mesh;              // Rango que ocupa el cubo dentro de la arena
 
     public:
 
-        Cube();
+        Cube(Mesh_Arena & arena);
         ~Cube();
 
         void render();
 
+        Mesh get_mesh() const;
+
     };
 
 }
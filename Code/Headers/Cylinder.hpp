@@ -5,6 +5,7 @@
 
 #include <glad/glad.h>  // Biblioteca para cargar funciones de OpenGL
 #include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include "Mesh_Arena.hpp"
 
 namespace udit
 {
@@ -15,33 +16,21 @@ namespace udit
      *
      * Esta clase genera los vrtices, colores, coordenadas UV e ndices necesarios para renderizar
      * un cilindro con un nmero especificado de segmentos radiales y de altura. Tambin configura los
-     * buffers de OpenGL para almacenar y organizar estos datos de manera eficiente.
+     * la arena de mallas compartida para almacenar estos datos de manera eficiente.
      */
     class Cylinder
     {
     private:
 
-        // ndices para indexar el array vbo_ids:
-        // Los VBOs almacenan los datos de las coordenadas, colores, UVs y los ndices
-        // El EBO (Element Buffer Object) almacena los ndices que forman los tringulos de la malla.
-        enum
-        {
-            COORDINATES_VBO,  ///< VBO que almacena las coordenadas de los vrtices
-            COLORS_VBO,       ///< VBO que almacena los colores de los vrtices
-            UVS_VBO,          ///< VBO que almacena las coordenadas de textura (UVs)
-            INDICES_EBO,      ///< EBO que almacena los ndices para los tringulos
-            VBO_COUNT         ///< Total de VBOs utilizados
-        };
-
         // Arrays dinmicos para almacenar los datos del cilindro:
         // Se usan vectores dinmicos para almacenar los datos, que luego sern enviados a los buffers de OpenGL
         std::vector<GLfloat> coordinates;  ///< Vrtices del cilindro
         std::vector<GLfloat> colors;      ///< Colores de los vrtices
-        std::vector<GLubyte> indices;     ///< ndices que definen las caras del cilindro
+        std::vector<GLuint>  indices;     ///< ndices que definen las caras del cilindro
         std::vector<GLfloat> uvs;         ///< Coordenadas UV para las texturas
 
-        GLuint vbo_ids[VBO_COUNT];        ///< Ids de los VBOs que se usan
-        GLuint vao_id;                    ///< Id del VAO (Vertex Array Object) del cilindro
+        Mesh_Arena & arena;               ///< Arena en la que se guarda la geometra del cilindro
+        Mesh         mesh;                ///< Rango que ocupa el cilindro dentro de la arena
 
     public:
 
@@ -52,17 +41,18 @@ namespace udit
          * para renderizar el cilindro. Los segmentos radiales y de altura permiten definir
          * la resolucin del cilindro. El radio y la altura definen las dimensiones del cilindro.
          *
+         * @param arena Arena de mallas en la que se guarda la geometra.
          * @param radial_segments Nmero de segmentos radiales de la base del cilindro.
          * @param height_segments Nmero de segmentos de altura del cilindro.
          * @param radius Radio de la base del cilindro.
          * @param height Altura del cilindro.
          */
-        Cylinder(int radial_segments, int height_segments, float radius, float height);
+        Cylinder(Mesh_Arena & arena, int radial_segments, int height_segments, float radius, float height);
 
         /**
          * @brief Destructor de la clase Cylinder.
          *
-         * Elimina los recursos de OpenGL utilizados por el cilindro, como los VBOs y el VAO.
+         * Devuelve a la arena de mallas el espacio que ocupaba la geometra del cilindro.
          */
         ~Cylinder();
 
@@ -70,9 +60,16 @@ namespace udit
          * @brief Renderiza el cilindro en la escena.
          *
          * Este mtodo configura los atributos de OpenGL necesarios y dibuja el cilindro usando los
-         * datos almacenados en los buffers (VBOs y EBO).
+         * datos almacenados en la arena de mallas.
          */
         void render();
+
+        /**
+         * @brief Devuelve la descripcin de la malla del cilindro para la cola de render.
+         *
+         * @return Mesh El rango de la arena y el estado de rasterizacin con el que se dibuja el cilindro.
+         */
+        Mesh get_mesh() const;
     };
 
 }
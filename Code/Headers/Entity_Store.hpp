@@ -0,0 +1,224 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include "Mesh.hpp"
+#include "Frustum.hpp"
+#include "Job_System.hpp"
+#include "Render_Queue.hpp"
+#include "Transform_Hierarchy.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Entity_Store
+     * @brief Almacn de entidades dibujables con sus componentes en arrays densos (estructura de arrays).
+     *
+     * Cada componente (nodo de transformacin, malla, material, esfera en el mundo, indicadores e
+     * identificador de objeto) vive en su propio array y la entidad i-sima ocupa la posicin i de
+     * todos ellos, sin huecos: al destruir una entidad la ltima pasa a ocupar su lugar. Un array
+     * disperso traduce los identificadores de las entidades, que no cambian, a su posicin actual.
+     *
+     * Los sistemas recorren los arrays de principio a fin y reparten el trabajo en tramos entre los
+     * hilos del Job_System:
+     *
+     *   - update_bounds() lleva al mundo la esfera de las entidades cuyo nodo cambi en el ltimo
+     *     Transform_Hierarchy::update() y las marca como movidas.
+     *   - cull() comprueba las esferas de cuatro en cuatro contra el volumen de visin, directamente
+     *     sobre los arrays de coordenadas y radios. Si las entidades estn en un ndice espacial, su
+     *     consulta puede sustituirlo con mark_visible().
+     *   - submit() construye la lista de dibujos con las entidades visibles.
+     *
+     * Las transformaciones son de la Transform_Hierarchy y los materiales de quien posee el almacn:
+     * las entidades solo guardan el nodo y el ndice del material.
+     */
+    class Entity_Store
+    {
+    public:
+
+        using Entity = std::uint32_t;
+
+        static constexpr Entity NO_ENTITY = 0xFFFFFFFF;
+
+        static constexpr std::size_t ENTITIES_PER_RANGE = 1024;   ///< Tamao mnimo de los tramos de los sistemas
+
+        // Indicadores de cada entidad:
+
+        enum : std::uint8_t
+        {
+            HIDDEN = 1 << 0,           ///< No se dibuja (sigue actualizando su esfera)
+            MOVED  = 1 << 1,           ///< Su esfera cambi en el ltimo update_bounds()
+        };
+
+    private:
+
+        Job_System & job_system;
+
+        // Componentes, indexados por la posicin densa de la entidad:
+
+        std::vector<Entity>                     entities;       ///< Identificador de la entidad de cada posicin
+        std::vector<Transform_Hierarchy::Node>  nodes;
+        std::vector<Mesh>                       meshes;
+        std::vector<std::uint32_t>              materials;      ///< ndice en la tabla de materiales de quien dibuja
+        std::vector<std::uint32_t>              object_ids;     ///< Identificador para seguir el dibujo entre frames
+        std::vector<std::uint8_t>               flags;
+
+        // Esferas en el mundo, rellenas hasta un mltiplo de Frustum::SIMD_WIDTH:
+
+        std::vector<float>                      sphere_x;
+        std::vector<float>                      sphere_y;
+        std::vector<float>                      sphere_z;
+        std::vector<float>                      sphere_radius;
+        std::vector<std::uint8_t>               visibility;     ///< Resultado del ltimo cull()
+
+        std::vector<std::uint32_t>              positions;      ///< Posicin densa de cada entidad (disperso)
+        std::vector<Entity>                     free_entities;  ///< Identificadores de entidades destruidas
+
+        std::size_t                             visible_count;  ///< Entidades enviadas en el ltimo submit()
+
+    public:
+
+        /**
+         * @brief Crea un almacn vaco.
+         * @param job_system Hilos entre los que se reparten los sistemas.
+         */
+        Entity_Store(Job_System & job_system);
+
+        /**
+         * @brief Crea una entidad dibujable.
+         * @param node Nodo de la jerarqua con su transformacin.
+         * @param mesh Malla que se dibuja.
+         * @param material ndice del material en la tabla que se pasa a submit().
+         * @param object_id Identificador estable del dibujo entre frames (Draw_Item::NO_OBJECT si no hace falta).
+         * @return El identificador de la entidad.
+         */
+        Entity create(Transform_Hierarchy::Node node, const Mesh & mesh, std::uint32_t material, std::uint32_t object_id = Draw_Item::NO_OBJECT);
+
+        /**
+         * @brief Reserva espacio en los arrays para un nmero de entidades, para crearlas sin realojar.
+         */
+        void reserve(std::size_t count);
+
+        /**
+         * @brief Destruye una entidad. Su identificador puede reutilizarse.
+         */
+        void destroy(Entity entity);
+
+        /**
+         * @brief Muestra u oculta una entidad.
+         */
+        void set_hidden(Entity entity, bool hidden);
+
+        /**
+         * @brief Cambia el material de una entidad.
+         */
+        void set_material(Entity entity, std::uint32_t material)
+        {
+            materials[positions[entity]] = material;
+        }
+
+        /**
+         * @brief Sistema de volmenes: lleva al mundo la esfera de las entidades que se han movido.
+         * @param transforms Jerarqua, con update() ya llamado en este frame.
+         */
+        void update_bounds(const Transform_Hierarchy & transforms);
+
+        /**
+         * @brief Sistema de descarte: marca como visibles las entidades cuya esfera toca el volumen de visin.
+         */
+        void cull(const Frustum & frustum);
+
+        /**
+         * @brief Marca todas las entidades como visibles (cuando el descarte lo hace otro, como la GPU).
+         */
+        void mark_all_visible();
+
+        /**
+         * @brief Marca como visibles solo las entidades indicadas (cuando el descarte lo hace un ndice espacial).
+         */
+        void mark_visible(const std::vector<Entity> & visible_entities);
+
+        /**
+         * @brief Sistema de dibujo: enva a la cola las entidades visibles que no estn ocultas.
+         * @param queue Cola de render del frame.
+         * @param material_table Materiales a los que apuntan los ndices de las entidades.
+         * @param transforms Jerarqua con las matrices del mundo del frame.
+         */
+        void submit(Render_Queue & queue, const Material * material_table, const Transform_Hierarchy & transforms);
+
+        /**
+         * @brief Nmero de entidades.
+         */
+        std::size_t size() const
+        {
+            return entities.size();
+        }
+
+        /**
+         * @brief Nmero de entidades enviadas a la cola en el ltimo submit().
+         */
+        std::size_t get_visible_count() const
+        {
+            return visible_count;
+        }
+
+        /**
+         * @brief Posicin densa de una entidad, vlida hasta la prxima destruccin.
+         */
+        std::size_t get_position(Entity entity) const
+        {
+            return positions[entity];
+        }
+
+        /**
+         * @brief Indica si la entidad de una posicin se movi en el ltimo update_bounds().
+         */
+        bool is_moved(std::size_t position) const
+        {
+            return (flags[position] & MOVED) != 0;
+        }
+
+        /**
+         * @brief Entidad de una posicin.
+         */
+        Entity get_entity(std::size_t position) const
+        {
+            return entities[position];
+        }
+
+        /**
+         * @brief Nodo de transformacin de la entidad de una posicin.
+         */
+        Transform_Hierarchy::Node get_node(std::size_t position) const
+        {
+            return nodes[position];
+        }
+
+        /**
+         * @brief Identificador de objeto de la entidad de una posicin.
+         */
+        std::uint32_t get_object_id(std::size_t position) const
+        {
+            return object_ids[position];
+        }
+
+        /**
+         * @brief Malla de la entidad de una posicin.
+         */
+        const Mesh & get_mesh(std::size_t position) const
+        {
+            return meshes[position];
+        }
+
+    private:
+
+        void resize_spheres();
+
+    };
+
+}
@@ -0,0 +1,235 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <functional>    // function
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+namespace udit
+{
+
+    /**
+     * @class Frame_Graph
+     * @brief Describe el frame como una lista de pasadas que leen y escriben texturas.
+     *
+     * Cada pasada declara al aadirla, a travs de un Builder, las texturas transitorias que crea,
+     * lee y escribe, y aporta la funcin que la dibuja. Al compilar el grafo:
+     *
+     *   - Se descartan las pasadas desactivadas y las que no tienen efectos visibles: las que
+     *     solo escriben texturas que ninguna pasada viva lee.
+     *   - Se ordenan las pasadas de modo que cada una se ejecute despus de las que escriben lo
+     *     que lee, respetando el orden en que se aadieron cuando no hay dependencias.
+     *   - Se calcula el intervalo de pasadas en el que vive cada textura transitoria y se asignan
+     *     texturas de OpenGL reutilizando la misma textura para recursos con la misma descripcin
+     *     cuyos intervalos no se solapan. OpenGL no permite solapar la memoria de dos texturas, por
+     *     lo que compartir el objeto textura es la forma de aliasing disponible.
+     *
+     * Las texturas y framebuffers se conservan entre frames y solo se vuelven a asignar al compilar,
+     * cosa que ocurre al cambiar el grafo (aadir pasadas o activarlas y desactivarlas). Las texturas
+     * que dejan de usarse se liberan, por lo que la memoria de vdeo depende del nmero de texturas
+     * vivas a la vez y no del nmero de pasadas.
+     */
+    class Frame_Graph
+    {
+    public:
+
+        using Resource = std::uint32_t;          ///< Identificador de una textura del grafo
+        using Pass_Id  = std::uint32_t;          ///< Identificador de una pasada del grafo
+
+        /**
+         * @brief Formato de una textura transitoria. Las texturas con la misma descripcin pueden compartirse.
+         */
+        struct Texture_Description
+        {
+            GLsizei width;
+            GLsizei height;
+            GLenum  internal_format;             ///< GL_RGBA8, GL_RGBA16F, GL_DEPTH_COMPONENT24...
+
+            bool operator == (const Texture_Description & ) const = default;
+        };
+
+        /**
+         * @brief Permite a una pasada declarar sus recursos al aadirla.
+         */
+        class Builder
+        {
+            friend class Frame_Graph;
+
+            Frame_Graph & graph;
+            Pass_Id       pass;
+
+            Builder(Frame_Graph & graph, Pass_Id pass) : graph(graph), pass(pass)
+            {
+            }
+
+        public:
+
+            /**
+             * @brief Crea una textura transitoria que la pasada escribe.
+             * @param name Nombre de la textura (para los mensajes de depuracin).
+             * @param description Formato de la textura.
+             */
+            Resource create(const std::string & name, const Texture_Description & description);
+
+            /**
+             * @brief Declara que la pasada lee una textura escrita por una pasada anterior.
+             */
+            Resource read(Resource resource);
+
+            /**
+             * @brief Declara que la pasada escribe (o sigue escribiendo) una textura.
+             */
+            Resource write(Resource resource);
+
+            /**
+             * @brief Marca la pasada como visible fuera del grafo (por ejemplo, escribe en la ventana),
+             * de modo que nunca se descarta.
+             */
+            void set_side_effect();
+        };
+
+        /**
+         * @brief Da acceso a una pasada a las texturas de OpenGL asignadas al ejecutarla.
+         */
+        class Context
+        {
+            friend class Frame_Graph;
+
+            Frame_Graph & graph;
+
+            Context(Frame_Graph & graph) : graph(graph)
+            {
+            }
+
+        public:
+
+            /**
+             * @brief Textura de OpenGL asignada a un recurso del grafo.
+             */
+            GLuint get_texture(Resource resource) const;
+
+            /**
+             * @brief Framebuffer que tiene como nico adjunto la textura de un recurso (para leer de l con glBlitFramebuffer).
+             */
+            GLuint get_framebuffer(Resource resource) const;
+        };
+
+        using Setup_Function   = std::function< void (Builder & ) >;
+        using Execute_Function = std::function< void (const Context & ) >;
+
+    private:
+
+        struct Pass
+        {
+            std::string           name;
+            Execute_Function      execute;
+            std::vector<Resource> reads;
+            std::vector<Resource> writes;
+            bool                  side_effect = false;
+            bool                  enabled     = true;
+            bool                  culled      = false;
+            unsigned              reference_count = 0;     ///< Usado al descartar pasadas
+        };
+
+        struct Virtual_Texture
+        {
+            std::string         name;
+            Texture_Description description;
+            std::vector<Pass_Id> writers;
+            unsigned            reference_count = 0;        ///< Usado al descartar pasadas
+            int                 first_use       = -1;       ///< Primera posicin en el orden de ejecucin
+            int                 last_use        = -1;       ///< ltima posicin en el orden de ejecucin
+            int                 physical        = -1;       ///< Textura de OpenGL asignada
+        };
+
+        struct Physical_Texture
+        {
+            Texture_Description description;
+            GLuint              texture_id;
+            int                 busy_until;                 ///< ltima posicin en la que est ocupada
+        };
+
+        struct Framebuffer
+        {
+            std::vector<int> attachments;                  ///< ndices de las texturas fsicas adjuntas
+            GLuint           framebuffer_id;
+        };
+
+        std::vector<Pass>             passes;
+        std::vector<Virtual_Texture>  textures;
+        std::vector<Pass_Id>          execution_order;
+        std::vector<Physical_Texture> physical_textures;
+        std::vector<Framebuffer>      framebuffers;
+        std::vector<int>              attachments;       ///< Memoria auxiliar de execute()
+
+        bool compiled;
+
+    public:
+
+        Frame_Graph();
+       ~Frame_Graph();
+
+        Frame_Graph(const Frame_Graph & ) = delete;
+        Frame_Graph & operator = (const Frame_Graph & ) = delete;
+
+        /**
+         * @brief Elimina todas las pasadas y recursos (las texturas de OpenGL se conservan hasta la
+         * siguiente compilacin para poder reutilizarlas).
+         */
+        void clear();
+
+        /**
+         * @brief Aade una pasada al grafo.
+         * @param name Nombre de la pasada.
+         * @param setup Funcin que declara los recursos de la pasada (se llama inmediatamente).
+         * @param execute Funcin que dibuja la pasada (se llama en cada execute() si la pasada no se descarta).
+         * @return Identificador de la pasada.
+         */
+        Pass_Id add_pass(const std::string & name, const Setup_Function & setup, Execute_Function execute);
+
+        /**
+         * @brief Activa o desactiva una pasada. Las pasadas que solo alimentan a pasadas desactivadas
+         * tambin se descartan.
+         */
+        void set_enabled(Pass_Id pass, bool enabled);
+
+        /**
+         * @brief Descarta, ordena y asigna las texturas de las pasadas (execute() lo hace si hace falta).
+         */
+        void compile();
+
+        /**
+         * @brief Ejecuta las pasadas vivas en orden.
+         *
+         * Antes de cada pasada se vincula un framebuffer con las texturas que escribe y se ajusta el
+         * viewport a su tamao. Las pasadas que no escriben texturas dibujan en la ventana.
+         */
+        void execute();
+
+        /**
+         * @brief Nmero de texturas de OpenGL en uso tras la ltima compilacin.
+         */
+        std::size_t get_physical_texture_count() const
+        {
+            return physical_textures.size();
+        }
+
+    private:
+
+        void   cull_passes();
+        bool   all_live_passes_referenced() const;
+        void   sort_passes();
+        void   allocate_textures();
+        void   release_framebuffers();
+        GLuint find_framebuffer(const std::vector<int> & attachments);
+
+        static bool is_depth_format(GLenum internal_format);
+
+    };
+
+}
@@ -0,0 +1,61 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+namespace udit
+{
+
+    /**
+     * @class Frame_Timer
+     * @brief Mide el tiempo de CPU y de GPU que cuesta dibujar cada frame.
+     *
+     * El tiempo de CPU se mide con el contador de alta resolucin de SDL. El de GPU con consultas
+     * GL_TIME_ELAPSED, que se leen tres frames despus de emitirlas para no detener la CPU esperando
+     * el resultado. Los tiempos se acumulan hasta que se piden las medias con take_averages().
+     */
+    class Frame_Timer
+    {
+        static constexpr unsigned QUERY_COUNT = 3;
+
+        GLuint        query_ids[QUERY_COUNT];
+        bool          query_pending[QUERY_COUNT];
+        unsigned      current_query;
+
+        std::uint64_t frame_start;
+        double        cpu_milliseconds;            ///< Suma de los tiempos de CPU medidos
+        double        gpu_milliseconds;            ///< Suma de los tiempos de GPU medidos
+        unsigned      cpu_samples;
+        unsigned      gpu_samples;
+
+    public:
+
+        Frame_Timer();
+       ~Frame_Timer();
+
+        Frame_Timer(const Frame_Timer & ) = delete;
+        Frame_Timer & operator = (const Frame_Timer & ) = delete;
+
+        /**
+         * @brief Empieza a medir el dibujo del frame.
+         */
+        void begin_frame();
+
+        /**
+         * @brief Termina de medir el dibujo del frame.
+         */
+        void end_frame();
+
+        /**
+         * @brief Devuelve los tiempos medios en milisegundos desde la ltima llamada y los reinicia.
+         * @param cpu Recibe el tiempo medio de CPU.
+         * @param gpu Recibe el tiempo medio de GPU.
+         */
+        void take_averages(double & cpu, double & gpu);
+
+    };
+
+}
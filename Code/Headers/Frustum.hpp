@@ -0,0 +1,97 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+
+namespace udit
+{
+
+    /**
+     * @class Frustum
+     * @brief Volumen de visin de la cmara descrito por sus seis planos.
+     *
+     * Los planos se extraen de la matriz de vista y proyeccin (mtodo de Gribb y Hartmann) con la
+     * normal hacia dentro y normalizados, de modo que la ecuacin del plano da la distancia con
+     * signo de un punto del mundo.
+     *
+     * Las esferas se comprueban de cuatro en cuatro con SSE a partir de arrays separados de
+     * coordenadas y radios (estructura de arrays): cada instruccin evala un plano para cuatro
+     * objetos.
+     */
+    class Frustum
+    {
+    public:
+
+        static constexpr std::size_t PLANE_COUNT = 6;
+        static constexpr std::size_t SIMD_WIDTH  = 4;       ///< Esferas que se comprueban a la vez
+
+        /**
+         * @brief Posicin de un volumen respecto al volumen de visin.
+         */
+        enum Containment
+        {
+            OUTSIDE,                                        ///< Completamente fuera
+            INTERSECTING,                                   ///< Cortado por algn plano
+            INSIDE,                                         ///< Completamente dentro
+        };
+
+    private:
+
+        glm::vec4 planes[PLANE_COUNT];                      ///< (normal, distancia): izquierdo, derecho, inferior, superior, cercano y lejano
+
+    public:
+
+        /**
+         * @brief Crea un volumen que lo contiene todo hasta que se extraen sus planos.
+         */
+        Frustum();
+
+        /**
+         * @brief Extrae los planos de la matriz de vista y proyeccin.
+         * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+         */
+        void extract(const glm::mat4 & view_projection_matrix);
+
+        /**
+         * @brief Indica si una esfera est total o parcialmente dentro del volumen.
+         */
+        bool intersects_sphere(const glm::vec3 & center, float radius) const;
+
+        /**
+         * @brief Clasifica una caja alineada con los ejes respecto al volumen.
+         *
+         * Como con las esferas, una caja cercana a una esquina del volumen puede darse por cortada
+         * aunque quede fuera; nunca se da por fuera una caja que lo toca.
+         *
+         * @param min Esquina mnima de la caja en el espacio del mundo.
+         * @param max Esquina mxima de la caja.
+         */
+        Containment classify_box(const glm::vec3 & min, const glm::vec3 & max) const;
+
+        /**
+         * @brief Comprueba un conjunto de esferas guardadas como estructura de arrays.
+         *
+         * @param x Coordenadas X de los centros.
+         * @param y Coordenadas Y de los centros.
+         * @param z Coordenadas Z de los centros.
+         * @param radius Radios.
+         * @param count Nmero de esferas, mltiplo de SIMD_WIDTH (los arrays se rellenan hasta l).
+         * @param visible Recibe 1 por cada esfera que toca el volumen y 0 por cada una que no.
+         */
+        void cull_spheres
+        (
+            const float  * x,
+            const float  * y,
+            const float  * z,
+            const float  * radius,
+            std::size_t    count,
+            std::uint8_t * visible
+        ) const;
+
+    };
+
+}
@@ -0,0 +1,63 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+
+namespace udit
+{
+
+    /**
+     * @class GL_Capture
+     * @brief Graba en un archivo las llamadas a OpenGL que hace la aplicacin durante N frames.
+     *
+     * Al empezar la grabacin se sustituyen los punteros a funcin de GLAD (y los de
+     * OpenGL_Extensions) por versiones que llaman a la funcin original y escriben la llamada en la
+     * traza con el formato descrito en GL_Trace.hpp, incluidos los datos de buffers y texturas. As
+     * se graba todo lo que llega al driver sin tocar el cdigo que dibuja. Las consultas (glGet*)
+     * no se graban porque no cambian el estado.
+     *
+     * Lo que se escribe en un buffer mapeado solo se puede grabar al desmaparlo, por lo que durante
+     * la grabacin no se crean buffers mapeados de forma persistente.
+     *
+     * La traza se reproduce con la herramienta GL_Replay.
+     */
+    class GL_Capture
+    {
+    public:
+
+        /**
+         * @brief Empieza a grabar.
+         *
+         * Debe llamarse con el contexto ya creado, despus de OpenGL_Extensions::load() y antes de
+         * crear los objetos de OpenGL de la escena, para que la traza los incluya.
+         *
+         * @param path Ruta del archivo de la traza.
+         * @param frame_count Frames que se graban.
+         * @param width Ancho de la ventana.
+         * @param height Alto de la ventana.
+         * @return true si se ha podido crear el archivo.
+         */
+        static bool start(const std::string & path, unsigned frame_count, unsigned width, unsigned height);
+
+        /**
+         * @brief Marca el final de un frame. Se llama despus de intercambiar los buffers.
+         *
+         * Cuando se han grabado los frames pedidos se termina la grabacin.
+         */
+        static void end_frame();
+
+        /**
+         * @brief Termina la grabacin aunque no se hayan grabado todos los frames pedidos.
+         */
+        static void stop();
+
+        /**
+         * @brief Indica si se est grabando.
+         */
+        static bool is_active();
+
+    };
+
+}
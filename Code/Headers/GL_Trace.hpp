@@ -0,0 +1,149 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+// Formato de las trazas de llamadas a OpenGL que graba GL_Capture y reproduce la herramienta GL_Replay.
+//
+// Una traza empieza con una cabecera (GL_Trace::Header) seguida de registros. Cada registro es un
+// cdigo de operacin de 16 bits seguido de los argumentos de la llamada tal como estn en memoria,
+// sin relleno, y de los datos a los que apuntan los argumentos de tipo puntero (vrtices, pxeles,
+// cdigo de shaders...) precedidos de su tamao en bytes (64 bits). Los tipos de los argumentos
+// son los de la plataforma que graba, por lo que la traza solo se reproduce en una plataforma con
+// el mismo tamao de puntero (se comprueba con la cabecera).
+//
+// Los nombres de objetos (buffers, texturas...), las localizaciones de uniforms y los objetos de
+// sincronizacin se guardan con el valor que devolvi el driver al grabar; al reproducir se crean
+// los objetos de nuevo y se traducen los valores grabados a los nuevos.
+
+namespace udit
+{
+
+    struct GL_Trace
+    {
+        static constexpr char          MAGIC[8] = { 'U', 'D', 'I', 'T', 'G', 'L', 'T', 'R' };
+        static constexpr std::uint32_t VERSION  = 2;
+
+        struct Header
+        {
+            char          magic[8];
+            std::uint32_t version;
+            std::uint32_t pointer_size;        ///< sizeof(void *) de la plataforma que grab
+            std::uint32_t width;               ///< Tamao de la ventana al grabar
+            std::uint32_t height;
+            std::uint32_t frame_count;         ///< Frames grabados
+        };
+
+        /**
+         * @brief Espacios de nombres de los objetos de OpenGL que se traducen al reproducir.
+         */
+        enum Name_Space
+        {
+            BUFFER,
+            TEXTURE,
+            VERTEX_ARRAY,
+            FRAMEBUFFER,
+            QUERY,
+            SHADER,
+            PROGRAM,
+            NAME_SPACE_COUNT
+        };
+
+        // Tipos con los que se marcan los argumentos que se traducen al reproducir. Se guardan en la
+        // traza como el tipo de OpenGL que representan (GLuint o GLint):
+
+        template< Name_Space NAME_SPACE >
+        struct Name { };                        ///< Nombre de un objeto (GLuint)
+
+        struct Location { };                    ///< Localizacin de un uniform del programa activo (GLint)
+
+    };
+
+}
+
+// Funciones de OpenGL cuyos argumentos son todos valores (o desplazamientos dentro de un buffer
+// pasados como puntero). Para cada una se indica: nombre sin el prefijo gl, parmetros, argumentos
+// y tipos con los que se leen al reproducir.
+
+#define UDIT_GL_TRACE_FUNCTIONS(X) \
+    X(ActiveTexture,                   (GLenum texture), (texture), (GLenum)) \
+    X(AttachShader,                    (GLuint program, GLuint shader), (program, shader), (GL_Trace::Name<GL_Trace::PROGRAM>, GL_Trace::Name<GL_Trace::SHADER>)) \
+    X(BeginConditionalRender,          (GLuint id, GLenum mode), (id, mode), (GL_Trace::Name<GL_Trace::QUERY>, GLenum)) \
+    X(BeginQuery,                      (GLenum target, GLuint id), (target, id), (GLenum, GL_Trace::Name<GL_Trace::QUERY>)) \
+    X(BindBuffer,                      (GLenum target, GLuint buffer), (target, buffer), (GLenum, GL_Trace::Name<GL_Trace::BUFFER>)) \
+    X(BindBufferBase,                  (GLenum target, GLuint index, GLuint buffer), (target, index, buffer), (GLenum, GLuint, GL_Trace::Name<GL_Trace::BUFFER>)) \
+    X(BindBufferRange,                 (GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size), (target, index, buffer, offset, size), (GLenum, GLuint, GL_Trace::Name<GL_Trace::BUFFER>, GLintptr, GLsizeiptr)) \
+    X(BindFramebuffer,                 (GLenum target, GLuint framebuffer), (target, framebuffer), (GLenum, GL_Trace::Name<GL_Trace::FRAMEBUFFER>)) \
+    X(BindTexture,                     (GLenum target, GLuint texture), (target, texture), (GLenum, GL_Trace::Name<GL_Trace::TEXTURE>)) \
+    X(BindVertexArray,                 (GLuint array), (array), (GL_Trace::Name<GL_Trace::VERTEX_ARRAY>)) \
+    X(BlendFunc,                       (GLenum sfactor, GLenum dfactor), (sfactor, dfactor), (GLenum, GLenum)) \
+    X(BlitFramebuffer,                 (GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter), (srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter), (GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum)) \
+    X(Clear,                           (GLbitfield mask), (mask), (GLbitfield)) \
+    X(ClearColor,                      (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha), (GLfloat, GLfloat, GLfloat, GLfloat)) \
+    X(ColorMask,                       (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha), (red, green, blue, alpha), (GLboolean, GLboolean, GLboolean, GLboolean)) \
+    X(CompileShader,                   (GLuint shader), (shader), (GL_Trace::Name<GL_Trace::SHADER>)) \
+    X(DeleteProgram,                   (GLuint program), (program), (GL_Trace::Name<GL_Trace::PROGRAM>)) \
+    X(DeleteShader,                    (GLuint shader), (shader), (GL_Trace::Name<GL_Trace::SHADER>)) \
+    X(DepthFunc,                       (GLenum func), (func), (GLenum)) \
+    X(DepthMask,                       (GLboolean flag), (flag), (GLboolean)) \
+    X(Disable,                         (GLenum cap), (cap), (GLenum)) \
+    X(DrawArrays,                      (GLenum mode, GLint first, GLsizei count), (mode, first, count), (GLenum, GLint, GLsizei)) \
+    X(DrawBuffer,                      (GLenum buf), (buf), (GLenum)) \
+    X(DrawElementsBaseVertex,          (GLenum mode, GLsizei count, GLenum type, const void * indices, GLint basevertex), (mode, count, type, indices, basevertex), (GLenum, GLsizei, GLenum, const void *, GLint)) \
+    X(DrawElementsInstancedBaseVertex, (GLenum mode, GLsizei count, GLenum type, const void * indices, GLsizei instancecount, GLint basevertex), (mode, count, type, indices, instancecount, basevertex), (GLenum, GLsizei, GLenum, const void *, GLsizei, GLint)) \
+    X(Enable,                          (GLenum cap), (cap), (GLenum)) \
+    X(EnableVertexAttribArray,         (GLuint index), (index), (GLuint)) \
+    X(EndConditionalRender,            (), (), ()) \
+    X(EndQuery,                        (GLenum target), (target), (GLenum)) \
+    X(FramebufferTexture2D,            (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level), (target, attachment, textarget, texture, level), (GLenum, GLenum, GLenum, GL_Trace::Name<GL_Trace::TEXTURE>, GLint)) \
+    X(GenerateMipmap,                  (GLenum target), (target), (GLenum)) \
+    X(LinkProgram,                     (GLuint program), (program), (GL_Trace::Name<GL_Trace::PROGRAM>)) \
+    X(PixelStorei,                     (GLenum pname, GLint param), (pname, param), (GLenum, GLint)) \
+    X(PolygonMode,                     (GLenum face, GLenum mode), (face, mode), (GLenum, GLenum)) \
+    X(ReadBuffer,                      (GLenum src), (src), (GLenum)) \
+    X(TexParameteri,                   (GLenum target, GLenum pname, GLint param), (target, pname, param), (GLenum, GLenum, GLint)) \
+    X(Uniform1f,                       (GLint location, GLfloat v0), (location, v0), (GL_Trace::Location, GLfloat)) \
+    X(Uniform1i,                       (GLint location, GLint v0), (location, v0), (GL_Trace::Location, GLint)) \
+    X(UniformBlockBinding,             (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding), (program, uniformBlockIndex, uniformBlockBinding), (GL_Trace::Name<GL_Trace::PROGRAM>, GLuint, GLuint)) \
+    X(UseProgram,                      (GLuint program), (program), (GL_Trace::Name<GL_Trace::PROGRAM>)) \
+    X(VertexAttribDivisor,             (GLuint index, GLuint divisor), (index, divisor), (GLuint, GLuint)) \
+    X(VertexAttribPointer,             (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer), (index, size, type, normalized, stride, pointer), (GLuint, GLint, GLenum, GLboolean, GLsizei, const void *)) \
+    X(Viewport,                        (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height), (GLint, GLint, GLsizei, GLsizei))
+
+// Funciones con datos apuntados, valores devueltos u objetos que hay que traducir de otra forma.
+// Cada una tiene su propia grabacin en GL_Capture y su propia reproduccin en GL_Replay. A estas
+// se suma glMultiDrawElementsIndirect, que no es de GLAD sino de OpenGL_Extensions:
+
+#define UDIT_GL_TRACE_SPECIAL_FUNCTIONS(X) \
+    X(GenBuffers) X(GenTextures) X(GenVertexArrays) X(GenFramebuffers) X(GenQueries) \
+    X(DeleteBuffers) X(DeleteTextures) X(DeleteVertexArrays) X(DeleteFramebuffers) X(DeleteQueries) \
+    X(CreateShader) X(CreateProgram) X(ShaderSource) X(GetUniformLocation) \
+    X(BufferData) X(BufferSubData) X(MapBufferRange) X(UnmapBuffer) \
+    X(TexImage2D) X(TexImage3D) X(DrawBuffers) \
+    X(Uniform2fv) X(Uniform3fv) X(Uniform4fv) X(UniformMatrix3fv) X(UniformMatrix4fv) \
+    X(FenceSync) X(ClientWaitSync) X(DeleteSync)
+
+namespace udit
+{
+
+    /**
+     * @brief Cdigos de operacin de los registros de una traza.
+     */
+    enum class GL_Trace_Opcode : std::uint16_t
+    {
+        #define UDIT_GL_TRACE_OPCODE(NAME, ...) NAME,
+
+        UDIT_GL_TRACE_FUNCTIONS        (UDIT_GL_TRACE_OPCODE)
+        UDIT_GL_TRACE_SPECIAL_FUNCTIONS(UDIT_GL_TRACE_OPCODE)
+
+        #undef  UDIT_GL_TRACE_OPCODE
+
+        MultiDrawElementsIndirect,
+        END_FRAME,                              ///< Fin de un frame (intercambio de buffers)
+        END_TRACE,                              ///< Fin de la traza
+    };
+
+}
@@ -0,0 +1,158 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Hi_Z_Pyramid.hpp"
+#include "Instance_Buffer.hpp"
+#include "Ring_Buffer.hpp"
+#include "Shader_Program.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class GPU_Culling
+     * @brief Descarte de instancias en la GPU con un compute shader, contra el volumen de visin y
+     * una pirmide Hi-Z, que compacta las que sobreviven para los dibujos indirectos.
+     *
+     * La cola escribe, junto a los datos de cada instancia, su esfera envolvente local y el comando
+     * indirecto de su grupo, y deja a 0 el nmero de instancias de los comandos que se pueden
+     * descartar. Un hilo del compute shader por instancia lleva la esfera al mundo con la matriz de
+     * la instancia, la comprueba contra los planos del volumen de visin y, con la matriz del frame
+     * anterior, contra la pirmide Hi-Z construida con su profundidad. Las que sobreviven suman uno
+     * de forma atmica al nmero de instancias de su comando y se copian al hueco que les toca a
+     * partir de su baseInstance en un buffer que solo escribe la GPU. La CPU nunca conoce la
+     * visibilidad de ningn objeto.
+     *
+     * Las instancias que no se pueden descartar (las transparentes, cuyo orden dentro del grupo
+     * importa) se copian a su misma posicin y su comando conserva el nmero de instancias que puso
+     * la CPU.
+     *
+     * Como la pirmide se construye con la profundidad del frame anterior, un objeto que acaba de
+     * quedar a la vista puede tardar un frame en aparecer. Exige compute shaders (OpenGL 4.3) y
+     * multi-draw indirect.
+     */
+    class GPU_Culling
+    {
+    public:
+
+        /**
+         * @struct Instance_Bounds
+         * @brief Lo que necesita el compute shader de cada instancia, adems de sus datos de dibujo.
+         *
+         * El tamao es mltiplo de 16 bytes para que el array tenga la misma disposicin en std430.
+         */
+        struct Instance_Bounds
+        {
+            glm::vec4     sphere;        ///< Centro (xyz) y radio (w) de la esfera envolvente local de la malla
+            std::uint32_t command;       ///< Comando indirecto del grupo de la instancia
+            std::uint32_t cullable;      ///< 1 si la instancia se puede descartar y compactar
+            std::uint32_t reserved[2];   ///< Relleno hasta un mltiplo de 16 bytes
+        };
+
+        // Puntos de enlace de los buffers de almacenamiento en el compute shader:
+
+        enum
+        {
+            INPUT_INSTANCES_BINDING  = 0,   ///< Datos por instancia subidos por la CPU
+            BOUNDS_BINDING           = 1,   ///< Instance_Bounds de cada instancia
+            COMMANDS_BINDING         = 2,   ///< Comandos indirectos del frame
+            OUTPUT_INSTANCES_BINDING = 3,   ///< Instancias que sobreviven, compactadas por grupo
+        };
+
+        static constexpr GLuint WORK_GROUP_SIZE = 64;
+
+    private:
+
+        static const std::string cull_shader_code;
+
+        Shader_Program                      cull_program;
+        Shader_Program::Uniform<glm::mat4>  view_projection_uniform;
+        Shader_Program::Uniform<glm::mat4>  hi_z_matrix_uniform;
+        Shader_Program::Uniform<GLint>      hi_z_level_count_uniform;
+        Shader_Program::Uniform<GLint>      instance_count_uniform;
+
+        Hi_Z_Pyramid        hi_z_pyramid;
+        Ring_Buffer         bounds_buffer;             ///< Instance_Bounds de los ltimos frames
+        GLuint              output_buffer_id;          ///< Instancias que sobreviven (solo las escribe la GPU)
+        std::size_t         output_capacity;           ///< Instancias que caben en el buffer de salida
+
+        glm::mat4           view_projection_matrix;    ///< Matriz del frame actual
+        std::size_t         tested_count;              ///< Instancias enviadas al compute shader en el frame actual
+
+    public:
+
+        /**
+         * @brief Compila el programa de descarte y el de la pirmide.
+         */
+        GPU_Culling();
+
+        /**
+         * @brief Libera el buffer de salida.
+         */
+        ~GPU_Culling();
+
+        GPU_Culling(const GPU_Culling & ) = delete;
+        GPU_Culling & operator = (const GPU_Culling & ) = delete;
+
+        /**
+         * @brief Empieza un frame.
+         * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+         */
+        void begin_frame(const glm::mat4 & view_projection_matrix);
+
+        /**
+         * @brief Descarta las instancias del frame y escribe las que sobreviven en el buffer de salida.
+         *
+         * Los datos de las instancias y los comandos ya deben estar subidos. Al volver, los comandos
+         * indirectos y el buffer de salida estn listos para que los lean los dibujos.
+         *
+         * @param instances Buffer con los datos de las instancias del frame.
+         * @param bounds Instance_Bounds de cada instancia, en el mismo orden.
+         * @param commands_buffer_id Buffer con los comandos indirectos.
+         * @param commands_offset Desplazamiento de los comandos del frame (mltiplo de 256 bytes).
+         * @param command_count Nmero de comandos del frame.
+         */
+        void dispatch
+        (
+            const Instance_Buffer & instances,
+            const std::vector<Instance_Bounds> & bounds,
+            GLuint commands_buffer_id,
+            std::size_t commands_offset,
+            std::size_t command_count
+        );
+
+        /**
+         * @brief Construye la pirmide Hi-Z con la profundidad del frame actual, para el siguiente.
+         * @param depth_texture_id Textura de profundidad de la escena.
+         * @param width Ancho de la textura.
+         * @param height Alto de la textura.
+         */
+        void build_hi_z(GLuint depth_texture_id, GLsizei width, GLsizei height);
+
+        /**
+         * @brief Buffer del que deben leer los dibujos los datos por instancia.
+         */
+        GLuint get_output_buffer_id() const
+        {
+            return output_buffer_id;
+        }
+
+        /**
+         * @brief Instancias enviadas al compute shader en el frame actual.
+         */
+        std::size_t get_tested_count() const
+        {
+            return tested_count;
+        }
+
+    };
+
+}
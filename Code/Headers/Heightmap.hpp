@@ -3,11 +3,13 @@
 
 #pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
 
+#include <cstdint>       // Tipos enteros de tamao fijo
 #include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
 #include <string>        // Biblioteca para trabajar con cadenas de texto
 #include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
 #include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
 #include "../Headers/stb_image.h"  // Librera para cargar imgenes (usada para leer el heightmap)
+#include "Mesh_Arena.hpp"
 
 class Heightmap {
 public:
@@ -15,33 +17,53 @@ public:
      * @brief Constructor de la clase Heightmap.
      *
      * Este constructor carga el heightmap desde una imagen, genera la malla del terreno
-     * y configura los buffers de OpenGL para su renderizado.
+     * y la guarda en la arena de mallas compartida para su renderizado.
      *
+     * @param arena Arena de mallas en la que se guarda la geometra del terreno.
      * @param heightmap_path Ruta del archivo de imagen que contiene el heightmap.
      * @param width Ancho del terreno generado.
      * @param depth Profundidad del terreno generado.
      * @param max_height La altura mxima para los valores del heightmap.
      */
-    Heightmap(const std::string& heightmap_path, float width, float depth, float max_height);
+    Heightmap(udit::Mesh_Arena& arena, const std::string& heightmap_path, float width, float depth, float max_height);
 
     /**
      * @brief Destructor de la clase Heightmap.
      *
-     * Libera los recursos de OpenGL asociados al heightmap, como los buffers y la textura.
+     * Devuelve a la arena de mallas el espacio que ocupaba la geometra del terreno.
      */
     ~Heightmap();
 
     /**
      * @brief Renderiza el heightmap en la escena.
      *
-     * Este mtodo dibuja la malla del terreno utilizando los datos almacenados en los buffers de OpenGL.
+     * Este mtodo dibuja la malla del terreno utilizando el rango que ocupa dentro de la arena de mallas.
      */
     void render();
 
+    /**
+     * @brief Devuelve la descripcin de la malla del terreno para la cola de render.
+     *
+     * @return udit::Mesh El rango de la arena y el estado de rasterizacin con el que se dibuja el terreno.
+     */
+    udit::Mesh get_mesh() const;
+
+    /**
+     * @brief Genera una versin simplificada del terreno para usarla como oclusor.
+     *
+     * Es una rejilla de cells x cells celdas que cubre el mismo terreno. La altura de cada vrtice
+     * es la mnima del terreno alrededor de l, de modo que la rejilla queda por debajo de la
+     * superficie real y nunca tapa algo que el terreno deja ver.
+     *
+     * @param cells Nmero de celdas por lado.
+     * @param occluder_vertices Recibe las posiciones de los vrtices en el espacio local del terreno.
+     * @param occluder_indices Recibe los ndices de los tringulos.
+     */
+    void build_occluder(int cells, std::vector<glm::vec3>& occluder_vertices, std::vector<std::uint32_t>& occluder_indices) const;
+
 private:
-    GLuint vao_id;       ///< ID del Vertex Array Object (VAO) utilizado para almacenar los buffers de vrtices.
-    GLuint vbo_id;       ///< ID del Vertex Buffer Object (VBO) utilizado para almacenar los vrtices del terreno.
-    GLuint ebo_id;       ///< ID del Element Buffer Object (EBO) utilizado para almacenar los ndices de los tringulos.
+    udit::Mesh_Arena& arena;  ///< Arena de mallas en la que se guarda la geometra del terreno.
+    udit::Mesh mesh;          ///< Rango que ocupa el terreno dentro de la arena.
     GLuint texture_id;   ///< ID de la textura del terreno (si se utiliza una).
 
     // Vectores para almacenar los datos de la malla del terreno:
@@ -0,0 +1,111 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Shader_Program.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Hi_Z_Pyramid
+     * @brief Pirmide de profundidad jerrquica (Hi-Z) construida en la GPU con compute shaders.
+     *
+     * El nivel 0 es una copia en R32F del buffer de profundidad de la escena y cada nivel siguiente
+     * guarda, para cada texel, la profundidad ms lejana de los texels del nivel anterior que cubre.
+     * As, si lo ms cercano de un objeto queda por detrs de lo ms lejano de un texel que lo cubre
+     * por completo, el objeto estaba tapado.
+     *
+     * Cuando un nivel tiene un tamao impar, el ltimo texel de cada fila y columna del siguiente
+     * cubre tambin el texel que sobra, de modo que ningn texel se queda sin representar.
+     *
+     * La pirmide se construye al terminar de dibujar un frame y se consulta al comienzo del
+     * siguiente, por lo que guarda la matriz de vista y proyeccin con la que se dibuj aquella
+     * profundidad. Solo se puede usar si OpenGL_Extensions::supports_compute() lo permite.
+     */
+    class Hi_Z_Pyramid
+    {
+    public:
+
+        enum
+        {
+            TEXTURE_UNIT = 0,                  ///< Unidad de textura en la que se lee la profundidad de la escena
+        };
+
+    private:
+
+        static const std::string copy_shader_code;
+        static const std::string reduce_shader_code;
+
+        Shader_Program copy_program;           ///< Copia la profundidad de la escena al nivel 0
+        Shader_Program reduce_program;         ///< Calcula un nivel a partir del anterior
+
+        GLuint    texture_id;
+        GLsizei   width;                       ///< Tamao del nivel 0
+        GLsizei   height;
+        GLint     level_count;                 ///< 0 mientras no se haya construido
+        glm::mat4 view_projection_matrix;      ///< Matriz con la que se dibuj la profundidad
+
+    public:
+
+        /**
+         * @brief Compila los programas. La textura se crea al construir la pirmide por primera vez.
+         */
+        Hi_Z_Pyramid();
+
+        /**
+         * @brief Libera la textura de la pirmide.
+         */
+        ~Hi_Z_Pyramid();
+
+        Hi_Z_Pyramid(const Hi_Z_Pyramid & ) = delete;
+        Hi_Z_Pyramid & operator = (const Hi_Z_Pyramid & ) = delete;
+
+        /**
+         * @brief Construye todos los niveles a partir de un buffer de profundidad.
+         *
+         * Si el tamao cambia la textura se recrea. Al terminar, las lecturas de la textura desde
+         * cualquier shader ya ven los niveles nuevos.
+         *
+         * @param depth_texture_id Textura de profundidad de la escena.
+         * @param width Ancho de la textura de profundidad.
+         * @param height Alto de la textura de profundidad.
+         * @param view_projection_matrix Matriz de vista y proyeccin con la que se dibuj.
+         */
+        void build(GLuint depth_texture_id, GLsizei width, GLsizei height, const glm::mat4 & view_projection_matrix);
+
+        /**
+         * @brief Id de la textura con todos los niveles.
+         */
+        GLuint get_texture_id() const
+        {
+            return texture_id;
+        }
+
+        /**
+         * @brief Nmero de niveles de la pirmide, o 0 si an no se ha construido.
+         */
+        GLint get_level_count() const
+        {
+            return level_count;
+        }
+
+        /**
+         * @brief Matriz de vista y proyeccin con la que se dibuj la profundidad de la pirmide.
+         */
+        const glm::mat4 & get_view_projection_matrix() const
+        {
+            return view_projection_matrix;
+        }
+
+    private:
+
+        void create_texture(GLsizei width, GLsizei height);
+
+    };
+
+}
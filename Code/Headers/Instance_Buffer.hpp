@@ -0,0 +1,117 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Ring_Buffer.hpp"
+
+namespace udit
+{
+
+    /**
+     * @struct Instance_Data
+     * @brief Datos propios de cada copia de una malla dibujada con instancing.
+     *
+     * El tamao es mltiplo de 16 bytes para que cada registro quede alineado en el buffer.
+     */
+    struct Instance_Data
+    {
+        glm::mat4 model_matrix;   ///< Transformacin de la instancia al espacio del mundo
+        float     texture_layer;  ///< Capa del array de texturas que usa la instancia
+        float     transparency;   ///< Opacidad de la instancia (1 = opaca)
+        float     fade;           ///< Fraccin de los pxeles que se dibujan, con un patrn de tramado (1 = todos)
+        float     reserved;       ///< Relleno hasta un mltiplo de 16 bytes
+    };
+
+    /**
+     * @class Instance_Buffer
+     * @brief Buffer con los datos por instancia de los dibujos instanciados.
+     *
+     * Los datos de todas las instancias del frame se escriben con una sola copia en un Ring_Buffer
+     * de tres segmentos (mapeado de forma persistente si el contexto lo permite), de modo que la
+     * CPU nunca espera a que la GPU termine de leer los datos de los frames anteriores.
+     *
+     * Los datos se exponen al vertex shader como atributos con divisor 1: la matriz de modelo ocupa
+     * las localizaciones 3 a 6 y el material (capa de textura, transparencia y desvanecimiento) la
+     * localizacin 7.
+     * Como OpenGL 3.3 no permite indicar la instancia base de un dibujo, cada dibujo apunta los
+     * atributos al primer registro que le corresponde dentro del segmento del frame.
+     *
+     * Con vertex pulling los datos no se leen como atributos sino desde el vertex shader, vinculando
+     * el segmento del frame como buffer de almacenamiento (SSBO) con bind_storage().
+     */
+    class Instance_Buffer
+    {
+    public:
+
+        // Localizaciones de los atributos por instancia en el vertex shader:
+
+        enum
+        {
+            MODEL_MATRIX_ATTRIBUTE = 3,   ///< Primera de las 4 columnas de la matriz de modelo
+            MATERIAL_ATTRIBUTE     = 7,   ///< Capa de textura (x), transparencia (y) y desvanecimiento (z)
+        };
+
+    private:
+
+        Ring_Buffer ring;        ///< Buffer con los datos por instancia de los ltimos frames
+
+    public:
+
+        /**
+         * @brief Crea el buffer con capacidad para un nmero inicial de instancias por frame.
+         * @param initial_capacity Nmero de instancias que caben inicialmente en cada frame.
+         */
+        Instance_Buffer(std::size_t initial_capacity = 1024);
+
+        /**
+         * @brief Escribe en el segmento del frame los datos de todas las instancias.
+         * @param instances Datos de las instancias.
+         */
+        void upload(const std::vector<Instance_Data> & instances);
+
+        /**
+         * @brief Marca el final de los dibujos que leen los datos del frame.
+         *
+         * Debe llamarse despus de emitir el ltimo dibujo que usa los datos subidos con upload().
+         */
+        void end_frame();
+
+        /**
+         * @brief Activa los atributos por instancia en el VAO vinculado actualmente.
+         *
+         * Solo es necesario hacerlo una vez por VAO, ya que el estado queda guardado en l.
+         */
+        void enable_attributes() const;
+
+        /**
+         * @brief Apunta los atributos por instancia del VAO vinculado al registro indicado.
+         * @param first_instance ndice del primer registro que usar el siguiente dibujo.
+         */
+        void bind_attributes(std::size_t first_instance) const;
+
+        /**
+         * @brief Apunta los atributos por instancia del VAO vinculado a registros de otro buffer.
+         *
+         * Lo usa el descarte en la GPU, que escribe las instancias que sobreviven en un buffer propio
+         * con el mismo formato.
+         *
+         * @param buffer_id Buffer con registros Instance_Data.
+         * @param offset Desplazamiento en bytes del primer registro que usar el siguiente dibujo.
+         */
+        static void bind_attributes(GLuint buffer_id, std::size_t offset);
+
+        /**
+         * @brief Vincula el segmento del frame como buffer de almacenamiento para los shaders.
+         * @param binding Punto de enlace del bloque buffer en el shader.
+         * @param instance_count Nmero de registros subidos en el frame.
+         */
+        void bind_storage(GLuint binding, std::size_t instance_count) const;
+
+    };
+
+}
@@ -0,0 +1,97 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <condition_variable>   // Espera de los hilos a que haya trabajos
+#include <cstddef>              // size_t
+#include <deque>                // Cola de trabajos pendientes
+#include <functional>           // function
+#include <mutex>                // Exclusin mutua de la cola
+#include <thread>               // Hilos de trabajo
+#include <vector>               // Biblioteca para usar el contenedor dinmico std::vector
+
+namespace udit
+{
+
+    /**
+     * @class Job_System
+     * @brief Conjunto de hilos de trabajo que reparten entre s tareas de la CPU.
+     *
+     * El trabajo se reparte con parallel_for(): un rango de elementos se divide en subrangos
+     * contiguos, uno por hilo como mucho, que se ejecutan en paralelo. El hilo que llama tambin
+     * procesa un subrango y, mientras espera al resto, ejecuta trabajos pendientes de la cola, por
+     * lo que se puede llamar a parallel_for() desde dentro de otro parallel_for().
+     *
+     * Los subrangos se numeran en orden, de modo que quien llama puede guardar el resultado de
+     * cada uno por separado y combinarlos despus en un orden determinista.
+     */
+    class Job_System
+    {
+    public:
+
+        /**
+         * @brief Funcin que procesa los elementos [first, end) del subrango range.
+         */
+        using Range_Function = std::function< void (std::size_t range, std::size_t first, std::size_t end) >;
+
+    private:
+
+        std::vector<std::thread>          workers;
+        std::deque<std::function<void()>> jobs;           ///< Trabajos pendientes
+        std::mutex                        jobs_mutex;
+        std::condition_variable           job_available;
+        bool                              stopping;
+
+    public:
+
+        /**
+         * @brief Crea los hilos de trabajo.
+         * @param worker_count Nmero de hilos adems del que llama (0 para ejecutarlo todo en l).
+         */
+        Job_System(unsigned worker_count);
+
+        /**
+         * @brief Espera a que terminen los hilos de trabajo.
+         */
+        ~Job_System();
+
+        Job_System(const Job_System & ) = delete;
+        Job_System & operator = (const Job_System & ) = delete;
+
+        /**
+         * @brief Nmero de hilos que procesan trabajos, incluido el que llama.
+         */
+        unsigned get_thread_count() const
+        {
+            return unsigned(workers.size()) + 1;
+        }
+
+        /**
+         * @brief Nmero de subrangos en que parallel_for() divide un rango.
+         *
+         * Sirve para reservar antes de la llamada el espacio en el que cada subrango deja su resultado.
+         *
+         * @param count Nmero de elementos.
+         * @param min_range_size Nmero mnimo de elementos de cada subrango.
+         */
+        std::size_t get_range_count(std::size_t count, std::size_t min_range_size) const;
+
+        /**
+         * @brief Procesa en paralelo los elementos [0, count) y espera a que terminen.
+         *
+         * @param count Nmero de elementos.
+         * @param min_range_size Nmero mnimo de elementos de cada subrango, para que repartir el
+         *        trabajo no cueste ms que hacerlo.
+         * @param function Funcin que procesa cada subrango. Se puede llamar desde cualquier hilo.
+         */
+        void parallel_for(std::size_t count, std::size_t min_range_size, const Range_Function & function);
+
+    private:
+
+        bool run_pending_job();
+        void work();
+
+    };
+
+}
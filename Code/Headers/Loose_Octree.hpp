@@ -0,0 +1,198 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Mesh.hpp"
+#include "Frustum.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Loose_Octree
+     * @brief ndice espacial de las cajas envolventes de los objetos de la escena (octree holgado).
+     *
+     * Cada nodo cubre un cubo del espacio, pero los objetos que guarda pueden sobresalir de l
+     * hasta la mitad de su lado por cada cara: sus lmites holgados miden el doble que su celda.
+     * As un objeto se guarda siempre en un nico nodo, elegido solo por su tamao (la profundidad
+     * a la que el lado de la celda es al menos el de la caja) y por la posicin de su centro, sin
+     * repartirlo entre varios nodos ni subirlo a la raz porque cruce el borde de una celda.
+     *
+     * Insertar, quitar y mover un objeto cuesta O(profundidad). Los objetos de cada nodo forman una
+     * lista doblemente enlazada dentro del array de objetos, y cada nodo cuenta los objetos de su
+     * subrbol para que las consultas se salten las ramas vacas. Los nodos que se quedan vacos se
+     * conservan, de modo que un objeto que se mueve de un lado a otro no crea ni destruye nodos.
+     *
+     * Las consultas (volumen de visin, esfera, caja y rayo) recorren el rbol con una pila fija y
+     * devuelven los valores asociados a los objetos. Cuando un nodo queda entero dentro de la regin
+     * consultada se toman todos los objetos de su subrbol sin comprobarlos, por lo que el coste es
+     * O(log n + k) para k resultados. Los objetos cuyo centro cae fuera del cubo raz se guardan en
+     * la raz y se comprueban uno a uno en cada consulta.
+     */
+    class Loose_Octree
+    {
+    public:
+
+        static constexpr std::uint32_t INVALID   = 0xFFFFFFFF;
+        static constexpr unsigned      MAX_DEPTH = 12;
+
+    private:
+
+        /**
+         * @brief Nodo del rbol. Los hijos se crean al insertar el primer objeto que llega a ellos.
+         */
+        struct Node
+        {
+            glm::vec3     center;               ///< Centro de la celda
+            float         half_size;            ///< Mitad del lado de la celda (los lmites holgados miden el doble)
+            std::uint32_t parent;
+            std::uint32_t children[8];          ///< Indexados por octante: bit 0 = x, bit 1 = y, bit 2 = z
+            std::uint32_t first_object;         ///< Primer objeto guardado en el propio nodo
+            std::uint32_t subtree_count;        ///< Objetos del nodo y de todos sus descendientes
+            unsigned      depth;
+        };
+
+        /**
+         * @brief Objeto guardado. Los huecos de los objetos quitados se reutilizan.
+         */
+        struct Object
+        {
+            glm::vec3     min;                  ///< Caja en el espacio del mundo
+            glm::vec3     max;
+            std::uint32_t value;                ///< Valor que devuelven las consultas
+            std::uint32_t node;                 ///< Nodo que lo guarda (INVALID si el hueco est libre)
+            std::uint32_t previous;             ///< Objetos anterior y siguiente en la lista del nodo
+            std::uint32_t next;
+        };
+
+        std::vector<Node>          nodes;       ///< El primero es la raz
+        std::vector<Object>        objects;     ///< Indexados por handle
+        std::vector<std::uint32_t> free_objects;
+        unsigned                   max_depth;
+        std::size_t                object_count;
+
+    public:
+
+        /**
+         * @brief Crea el rbol con solo la raz.
+         * @param center Centro del cubo raz.
+         * @param half_size Mitad del lado del cubo raz, que debera abarcar toda la escena.
+         * @param max_depth Profundidad mxima (como mucho MAX_DEPTH).
+         */
+        Loose_Octree(const glm::vec3 & center, float half_size, unsigned max_depth = 8);
+
+        /**
+         * @brief Aade un objeto.
+         * @param min Esquina mnima de su caja en el espacio del mundo.
+         * @param max Esquina mxima de su caja.
+         * @param value Valor que devolvern las consultas que lo encuentren.
+         * @return Handle con el que se mueve o se quita el objeto.
+         */
+        std::uint32_t insert(const glm::vec3 & min, const glm::vec3 & max, std::uint32_t value);
+
+        /**
+         * @brief Quita un objeto. Su handle puede reutilizarse en inserciones posteriores.
+         */
+        void remove(std::uint32_t handle);
+
+        /**
+         * @brief Cambia la caja de un objeto que se ha movido.
+         *
+         * Si la caja sigue correspondiendo al mismo nodo solo se actualiza; si no, el objeto pasa
+         * al nodo que le corresponde.
+         */
+        void update(std::uint32_t handle, const glm::vec3 & min, const glm::vec3 & max);
+
+        /**
+         * @brief Valores de los objetos cuya caja toca el volumen de visin.
+         * @param frustum Volumen de visin.
+         * @param values Recibe al final los valores encontrados.
+         */
+        void query_frustum(const Frustum & frustum, std::vector<std::uint32_t> & values) const;
+
+        /**
+         * @brief Valores de los objetos cuya caja toca una esfera.
+         */
+        void query_sphere(const glm::vec3 & center, float radius, std::vector<std::uint32_t> & values) const;
+
+        /**
+         * @brief Valores de los objetos cuya caja se solapa con otra caja.
+         */
+        void query_box(const glm::vec3 & min, const glm::vec3 & max, std::vector<std::uint32_t> & values) const;
+
+        /**
+         * @brief Valores de los objetos cuya caja atraviesa un rayo, en cualquier orden.
+         * @param origin Origen del rayo.
+         * @param direction Direccin del rayo (no hace falta que sea unitaria; las distancias se miden en ella).
+         * @param max_distance Distancia mxima a la que se buscan cortes.
+         * @param values Recibe al final los valores encontrados.
+         */
+        void query_ray(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance, std::vector<std::uint32_t> & values) const;
+
+        /**
+         * @brief Objeto cuya caja corta antes un rayo, para seleccionar objetos con el ratn.
+         *
+         * Los nodos se visitan de ms cercano a ms lejano y se descartan los que empiezan ms all
+         * del mejor corte encontrado.
+         *
+         * @param origin Origen del rayo.
+         * @param direction Direccin del rayo.
+         * @param max_distance Distancia mxima a la que se buscan cortes.
+         * @param distance Recibe la distancia al corte si lo hay.
+         * @return El valor del objeto o INVALID si el rayo no corta ninguno.
+         */
+        std::uint32_t pick(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance, float & distance) const;
+
+        /**
+         * @brief Nmero de objetos guardados.
+         */
+        std::size_t size() const
+        {
+            return object_count;
+        }
+
+        /**
+         * @brief Calcula la caja en el espacio del mundo de una malla transformada.
+         *
+         * Cada eje de la caja transformada suma las proyecciones de los tres ejes de la local
+         * (mtodo de Arvo), sin transformar sus ocho esquinas.
+         *
+         * @param bounds Volmenes envolventes locales de la malla.
+         * @param model_matrix Transformacin de la malla al espacio del mundo.
+         * @param min Recibe la esquina mnima.
+         * @param max Recibe la esquina mxima.
+         */
+        static void transform_box(const Bounds & bounds, const glm::mat4 & model_matrix, glm::vec3 & min, glm::vec3 & max);
+
+    private:
+
+        std::uint32_t find_node(const glm::vec3 & min, const glm::vec3 & max);
+        bool          fits_node(std::uint32_t node_index, const glm::vec3 & min, const glm::vec3 & max) const;
+        unsigned      get_depth(const glm::vec3 & min, const glm::vec3 & max) const;
+
+        void link  (std::uint32_t handle, std::uint32_t node_index);
+        void unlink(std::uint32_t handle);
+
+        void collect(std::uint32_t node_index, std::vector<std::uint32_t> & values) const;
+
+        template< typename CLASSIFY_NODE, typename TEST_OBJECT >
+        void query(CLASSIFY_NODE classify_node, TEST_OBJECT test_object, std::vector<std::uint32_t> & values) const;
+
+        glm::vec3 get_loose_min(const Node & node) const
+        {
+            return node.center - glm::vec3(node.half_size * 2.f);
+        }
+
+        glm::vec3 get_loose_max(const Node & node) const
+        {
+            return node.center + glm::vec3(node.half_size * 2.f);
+        }
+
+    };
+
+}
@@ -0,0 +1,85 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+namespace udit
+{
+
+    /**
+     * @class Material_Textures
+     * @brief Texturas de los materiales de la escena empaquetadas en un solo GL_TEXTURE_2D_ARRAY.
+     *
+     * Todas las capas del array tienen el mismo tamao; las imgenes de otro tamao se reescalan al
+     * cargarlas. Cada objeto indica la capa de su material como dato por instancia, de modo que los
+     * objetos con materiales distintos no necesitan cambiar de textura entre dibujos y se pueden
+     * agrupar en los mismos dibujos instanciados o indirectos.
+     *
+     * Las imgenes se acumulan en memoria con load() y se suben a la GPU juntas con upload().
+     */
+    class Material_Textures
+    {
+        GLsizei layer_width;
+        GLsizei layer_height;
+        GLuint  texture_id;
+
+        std::vector<unsigned char> pixels;     ///< Capas cargadas pendientes de subir (RGBA)
+        unsigned                   layer_count;
+
+    public:
+
+        /**
+         * @brief Prepara un array de texturas vaco.
+         * @param layer_width Ancho en pxeles de cada capa.
+         * @param layer_height Alto en pxeles de cada capa.
+         */
+        Material_Textures(GLsizei layer_width = 1024, GLsizei layer_height = 1024);
+
+        /**
+         * @brief Libera el array de texturas.
+         */
+       ~Material_Textures();
+
+        Material_Textures(const Material_Textures & ) = delete;
+        Material_Textures & operator = (const Material_Textures & ) = delete;
+
+        /**
+         * @brief Carga una imagen en una capa nueva, reescalndola si no tiene el tamao de las capas.
+         *
+         * Si la imagen no se puede cargar la capa se rellena de blanco para que el objeto se siga viendo.
+         *
+         * @param path Ruta del archivo de imagen.
+         * @return ndice de la capa.
+         */
+        unsigned load(const std::string & path);
+
+        /**
+         * @brief Crea el array de texturas con todas las capas cargadas y genera sus mipmaps.
+         *
+         * Libera la copia en memoria de las imgenes.
+         */
+        void upload();
+
+        /**
+         * @brief Id del array de texturas de OpenGL (0 hasta que se llama a upload()).
+         */
+        GLuint get_id() const
+        {
+            return texture_id;
+        }
+
+        /**
+         * @brief Nmero de capas cargadas.
+         */
+        unsigned get_layer_count() const
+        {
+            return layer_count;
+        }
+
+    };
+
+}
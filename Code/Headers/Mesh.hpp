@@ -0,0 +1,50 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+
+namespace udit
+{
+
+    /**
+     * @struct Bounds
+     * @brief Volmenes envolventes de una malla en su espacio local.
+     *
+     * La esfera se centra en el centro de la caja y su radio es la distancia al vrtice ms
+     * alejado, por lo que nunca es mayor que la que circunscribe la caja.
+     */
+    struct Bounds
+    {
+        glm::vec3 min    { 0.f };      ///< Esquina mnima de la caja alineada con los ejes (AABB)
+        glm::vec3 max    { 0.f };      ///< Esquina mxima de la caja
+        glm::vec3 center { 0.f };      ///< Centro de la esfera envolvente
+        float     radius = 0.f;        ///< Radio de la esfera envolvente
+    };
+
+    /**
+     * @struct Mesh
+     * @brief Descripcin de una malla indexada lista para ser dibujada.
+     *
+     * Recoge lo mnimo que necesita la cola de render para emitir el dibujo de una malla sin
+     * conocer la clase concreta que la gener: el rango que ocupa dentro de los buffers de la
+     * arena de mallas y el estado de rasterizacin con el que la malla espera ser dibujada.
+     * Los ndices son siempre de tipo GL_UNSIGNED_INT y relativos al vrtice base.
+     */
+    struct Mesh
+    {
+        GLuint        vao_id;        ///< VAO que contiene los atributos y el EBO de la malla
+        std::uint32_t mesh_id;       ///< Identificador de la malla dentro de su arena
+        GLsizei       index_count;   ///< Nmero de ndices que forman los tringulos
+        GLuint        first_index;   ///< Posicin del primer ndice dentro del EBO
+        GLint         base_vertex;   ///< Posicin del primer vrtice dentro del VBO
+        GLsizei       vertex_count;  ///< Nmero de vrtices de la malla
+        GLenum        polygon_mode;  ///< Modo de relleno de los polgonos (GL_FILL o GL_LINE)
+        bool          cull_face;     ///< Indica si la malla se dibuja con GL_CULL_FACE activado
+        Bounds        bounds;        ///< Caja y esfera envolventes de los vrtices de la malla
+    };
+
+}
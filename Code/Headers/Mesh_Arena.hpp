@@ -0,0 +1,182 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include "Mesh.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Mesh_Arena
+     * @brief Almacn comn de vrtices e ndices para todas las mallas de la escena.
+     *
+     * En lugar de que cada primitiva cree su propio VAO y sus propios buffers, todas reservan un
+     * rango de vrtices y otro de ndices dentro de un nico VBO y un nico EBO compartidos por un
+     * solo VAO. Cada malla queda descrita por un registro (primer ndice, nmero de ndices y vrtice
+     * base) que se dibuja con glDrawElementsBaseVertex, por lo que dibujar mallas distintas no exige
+     * cambiar de VAO.
+     *
+     * La arena guarda una copia en CPU de la geometra, que se usa para volver a subirla cuando los
+     * buffers tienen que crecer.
+     */
+    class Mesh_Arena
+    {
+    public:
+
+        /**
+         * @struct Vertex
+         * @brief Formato de vrtice entrelazado de la arena.
+         *
+         * Las localizaciones de los atributos son las mismas que usaban las primitivas: 0 para la
+         * posicin, 1 para el color (o la normal en el terreno) y 2 para las coordenadas UV.
+         */
+        struct Vertex
+        {
+            GLfloat position[3];
+            GLfloat color   [3];
+            GLfloat uv      [2];
+        };
+
+    private:
+
+        /**
+         * @brief Reparto de un espacio lineal en rangos libres y ocupados (first fit).
+         */
+        struct Range_Allocator
+        {
+            struct Range
+            {
+                std::size_t offset;
+                std::size_t size;
+            };
+
+            std::vector<Range> free_ranges;   ///< Rangos libres ordenados por offset
+            std::size_t        end = 0;       ///< Final de la zona usada alguna vez
+
+            std::size_t allocate(std::size_t size);
+            void        release (std::size_t offset, std::size_t size);
+        };
+
+        GLuint vao_id;                        ///< VAO compartido por todas las mallas
+        GLuint vbo_id;                        ///< VBO con los vrtices de todas las mallas
+        GLuint ebo_id;                        ///< EBO con los ndices de todas las mallas
+
+        std::vector<Vertex> vertices;         ///< Copia en CPU del contenido del VBO
+        std::vector<GLuint> indices;          ///< Copia en CPU del contenido del EBO
+
+        Range_Allocator vertex_ranges;        ///< Ocupacin del VBO
+        Range_Allocator  index_ranges;        ///< Ocupacin del EBO
+
+        std::size_t vertex_capacity;          ///< Vrtices que caben en el VBO
+        std::size_t  index_capacity;          ///< ndices que caben en el EBO
+
+        std::uint32_t next_mesh_id;           ///< Identificador de la prxima malla reservada
+
+    public:
+
+        /**
+         * @brief Crea el VAO y los buffers compartidos con una capacidad inicial.
+         * @param initial_vertices Nmero de vrtices que caben inicialmente.
+         * @param initial_indices Nmero de ndices que caben inicialmente.
+         */
+        Mesh_Arena(std::size_t initial_vertices = 65536, std::size_t initial_indices = 262144);
+
+        /**
+         * @brief Libera el VAO y los buffers compartidos.
+         */
+        ~Mesh_Arena();
+
+        Mesh_Arena(const Mesh_Arena & ) = delete;
+        Mesh_Arena & operator = (const Mesh_Arena & ) = delete;
+
+        /**
+         * @brief Reserva espacio para una malla y sube su geometra.
+         *
+         * @param mesh_vertices Vrtices de la malla en el formato de la arena.
+         * @param mesh_indices ndices de la malla, relativos a su primer vrtice.
+         * @param polygon_mode Modo de relleno con el que se dibuja la malla.
+         * @param cull_face Indica si la malla se dibuja con GL_CULL_FACE activado.
+         * @return Mesh El registro que describe la malla dentro de la arena.
+         */
+        Mesh allocate(const std::vector<Vertex> & mesh_vertices, const std::vector<GLuint> & mesh_indices, GLenum polygon_mode, bool cull_face);
+
+        /**
+         * @brief Reserva una malla a partir de arrays separados de coordenadas, colores y UVs.
+         *
+         * Es el formato en el que generan su geometra Plane, Cone, Cylinder y Cube. Los colores y
+         * las UVs pueden omitirse (nullptr), en cuyo caso se rellenan con ceros.
+         *
+         * @param coordinates Coordenadas (X, Y, Z) de cada vrtice.
+         * @param colors Colores (R, G, B) de cada vrtice o nullptr.
+         * @param uvs Coordenadas (U, V) de cada vrtice o nullptr.
+         * @param vertex_count Nmero de vrtices.
+         * @param mesh_indices ndices de la malla, relativos a su primer vrtice.
+         * @param polygon_mode Modo de relleno con el que se dibuja la malla.
+         * @param cull_face Indica si la malla se dibuja con GL_CULL_FACE activado.
+         * @return Mesh El registro que describe la malla dentro de la arena.
+         */
+        Mesh allocate
+        (
+            const GLfloat * coordinates,
+            const GLfloat * colors,
+            const GLfloat * uvs,
+            std::size_t     vertex_count,
+            const std::vector<GLuint> & mesh_indices,
+            GLenum          polygon_mode,
+            bool            cull_face
+        );
+
+        /**
+         * @brief Devuelve a la arena el espacio ocupado por una malla.
+         * @param mesh Malla reservada previamente con allocate().
+         */
+        void release(const Mesh & mesh);
+
+        /**
+         * @brief Copia la geometra de una malla desde la copia en CPU de la arena.
+         * @param mesh Malla reservada previamente con allocate().
+         * @param mesh_vertices Recibe los vrtices de la malla.
+         * @param mesh_indices Recibe los ndices de la malla, relativos a su primer vrtice.
+         */
+        void read(const Mesh & mesh, std::vector<Vertex> & mesh_vertices, std::vector<GLuint> & mesh_indices) const;
+
+        /**
+         * @brief Dibuja una malla de la arena (el VAO de la arena debe estar vinculado).
+         * @param mesh Malla que se dibuja.
+         */
+        static void draw(const Mesh & mesh);
+
+        /**
+         * @brief Id del VAO compartido por todas las mallas.
+         */
+        GLuint get_vao_id() const
+        {
+            return vao_id;
+        }
+
+        /**
+         * @brief Id del VBO con los vrtices de todas las mallas.
+         *
+         * Los vrtices estn entrelazados con el formato de Vertex (8 floats por vrtice).
+         */
+        GLuint get_vertex_buffer_id() const
+        {
+            return vbo_id;
+        }
+
+    private:
+
+        void reserve_vertices(std::size_t capacity);
+        void reserve_indices (std::size_t capacity);
+
+        static Bounds compute_bounds(const std::vector<Vertex> & mesh_vertices);
+
+    };
+
+}
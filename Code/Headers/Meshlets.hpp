@@ -0,0 +1,129 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Mesh_Arena.hpp"
+#include "Frustum.hpp"
+
+namespace udit
+{
+
+    /**
+     * @struct Meshlet
+     * @brief Grupo de tringulos contiguos de una malla con sus volmenes para descartarlo entero.
+     */
+    struct Meshlet
+    {
+        glm::vec3     center;          ///< Centro de la esfera envolvente
+        float         radius;          ///< Radio de la esfera envolvente
+        glm::vec3     cone_axis;       ///< Direccin media de las normales de sus tringulos
+        float         cone_cutoff;     ///< Seno del ngulo del cono de normales (1 si no se puede descartar por orientacin)
+        GLuint        first_index;     ///< Primer ndice, relativo al primero de la malla
+        GLsizei       index_count;     ///< Nmero de ndices (3 por tringulo)
+        std::uint32_t vertex_count;    ///< Vrtices distintos que usa
+    };
+
+    /**
+     * @class Meshlets
+     * @brief Particin de una malla en meshlets (clusters) que se descartan por separado.
+     *
+     * build() reparte los tringulos en grupos de como mucho MAX_VERTICES vrtices distintos y
+     * MAX_TRIANGLES tringulos, y reordena los ndices de la malla para que los de cada grupo queden
+     * seguidos. Cada grupo crece de forma voraz a partir de un tringulo libre con los tringulos
+     * vecinos que aaden menos vrtices nuevos y estn ms cerca de su centro, de modo que queda
+     * compacto y su esfera envolvente es pequea.
+     *
+     * De cada meshlet se guarda su esfera y un cono con las normales de sus tringulos. cull()
+     * descarta los que quedan fuera del volumen de visin (de cuatro en cuatro con
+     * Frustum::cull_spheres) y los que la cmara ve por detrs: si la cmara queda dentro del cono
+     * opuesto al de las normales, todos sus tringulos le dan la espalda. Los que sobreviven se
+     * devuelven como rangos de ndices, uniendo los consecutivos, para emitir solo esos ndices.
+     *
+     * Los lmites coinciden con los habituales de los mesh shaders, aunque aqu los meshlets se
+     * dibujan como rangos del EBO de la arena.
+     */
+    class Meshlets
+    {
+    public:
+
+        static constexpr std::size_t MAX_VERTICES  =  64;
+        static constexpr std::size_t MAX_TRIANGLES = 124;
+
+        /**
+         * @brief Rango de ndices de la malla que se emite con un dibujo.
+         */
+        struct Index_Range
+        {
+            GLuint  first_index;       ///< Primer ndice, relativo al primero de la malla
+            GLsizei index_count;
+        };
+
+    private:
+
+        std::vector<Meshlet> meshlets;
+
+        // Esferas como estructura de arrays, rellenas hasta un mltiplo de Frustum::SIMD_WIDTH:
+
+        std::vector<float>        sphere_x;
+        std::vector<float>        sphere_y;
+        std::vector<float>        sphere_z;
+        std::vector<float>        sphere_radius;
+        std::vector<std::uint8_t> visibility;
+
+    public:
+
+        /**
+         * @brief Reparte una malla en meshlets y reordena sus ndices.
+         *
+         * @param vertices Vrtices de la malla en el espacio en que se van a descartar.
+         * @param indices ndices de la malla (tringulos), que se reordenan por meshlets.
+         */
+        void build(const std::vector<Mesh_Arena::Vertex> & vertices, std::vector<GLuint> & indices);
+
+        /**
+         * @brief Calcula qu meshlets pueden verse.
+         *
+         * @param frustum Volumen de visin, en el mismo espacio que los vrtices.
+         * @param camera_position Posicin de la cmara en ese espacio.
+         * @param back_face_culling Indica si se descartan los meshlets vistos por detrs (solo
+         * tiene sentido si la malla se dibuja con GL_CULL_FACE).
+         * @param ranges Recibe los rangos de ndices de los meshlets visibles, unidos cuando son consecutivos.
+         * @return El nmero de meshlets visibles.
+         */
+        std::size_t cull
+        (
+            const Frustum & frustum,
+            const glm::vec3 & camera_position,
+            bool back_face_culling,
+            std::vector<Index_Range> & ranges
+        );
+
+        /**
+         * @brief Nmero de meshlets.
+         */
+        std::size_t size() const
+        {
+            return meshlets.size();
+        }
+
+        /**
+         * @brief Meshlet i-simo.
+         */
+        const Meshlet & operator [] (std::size_t index) const
+        {
+            return meshlets[index];
+        }
+
+    private:
+
+        void compute_bounds(Meshlet & meshlet, const std::vector<Mesh_Arena::Vertex> & vertices, const std::vector<GLuint> & indices) const;
+
+    };
+
+}
@@ -0,0 +1,139 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Job_System.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Occlusion_Buffer
+     * @brief Buffer de profundidad de baja resolucin rasterizado en CPU para descartar objetos tapados.
+     *
+     * Cada frame se rasterizan unos pocos oclusores (el terreno simplificado y los objetos grandes)
+     * en un buffer pequeo (256x128 por defecto) que guarda la profundidad normalizada ms cercana
+     * de cada pxel. Despus, la caja envolvente de cada objeto se proyecta a la pantalla y el objeto
+     * se da por tapado si en todos los pxeles que cubre hay un oclusor ms cercano que el punto ms
+     * cercano de la caja.
+     *
+     * El rasterizador evala las funciones de arista y la profundidad de cuatro pxeles a la vez con
+     * SSE. El buffer se divide en franjas horizontales que se rasterizan en paralelo en los hilos del
+     * Job_System, cada una con todos los tringulos recortados a sus filas, por lo que ningn pxel
+     * lo escriben dos hilos.
+     *
+     * Para que el descarte sea conservador, los tringulos que cruzan el plano cercano no se
+     * rasterizan (los recortara la GPU) y las cajas que lo cruzan se dan siempre por visibles.
+     *
+     * La clase no usa OpenGL: se puede probar sin GPU.
+     */
+    class Occlusion_Buffer
+    {
+    public:
+
+        static constexpr unsigned BAND_HEIGHT = 16;         ///< Filas de cada franja que rasteriza un hilo
+
+    private:
+
+        /**
+         * @brief Vrtice de un oclusor proyectado a la pantalla.
+         */
+        struct Screen_Vertex
+        {
+            float x, y;                                     ///< Posicin en pxeles
+            float z;                                        ///< Profundidad normalizada (-1 a 1)
+            bool  valid;                                    ///< Est delante del plano cercano
+        };
+
+        Job_System                 & job_system;
+
+        unsigned                     width;                  ///< Mltiplo de 4
+        unsigned                     height;
+
+        std::vector<float>           depth;                  ///< Profundidad ms cercana de cada pxel
+        std::vector<glm::vec3>       occluder_vertices;      ///< Vrtices de todos los oclusores en el mundo
+        std::vector<std::uint32_t>   occluder_indices;       ///< Tringulos de todos los oclusores
+        std::vector<Screen_Vertex>   screen_vertices;        ///< Vrtices proyectados en el frame actual
+
+        glm::mat4                    view_projection_matrix;
+
+    public:
+
+        /**
+         * @brief Crea el buffer.
+         * @param job_system Hilos entre los que se reparte la rasterizacin.
+         * @param width Ancho en pxeles (se redondea a un mltiplo de 4).
+         * @param height Alto en pxeles.
+         */
+        Occlusion_Buffer(Job_System & job_system, unsigned width = 256, unsigned height = 128);
+
+        Occlusion_Buffer(const Occlusion_Buffer & ) = delete;
+        Occlusion_Buffer & operator = (const Occlusion_Buffer & ) = delete;
+
+        /**
+         * @brief Aade un oclusor, que se rasterizar todos los frames.
+         *
+         * Los oclusores deben estar por dentro de la superficie que representan (nunca delante de
+         * ella) para que no tapen lo que en realidad se ve.
+         *
+         * @param vertices Posiciones de los vrtices en el espacio local.
+         * @param indices Tringulos, tres ndices por tringulo.
+         * @param model_matrix Transformacin del oclusor al espacio del mundo.
+         */
+        void add_occluder(const std::vector<glm::vec3> & vertices, const std::vector<std::uint32_t> & indices, const glm::mat4 & model_matrix);
+
+        /**
+         * @brief Quita todos los oclusores.
+         */
+        void clear_occluders();
+
+        /**
+         * @brief Borra el buffer y rasteriza los oclusores vistos con la matriz indicada.
+         * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+         */
+        void render(const glm::mat4 & view_projection_matrix);
+
+        /**
+         * @brief Indica si alguna parte de una caja puede verse por delante de los oclusores.
+         *
+         * Se puede llamar desde varios hilos a la vez una vez terminado render().
+         *
+         * @param min Esquina mnima de la caja en el espacio local.
+         * @param max Esquina mxima de la caja en el espacio local.
+         * @param model_matrix Transformacin de la caja al espacio del mundo.
+         * @return false solo si la caja est completamente tapada o fuera de la pantalla.
+         */
+        bool is_visible(const glm::vec3 & min, const glm::vec3 & max, const glm::mat4 & model_matrix) const;
+
+        unsigned get_width () const { return width;  }
+        unsigned get_height() const { return height; }
+
+        /**
+         * @brief Profundidades del buffer, por filas de abajo arriba (para depurar o probar).
+         */
+        const float * get_depth_data() const
+        {
+            return depth.data();
+        }
+
+        /**
+         * @brief Nmero de tringulos de todos los oclusores.
+         */
+        std::size_t get_triangle_count() const
+        {
+            return occluder_indices.size() / 3;
+        }
+
+    private:
+
+        void rasterize_band(unsigned first_row, unsigned end_row);
+        void rasterize_triangle(const Screen_Vertex & a, const Screen_Vertex & b, const Screen_Vertex & c, unsigned first_row, unsigned end_row);
+
+    };
+
+}
@@ -0,0 +1,144 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Mesh.hpp"
+#include "Shader_Program.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Occlusion_Queries
+     * @brief Consultas de oclusin de la GPU sobre las cajas envolventes de los objetos, con coherencia temporal.
+     *
+     * Cada objeto que se sigue (identificado por un id estable entre frames) recibe cada frame una
+     * consulta GL_ANY_SAMPLES_PASSED_CONSERVATIVE (o GL_ANY_SAMPLES_PASSED si el contexto no la
+     * tiene) que dibuja su caja sin escribir color ni profundidad, despus de los opacos visibles.
+     *
+     * El resultado se lee en el frame siguiente, cuando ya debera estar listo, y solo si lo est:
+     * la CPU nunca espera a la GPU. Los objetos que estaban visibles se dibujan con normalidad y su
+     * consulta solo sirve para detectar cundo quedan tapados. Los que estaban tapados se dibujan con
+     * glBeginConditionalRender sobre la consulta de este mismo frame, de modo que es la GPU la que
+     * se salta su dibujo si siguen tapados.
+     *
+     * Para no dar por tapado lo que no lo est, las cajas que cruzan el plano cercano no se
+     * consultan y su objeto se da siempre por visible.
+     */
+    class Occlusion_Queries
+    {
+    private:
+
+        static const std::string vertex_shader_code;
+        static const std::string fragment_shader_code;
+
+        /**
+         * @brief Consultas y visibilidad de un objeto. Se alternan dos consultas de un frame al siguiente.
+         */
+        struct Object_State
+        {
+            GLuint        query_ids   [2] = { 0, 0 };
+            std::uint64_t issued_frame[2] = { 0, 0 };   ///< Frame en el que se emiti cada consulta (0 = nunca)
+            bool          visible         = true;       ///< Visibilidad segn la ltima consulta leda
+        };
+
+        /**
+         * @brief Caja que se consulta en el frame actual.
+         */
+        struct Box
+        {
+            GLuint    query_id;
+            glm::mat4 clip_matrix;                      ///< Lleva el cubo de la arena al espacio de recorte
+        };
+
+        Shader_Program                      program;              ///< Dibuja las cajas sin color
+        Shader_Program::Uniform<glm::mat4>  clip_matrix_uniform;
+        Mesh                                box_mesh;             ///< Cubo de -1 a 1 de la arena de mallas
+        GLenum                              query_target;
+
+        std::vector<Object_State>           objects;              ///< Indexado por id de objeto
+        std::vector<Box>                    boxes;                ///< Consultas pedidas en el frame actual
+
+        glm::mat4                           view_projection_matrix;
+        std::uint64_t                       frame;
+
+        std::size_t                         hit_count;            ///< Consultas ledas con el objeto visible
+        std::size_t                         miss_count;           ///< Consultas ledas con el objeto tapado
+        std::size_t                         pending_count;        ///< Consultas cuyo resultado an no estaba listo
+
+    public:
+
+        /**
+         * @brief Crea el programa con el que se dibujan las cajas.
+         * @param box_mesh Cubo de -1 a 1 guardado en la arena de mallas.
+         */
+        Occlusion_Queries(const Mesh & box_mesh);
+
+        /**
+         * @brief Libera las consultas de todos los objetos.
+         */
+        ~Occlusion_Queries();
+
+        Occlusion_Queries(const Occlusion_Queries & ) = delete;
+        Occlusion_Queries & operator = (const Occlusion_Queries & ) = delete;
+
+        /**
+         * @brief Empieza un frame: olvida las cajas del anterior y reinicia las estadsticas.
+         * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+         */
+        void begin_frame(const glm::mat4 & view_projection_matrix);
+
+        /**
+         * @brief Pide la consulta de un objeto para el frame actual (solo en el hilo del contexto).
+         *
+         * Antes se lee, si ya est disponible, el resultado de la consulta del frame anterior.
+         *
+         * @param object_id Identificador estable del objeto.
+         * @param bounds Volmenes envolventes de la malla del objeto.
+         * @param model_matrix Transformacin del objeto al espacio del mundo.
+         * @param hidden Recibe true si el objeto estaba tapado en el frame anterior.
+         * @return La consulta que se emitir en issue(), o 0 si la caja no se consulta.
+         */
+        GLuint request(std::uint32_t object_id, const Bounds & bounds, const glm::mat4 & model_matrix, bool & hidden);
+
+        /**
+         * @brief Emite las consultas pedidas en el frame, dibujando cada caja contra la profundidad actual.
+         *
+         * Debe llamarse despus de dibujar los opacos visibles y antes de los dibujos condicionales.
+         */
+        void issue();
+
+        /**
+         * @brief Consultas ledas en el frame actual que encontraron visible su objeto.
+         */
+        std::size_t get_hit_count() const
+        {
+            return hit_count;
+        }
+
+        /**
+         * @brief Consultas ledas en el frame actual que encontraron tapado su objeto.
+         */
+        std::size_t get_miss_count() const
+        {
+            return miss_count;
+        }
+
+        /**
+         * @brief Consultas del frame anterior cuyo resultado an no estaba disponible.
+         */
+        std::size_t get_pending_count() const
+        {
+            return pending_count;
+        }
+
+    };
+
+}
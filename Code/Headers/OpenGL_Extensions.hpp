@@ -0,0 +1,167 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+// GLAD est generado solo para OpenGL 3.3. Las constantes de versiones posteriores que se usan
+// se definen aqu con los valores de la especificacin:
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+#ifndef GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+#define GL_ANY_SAMPLES_PASSED_CONSERVATIVE 0x8D6A
+#endif
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT  0x00000001
+#define GL_TEXTURE_FETCH_BARRIER_BIT        0x00000008
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT  0x00000020
+#define GL_COMMAND_BARRIER_BIT              0x00000040
+#define GL_SHADER_STORAGE_BARRIER_BIT       0x00002000
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT   0x0040
+#define GL_MAP_COHERENT_BIT     0x0080
+#define GL_DYNAMIC_STORAGE_BIT  0x0100
+#define GL_CLIENT_STORAGE_BIT   0x0200
+#endif
+
+namespace udit
+{
+
+    /**
+     * @class OpenGL_Extensions
+     * @brief Carga en tiempo de ejecucin las funciones de OpenGL posteriores a la versin 3.3.
+     *
+     * Las funciones se obtienen con SDL_GL_GetProcAddress una vez creado el contexto. Cada
+     * funcionalidad solo se da por disponible si el contexto tiene la versin que la incluye o
+     * anuncia la extensin ARB correspondiente y adems se han podido cargar todas sus funciones.
+     * Quien la use debe comprobarlo y recurrir al camino de OpenGL 3.3 si no lo est.
+     */
+    class OpenGL_Extensions
+    {
+    public:
+
+        using Buffer_Storage_Function = void (APIENTRYP)(GLenum target, GLsizeiptr size, const void * data, GLbitfield flags);
+
+        using Multi_Draw_Elements_Indirect_Function = void (APIENTRYP)(GLenum mode, GLenum type, const void * indirect, GLsizei draw_count, GLsizei stride);
+
+        using Dispatch_Compute_Function = void (APIENTRYP)(GLuint group_count_x, GLuint group_count_y, GLuint group_count_z);
+
+        using Memory_Barrier_Function = void (APIENTRYP)(GLbitfield barriers);
+
+        using Bind_Image_Texture_Function = void (APIENTRYP)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+
+        static Buffer_Storage_Function              buffer_storage;                 ///< glBufferStorage (4.4 o ARB_buffer_storage)
+        static Multi_Draw_Elements_Indirect_Function multi_draw_elements_indirect;  ///< glMultiDrawElementsIndirect (4.3 o ARB_multi_draw_indirect)
+        static Dispatch_Compute_Function            dispatch_compute;               ///< glDispatchCompute (4.3)
+        static Memory_Barrier_Function              memory_barrier;                 ///< glMemoryBarrier (4.2)
+        static Bind_Image_Texture_Function          bind_image_texture;             ///< glBindImageTexture (4.2)
+
+    private:
+
+        static GLint context_major_version;
+        static GLint context_minor_version;
+        static bool  buffer_storage_supported;
+        static bool  multi_draw_indirect_supported;
+        static bool  shader_storage_supported;
+        static bool  conservative_occlusion_supported;
+        static bool  compute_supported;
+
+    public:
+
+        /**
+         * @brief Carga las funciones disponibles en el contexto actual.
+         *
+         * Debe llamarse una vez, despus de crear el contexto de OpenGL e inicializar GLAD.
+         */
+        static void load();
+
+        /**
+         * @brief Indica si el contexto es al menos de la versin indicada.
+         */
+        static bool has_version(GLint major, GLint minor);
+
+        /**
+         * @brief Indica si el contexto anuncia una extensin.
+         * @param name Nombre completo de la extensin (por ejemplo "GL_ARB_buffer_storage").
+         */
+        static bool has_extension(const char * name);
+
+        /**
+         * @brief Indica si se pueden crear buffers inmutables mapeados de forma persistente.
+         */
+        static bool supports_buffer_storage()
+        {
+            return buffer_storage_supported;
+        }
+
+        /**
+         * @brief Deja de dar por disponibles los buffers inmutables.
+         *
+         * Los buffers que se creen a partir de entonces se mapearn y desmaparn en cada uso. Lo usa
+         * GL_Capture, que solo puede grabar lo que se escribe en un buffer mapeado al desmaparlo.
+         */
+        static void disable_buffer_storage()
+        {
+            buffer_storage_supported = false;
+        }
+
+        /**
+         * @brief Indica si se pueden emitir varios dibujos indirectos con una llamada.
+         *
+         * Incluye el uso de baseInstance en los comandos indirectos (4.2 o ARB_base_instance).
+         */
+        static bool supports_multi_draw_indirect()
+        {
+            return multi_draw_indirect_supported;
+        }
+
+        /**
+         * @brief Indica si los shaders pueden leer buffers de almacenamiento (SSBOs).
+         *
+         * Los shaders que los usan deben declarar #version 430, por lo que se exige la versin 4.3
+         * del contexto (la extensin ARB_shader_storage_buffer_object sola no permite esa versin).
+         */
+        static bool supports_shader_storage()
+        {
+            return shader_storage_supported;
+        }
+
+        /**
+         * @brief Indica si hay consultas de oclusin conservadoras (GL_ANY_SAMPLES_PASSED_CONSERVATIVE).
+         *
+         * Estn en OpenGL 4.3 y en ARB_ES3_compatibility. Sin ellas se usa GL_ANY_SAMPLES_PASSED,
+         * que da el mismo resultado pero puede costar ms a la GPU.
+         */
+        static bool supports_conservative_occlusion()
+        {
+            return conservative_occlusion_supported;
+        }
+
+        /**
+         * @brief Indica si se pueden ejecutar compute shaders que escriben en SSBOs e imgenes.
+         *
+         * Como los SSBOs, exige la versin 4.3 del contexto para poder declarar #version 430.
+         */
+        static bool supports_compute()
+        {
+            return compute_supported;
+        }
+
+    };
+
+}
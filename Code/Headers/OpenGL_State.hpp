@@ -0,0 +1,157 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+namespace udit
+{
+
+    /**
+     * @class OpenGL_State
+     * @brief Copia en CPU del estado de OpenGL que se cambia al dibujar.
+     *
+     * Guarda el programa, el VAO, las texturas vinculadas a cada unidad, el culling, el blending,
+     * el test y la funcin de profundidad, las mscaras de escritura de color y profundidad y el modo
+     * de relleno de los polgonos. Cada cambio se
+     * compara con la copia y solo se enva al driver si el valor es distinto del actual, de modo
+     * que las llamadas redundantes no llegan a OpenGL.
+     *
+     * Como el contexto de OpenGL es nico, tambin lo es esta copia de su estado. Todo el cdigo
+     * de dibujo debe cambiar el estado a travs de ella: si se llama a OpenGL directamente, la copia
+     * deja de coincidir con el estado real y hay que llamar a invalidate().
+     *
+     * Se cuentan las llamadas enviadas y las evitadas en cada frame.
+     */
+    class OpenGL_State
+    {
+    public:
+
+        static constexpr unsigned TEXTURE_UNIT_COUNT = 16;     ///< Unidades de textura que se siguen
+
+    private:
+
+        // ndices para indexar el array de texturas de cada unidad:
+
+        enum
+        {
+            TEXTURE_2D_TARGET,
+            TEXTURE_2D_ARRAY_TARGET,
+            TEXTURE_CUBE_MAP_TARGET,
+            TEXTURE_TARGET_COUNT
+        };
+
+        // Valor de los campos cuyo estado real se desconoce:
+
+        static constexpr GLuint UNKNOWN_NAME  = GLuint(-1);
+        static constexpr GLenum UNKNOWN_ENUM  = GLenum(-1);
+        static constexpr int    UNKNOWN_FLAG  = -1;
+
+        GLuint program_id;
+        GLuint vao_id;
+        GLenum active_texture_unit;
+        GLuint texture_ids[TEXTURE_UNIT_COUNT][TEXTURE_TARGET_COUNT];
+
+        int    cull_face;                ///< 1 activado, 0 desactivado, -1 desconocido
+        int    blend;
+        int    depth_test;
+        int    color_write;              ///< Mscara de escritura de color (todas las componentes a la vez)
+        int    depth_write;              ///< Mscara de escritura de profundidad
+        GLenum blend_source;
+        GLenum blend_destination;
+        GLenum depth_func;
+        GLenum polygon_mode;
+
+        std::size_t issued_calls;        ///< Llamadas enviadas al driver en el frame actual
+        std::size_t skipped_calls;       ///< Llamadas evitadas en el frame actual
+        std::size_t last_issued_calls;   ///< Llamadas enviadas en el frame anterior
+        std::size_t last_skipped_calls;  ///< Llamadas evitadas en el frame anterior
+
+    public:
+
+        /**
+         * @brief Devuelve la copia del estado del contexto de OpenGL.
+         */
+        static OpenGL_State & instance();
+
+        OpenGL_State(const OpenGL_State & ) = delete;
+        OpenGL_State & operator = (const OpenGL_State & ) = delete;
+
+        /**
+         * @brief Marca todo el estado como desconocido.
+         *
+         * Debe llamarse cuando se ha cambiado el estado llamando a OpenGL directamente. El siguiente
+         * cambio de cada campo se enva al driver aunque coincida con el valor anterior.
+         */
+        void invalidate();
+
+        /**
+         * @brief Cierra la cuenta de llamadas del frame anterior y empieza la del nuevo.
+         */
+        void begin_frame();
+
+        void use_program      (GLuint program_id);
+        void bind_vertex_array(GLuint vao_id);
+
+        /**
+         * @brief Vincula una textura a una unidad de textura.
+         * @param unit Unidad de textura (0 a TEXTURE_UNIT_COUNT - 1).
+         * @param target GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY o GL_TEXTURE_CUBE_MAP.
+         * @param texture_id Textura que se vincula.
+         */
+        void bind_texture(unsigned unit, GLenum target, GLuint texture_id);
+
+        void set_cull_face   (bool   enabled);
+        void set_blend       (bool   enabled);
+        void set_blend_func  (GLenum source, GLenum destination);
+        void set_depth_test  (bool   enabled);
+        void set_depth_func  (GLenum function);
+        void set_color_write (bool   enabled);
+        void set_depth_write (bool   enabled);
+        void set_polygon_mode(GLenum mode);
+
+        /**
+         * @brief Llamadas que se enviaron al driver durante el frame anterior.
+         */
+        std::size_t get_issued_count() const
+        {
+            return last_issued_calls;
+        }
+
+        /**
+         * @brief Llamadas redundantes que se evitaron durante el frame anterior.
+         */
+        std::size_t get_skipped_count() const
+        {
+            return last_skipped_calls;
+        }
+
+    private:
+
+        OpenGL_State();
+
+        /**
+         * @brief Compara un campo con su nuevo valor y lo actualiza, contando la llamada.
+         * @return true si el valor cambia y hay que enviar la llamada al driver.
+         */
+        template< typename TYPE >
+        bool change(TYPE & current, TYPE value)
+        {
+            if (current == value)
+            {
+                skipped_calls++;
+                return false;
+            }
+
+            current = value;
+            issued_calls++;
+            return true;
+        }
+
+        void set_capability(int & current, GLenum capability, bool enabled);
+
+    };
+
+}
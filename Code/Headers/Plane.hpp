@@ -7,6 +7,7 @@
 
 #include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
 #include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include "Mesh_Arena.hpp"
 
 namespace udit
 {
@@ -16,33 +17,22 @@ namespace udit
      * @brief Clase que representa un plano 3D en OpenGL.
      *
      * Esta clase genera un plano 3D, calcula sus vrtices, colores, coordenadas UV e ndices,
-     * y utiliza los buffers de OpenGL para su renderizado eficiente. El tamao del plano se
+     * y los guarda en la arena de mallas compartida para su renderizado eficiente. El tamao del plano se
      * define por el nmero de segmentos en el ancho y alto del plano.
      */
     class Plane
     {
     private:
 
-        // ndices para indexar el array vbo_ids:
-        // Se definen los ndices que corresponden a los diferentes VBOs y EBO que se usarn en OpenGL
-        enum
-        {
-            COORDINATES_VBO,  ///< VBO para las coordenadas de los vrtices
-            COLORS_VBO,       ///< VBO para los colores de los vrtices
-            UVS_VBO,          ///< VBO para las coordenadas UV
-            INDICES_EBO,      ///< EBO para los ndices de los tringulos
-            VBO_COUNT         ///< Nmero total de VBOs utilizados
-        };
-
         // Arrays dinmicos para almacenar los datos del plano:
         // Vectores para almacenar las coordenadas de los vrtices, colores, ndices y coordenadas UV
         std::vector<GLfloat> coordinates;  ///< Coordenadas de los vrtices (X, Y, Z)
         std::vector<GLfloat> colors;      ///< Colores de los vrtices (RGB)
-        std::vector<GLubyte> indices;     ///< ndices que definen los tringulos del plano
+        std::vector<GLuint>  indices;     ///< ndices que definen los tringulos del plano
         std::vector<GLfloat> uvs;         ///< Coordenadas UV para texturizacin
 
-        GLuint vbo_ids[VBO_COUNT];        ///< Array que contiene los IDs de los VBOs
-        GLuint vao_id;                    ///< ID del VAO (Vertex Array Object) que organiza los VBOs
+        Mesh_Arena & arena;               ///< Arena en la que se guarda la geometra del plano
+        Mesh         mesh;                ///< Rango que ocupa el plano dentro de la arena
 
     public:
 
@@ -53,26 +43,34 @@ namespace udit
          * para crear el plano. El nmero de segmentos en los ejes X y Y determina la resolucin
          * de la malla del plano.
          *
+         * @param arena Arena de mallas en la que se guarda la geometra.
          * @param width El nmero de segmentos a lo largo del eje X del plano.
          * @param height El nmero de segmentos a lo largo del eje Y del plano.
          */
-        Plane(int width, int height);
+        Plane(Mesh_Arena & arena, int width, int height);
 
         /**
          * @brief Destructor de la clase Plane.
          *
-         * Elimina los buffers de OpenGL (VAO, VBOs y EBO) cuando el objeto Plane es destruido.
+         * Devuelve a la arena de mallas el espacio que ocupaba la geometra del plano.
          */
         ~Plane();
 
         /**
          * @brief Renderiza el plano en la escena.
          *
-         * Este mtodo utiliza los buffers de OpenGL configurados previamente (VAO, VBOs, EBO)
+         * Este mtodo utiliza el rango de la arena de mallas que ocupa el plano
          * para renderizar el plano en la escena.
          */
         void render();
 
+        /**
+         * @brief Devuelve la descripcin de la malla del plano para la cola de render.
+         *
+         * @return Mesh El rango de la arena y el estado de rasterizacin con el que se dibuja el plano.
+         */
+        Mesh get_mesh() const;
+
     };
 
 }
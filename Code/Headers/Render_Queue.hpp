@@ -0,0 +1,439 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstdint>       // Tipos enteros de tamao fijo para las claves de ordenacin
+#include <memory>        // unique_ptr
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+#include "Mesh.hpp"
+#include "Instance_Buffer.hpp"
+#include "Ring_Buffer.hpp"
+#include "Shader_Program.hpp"
+#include "Command_List.hpp"
+#include "Job_System.hpp"
+#include "Frustum.hpp"
+#include "Occlusion_Buffer.hpp"
+#include "Occlusion_Queries.hpp"
+#include "GPU_Culling.hpp"
+
+namespace udit
+{
+
+    /**
+     * @brief Pasadas en las que se agrupan los dibujos de la cola.
+     *
+     * El valor de la pasada ocupa los bits ms significativos de la clave de ordenacin,
+     * por lo que todos los dibujos de una pasada se emiten antes que los de la siguiente.
+     */
+    enum class Render_Pass : std::uint8_t
+    {
+        OPAQUE_PASS      = 0,   ///< Objetos opacos, sin blending
+        CONDITIONAL_PASS = 1,   ///< Objetos opacos tapados en el frame anterior, condicionados a su consulta de oclusin
+        TRANSPARENT_PASS = 2,   ///< Objetos translcidos, con blending activado
+    };
+
+    /**
+     * @struct Draw_Item
+     * @brief Todo lo necesario para dibujar un objeto de la escena.
+     */
+    struct Draw_Item
+    {
+        static constexpr std::uint32_t NO_OBJECT = 0xFFFFFFFF;   ///< Dibujo sin identidad entre frames
+
+        Render_Pass pass;          ///< Pasada en la que se dibuja el objeto
+        GLuint      program_id;    ///< Programa de shaders con el que se dibuja
+        GLuint      texture_id;    ///< Array de texturas que se vincula a la unidad 0
+        Mesh        mesh;          ///< Malla que se dibuja
+        glm::mat4   model_matrix;  ///< Transformacin del objeto al espacio del mundo
+        float       transparency;  ///< Opacidad del objeto (1 = opaco)
+        float       texture_layer; ///< Capa del array de texturas con el material del objeto
+        std::uint32_t object_id       = NO_OBJECT;   ///< Identificador estable del objeto entre frames
+        GLuint        occlusion_query = 0;           ///< Consulta de oclusin de la que depende el dibujo (0 = ninguna)
+        float         fade            = 1.f;         ///< Fraccin de los pxeles que se dibujan (la fija cull_small())
+    };
+
+    /**
+     * @struct Material
+     * @brief Aspecto de un objeto: programa, textura y opacidad.
+     *
+     * La opacidad decide en qu pasada se dibujan los objetos con el material.
+     */
+    struct Material
+    {
+        GLuint program_id    = 0;     ///< Programa de shaders con el que se dibuja
+        GLuint texture_id    = 0;     ///< Array de texturas que se vincula a la unidad 0
+        float  texture_layer = 0.f;   ///< Capa del array de texturas
+        float  transparency  = 1.f;   ///< Opacidad (1 = opaco)
+
+        /**
+         * @brief Pasada en la que se dibujan los objetos con este material.
+         */
+        Render_Pass get_pass() const
+        {
+            return transparency < 1.f ? Render_Pass::TRANSPARENT_PASS : Render_Pass::OPAQUE_PASS;
+        }
+    };
+
+    /**
+     * @brief Crea el dibujo de un objeto con un material, eligiendo la pasada segn su opacidad.
+     * @param material Material del objeto.
+     * @param mesh Malla del objeto.
+     * @param model_matrix Transformacin del objeto al espacio del mundo.
+     * @param object_id Identificador estable del objeto, necesario para seguirlo entre frames.
+     */
+    inline Draw_Item make_draw_item(const Material & material, const Mesh & mesh, const glm::mat4 & model_matrix, std::uint32_t object_id = Draw_Item::NO_OBJECT)
+    {
+        return
+        {
+            material.get_pass(),
+            material.program_id,
+            material.texture_id,
+            mesh,
+            model_matrix,
+            material.transparency,
+            material.texture_layer,
+            object_id
+        };
+    }
+
+    /**
+     * @struct Draw_Elements_Indirect_Command
+     * @brief Comando de dibujo indexado que lee glMultiDrawElementsIndirect del buffer indirecto.
+     *
+     * El orden y el tamao de los campos los fija la especificacin de OpenGL.
+     */
+    struct Draw_Elements_Indirect_Command
+    {
+        GLuint index_count;      ///< Nmero de ndices de la malla
+        GLuint instance_count;   ///< Nmero de instancias
+        GLuint first_index;      ///< Primer ndice de la malla dentro del EBO
+        GLint  base_vertex;      ///< Vrtice base de la malla
+        GLuint base_instance;    ///< Primer registro de las instancias en el buffer de instancias
+    };
+
+    /**
+     * @class Render_Queue
+     * @brief Cola de dibujos ordenada por una clave de 64 bits.
+     *
+     * Cada objeto se enva a la cola junto con una clave empaquetada (pasada, programa, textura,
+     * malla y profundidad). Una vez por frame la cola se ordena con un radix sort y se emiten los
+     * dibujos en ese orden, de modo que los dibujos consecutivos comparten estado y los cambios
+     * de programa, textura y VAO solo se hacen cuando realmente cambian.
+     *
+     * Los opacos se emiten antes que los transparentes, y el estado de blending se establece una
+     * sola vez al comenzar cada pasada. Con consultas de oclusin (cull_occluded() con un
+     * Occlusion_Queries), los opacos que estaban tapados en el frame anterior pasan a una pasada
+     * intermedia: al terminar los opacos visibles se emiten las consultas y despus esos objetos se
+     * dibujan uno a uno con glBeginConditionalRender. Dentro de la pasada de transparentes manda la profundidad
+     * (de atrs hacia delante), as que solo se agrupan en un dibujo instanciado las copias
+     * consecutivas de una misma malla, que se dibujan en el orden de sus instancias.
+     *
+     * Los dibujos consecutivos que comparten estado y malla se agrupan en un solo dibujo instanciado
+     * (glDrawElementsInstancedBaseVertex), de modo que las copias de una misma malla cuestan una
+     * llamada. Como todas las mallas de la arena comparten VAO, pasar de una malla a otra no exige
+     * cambiar de VAO, solo de rango de ndices.
+     *
+     * Si el contexto admite multi-draw indirect (OpenGL 4.3), los grupos consecutivos que comparten
+     * estado aunque usen mallas distintas se emiten con un solo glMultiDrawElementsIndirect. Cada
+     * grupo escribe un comando en un buffer indirecto y su baseInstance apunta al primer registro de
+     * sus instancias, de donde los atributos por instancia toman los datos de cada objeto.
+     *
+     * Con vertex pulling (enable_vertex_pulling()) el VAO solo aporta los ndices: el vertex shader
+     * lee los vrtices de la arena y los datos por instancia de buffers de almacenamiento (SSBOs).
+     * Como gl_InstanceID no incluye la instancia base, cada grupo se emite con su propio dibujo y
+     * el primer registro de sus instancias se indica en un uniform.
+     *
+     * El trabajo de CPU de cada frame se reparte entre los hilos del Job_System: las claves de
+     * ordenacin se calculan en paralelo y los grupos se dividen en tramos contiguos para los que
+     * cada hilo escribe los datos por instancia y graba una Command_List. El hilo del contexto sube
+     * los datos y reproduce las listas en orden, que es el nico paso que llama a OpenGL.
+     *
+     * Con descarte en la GPU (cull_on_gpu()) la cola no quita ningn dibujo: cada hilo escribe
+     * adems la esfera envolvente de cada instancia y un GPU_Culling decide en un compute shader,
+     * antes de reproducir las listas, qu instancias llegan a los comandos indirectos.
+     */
+    class Render_Queue
+    {
+    public:
+
+        // Puntos de enlace de los buffers de almacenamiento en el vertex shader con vertex pulling:
+
+        enum
+        {
+            VERTEX_STORAGE_BINDING   = 0,   ///< Vrtices de la arena de mallas
+            INSTANCE_STORAGE_BINDING = 1,   ///< Datos por instancia del frame
+        };
+
+        // Tamao mnimo de los tramos en que se reparte el trabajo entre hilos:
+
+        static constexpr std::size_t ITEMS_PER_RANGE   = 256;   ///< Dibujos por tramo al calcular claves
+        static constexpr std::size_t BATCHES_PER_RANGE =  64;   ///< Grupos por tramo al grabar comandos
+
+    private:
+
+        std::vector<Draw_Item>     items;          ///< Dibujos enviados en el frame actual
+        std::vector<std::uint64_t> keys;           ///< Clave de ordenacin de cada dibujo
+        std::vector<std::uint32_t> order;          ///< ndices de los dibujos en orden de emisin
+        std::vector<std::uint64_t> keys_scratch;   ///< Memoria auxiliar del radix sort
+        std::vector<std::uint32_t> order_scratch;  ///< Memoria auxiliar del radix sort
+
+        /**
+         * @brief Grupo de dibujos consecutivos que se emiten con una sola llamada instanciada.
+         */
+        struct Batch
+        {
+            std::uint32_t item_index;       ///< Dibujo del que se toma el estado y la malla
+            std::size_t   first_instance;   ///< Primer registro del grupo en el buffer de instancias
+            GLsizei       instance_count;   ///< Nmero de instancias del grupo
+        };
+
+        Job_System               & job_system;       ///< Hilos entre los que se reparte el trabajo
+
+        std::vector<Batch>         batches;          ///< Grupos del frame actual
+        std::vector<Instance_Data> instances;        ///< Datos por instancia del frame actual
+        std::vector<Command_List>  command_lists;    ///< Comandos grabados para cada tramo de grupos
+        std::vector<GLuint>        configured_vaos;  ///< VAOs con los atributos por instancia activados
+        Instance_Buffer            instance_buffer;  ///< VBO con los datos por instancia
+
+        std::vector<Draw_Elements_Indirect_Command> commands;   ///< Comandos indirectos del frame actual
+        std::unique_ptr<Ring_Buffer>                indirect_buffer;  ///< Buffer indirecto (nulo sin multi-draw indirect)
+
+        Shader_Program                * pulling_program;          ///< Programa que lee los vrtices de SSBOs (o nulo)
+        Shader_Program::Uniform<GLint>  base_instance_uniform;    ///< Primer registro de instancias del grupo
+        GLuint                          pulling_vertex_buffer_id; ///< Buffer con los vrtices que lee el programa
+
+        // Esferas envolventes de los dibujos en el espacio del mundo, como estructura de arrays
+        // para comprobarlas de cuatro en cuatro contra el volumen de visin:
+
+        std::vector<float>         sphere_x;
+        std::vector<float>         sphere_y;
+        std::vector<float>         sphere_z;
+        std::vector<float>         sphere_radius;
+        std::vector<std::uint8_t>  visibility;     ///< 1 si el dibujo es visible en el frame actual
+
+        std::size_t visible_count;                  ///< Dibujos que pasaron el ltimo descarte
+        std::size_t culled_count;                   ///< Dibujos descartados en el ltimo descarte
+        std::size_t occluded_count;                 ///< Dibujos descartados por estar tapados en el frame actual
+        std::size_t small_count;                    ///< Dibujos descartados por ocupar pocos pxeles en el frame actual
+
+        std::size_t draw_call_count;                ///< Llamadas de dibujo emitidas en la ltima ejecucin
+
+        Occlusion_Queries * occlusion_queries;      ///< Consultas que se emiten tras los opacos en este frame (o nulo)
+        std::size_t         query_batch;            ///< Primer grupo tras los opacos, antes del que se emiten
+
+        GPU_Culling * gpu_culling;                  ///< Descarte de las instancias en la GPU en este frame (o nulo)
+        std::vector<GPU_Culling::Instance_Bounds> instance_bounds;   ///< Esfera y comando de cada instancia del frame
+
+        glm::mat4 view_matrix;                     ///< Matriz de vista del frame actual
+
+    public:
+
+        /**
+         * @brief Crea la cola, con el buffer indirecto si se pide y el contexto admite multi-draw indirect.
+         * @param job_system Hilos entre los que se reparte el trabajo de CPU de cada frame.
+         * @param use_multi_draw_indirect Indica si se quiere usar multi-draw indirect cuando est disponible.
+         */
+        Render_Queue(Job_System & job_system, bool use_multi_draw_indirect = true);
+
+        /**
+         * @brief Hace que los dibujos con el programa indicado lean sus vrtices con vertex pulling.
+         *
+         * El programa debe declarar los bloques buffer de vrtices e instancias en los puntos de
+         * enlace VERTEX_STORAGE_BINDING e INSTANCE_STORAGE_BINDING y el uniform base_instance.
+         * Los dibujos con ese programa se emiten siempre con una llamada por grupo.
+         *
+         * @param program Programa de shaders con vertex pulling.
+         * @param vertex_buffer_id Buffer con los vrtices (el VBO de la arena de mallas).
+         */
+        void enable_vertex_pulling(Shader_Program & program, GLuint vertex_buffer_id);
+
+        /**
+         * @brief Empaqueta los criterios de ordenacin en una clave de 64 bits.
+         *
+         * Cada pasada ordena con su propia distribucin de bits (de ms a menos significativo):
+         *
+         *   - Opacos (tambin los condicionados): pasada (4), programa (10), textura (12), malla (12) y profundidad (26). Prima
+         *     agrupar los cambios de estado; dentro de cada grupo se dibuja de delante hacia atrs
+         *     para que el test de profundidad temprano descarte los fragmentos tapados.
+         *   - Transparentes: pasada (4), profundidad invertida (26), programa (10), textura (12) y
+         *     malla (12). Para mezclar bien se dibujan estrictamente de atrs hacia delante; el
+         *     estado solo desempata entre objetos a la misma distancia.
+         *
+         * Los ids que no caben en su campo se recortan, lo que solo afecta a la agrupacin de los
+         * dibujos, nunca a su correccin.
+         *
+         * @param pass Pasada del dibujo.
+         * @param program_id Programa de shaders.
+         * @param texture_id Textura vinculada.
+         * @param mesh_id Identificador de la malla dentro de su arena.
+         * @param depth Distancia a la cmara en el espacio de vista (positiva delante de ella).
+         * @return La clave de ordenacin.
+         */
+        static std::uint64_t make_sort_key(Render_Pass pass, GLuint program_id, GLuint texture_id, std::uint32_t mesh_id, float depth);
+
+        /**
+         * @brief Vaca la cola y fija la matriz de vista con la que se calculan las profundidades.
+         * @param view_matrix Matriz de vista de la cmara para este frame.
+         */
+        void begin_frame(const glm::mat4 & view_matrix);
+
+        /**
+         * @brief Aade un dibujo a la cola.
+         *
+         * Su clave de ordenacin se calcula en paralelo con las dems al ordenar.
+         *
+         * @param item Dibujo que se aade.
+         */
+        void submit(const Draw_Item & item);
+
+        /**
+         * @brief Quita de la cola los dibujos cuya esfera envolvente queda fuera del volumen de visin.
+         *
+         * La esfera local de la malla se lleva al mundo con la matriz del objeto (el radio se escala
+         * por el mayor factor de escala) y se comprueba con Frustum::cull_spheres(). Los dibujos que
+         * quedan conservan su orden. Debe llamarse despus de enviar todos los dibujos y antes de sort().
+         *
+         * @param frustum Volumen de visin de la cmara en este frame.
+         */
+        void cull(const Frustum & frustum);
+
+        /**
+         * @brief Da por hecho el descarte por volumen de visin, porque ya lo hicieron quienes
+         * enviaron los dibujos, y solo anota cuntos quedaron fuera. Sustituye a cull().
+         *
+         * @param culled_count Dibujos que se descartaron antes de enviarlos.
+         */
+        void accept_culled(std::size_t culled_count);
+
+        /**
+         * @brief Quita de la cola los dibujos que ocupan demasiado pocos pxeles en pantalla.
+         *
+         * La esfera envolvente de cada dibujo se lleva al espacio de vista y se proyecta con la escala
+         * vertical de la proyeccin: su dimetro en pxeles es aproximadamente el radio por
+         * projection[1][1] por el alto de la ventana entre la profundidad. Los dibujos por debajo
+         * de min_pixels se quitan, y los que quedan a menos de fade_pixels por encima se desvanecen
+         * con un patrn de tramado en el fragment shader (fade de 0 a 1), para que no desaparezcan
+         * de golpe al alejarse. Las esferas que contienen la cmara o estn detrs de ella siempre
+         * se conservan.
+         *
+         * Es un filtro de CPU que no toca OpenGL. Los dibujos que quedan conservan su orden. Debe
+         * llamarse antes de sort().
+         *
+         * @param projection_matrix Proyeccin de la cmara en este frame.
+         * @param viewport_height Alto de la ventana en pxeles.
+         * @param min_pixels Dimetro en pxeles por debajo del que se quita un dibujo.
+         * @param fade_pixels Margen por encima de min_pixels en el que se desvanece (0 = sin desvanecer).
+         */
+        void cull_small(const glm::mat4 & projection_matrix, float viewport_height, float min_pixels, float fade_pixels);
+
+        /**
+         * @brief Quita de la cola los dibujos cuya caja envolvente queda tapada por los oclusores.
+         *
+         * Las cajas se comprueban en paralelo contra el buffer, que ya debe estar rasterizado para
+         * este frame. Los dibujos que quedan conservan su orden. Debe llamarse antes de sort().
+         *
+         * @param occlusion_buffer Buffer de profundidad con los oclusores del frame.
+         */
+        void cull_occluded(const Occlusion_Buffer & occlusion_buffer);
+
+        /**
+         * @brief Pide consultas de oclusin para los opacos con identificador y condiciona a ellas
+         * los que estaban tapados en el frame anterior.
+         *
+         * Se ejecuta en el hilo del contexto, porque lee los resultados de las consultas del frame
+         * anterior. Los dibujos condicionados pasan a Render_Pass::CONDITIONAL_PASS y cada uno se
+         * emite con su propia llamada. Las consultas se emiten en execute() despus de los opacos
+         * visibles. Debe llamarse antes de sort().
+         *
+         * @param occlusion_queries Consultas de oclusin, con begin_frame() ya llamado en este frame.
+         */
+        void cull_occluded(Occlusion_Queries & occlusion_queries);
+
+        /**
+         * @brief Deja en manos de la GPU el descarte de los dibujos del frame.
+         *
+         * Ningn dibujo se quita de la cola: al ejecutarla, los opacos se comprueban en un compute
+         * shader contra el volumen de visin y la pirmide Hi-Z y solo se dibujan los que sobreviven.
+         * Necesita el buffer indirecto, as que sin multi-draw indirect o con vertex pulling no tiene
+         * efecto. Sustituye a cull() y a cull_occluded().
+         *
+         * @param gpu_culling Descarte en la GPU, con begin_frame() ya llamado en este frame.
+         */
+        void cull_on_gpu(GPU_Culling & gpu_culling);
+
+        /**
+         * @brief Calcula las claves de los dibujos enviados y los ordena segn ellas (radix sort LSD
+         * de 8 bits por pasada).
+         */
+        void sort();
+
+        /**
+         * @brief Emite los dibujos en el orden calculado, evitando cambios de estado redundantes.
+         */
+        void execute();
+
+        /**
+         * @brief Nmero de llamadas de dibujo emitidas en la ltima ejecucin.
+         */
+        std::size_t get_draw_call_count() const
+        {
+            return draw_call_count;
+        }
+
+        /**
+         * @brief Nmero de dibujos que pasaron el ltimo descarte por volumen de visin.
+         */
+        std::size_t get_visible_count() const
+        {
+            return visible_count;
+        }
+
+        /**
+         * @brief Nmero de dibujos descartados en el ltimo descarte por volumen de visin.
+         */
+        std::size_t get_culled_count() const
+        {
+            return culled_count;
+        }
+
+        /**
+         * @brief Nmero de dibujos descartados por estar tapados en el frame actual.
+         *
+         * Con consultas de oclusin son los dibujos condicionados, que la GPU se salta si siguen tapados.
+         */
+        std::size_t get_occluded_count() const
+        {
+            return occluded_count;
+        }
+
+        /**
+         * @brief Nmero de dibujos descartados por ocupar pocos pxeles en el frame actual.
+         */
+        std::size_t get_small_count() const
+        {
+            return small_count;
+        }
+
+        /**
+         * @brief Nmero de dibujos enviados en el frame actual.
+         */
+        std::size_t size() const
+        {
+            return items.size();
+        }
+
+    private:
+
+        std::size_t remove_invisible();
+
+        void record_range  (Command_List & list, std::size_t first_batch, std::size_t end_batch);
+        void record_state  (Command_List & list, const Draw_Item * previous, const Draw_Item & item) const;
+        void record_queries(Command_List & list, const Draw_Item * & previous) const;
+        void replay        (const Command_List & list);
+
+    };
+
+}
@@ -0,0 +1,65 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+
+namespace udit
+{
+
+    /**
+     * @brief Tcnica con la que se descartan los objetos tapados por otros.
+     */
+    enum class Occlusion_Mode
+    {
+        NONE,                                ///< Solo se descarta lo que queda fuera del volumen de visin
+        SOFTWARE,                            ///< Buffer de profundidad de baja resolucin rasterizado en CPU
+        HARDWARE,                            ///< Consultas de oclusin de la GPU y dibujo condicional
+        GPU,                                 ///< Descarte y compactacin en un compute shader con una pirmide Hi-Z
+    };
+
+    /**
+     * @struct Render_Settings
+     * @brief Opciones del renderizado que se eligen al arrancar desde la lnea de comandos.
+     *
+     * Permiten comparar caminos de dibujo alternativos sobre la misma escena. Despus de crear el
+     * contexto de OpenGL hay que llamar a validate() para desactivar lo que el contexto no admita.
+     */
+    struct Render_Settings
+    {
+        bool multi_draw_indirect = true;     ///< Usar glMultiDrawElementsIndirect si est disponible (--no-mdi)
+        bool vertex_pulling      = false;    ///< Leer los vrtices de SSBOs en el vertex shader (--vertex-pulling)
+        unsigned worker_threads  = 0;        ///< Hilos de trabajo adems del principal (--threads N)
+        Occlusion_Mode occlusion = Occlusion_Mode::SOFTWARE;   ///< Descarte de objetos tapados (--occlusion none|software|hardware|gpu)
+        std::string scene_path   = "../Scenes/default.scene";   ///< Archivo binario con la descripcin de la escena (--scene archivo)
+        std::string capture_path;            ///< Archivo en el que grabar las llamadas a OpenGL (--capture archivo N)
+        unsigned capture_frames  = 0;        ///< Frames que se graban
+        float min_pixels         = 2.f;      ///< Tamao en pantalla por debajo del que se descarta un objeto (--min-pixels P)
+        float fade_pixels        = 0.f;      ///< Margen sobre min_pixels en el que se desvanece con tramado (--fade-pixels P, 0 = sin desvanecer)
+
+        /**
+         * @brief Lee las opciones de los argumentos del programa.
+         *
+         * Los argumentos desconocidos se ignoran con un aviso.
+         *
+         * @param argc Nmero de argumentos.
+         * @param argv Argumentos (argv[0] es el nombre del programa).
+         * @return Las opciones ledas.
+         */
+        static Render_Settings parse(int argc, char * argv[]);
+
+        /**
+         * @brief Desactiva las opciones que el contexto de OpenGL actual no admite.
+         *
+         * Informa por consola de las opciones con las que se dibujar.
+         */
+        void validate();
+    };
+
+    /**
+     * @brief Nombre de un modo de descarte de objetos tapados, como se escribe en la lnea de comandos.
+     */
+    const char * get_occlusion_name(Occlusion_Mode mode);
+
+}
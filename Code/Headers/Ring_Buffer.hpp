@@ -0,0 +1,117 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+
+namespace udit
+{
+
+    /**
+     * @class Ring_Buffer
+     * @brief Buffer de OpenGL dividido en tres segmentos que se escriben por turnos, uno por frame.
+     *
+     * Mientras la GPU lee el segmento de un frame, la CPU escribe el del siguiente. Cada segmento se
+     * protege con un fence que se coloca despus de emitir los dibujos que lo leen; antes de volver
+     * a escribir en l se espera a ese fence, que con tres segmentos normalmente ya se ha cumplido.
+     *
+     * Si el contexto admite buffers inmutables (OpenGL 4.4 o ARB_buffer_storage) el buffer se mapea
+     * una sola vez de forma persistente y coherente, y escribir en l es una simple copia en memoria.
+     * Si no, cada segmento se mapea con glMapBufferRange sin sincronizar (la sincronizacin ya la
+     * dan los fences) y se desmapea antes de dibujar.
+     *
+     * Uso por frame: begin_segment(), escribir en el puntero devuelto, end_segment(), emitir los
+     * dibujos que leen del segmento y fence_segment().
+     */
+    class Ring_Buffer
+    {
+    public:
+
+        static constexpr unsigned SEGMENT_COUNT = 3;
+
+    private:
+
+        GLenum      target;                        ///< Tipo de buffer (GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER...)
+        GLuint      buffer_id;
+        std::size_t segment_size;                  ///< Bytes de cada segmento
+        std::size_t alignment;                     ///< Alineacin del comienzo de cada segmento
+        unsigned    current_segment;
+        bool        persistent;                    ///< Indica si el buffer est mapeado de forma persistente
+        char      * persistent_pointer;            ///< Comienzo del mapeado persistente
+        GLsync      fences[SEGMENT_COUNT];         ///< Fence de los dibujos que leen cada segmento
+
+    public:
+
+        /**
+         * @brief Crea el buffer.
+         * @param target Tipo de buffer al que se vincula.
+         * @param initial_segment_size Bytes que caben inicialmente en cada segmento.
+         * @param alignment Alineacin en bytes del comienzo de cada segmento.
+         */
+        Ring_Buffer(GLenum target, std::size_t initial_segment_size, std::size_t alignment = 256);
+
+        /**
+         * @brief Espera a que la GPU deje de usar el buffer y lo libera.
+         */
+        ~Ring_Buffer();
+
+        Ring_Buffer(const Ring_Buffer & ) = delete;
+        Ring_Buffer & operator = (const Ring_Buffer & ) = delete;
+
+        /**
+         * @brief Prepara el segmento del frame actual para escribir en l.
+         *
+         * Espera al fence del segmento y, si no caben los bytes pedidos, recrea el buffer ms grande.
+         *
+         * @param size Bytes que se van a escribir.
+         * @return Puntero en el que escribir los datos del frame.
+         */
+        void * begin_segment(std::size_t size);
+
+        /**
+         * @brief Termina la escritura del segmento actual (lo desmapea si no es persistente).
+         */
+        void end_segment();
+
+        /**
+         * @brief Coloca el fence del segmento actual y pasa al siguiente.
+         *
+         * Debe llamarse despus de emitir todos los dibujos que leen del segmento.
+         */
+        void fence_segment();
+
+        /**
+         * @brief Id del buffer de OpenGL (cambia si el buffer se recrea al crecer).
+         */
+        GLuint get_id() const
+        {
+            return buffer_id;
+        }
+
+        /**
+         * @brief Posicin en bytes del segmento actual dentro del buffer.
+         */
+        std::size_t get_segment_offset() const
+        {
+            return current_segment * segment_size;
+        }
+
+        /**
+         * @brief Indica si el buffer est mapeado de forma persistente.
+         */
+        bool is_persistent() const
+        {
+            return persistent;
+        }
+
+    private:
+
+        void create (std::size_t segment_size);
+        void destroy();
+        void wait_fence(unsigned segment);
+
+    };
+
+}
@@ -23,7 +23,26 @@
 #include "Camera.hpp"
 #include "Skybox.hpp"
 #include "Heightmap.hpp"
+#include "Render_Queue.hpp"
+#include "Shader_Program.hpp"
+#include "Camera_Buffer.hpp"
+#include "Static_Batcher.hpp"
+#include "Render_Settings.hpp"
+#include "Entity_Store.hpp"
+#include "Scene_File.hpp"
+#include "Job_System.hpp"
+#include "Material_Textures.hpp"
+#include "Frame_Graph.hpp"
+#include "Frustum.hpp"
+#include "Occlusion_Buffer.hpp"
+#include "Occlusion_Queries.hpp"
+#include "GPU_Culling.hpp"
+#include "Loose_Octree.hpp"
+#include "Transform_Hierarchy.hpp"
+#include "Animation_System.hpp"
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace udit
 {
@@ -39,33 +58,66 @@ namespace udit
     private:
 
         static const std::string   vertex_shader_code;
+        static const std::string   pulling_vertex_shader_code;
         static const std::string fragment_shader_code;
         static const std::string skybox_vertex_shader;
         static const std::string skybox_fragment_shader;
 
-        GLint  model_view_matrix_id;
-        GLint  projection_matrix_id;
+        Mesh_Arena mesh_arena;          // Debe construirse antes que las mallas que se guardan en ella
 
         Cube   cube;
-        Plane plane;
-        Cylinder cylinder;
-        Cone cone;
         Camera camera;
-        GLuint texture_id;
-        GLuint program_id;
+        Material_Textures material_textures;       // Texturas de todos los materiales, una por capa
+        std::vector<Material> materials;           // Programa, capa de textura y opacidad de cada material del archivo
+        Shader_Program scene_program;
         Skybox skybox;
-        GLuint skybox_shader_program;
-        Heightmap terrain;
-        float  angle;
-        float  movement_Speed;
+        Shader_Program skybox_program;
+
+        // Uniforms de los programas, resueltos una vez al crear la escena:
+
+        Shader_Program::Uniform< GLint     > texture_sampler_uniform;
+        Shader_Program::Uniform< glm::mat4 > skybox_projection_uniform;
+        Shader_Program::Uniform< GLint     > skybox_sampler_uniform;
+
+        // Geometra generada a partir de los registros de mallas del archivo de la escena:
+
+        std::vector<std::unique_ptr<Plane    >> planes;
+        std::vector<std::unique_ptr<Cylinder >> cylinders;
+        std::vector<std::unique_ptr<Cone     >> cones;
+        std::vector<std::unique_ptr<Heightmap>> terrains;
+        std::vector<Mesh>                       meshes;          // Malla de cada registro, en el orden del archivo
+        std::vector<const Heightmap *>          mesh_terrains;   // Terreno de cada registro (nullptr si no es un heightmap)
+
+        Static_Batcher static_batcher;  // Objetos que no se mueven, combinados por material
+        Job_System job_system;          // Debe construirse antes que la cola, que reparte trabajo en l
+        Occlusion_Buffer occlusion_buffer;          // Profundidad de los oclusores rasterizada en CPU
+        Occlusion_Queries occlusion_queries;        // Consultas de oclusin de la GPU sobre las cajas de los objetos
+        std::unique_ptr<GPU_Culling> gpu_culling;   // Descarte en un compute shader (solo con Occlusion_Mode::GPU)
+        Occlusion_Mode   occlusion_mode;            // Tcnica con la que se descartan los objetos tapados
+        Render_Queue render_queue;
+        Camera_Buffer camera_buffer;
+        Frame_Graph frame_graph;        // Pasadas del frame y sus texturas intermedias
+        Frustum frustum;                // Volumen de visin de la cmara en el frame actual
+        Transform_Hierarchy transforms;                // Transformaciones de los nodos de la escena
+        Animation_System animations;    // Animadores de los nodos del archivo de la escena (despus de job_system)
+        Entity_Store entities;          // Componentes de los objetos que se mueven (despus de job_system)
+        Loose_Octree spatial_index;     // Cajas en el mundo de los objetos que se mueven; el valor de cada una es su entidad
+        std::vector<std::uint32_t> entity_handles;     // Handle en el ndice espacial de cada entidad
+        std::vector<std::uint32_t> visible_entities;   // Entidades que devuelve el ndice espacial en cada frame
+        glm::mat4 projection_matrix;
+        float  viewport_height;         // Alto de la ventana, para medir en pxeles el tamao de los objetos
+        float  min_pixels;              // Tamao en pantalla por debajo del que se descartan los objetos
+        float  fade_pixels;             // Margen sobre min_pixels en el que se desvanecen
 
     public:
      /**
      * @brief Constructor de la escena.
      * @param width Ancho de la ventana de renderizacin.
      * @param height Alto de la ventana de renderizacin.
+     * @param settings Opciones de renderizado ya validadas para el contexto actual.
+     * @param scene_file Descripcin de la escena ya abierta; solo hace falta mientras se construye.
      */
-        Scene(unsigned width, unsigned height);
+        Scene(unsigned width, unsigned height, const Render_Settings & settings, const Scene_File & scene_file);
 
      /**
      * @brief Procesa la entrada del teclado para la cmara.
@@ -103,33 +155,138 @@ namespace udit
         void   resize(unsigned width, unsigned height);
 
      /**
-     * @brief Carga una textura desde un archivo.
-     * @param route Ruta del archivo de textura.
+     * @brief Nmero de llamadas de dibujo emitidas por la cola en el ltimo frame.
      */
-        void textureLoader(std::string route);
+        std::size_t get_draw_call_count() const
+        {
+            return render_queue.get_draw_call_count();
+        }
 
      /**
-     * @brief Carga las texturas de la skybox.
-     * @param faces Rutas de las imgenes para cada cara de la skybox.
-     * @return ID de la textura cargada.
+     * @brief Nmero de dibujos que pasaron el descarte por volumen de visin en el ltimo frame.
      */
+        std::size_t get_visible_count() const
+        {
+            return render_queue.get_visible_count();
+        }
 
-        GLuint load_skybox_texture(std::vector<std::string> faces);
+     /**
+     * @brief Nmero de dibujos descartados por estar fuera del volumen de visin en el ltimo frame.
+     */
+        std::size_t get_culled_count() const
+        {
+            return render_queue.get_culled_count();
+        }
 
-    private:
+     /**
+     * @brief Nmero de dibujos descartados por estar tapados en el ltimo frame.
+     */
+        std::size_t get_occluded_count() const
+        {
+            return render_queue.get_occluded_count();
+        }
+
+     /**
+     * @brief Nmero de dibujos descartados por ocupar pocos pxeles en el ltimo frame.
+     */
+        std::size_t get_small_count() const
+        {
+            return render_queue.get_small_count();
+        }
+
+     /**
+     * @brief Nmero de meshlets de los objetos estticos.
+     */
+        std::size_t get_meshlet_count() const
+        {
+            return static_batcher.get_meshlet_count();
+        }
+
+     /**
+     * @brief Nmero de meshlets de los objetos estticos enviados en el ltimo frame.
+     */
+        std::size_t get_visible_meshlet_count() const
+        {
+            return static_batcher.get_visible_meshlet_count();
+        }
+
+        /**
+         * @brief Nmero de entidades del almacn.
+         */
+        std::size_t get_entity_count() const
+        {
+            return entities.size();
+        }
+
+        /**
+         * @brief Nmero de entidades enviadas a la cola en el ltimo frame.
+         */
+        std::size_t get_visible_entity_count() const
+        {
+            return entities.get_visible_count();
+        }
+
+     /**
+     * @brief Consultas de oclusin del frame anterior que encontraron visible su objeto.
+     */
+        std::size_t get_query_hit_count() const
+        {
+            return occlusion_queries.get_hit_count();
+        }
 
      /**
-     * @brief Compila los shaders del programa de la escena.
-     * @return ID del programa de shaders.
+     * @brief Consultas de oclusin del frame anterior que encontraron tapado su objeto.
      */
-        GLuint compile_shaders();
+        std::size_t get_query_miss_count() const
+        {
+            return occlusion_queries.get_miss_count();
+        }
+
+     /**
+     * @brief Instancias que se comprobaron en la GPU en el ltimo frame (0 sin descarte en la GPU).
+     */
+        std::size_t get_gpu_tested_count() const
+        {
+            return gpu_culling ? gpu_culling->get_tested_count() : 0;
+        }
+
+     /**
+     * @brief Objeto que se mueve cuya caja corta antes un rayo, para seleccionarlo con el ratn.
+     * @param origin Origen del rayo en el espacio del mundo.
+     * @param direction Direccin del rayo.
+     * @param distance Recibe la distancia al corte si lo hay.
+     * @return El identificador del objeto o Loose_Octree::INVALID si el rayo no corta ninguno.
+     */
+        std::uint32_t pick_object(const glm::vec3 & origin, const glm::vec3 & direction, float & distance) const
+        {
+            const std::uint32_t entity = spatial_index.pick(origin, direction, 5000.f, distance);
+
+            return entity == Loose_Octree::INVALID ? Loose_Octree::INVALID : entities.get_object_id(entities.get_position(entity));
+        }
+
+     /**
+     * @brief Objeto que se mueve al que apunta la cmara (el centro de la pantalla).
+     * @param distance Recibe la distancia a la cmara si hay alguno.
+     * @return El identificador del objeto o Loose_Octree::INVALID si no apunta a ninguno.
+     */
+        std::uint32_t pick_aimed_object(float & distance) const
+        {
+            return pick_object(camera.get_position(), camera.get_front(), distance);
+        }
+
+     /**
+     * @brief Crea las pasadas del frame graph para el tamao de la ventana.
+     * @param width Ancho de la ventana.
+     * @param height Alto de la ventana.
+     */
+        void build_frame_graph(unsigned width, unsigned height);
+
      /**
-     * @brief Compila los shaders para la skybox.
-     * @return ID del programa de shaders de la skybox.
+     * @brief Aade una malla de la arena como oclusor del descarte por oclusin en CPU.
+     * @param mesh Malla que tapa lo que tiene detrs.
+     * @param model_matrix Transformacin de la malla al espacio del mundo.
      */
-        GLuint compile_skybox_shaders();
-        void   show_compilation_error(GLuint  shader_id);
-        void   show_linkage_error(GLuint program_id);
+        void add_occluder(const Mesh & mesh, const glm::mat4 & model_matrix);
 
     };
 
@@ -0,0 +1,114 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>       // size_t
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include "Scene_Format.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Scene_File
+     * @brief Archivo binario con la descripcin de una escena (ver Scene_Format.hpp), mapeado en memoria.
+     *
+     * Al abrirlo se mapea el archivo completo y se comprueban la cabecera, que las secciones caben en
+     * el archivo y que todas las referencias entre registros son vlidas. A partir de ah los
+     * registros se leen directamente de la memoria mapeada, sin copiarlos, y siguen siendo vlidos
+     * hasta que se cierra el archivo.
+     */
+    class Scene_File
+    {
+    private:
+
+        const std::uint8_t * data;          ///< Contenido del archivo o nullptr si no est abierto
+        std::size_t          size;
+
+        #ifdef _WIN32
+            void *           file_handle;
+            void *           mapping_handle;
+        #endif
+
+    public:
+
+        Scene_File();
+       ~Scene_File();
+
+        Scene_File(const Scene_File & ) = delete;
+        Scene_File & operator = (const Scene_File & ) = delete;
+
+        /**
+         * @brief Mapea un archivo de escena y comprueba que es vlido.
+         * @param path Ruta del archivo.
+         * @return true si el archivo se ha podido mapear y es vlido. Si no, se informa del motivo por la salida de error.
+         */
+        bool open(const std::string & path);
+
+        /**
+         * @brief Deshace el mapeo. Los punteros obtenidos del archivo dejan de ser vlidos.
+         */
+        void close();
+
+        /**
+         * @brief Indica si hay un archivo mapeado.
+         */
+        bool is_open() const
+        {
+            return data != nullptr;
+        }
+
+        /**
+         * @brief Cabecera del archivo, con los datos globales de la escena.
+         */
+        const Scene_Format::Header & get_header() const
+        {
+            return *reinterpret_cast< const Scene_Format::Header * >(data);
+        }
+
+        /**
+         * @brief Nmero de registros de una seccin.
+         */
+        std::size_t get_count(Scene_Format::Section section) const
+        {
+            return get_header().sections[section].count;
+        }
+
+        /**
+         * @brief Primer registro de una seccin.
+         */
+        template< typename RECORD >
+        const RECORD * get_records(Scene_Format::Section section) const
+        {
+            return reinterpret_cast< const RECORD * >(data + get_header().sections[section].offset);
+        }
+
+        /**
+         * @brief Texto de la seccin de textos, o una cadena vaca si la referencia es Scene_Format::NO_INDEX.
+         */
+        const char * get_string(std::uint32_t string) const
+        {
+            return string == Scene_Format::NO_INDEX ? "" : get_records< char >(Scene_Format::STRINGS) + string;
+        }
+
+        /**
+         * @brief Rutas de las imgenes de las caras de la skybox, en el orden de las caras del cubemap.
+         */
+        std::vector< std::string > get_skybox_faces() const;
+
+        /**
+         * @brief Busca un nodo por su nombre.
+         * @return El ndice del nodo en el archivo o Scene_Format::NO_INDEX si no hay ninguno con ese nombre.
+         */
+        std::uint32_t find_node(const char * name) const;
+
+    private:
+
+        const char * validate() const;
+
+    };
+
+}
@@ -0,0 +1,165 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstdint>              // Tipos enteros de tamao fijo
+#include <type_traits>          // is_trivially_copyable
+#include "Transform_Hierarchy.hpp"
+
+// Formato de los archivos binarios con la descripcin de una escena, que carga Scene_File y genera
+// la herramienta Scene_Converter a partir de una descripcin en texto.
+//
+// El archivo empieza con una cabecera (Scene_Format::Header) con los datos globales de la escena y
+// una tabla de secciones. Cada seccin es un array de registros de tamao fijo, tal como estn en
+// memoria: la posicin de su primer registro (mltiplo de 4) y el nmero de registros. Al cargar el
+// archivo se mapea en memoria y los registros se usan directamente desde ah, sin leer campo a campo.
+// Los enteros y los float se guardan en little-endian, el orden de las plataformas en las que se
+// compila el proyecto.
+//
+// Las referencias entre registros son ndices dentro de su seccin. Los textos (rutas y nombres) se
+// guardan terminados en cero en la seccin STRINGS y se referencian por su posicin dentro de ella.
+//
+// Los nodos se guardan como estructura de arrays (padres, transformaciones locales y nombres en tres
+// secciones) para poder aadirlos de una vez a la Transform_Hierarchy. Cada padre va antes que sus
+// hijos, como exige la jerarqua.
+//
+// Los animadores se guardan en un solo tipo de registro para los cuatro tipos; los fotogramas de las
+// pistas van seguidos en la seccin KEYFRAMES y cada pista referencia su primer fotograma. Un nodo
+// tiene como mucho un animador de cada tipo, los ejes de los giros y las rbitas no son nulos y los
+// fotogramas de cada pista tienen tiempos estrictamente crecientes. Como las entidades estticas se
+// combinan al cargar la escena, son opacas y los nodos animados solo tienen entidades que se mueven
+// (en ellos o en sus descendientes).
+
+namespace udit
+{
+
+    struct Scene_Format
+    {
+        static constexpr char          MAGIC[8]  = { 'U', 'D', 'I', 'T', 'S', 'C', 'N', 'E' };
+        static constexpr std::uint32_t VERSION   = 2;
+        static constexpr std::uint32_t NO_INDEX  = 0xFFFFFFFF;     ///< Referencia vaca (nodo sin padre, sin nombre...)
+
+        /**
+         * @brief Secciones del archivo, en el orden de la tabla de la cabecera.
+         */
+        enum Section
+        {
+            STRINGS,                ///< char: textos terminados en cero
+            MATERIALS,              ///< Material_Record
+            MESHES,                 ///< Mesh_Record
+            NODE_PARENTS,           ///< uint32_t: padre de cada nodo o NO_INDEX
+            NODE_TRANSFORMS,        ///< Transform: transformacin local de cada nodo (el cuaternin en el orden de glm::quat)
+            NODE_NAMES,             ///< uint32_t: nombre de cada nodo o NO_INDEX
+            ENTITIES,               ///< Entity_Record
+            ANIMATORS,              ///< Animator_Record
+            KEYFRAMES,              ///< Keyframe: fotogramas de todas las pistas
+            SECTION_COUNT
+        };
+
+        struct Section_Range
+        {
+            std::uint32_t offset;           ///< Posicin del primer registro desde el principio del archivo
+            std::uint32_t count;            ///< Nmero de registros
+        };
+
+        struct Header
+        {
+            char          magic[8];
+            std::uint32_t version;
+            std::uint32_t file_size;                ///< Tamao total, para detectar archivos truncados
+            float         camera_position[3];
+            float         camera_yaw;               ///< Grados
+            float         camera_pitch;             ///< Grados
+            float         clear_color[4];
+            std::uint32_t skybox_faces[6];          ///< Textos con las imgenes de las caras, en el orden de GL_TEXTURE_CUBE_MAP_POSITIVE_X + i
+            Section_Range sections[SECTION_COUNT];
+        };
+
+        /**
+         * @brief Clases de geometra con las que se generan las mallas al cargar la escena.
+         */
+        enum Generator : std::uint32_t
+        {
+            PLANE,                  ///< parameters: columnas, filas
+            CYLINDER,               ///< parameters: segmentos radiales, segmentos de altura, radio, altura
+            CONE,                   ///< parameters: segmentos radiales, radio, altura
+            HEIGHTMAP,              ///< path: imagen de alturas; parameters: ancho, profundidad, altura mxima
+            GENERATOR_COUNT
+        };
+
+        // Parmetros que usa cada generador. Los primeros de cada uno son nmeros de segmentos y el
+        // resto medidas; unos y otros tienen que ser positivos y no pasar de los mximos:
+
+        static constexpr unsigned PARAMETER_COUNTS        [GENERATOR_COUNT] = { 2, 4, 3, 3 };
+        static constexpr unsigned SEGMENT_PARAMETER_COUNTS[GENERATOR_COUNT] = { 2, 2, 1, 0 };
+
+        static constexpr float    MAX_MESH_SEGMENTS = 1024.f;
+        static constexpr float    MAX_MESH_SIZE     = 10000.f;
+
+        struct Mesh_Record
+        {
+            std::uint32_t generator;
+            std::uint32_t path;             ///< Texto con el archivo que lee el generador o NO_INDEX
+            float         parameters[4];
+        };
+
+        struct Material_Record
+        {
+            std::uint32_t texture;          ///< Texto con la imagen de la capa del array de texturas
+            float         transparency;     ///< Opacidad (1 = opaco)
+        };
+
+        // Indicadores de las entidades:
+
+        enum Entity_Flags : std::uint32_t
+        {
+            DYNAMIC  = 1 << 0,      ///< Se mueve: va al Entity_Store en lugar de al Static_Batcher
+            OCCLUDER = 1 << 1,      ///< Tapa lo que tiene detrs en el descarte por oclusin en CPU (solo estticas)
+        };
+
+        struct Entity_Record
+        {
+            std::uint32_t node;
+            std::uint32_t mesh;
+            std::uint32_t material;
+            std::uint32_t flags;
+            std::uint32_t object_id;        ///< Identificador estable del dibujo (menor que el nmero de entidades) o NO_INDEX
+        };
+
+        /**
+         * @brief Tipos de animador (ver Animation_System).
+         */
+        enum Animator_Type : std::uint32_t
+        {
+            SPIN,                   ///< vector: eje
+            ORBIT,                  ///< vector: eje; radius: radio
+            BOB,                    ///< vector: desplazamiento mximo
+            TRACK,                  ///< first_key, key_count: fotogramas en KEYFRAMES
+            ANIMATOR_TYPE_COUNT
+        };
+
+        struct Animator_Record
+        {
+            std::uint32_t node;
+            std::uint32_t type;
+            float         vector[3];
+            float         radius;
+            float         speed;            ///< Radianes por fotograma (en las pistas, tiempo de pista por fotograma)
+            float         phase;            ///< Radianes
+            std::uint32_t first_key;
+            std::uint32_t key_count;
+        };
+
+    };
+
+    // Los registros se leen tal como estn en el archivo, as que no pueden tener relleno ni punteros:
+
+    static_assert(std::is_trivially_copyable_v< Transform > && sizeof(Transform) == 10 * sizeof(float));
+    static_assert(sizeof(Scene_Format::Mesh_Record    ) == 24);
+    static_assert(sizeof(Scene_Format::Material_Record) ==  8);
+    static_assert(sizeof(Scene_Format::Entity_Record  ) == 20);
+    static_assert(sizeof(Scene_Format::Animator_Record) == 40);
+    static_assert(std::is_trivially_copyable_v< Keyframe > && sizeof(Keyframe) == 8 * sizeof(float));
+
+}
@@ -0,0 +1,220 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <string>        // Biblioteca para trabajar con cadenas de texto
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include <glad/glad.h>   // Biblioteca para cargar funciones de OpenGL
+#include <glm.hpp>       // Biblioteca para operaciones con vectores y matrices en 3D
+
+namespace udit
+{
+
+    /**
+     * @class Shader_Program
+     * @brief Programa de shaders con sus uniforms resueltos al enlazarlo.
+     *
+     * Al crear el programa se compilan y enlazan sus shaders y se recorren una sola vez sus uniforms
+     * y bloques de uniforms activos (glGetActiveUniform y glGetActiveUniformBlockName). A partir de
+     * ah los uniforms se manejan con handles tipados obtenidos al inicializar, sin consultar
+     * localizaciones por nombre al driver durante el dibujo.
+     *
+     * Se guarda el ltimo valor subido de cada uniform, de modo que asignar el mismo valor otra vez
+     * no genera ninguna llamada a OpenGL.
+     */
+    class Shader_Program
+    {
+    public:
+
+        /**
+         * @brief Handle de un uniform de tipo TYPE ya resuelto.
+         *
+         * Un handle invlido (uniform inexistente o eliminado por el compilador) se puede usar igual
+         * que uno vlido: asignarle un valor no tiene efecto, como ocurre con la localizacin -1.
+         */
+        template< typename TYPE >
+        struct Uniform
+        {
+            int index = -1;      ///< Posicin del uniform en la tabla del programa
+
+            bool is_valid() const
+            {
+                return index >= 0;
+            }
+        };
+
+    private:
+
+        /**
+         * @brief Datos de un uniform activo obtenidos por reflexin.
+         */
+        struct Uniform_Info
+        {
+            std::string name;                 ///< Nombre (sin el sufijo [0] de los arrays)
+            GLint       location;             ///< Localizacin en el programa
+            GLenum      type;                 ///< Tipo GLSL (GL_FLOAT_MAT4, GL_SAMPLER_2D...)
+            GLint       size;                 ///< Nmero de elementos si es un array
+            bool        cached;               ///< Indica si value contiene el valor subido
+            alignas(16) unsigned char value[sizeof(glm::mat4)];   ///< ltimo valor subido
+        };
+
+        /**
+         * @brief Datos de un bloque de uniforms activo obtenidos por reflexin.
+         */
+        struct Uniform_Block_Info
+        {
+            std::string name;                 ///< Nombre del bloque
+            GLuint      index;                ///< ndice del bloque en el programa
+            GLint       data_size;            ///< Tamao en bytes que necesita el buffer del bloque
+        };
+
+        GLuint program_id;
+
+        std::vector<Uniform_Info>       uniforms;
+        std::vector<Uniform_Block_Info> uniform_blocks;
+
+    public:
+
+        /**
+         * @brief Compila y enlaza un programa a partir del cdigo de sus shaders y lo inspecciona.
+         * @param vertex_shader_code Cdigo fuente del vertex shader.
+         * @param fragment_shader_code Cdigo fuente del fragment shader.
+         */
+        Shader_Program(const std::string & vertex_shader_code, const std::string & fragment_shader_code);
+
+        /**
+         * @brief Compila y enlaza un programa con un nico compute shader y lo inspecciona.
+         *
+         * Solo se puede usar si OpenGL_Extensions::supports_compute() lo permite.
+         *
+         * @param compute_shader_code Cdigo fuente del compute shader.
+         */
+        explicit Shader_Program(const std::string & compute_shader_code);
+
+        /**
+         * @brief Libera el programa.
+         */
+        ~Shader_Program();
+
+        Shader_Program(const Shader_Program & ) = delete;
+        Shader_Program & operator = (const Shader_Program & ) = delete;
+
+        /**
+         * @brief Id del programa de OpenGL.
+         */
+        GLuint get_id() const
+        {
+            return program_id;
+        }
+
+        /**
+         * @brief Activa el programa a travs de la cach de estado de OpenGL.
+         */
+        void use() const;
+
+        /**
+         * @brief Busca un uniform por nombre y devuelve un handle para asignarlo.
+         *
+         * Se debe llamar al inicializar, no durante el dibujo. Si el uniform no existe se devuelve
+         * un handle invlido. Si existe con un tipo distinto de TYPE salta una asercin.
+         *
+         * @param name Nombre del uniform en el shader.
+         * @return El handle del uniform.
+         */
+        template< typename TYPE >
+        Uniform<TYPE> get_uniform(const std::string & name) const
+        {
+            Uniform<TYPE> uniform;
+
+            uniform.index = find_uniform(name, type_matches<TYPE>);
+
+            return uniform;
+        }
+
+        /**
+         * @brief Asigna el valor de un uniform si es distinto del ltimo subido.
+         *
+         * El programa se activa (si no lo estaba) antes de subir el valor.
+         *
+         * @param uniform Handle del uniform.
+         * @param value Valor que se asigna.
+         */
+        template< typename TYPE >
+        void set(Uniform<TYPE> uniform, const TYPE & value)
+        {
+            if (!uniform.is_valid()) return;
+
+            static_assert(sizeof(TYPE) <= sizeof(Uniform_Info::value), "Tipo de uniform demasiado grande");
+
+            Uniform_Info & info = uniforms[uniform.index];
+
+            if (info.cached && *reinterpret_cast<const TYPE *>(info.value) == value) return;
+
+            *reinterpret_cast<TYPE *>(info.value) = value;
+            info.cached = true;
+
+            use();
+            upload(info.location, value);
+        }
+
+        /**
+         * @brief ndice de un bloque de uniforms o GL_INVALID_INDEX si no existe.
+         */
+        GLuint get_uniform_block_index(const std::string & name) const;
+
+        /**
+         * @brief Tamao en bytes de un bloque de uniforms o 0 si no existe.
+         */
+        GLint get_uniform_block_size(const std::string & name) const;
+
+        /**
+         * @brief Asocia un bloque de uniforms a un punto de enlace de buffers.
+         * @param name Nombre del bloque.
+         * @param binding Punto de enlace (glBindBufferBase(GL_UNIFORM_BUFFER, binding, ...)).
+         */
+        void bind_uniform_block(const std::string & name, GLuint binding) const;
+
+    private:
+
+        int find_uniform(const std::string & name, bool (*matches)(GLenum)) const;
+
+        void reflect();
+
+        void show_compilation_error(GLuint shader_id) const;
+        void show_linkage_error() const;
+
+        // Tipos GLSL compatibles con cada tipo de C++:
+
+        template< typename TYPE >
+        static bool type_matches(GLenum type);
+
+        static void upload(GLint location, const GLint     & value) { glUniform1i       (location, value); }
+        static void upload(GLint location, const GLfloat   & value) { glUniform1f       (location, value); }
+        static void upload(GLint location, const glm::vec2 & value) { glUniform2fv      (location, 1, &value[0]); }
+        static void upload(GLint location, const glm::vec3 & value) { glUniform3fv      (location, 1, &value[0]); }
+        static void upload(GLint location, const glm::vec4 & value) { glUniform4fv      (location, 1, &value[0]); }
+        static void upload(GLint location, const glm::mat3 & value) { glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]); }
+        static void upload(GLint location, const glm::mat4 & value) { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
+
+    };
+
+    template< > inline bool Shader_Program::type_matches< GLint     >(GLenum type)
+    {
+        // Los samplers se asignan con glUniform1i (la unidad de textura):
+
+        return type == GL_INT
+            || type == GL_BOOL
+            || type == GL_SAMPLER_2D
+            || type == GL_SAMPLER_2D_ARRAY
+            || type == GL_SAMPLER_CUBE;
+    }
+
+    template< > inline bool Shader_Program::type_matches< GLfloat   >(GLenum type) { return type == GL_FLOAT;      }
+    template< > inline bool Shader_Program::type_matches< glm::vec2 >(GLenum type) { return type == GL_FLOAT_VEC2; }
+    template< > inline bool Shader_Program::type_matches< glm::vec3 >(GLenum type) { return type == GL_FLOAT_VEC3; }
+    template< > inline bool Shader_Program::type_matches< glm::vec4 >(GLenum type) { return type == GL_FLOAT_VEC4; }
+    template< > inline bool Shader_Program::type_matches< glm::mat3 >(GLenum type) { return type == GL_FLOAT_MAT3; }
+    template< > inline bool Shader_Program::type_matches< glm::mat4 >(GLenum type) { return type == GL_FLOAT_MAT4; }
+
+}
@@ -0,0 +1,138 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstdint>       // Tipos enteros de tamao fijo
+#include <vector>        // Biblioteca para usar el contenedor dinmico std::vector
+#include "Mesh_Arena.hpp"
+#include "Render_Queue.hpp"
+#include "Meshlets.hpp"
+#include "Frustum.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Static_Batcher
+     * @brief Combina en una sola malla los objetos estticos que comparten material.
+     *
+     * Los objetos que no se mueven se registran una vez al construir la escena. Sus vrtices se
+     * transforman al espacio del mundo y los de los objetos con el mismo material (programa, textura,
+     * pasada, estado de rasterizacin, capa y transparencia) se concatenan en una malla nueva de la
+     * arena, que se dibuja con una sola llamada y una matriz de modelo identidad.
+     *
+     * Las mallas combinadas solo se reconstruyen cuando se aade o se quita un objeto esttico.
+     * El atributo 1 (color o normal, segn la malla) se copia sin transformar.
+     *
+     * Cada malla combinada se reparte en meshlets al construirla. Al enviarla, solo se envan los
+     * rangos de ndices de los meshlets que quedan dentro del volumen de visin y de cara a la
+     * cmara, de modo que del terreno y de los objetos grandes solo se rasterizan las partes que
+     * pueden verse. Como las mallas combinadas estn en el espacio del mundo, el descarte no
+     * necesita transformar los volmenes de los meshlets.
+     *
+     * Los objetos translcidos no deben registrarse como estticos: la geometra combinada no se
+     * puede ordenar de atrs hacia delante.
+     */
+    class Static_Batcher
+    {
+    public:
+
+        using Object_Id = std::uint32_t;
+
+    private:
+
+        struct Static_Object
+        {
+            Object_Id id;
+            Draw_Item item;               ///< Dibujo original, con su malla y su matriz de modelo
+        };
+
+        Mesh_Arena & arena;
+
+        std::vector<Static_Object> objects;          ///< Objetos estticos registrados
+        std::vector<Draw_Item>     batches;          ///< Un dibujo por material, con la malla combinada
+        std::vector<Meshlets>      batch_meshlets;   ///< Meshlets de la malla de cada dibujo
+        std::vector<Meshlets::Index_Range> ranges;   ///< Rangos visibles del dibujo que se enva
+
+        std::size_t meshlet_count;                   ///< Meshlets de todas las mallas combinadas
+        std::size_t visible_meshlet_count;           ///< Meshlets enviados en el ltimo frame
+
+        Object_Id next_id;
+        bool      dirty;                             ///< Indica si hay que reconstruir las mallas combinadas
+
+    public:
+
+        /**
+         * @brief Crea el combinador, que guarda las mallas combinadas en la arena indicada.
+         * @param arena Arena de las mallas de los objetos y de las mallas combinadas.
+         */
+        Static_Batcher(Mesh_Arena & arena);
+
+        /**
+         * @brief Devuelve a la arena las mallas combinadas.
+         */
+        ~Static_Batcher();
+
+        Static_Batcher(const Static_Batcher & ) = delete;
+        Static_Batcher & operator = (const Static_Batcher & ) = delete;
+
+        /**
+         * @brief Registra un objeto esttico.
+         * @param item Dibujo del objeto con su malla (de la misma arena) y su matriz de modelo definitiva.
+         * @return Identificador con el que se puede quitar el objeto.
+         */
+        Object_Id add(const Draw_Item & item);
+
+        /**
+         * @brief Quita un objeto esttico registrado previamente.
+         * @param id Identificador devuelto por add().
+         */
+        void remove(Object_Id id);
+
+        /**
+         * @brief Enva a la cola los meshlets visibles de cada material, reconstruyendo antes las
+         * mallas si es necesario.
+         *
+         * Cada rango de meshlets consecutivos visibles es un dibujo con la misma malla y un rango
+         * de ndices ms corto. Todos comparten estado, as que con multi-draw indirect se emiten
+         * juntos.
+         *
+         * @param queue Cola de render del frame.
+         * @param frustum Volumen de visin de la cmara en este frame.
+         * @param camera_position Posicin de la cmara en el espacio del mundo.
+         */
+        void submit(Render_Queue & queue, const Frustum & frustum, const glm::vec3 & camera_position);
+
+        /**
+         * @brief Nmero de mallas combinadas (una por material).
+         */
+        std::size_t get_batch_count() const
+        {
+            return batches.size();
+        }
+
+        /**
+         * @brief Nmero de meshlets de todas las mallas combinadas.
+         */
+        std::size_t get_meshlet_count() const
+        {
+            return meshlet_count;
+        }
+
+        /**
+         * @brief Nmero de meshlets que se enviaron a la cola en el ltimo frame.
+         */
+        std::size_t get_visible_meshlet_count() const
+        {
+            return visible_meshlet_count;
+        }
+
+    private:
+
+        void rebuild();
+        void release_batches();
+
+    };
+
+}
@@ -0,0 +1,183 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#pragma once  // Prevenir la inclusin mltiple del archivo de encabezado
+
+#include <cstddef>              // size_t
+#include <cstdint>              // Tipos enteros de tamao fijo
+#include <vector>               // Biblioteca para usar el contenedor dinmico std::vector
+#include <glm.hpp>              // Biblioteca para operaciones con vectores y matrices en 3D
+#include <gtc/quaternion.hpp>   // quat
+
+namespace udit
+{
+
+    /**
+     * @struct Transform
+     * @brief Transformacin local de un nodo: escala, despus rotacin y despus traslacin.
+     */
+    struct Transform
+    {
+        glm::vec3 translation { 0.f };
+        glm::quat rotation    { 1.f, 0.f, 0.f, 0.f };   ///< Identidad (w, x, y, z)
+        glm::vec3 scale       { 1.f };
+    };
+
+    /**
+     * @struct Keyframe
+     * @brief Traslacin y rotacin de un nodo en un instante de una pista de animacin.
+     */
+    struct Keyframe
+    {
+        float     time;
+        glm::vec3 translation;
+        glm::quat rotation;
+    };
+
+    /**
+     * @class Transform_Hierarchy
+     * @brief Jerarqua de transformaciones con las matrices del mundo guardadas y marcas de cambio.
+     *
+     * Los nodos viven en arrays planos ordenados de modo que cada padre va antes que sus hijos (un
+     * nodo solo se puede aadir con un padre que ya existe, as que el orden de insercin lo
+     * garantiza). Cambiar la transformacin local de un nodo solo lo marca; update() recorre los
+     * arrays una vez de principio a fin y recalcula la matriz del mundo de los nodos marcados y de
+     * los que tienen el padre recalculado en ese mismo recorrido, que ya est al da porque va antes.
+     * No hay punteros entre nodos ni recursin, y los subrboles que no cambian no se tocan.
+     *
+     * Los identificadores de los nodos son su posicin en los arrays y no cambian mientras exista
+     * la jerarqua.
+     */
+    class Transform_Hierarchy
+    {
+    public:
+
+        using Node = std::uint32_t;
+
+        static constexpr Node NO_NODE   = 0xFFFFFFFF;
+        static constexpr Node NO_PARENT = NO_NODE;
+
+    private:
+
+        std::vector<Node>         parents;       ///< Padre de cada nodo (siempre anterior a l) o NO_PARENT
+        std::vector<Transform>    locals;        ///< Transformacin respecto al padre
+        std::vector<glm::mat4>    worlds;        ///< Matriz del mundo calculada en el ltimo update()
+        std::vector<std::uint8_t> dirty;         ///< 1 si la transformacin local cambi desde el ltimo update()
+        std::vector<std::uint8_t> updated;       ///< 1 si la matriz del mundo se recalcul en el ltimo update()
+
+        std::size_t updated_count;               ///< Nodos recalculados en el ltimo update()
+
+    public:
+
+        /**
+         * @brief Crea una jerarqua vaca.
+         */
+        Transform_Hierarchy();
+
+        /**
+         * @brief Aade un nodo al final de la jerarqua.
+         * @param local Transformacin respecto al padre.
+         * @param parent Nodo padre, que ya debe existir, o NO_PARENT para un nodo raz.
+         * @return El identificador del nodo.
+         */
+        Node add(const Transform & local, Node parent = NO_PARENT);
+
+        /**
+         * @brief Aade al final de la jerarqua un bloque de nodos guardados como arrays.
+         * @param block_parents Padre de cada nodo como ndice dentro del propio bloque (anterior al
+         *                      hijo) o NO_PARENT.
+         * @param block_locals Transformacin respecto al padre de cada nodo.
+         * @param count Nmero de nodos del bloque.
+         * @return El identificador del primer nodo del bloque; el resto le siguen en orden.
+         */
+        Node add(const Node * block_parents, const Transform * block_locals, std::size_t count);
+
+        /**
+         * @brief Cambia la transformacin local de un nodo. Su subrbol se recalcula en el prximo update().
+         */
+        void set_local(Node node, const Transform & local)
+        {
+            locals[node] = local;
+            dirty [node] = 1;
+        }
+
+        /**
+         * @brief Cambia solo la traslacin local de un nodo.
+         */
+        void set_translation(Node node, const glm::vec3 & translation)
+        {
+            locals[node].translation = translation;
+            dirty [node] = 1;
+        }
+
+        /**
+         * @brief Cambia solo la rotacin local de un nodo.
+         */
+        void set_rotation(Node node, const glm::quat & rotation)
+        {
+            locals[node].rotation = rotation;
+            dirty [node] = 1;
+        }
+
+        /**
+         * @brief Cambia solo la escala local de un nodo.
+         */
+        void set_scale(Node node, const glm::vec3 & scale)
+        {
+            locals[node].scale = scale;
+            dirty [node] = 1;
+        }
+
+        /**
+         * @brief Transformacin local de un nodo.
+         */
+        const Transform & get_local(Node node) const
+        {
+            return locals[node];
+        }
+
+        /**
+         * @brief Recalcula las matrices del mundo de los nodos marcados y de sus descendientes.
+         */
+        void update();
+
+        /**
+         * @brief Matriz del mundo del nodo, al da desde el ltimo update().
+         */
+        const glm::mat4 & get_world(Node node) const
+        {
+            return worlds[node];
+        }
+
+        /**
+         * @brief Indica si la matriz del mundo del nodo cambi en el ltimo update().
+         */
+        bool was_updated(Node node) const
+        {
+            return updated[node] != 0;
+        }
+
+        /**
+         * @brief Nodos cuya matriz del mundo se recalcul en el ltimo update().
+         */
+        std::size_t get_updated_count() const
+        {
+            return updated_count;
+        }
+
+        /**
+         * @brief Nmero de nodos.
+         */
+        std::size_t size() const
+        {
+            return parents.size();
+        }
+
+        /**
+         * @brief Matriz de una transformacin local (traslacin * rotacin * escala).
+         */
+        static glm::mat4 make_matrix(const Transform & transform);
+
+    };
+
+}
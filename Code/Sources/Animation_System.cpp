@@ -0,0 +1,400 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Animation_System.hpp"
+#include <algorithm>                        // min, upper_bound
+#include <cassert>                          // assert
+#include <cmath>                            // fmod
+#include <initializer_list>                 // initializer_list
+#include <emmintrin.h>                      // Intrnsecos de SSE2
+
+namespace udit
+{
+
+    /**
+     * @brief Nmero de carriles que ocupan count animadores, redondeado a un mltiplo de SIMD_WIDTH.
+     */
+    static std::size_t padded_size(std::size_t count)
+    {
+        return (count + Animation_System::SIMD_WIDTH - 1) / Animation_System::SIMD_WIDTH * Animation_System::SIMD_WIDTH;
+    }
+
+    /**
+     * @brief Ajusta los arrays de un grupo a count animadores ms el relleno, con ceros en los carriles que sobran.
+     */
+    static void resize_lanes(std::size_t count, std::initializer_list< std::vector<float> * > arrays)
+    {
+        for (std::vector<float> * array : arrays)
+        {
+            array->resize(padded_size(count), 0.f);
+        }
+    }
+
+    /**
+     * @brief Seno y coseno de cuatro ngulos a la vez.
+     *
+     * El ngulo se reduce a [-pi/4, pi/4] restndole el mltiplo de pi/2 ms cercano (en tres partes
+     * para no perder precisin) y se evalan los polinomios de seno y coseno de Cephes. El cuadrante
+     * decide si se intercambian y su signo. El error es del orden de 1e-7 para ngulos de unas pocas
+     * vueltas, que es lo que le llega con las fases en [-pi, pi].
+     */
+    static void sincos(__m128 x, __m128 & sine, __m128 & cosine)
+    {
+        const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));   // Redondea x / (pi/2)
+        const __m128  j        = _mm_cvtepi32_ps(quadrant);
+
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(1.5703125f)));
+        r        = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(4.837512969970703125e-4f)));
+        r        = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(7.549789954891882e-8f)));
+
+        const __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 s = _mm_set1_ps(-1.9515295891e-4f);
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps( 8.3321608736e-3f));
+        s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+        s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+        __m128 c = _mm_set1_ps(2.443315711809948e-5f);
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.388731625493765e-3f));
+        c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps( 4.166664568298827e-2f));
+        c = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(c, r2), r2), _mm_mul_ps(r2, _mm_set1_ps(.5f))), _mm_set1_ps(1.f));
+
+        // En los cuadrantes impares el seno es el coseno de r y al revs. El seno cambia de signo en
+        // los cuadrantes 2 y 3 y el coseno en el 1 y el 2 (el complemento a dos hace que valga para
+        // cuadrantes negativos):
+
+        const __m128i one  = _mm_set1_epi32(1);
+        const __m128i two  = _mm_set1_epi32(2);
+        const __m128  swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+
+        const __m128 sine_sign   = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        const __m128 cosine_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+        sine   = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sine_sign  );
+        cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosine_sign);
+    }
+
+    /**
+     * @brief Avanza cuatro fases y las devuelve a [-pi, pi] para que no pierdan precisin con el tiempo.
+     */
+    static __m128 advance_phases(float * phase, const float * speed, __m128 step)
+    {
+        __m128 angle = _mm_add_ps(_mm_loadu_ps(phase), _mm_mul_ps(_mm_loadu_ps(speed), step));
+
+        const __m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(0.159154943f))));   // Redondea angle / 2pi
+
+        angle = _mm_sub_ps(angle, _mm_mul_ps(turns, _mm_set1_ps(6.28318531f)));
+
+        _mm_storeu_ps(phase, angle);
+
+        return angle;
+    }
+
+    /**
+     * @brief Constructor de la clase Animation_System.
+     */
+    Animation_System::Animation_System(Job_System & job_system)
+        : job_system(job_system)
+    {
+    }
+
+    /**
+     * @brief Aade un giro tomando como reposo la rotacin actual del nodo.
+     */
+    void Animation_System::add_spin(const Transform_Hierarchy & transforms, Node node, const glm::vec3 & axis, float speed, float phase)
+    {
+        const std::size_t i    = spins.nodes.size();
+        const glm::quat   rest = transforms.get_local(node).rotation;
+        const glm::vec3   unit = glm::normalize(axis);
+
+        spins.nodes.push_back(node);
+
+        resize_lanes(i + 1, { &spins.rest_w, &spins.rest_x, &spins.rest_y, &spins.rest_z, &spins.axis_x, &spins.axis_y, &spins.axis_z, &spins.speed, &spins.phase });
+
+        spins.rest_w[i] = rest.w;
+        spins.rest_x[i] = rest.x;
+        spins.rest_y[i] = rest.y;
+        spins.rest_z[i] = rest.z;
+        spins.axis_x[i] = unit.x;
+        spins.axis_y[i] = unit.y;
+        spins.axis_z[i] = unit.z;
+        spins.speed [i] = speed;
+        spins.phase [i] = phase;
+    }
+
+    /**
+     * @brief Aade una rbita alrededor de la traslacin actual del nodo.
+     *
+     * Se guardan dos vectores perpendiculares al eje con la longitud del radio, de modo que la
+     * posicin es center + cos(fase) * u + sin(fase) * v.
+     */
+    void Animation_System::add_orbit(const Transform_Hierarchy & transforms, Node node, const glm::vec3 & axis, float radius, float speed, float phase)
+    {
+        const std::size_t i      = orbits.nodes.size();
+        const glm::vec3   center = transforms.get_local(node).translation;
+        const glm::vec3   unit   = glm::normalize(axis);
+        const glm::vec3   u      = glm::normalize(glm::cross(unit, glm::abs(unit.z) < .9f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(1.f, 0.f, 0.f)));
+        const glm::vec3   v      = glm::cross(unit, u);
+
+        orbits.nodes.push_back(node);
+
+        resize_lanes(i + 1, { &orbits.center_x, &orbits.center_y, &orbits.center_z, &orbits.u_x, &orbits.u_y, &orbits.u_z, &orbits.v_x, &orbits.v_y, &orbits.v_z, &orbits.speed, &orbits.phase });
+
+        orbits.center_x[i] = center.x;
+        orbits.center_y[i] = center.y;
+        orbits.center_z[i] = center.z;
+        orbits.u_x     [i] = u.x * radius;
+        orbits.u_y     [i] = u.y * radius;
+        orbits.u_z     [i] = u.z * radius;
+        orbits.v_x     [i] = v.x * radius;
+        orbits.v_y     [i] = v.y * radius;
+        orbits.v_z     [i] = v.z * radius;
+        orbits.speed   [i] = speed;
+        orbits.phase   [i] = phase;
+    }
+
+    /**
+     * @brief Aade un vaivn alrededor de la traslacin actual del nodo.
+     */
+    void Animation_System::add_bob(const Transform_Hierarchy & transforms, Node node, const glm::vec3 & offset, float speed, float phase)
+    {
+        const std::size_t i    = bobs.nodes.size();
+        const glm::vec3   rest = transforms.get_local(node).translation;
+
+        bobs.nodes.push_back(node);
+
+        resize_lanes(i + 1, { &bobs.rest_x, &bobs.rest_y, &bobs.rest_z, &bobs.offset_x, &bobs.offset_y, &bobs.offset_z, &bobs.speed, &bobs.phase });
+
+        bobs.rest_x  [i] = rest.x;
+        bobs.rest_y  [i] = rest.y;
+        bobs.rest_z  [i] = rest.z;
+        bobs.offset_x[i] = offset.x;
+        bobs.offset_y[i] = offset.y;
+        bobs.offset_z[i] = offset.z;
+        bobs.speed   [i] = speed;
+        bobs.phase   [i] = phase;
+    }
+
+    /**
+     * @brief Aade una pista copiando sus fotogramas al final de los de todas las pistas.
+     */
+    void Animation_System::add_track(Node node, const Keyframe * keys, std::size_t key_count, float speed)
+    {
+        assert(key_count > 0);
+
+        tracks.nodes     .push_back(node);
+        tracks.first_keys.push_back(std::uint32_t(tracks.keys.size()));
+        tracks.key_counts.push_back(std::uint32_t(key_count));
+        tracks.speed     .push_back(speed);
+        tracks.time      .push_back(keys[0].time);
+        tracks.keys      .insert   (tracks.keys.end(), keys, keys + key_count);
+    }
+
+    /**
+     * @brief Evala los animadores tipo a tipo.
+     */
+    void Animation_System::update(Transform_Hierarchy & transforms, float step)
+    {
+        update_spins (transforms, step);
+        update_orbits(transforms, step);
+        update_bobs  (transforms, step);
+        update_tracks(transforms, step);
+    }
+
+    /**
+     * @brief Giros: rotacin = reposo * (cos(fase/2), sin(fase/2) * eje), con el producto de
+     * cuaterniones desarrollado componente a componente para los cuatro carriles.
+     */
+    void Animation_System::update_spins(Transform_Hierarchy & transforms, float step)
+    {
+        const std::size_t count = spins.nodes.size();
+
+        if (count == 0) return;
+
+        job_system.parallel_for
+        (
+            padded_size(count) / SIMD_WIDTH, ANIMATORS_PER_RANGE / SIMD_WIDTH,
+            [this, &transforms, count, step] (std::size_t, std::size_t first_group, std::size_t end_group)
+            {
+                const __m128 step4 = _mm_set1_ps(step);
+                const __m128 half  = _mm_set1_ps(.5f);
+
+                alignas(16) float w[SIMD_WIDTH], x[SIMD_WIDTH], y[SIMD_WIDTH], z[SIMD_WIDTH];
+
+                for (std::size_t i = first_group * SIMD_WIDTH, end = end_group * SIMD_WIDTH; i < end; i += SIMD_WIDTH)
+                {
+                    const __m128 angle = advance_phases(spins.phase.data() + i, spins.speed.data() + i, step4);
+
+                    __m128 s, c;
+
+                    sincos(_mm_mul_ps(angle, half), s, c);
+
+                    const __m128 rw = _mm_loadu_ps(spins.rest_w.data() + i);
+                    const __m128 rx = _mm_loadu_ps(spins.rest_x.data() + i);
+                    const __m128 ry = _mm_loadu_ps(spins.rest_y.data() + i);
+                    const __m128 rz = _mm_loadu_ps(spins.rest_z.data() + i);
+                    const __m128 qx = _mm_mul_ps(s, _mm_loadu_ps(spins.axis_x.data() + i));
+                    const __m128 qy = _mm_mul_ps(s, _mm_loadu_ps(spins.axis_y.data() + i));
+                    const __m128 qz = _mm_mul_ps(s, _mm_loadu_ps(spins.axis_z.data() + i));
+
+                    // w = rw * c - r  q;  v = rw * q + c * r + r  q
+
+                    const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, qx), _mm_mul_ps(ry, qy)), _mm_mul_ps(rz, qz));
+
+                    _mm_store_ps(w, _mm_sub_ps(_mm_mul_ps(rw, c), dot));
+                    _mm_store_ps(x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(rw, qx), _mm_mul_ps(c, rx)), _mm_sub_ps(_mm_mul_ps(ry, qz), _mm_mul_ps(rz, qy))));
+                    _mm_store_ps(y, _mm_add_ps(_mm_add_ps(_mm_mul_ps(rw, qy), _mm_mul_ps(c, ry)), _mm_sub_ps(_mm_mul_ps(rz, qx), _mm_mul_ps(rx, qz))));
+                    _mm_store_ps(z, _mm_add_ps(_mm_add_ps(_mm_mul_ps(rw, qz), _mm_mul_ps(c, rz)), _mm_sub_ps(_mm_mul_ps(rx, qy), _mm_mul_ps(ry, qx))));
+
+                    for (std::size_t lane = 0, lanes = std::min(SIMD_WIDTH, count - i); lane < lanes; ++lane)
+                    {
+                        transforms.set_rotation(spins.nodes[i + lane], glm::quat(w[lane], x[lane], y[lane], z[lane]));
+                    }
+                }
+            }
+        );
+    }
+
+    /**
+     * @brief rbitas: traslacin = centro + cos(fase) * u + sin(fase) * v.
+     */
+    void Animation_System::update_orbits(Transform_Hierarchy & transforms, float step)
+    {
+        const std::size_t count = orbits.nodes.size();
+
+        if (count == 0) return;
+
+        job_system.parallel_for
+        (
+            padded_size(count) / SIMD_WIDTH, ANIMATORS_PER_RANGE / SIMD_WIDTH,
+            [this, &transforms, count, step] (std::size_t, std::size_t first_group, std::size_t end_group)
+            {
+                const __m128 step4 = _mm_set1_ps(step);
+
+                alignas(16) float x[SIMD_WIDTH], y[SIMD_WIDTH], z[SIMD_WIDTH];
+
+                for (std::size_t i = first_group * SIMD_WIDTH, end = end_group * SIMD_WIDTH; i < end; i += SIMD_WIDTH)
+                {
+                    const __m128 angle = advance_phases(orbits.phase.data() + i, orbits.speed.data() + i, step4);
+
+                    __m128 s, c;
+
+                    sincos(angle, s, c);
+
+                    _mm_store_ps(x, _mm_add_ps(_mm_loadu_ps(orbits.center_x.data() + i), _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(orbits.u_x.data() + i)), _mm_mul_ps(s, _mm_loadu_ps(orbits.v_x.data() + i)))));
+                    _mm_store_ps(y, _mm_add_ps(_mm_loadu_ps(orbits.center_y.data() + i), _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(orbits.u_y.data() + i)), _mm_mul_ps(s, _mm_loadu_ps(orbits.v_y.data() + i)))));
+                    _mm_store_ps(z, _mm_add_ps(_mm_loadu_ps(orbits.center_z.data() + i), _mm_add_ps(_mm_mul_ps(c, _mm_loadu_ps(orbits.u_z.data() + i)), _mm_mul_ps(s, _mm_loadu_ps(orbits.v_z.data() + i)))));
+
+                    for (std::size_t lane = 0, lanes = std::min(SIMD_WIDTH, count - i); lane < lanes; ++lane)
+                    {
+                        transforms.set_translation(orbits.nodes[i + lane], glm::vec3(x[lane], y[lane], z[lane]));
+                    }
+                }
+            }
+        );
+    }
+
+    /**
+     * @brief Vaivenes: traslacin = reposo + sin(fase) * desplazamiento.
+     */
+    void Animation_System::update_bobs(Transform_Hierarchy & transforms, float step)
+    {
+        const std::size_t count = bobs.nodes.size();
+
+        if (count == 0) return;
+
+        job_system.parallel_for
+        (
+            padded_size(count) / SIMD_WIDTH, ANIMATORS_PER_RANGE / SIMD_WIDTH,
+            [this, &transforms, count, step] (std::size_t, std::size_t first_group, std::size_t end_group)
+            {
+                const __m128 step4 = _mm_set1_ps(step);
+
+                alignas(16) float x[SIMD_WIDTH], y[SIMD_WIDTH], z[SIMD_WIDTH];
+
+                for (std::size_t i = first_group * SIMD_WIDTH, end = end_group * SIMD_WIDTH; i < end; i += SIMD_WIDTH)
+                {
+                    const __m128 angle = advance_phases(bobs.phase.data() + i, bobs.speed.data() + i, step4);
+
+                    __m128 s, c;
+
+                    sincos(angle, s, c);
+
+                    _mm_store_ps(x, _mm_add_ps(_mm_loadu_ps(bobs.rest_x.data() + i), _mm_mul_ps(s, _mm_loadu_ps(bobs.offset_x.data() + i))));
+                    _mm_store_ps(y, _mm_add_ps(_mm_loadu_ps(bobs.rest_y.data() + i), _mm_mul_ps(s, _mm_loadu_ps(bobs.offset_y.data() + i))));
+                    _mm_store_ps(z, _mm_add_ps(_mm_loadu_ps(bobs.rest_z.data() + i), _mm_mul_ps(s, _mm_loadu_ps(bobs.offset_z.data() + i))));
+
+                    for (std::size_t lane = 0, lanes = std::min(SIMD_WIDTH, count - i); lane < lanes; ++lane)
+                    {
+                        transforms.set_translation(bobs.nodes[i + lane], glm::vec3(x[lane], y[lane], z[lane]));
+                    }
+                }
+            }
+        );
+    }
+
+    /**
+     * @brief Pistas: se busca el tramo entre fotogramas que contiene el tiempo de la pista y se
+     * interpolan linealmente la traslacin y esfricamente la rotacin.
+     *
+     * Cada pista tiene su propio nmero de fotogramas, as que se evalan de una en una, repartidas
+     * en tramos entre los hilos como el resto.
+     */
+    void Animation_System::update_tracks(Transform_Hierarchy & transforms, float step)
+    {
+        const std::size_t count = tracks.nodes.size();
+
+        if (count == 0) return;
+
+        job_system.parallel_for
+        (
+            count, ANIMATORS_PER_RANGE,
+            [this, &transforms, step] (std::size_t, std::size_t first, std::size_t end)
+            {
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    const Keyframe * keys     = tracks.keys.data() + tracks.first_keys[i];
+                    const Keyframe * last     = keys + tracks.key_counts[i] - 1;
+                    const float      duration = last->time - keys->time;
+
+                    float time = tracks.time[i] + tracks.speed[i] * step;
+
+                    if (duration > 0.f)
+                    {
+                        time = keys->time + std::fmod(time - keys->time, duration);
+
+                        if (time < keys->time) time += duration;
+                    }
+
+                    tracks.time[i] = time;
+
+                    const Keyframe * next = std::upper_bound(keys, last + 1, time, [] (float t, const Keyframe & key) { return t < key.time; });
+
+                    glm::vec3 translation;
+                    glm::quat rotation;
+
+                    if (next == keys || next > last)
+                    {
+                        const Keyframe & key = next == keys ? *keys : *last;
+
+                        translation = key.translation;
+                        rotation    = key.rotation;
+                    }
+                    else
+                    {
+                        const Keyframe & a = next[-1];
+                        const Keyframe & b = next[ 0];
+                        const float      f = (time - a.time) / (b.time - a.time);
+
+                        translation = glm::mix  (a.translation, b.translation, f);
+                        rotation    = glm::slerp(a.rotation,    b.rotation,    f);
+                    }
+
+                    transforms.set_translation(tracks.nodes[i], translation);
+                    transforms.set_rotation   (tracks.nodes[i], rotation);
+                }
+            }
+        );
+    }
+
+}
@@ -0,0 +1,54 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Camera_Buffer.hpp"
+#include <cstring>       // memcpy
+
+namespace udit
+{
+
+    static_assert(sizeof(Camera_Data) == 3 * 64 + 16, "Camera_Data no coincide con la distribucion std140 del bloque");
+
+    /**
+     * @brief Devuelve la alineacin que exige el driver para glBindBufferRange de uniforms.
+     */
+    static std::size_t uniform_buffer_alignment()
+    {
+        GLint alignment = 256;
+
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+        return std::size_t(alignment > 0 ? alignment : 256);
+    }
+
+    /**
+     * @brief Constructor de la clase Camera_Buffer.
+     */
+    Camera_Buffer::Camera_Buffer()
+        : ring(GL_UNIFORM_BUFFER, sizeof(Camera_Data), uniform_buffer_alignment())
+    {
+    }
+
+    /**
+     * @brief Escribe los datos de la cmara del frame y vincula el bloque a su punto de enlace.
+     *
+     * @param data Datos de la cmara.
+     */
+    void Camera_Buffer::upload(const Camera_Data & data)
+    {
+        std::memcpy(ring.begin_segment(sizeof(Camera_Data)), &data, sizeof(Camera_Data));
+
+        ring.end_segment();
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, BINDING, ring.get_id(), GLintptr(ring.get_segment_offset()), sizeof(Camera_Data));
+    }
+
+    /**
+     * @brief Marca el final de los dibujos que leen los datos del frame.
+     */
+    void Camera_Buffer::end_frame()
+    {
+        ring.fence_segment();
+    }
+
+}
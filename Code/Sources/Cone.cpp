@@ -2,6 +2,7 @@
 // davidbercialblazquez@gmail.com
 
 #include "../Headers/Cone.hpp"
+#include "../Headers/OpenGL_State.hpp"
 #include <numbers>
 
 namespace udit
@@ -18,7 +19,8 @@ namespace udit
      * @param radius El radio de la base del cono.
      * @param height La altura del cono.
      */
-    Cone::Cone(int radial_segments, float radius, float height)
+    Cone::Cone(Mesh_Arena & arena, int radial_segments, float radius, float height)
+        : arena(arena)
     {
         // Generar los vrtices de la base del cono:
         for (int i = 0; i < radial_segments; ++i)
@@ -91,62 +93,52 @@ namespace udit
             indices.push_back((i + 1) % radial_segments);  // Vrtice siguiente de la base
         }
 
-        // Crear y configurar los buffers de OpenGL:
-        glGenBuffers(VBO_COUNT, vbo_ids);  // Crear los buffers (VBOs)
-        glGenVertexArrays(1, &vao_id);     // Crear el VAO (Vertex Array Object)
-
-        glBindVertexArray(vao_id);  // Vincular el VAO
-
-        // Coordenadas de los vrtices:
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[COORDINATES_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, coordinates.size() * sizeof(GLfloat), coordinates.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // Colores:
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[COLORS_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(GLfloat), colors.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // Coordenadas UV:
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[UVS_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(GLfloat), uvs.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // ndices de los tringulos:
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_ids[INDICES_EBO]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLubyte), indices.data(), GL_STATIC_DRAW);
-
-        glBindVertexArray(0);  // Desvincular el VAO
+        // Subir la geometra a la arena de mallas compartida:
+        mesh = arena.allocate
+        (
+            coordinates.data(), colors.data(), uvs.data(), coordinates.size() / 3,
+            indices, GL_FILL, true
+        );
     }
 
     /**
      * @brief Destructor de la clase Cone.
      *
-     * Elimina los buffers de OpenGL utilizados por el cono (VAO, VBOs, EBO).
+     * Devuelve a la arena de mallas el espacio ocupado por el cono.
      */
     Cone::~Cone()
     {
-        glDeleteVertexArrays(1, &vao_id);  // Eliminar el VAO
-        glDeleteBuffers(VBO_COUNT, vbo_ids);  // Eliminar los VBOs
+        arena.release(mesh);  // Devolver a la arena el espacio ocupado por el cono
     }
 
     /**
      * @brief Renderiza el cono en la escena.
      *
-     * Este mtodo activa el VAO y dibuja los tringulos que componen la malla del cono
-     * usando los ndices almacenados en el EBO. El modo de polgonos se establece en
+     * Este mtodo activa el VAO de la arena y dibuja los tringulos que componen la malla del cono
+     * usando el rango de ndices que ocupa dentro de ella. El modo de polgonos se establece en
      * GL_FILL para dibujar los tringulos con relleno.
      */
     void Cone::render()
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);  // Dibujar con relleno
-        glEnable(GL_CULL_FACE);  // Activar el culling para optimizar el renderizado
-        glBindVertexArray(vao_id);  // Vincular el VAO
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_BYTE, 0);  // Dibujar los tringulos usando los ndices
-        glBindVertexArray(0);  // Desvincular el VAO
+        OpenGL_State & state = OpenGL_State::instance();
+
+        state.set_polygon_mode(GL_FILL);  // Dibujar con relleno
+        state.set_cull_face(true);  // Activar el culling para optimizar el renderizado
+        state.bind_vertex_array(mesh.vao_id);  // Vincular el VAO de la arena (se queda vinculado)
+        Mesh_Arena::draw(mesh);  // Dibujar los tringulos de la malla con su vrtice base
+    }
+
+    /**
+     * @brief Devuelve la descripcin de la malla del cono.
+     *
+     * Recoge el mismo estado que establece render() para que la cola de render pueda dibujar el cono
+     * sin llamar a este mtodo.
+     *
+     * @return Mesh La descripcin de la malla.
+     */
+    Mesh Cone::get_mesh() const
+    {
+        return mesh;
     }
 
 }
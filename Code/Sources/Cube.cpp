@@ -3,6 +3,8 @@
 // angel.rodriguez@udit.es
 
 #include "../Headers/Cube.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include <iterator>
 
 namespace udit
 {
@@ -31,7 +33,7 @@ namespace udit
         0, 1, 0,            // 7
     };
 
-    const GLubyte Cube::indices[] =
+    const GLuint Cube::indices[] =
     {
         0, 1, 2,            // front
         0, 2, 3,
@@ -47,56 +49,38 @@ namespace udit
         5, 1, 0,
     };
 
-    Cube::Cube()
+    Cube::Cube(Mesh_Arena & arena)
+        : arena(arena)
     {
-        // Se generan ndices para los VBOs del cubo:
+        // Se reserva el cubo dentro de la arena de mallas y se sube su geometra (sin UVs):
 
-        glGenBuffers (VBO_COUNT, vbo_ids);
-        glGenVertexArrays (1, &vao_id);
+        std::vector<GLuint> mesh_indices(std::begin(indices), std::end(indices));
 
-        // Se activa el VAO del cubo para configurarlo:
-
-        glBindVertexArray (vao_id);
-
-        // Se suben a un VBO los datos de coordenadas y se vinculan al VAO:
-
-        glBindBuffer (GL_ARRAY_BUFFER, vbo_ids[COORDINATES_VBO]);
-        glBufferData (GL_ARRAY_BUFFER, sizeof(coordinates), coordinates, GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray (0);
-        glVertexAttribPointer (0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // Se suben a un VBO los datos de color y se vinculan al VAO:
-
-        glBindBuffer (GL_ARRAY_BUFFER, vbo_ids[COLORS_VBO]);
-        glBufferData (GL_ARRAY_BUFFER, sizeof(colors), colors, GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray (1);
-        glVertexAttribPointer (1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // Se suben a un EBO los datos de ndices:
-
-        glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, vbo_ids[INDICES_EBO]);
-        glBufferData (GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-        glBindVertexArray (0);
+        mesh = arena.allocate(coordinates, colors, nullptr, std::size(coordinates) / 3, mesh_indices, GL_LINE, false);
     }
 
     Cube::~Cube()
     {
-        // Se liberan los VBOs y el VAO usados:
+        // Se devuelve a la arena el espacio que ocupaba el cubo:
 
-        glDeleteVertexArrays (1, &vao_id);
-        glDeleteBuffers      (VBO_COUNT, vbo_ids);
+        arena.release(mesh);
     }
 
     void Cube::render ()
     {
-        // Se selecciona el VAO que contiene los datos del objeto y se dibujan sus elementos:
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glDisable(GL_CULL_FACE);
-        glBindVertexArray (vao_id);
-        glDrawElements    (GL_TRIANGLES, sizeof(indices), GL_UNSIGNED_BYTE, 0);
-        glBindVertexArray (0);
+        // Se selecciona el VAO de la arena y se dibuja el rango que ocupa el cubo:
+        OpenGL_State & state = OpenGL_State::instance();
+
+        state.set_polygon_mode  (GL_LINE);
+        state.set_cull_face     (false);
+        state.bind_vertex_array (mesh.vao_id);
+        Mesh_Arena::draw        (mesh);
+    }
+
+    Mesh Cube::get_mesh () const
+    {
+        // El cubo se dibuja en alambre, igual que en render():
+
+        return mesh;
     }
 }
@@ -2,6 +2,7 @@
 // davidbercialblazquez@gmail.com
 
 #include "../Headers/Cylinder.hpp"
+#include "../Headers/OpenGL_State.hpp"
 #include <numbers>
 
 namespace udit
@@ -19,7 +20,8 @@ namespace udit
      * @param radius Radio de la base del cilindro.
      * @param height Altura del cilindro.
      */
-    Cylinder::Cylinder(int radial_segments, int height_segments, float radius, float height)
+    Cylinder::Cylinder(Mesh_Arena & arena, int radial_segments, int height_segments, float radius, float height)
+        : arena(arena)
     {
         // Generar los vrtices del cuerpo del cilindro y sus colores:
         for (int y = 0; y <= height_segments; ++y)
@@ -109,47 +111,23 @@ namespace udit
             indices.push_back((height_segments * (radial_segments + 1)) + x);
         }
 
-        // Crear y configurar los buffers de OpenGL:
-        glGenBuffers(VBO_COUNT, vbo_ids);  // Generar los buffers
-        glGenVertexArrays(1, &vao_id);     // Generar el VAO (Vertex Array Object)
-
-        glBindVertexArray(vao_id);  // Enlazar el VAO
-
-        // Coordenadas de los vrtices
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[COORDINATES_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, coordinates.size() * sizeof(GLfloat), coordinates.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // Colores
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[COLORS_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(GLfloat), colors.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // Coordenadas UV
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[UVS_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(GLfloat), uvs.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-
-        // ndices de los tringulos
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_ids[INDICES_EBO]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLubyte), indices.data(), GL_STATIC_DRAW);
-
-        glBindVertexArray(0);  // Desvincular el VAO
+        // Subir la geometra a la arena de mallas compartida:
+        mesh = arena.allocate
+        (
+            coordinates.data(), colors.data(), uvs.data(), coordinates.size() / 3,
+            indices, GL_FILL, false
+        );
     }
 
 
     /**
      * @brief Destructor de la clase Cylinder.
      *
-     * Libera los recursos de OpenGL asociados al cilindro, eliminando los buffers y el VAO.
+     * Devuelve a la arena de mallas el espacio ocupado por el cilindro.
      */
     Cylinder::~Cylinder()
     {
-        glDeleteVertexArrays(1, &vao_id);
-        glDeleteBuffers(VBO_COUNT, vbo_ids);
+        arena.release(mesh);  // Devolver a la arena el espacio ocupado por el cilindro
     }
 
     /**
@@ -160,11 +138,25 @@ namespace udit
      */
     void Cylinder::render()
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);  // Dibuja el cilindro con relleno
-        glDisable(GL_CULL_FACE);  // Desactiva el culling (no recorta caras)
-        glBindVertexArray(vao_id);  // Vincula el VAO
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_BYTE, 0);  // Dibuja los tringulos utilizando los ndices
-        glBindVertexArray(0);  // Desvincula el VAO
+        OpenGL_State & state = OpenGL_State::instance();
+
+        state.set_polygon_mode(GL_FILL);  // Dibuja el cilindro con relleno
+        state.set_cull_face(false);  // Desactiva el culling (no recorta caras)
+        state.bind_vertex_array(mesh.vao_id);  // Vincular el VAO de la arena (se queda vinculado)
+        Mesh_Arena::draw(mesh);  // Dibujar los tringulos de la malla con su vrtice base
+    }
+
+    /**
+     * @brief Devuelve la descripcin de la malla del cilindro.
+     *
+     * Recoge el mismo estado que establece render() para que la cola de render pueda dibujar el cilindro
+     * sin llamar a este mtodo.
+     *
+     * @return Mesh La descripcin de la malla.
+     */
+    Mesh Cylinder::get_mesh() const
+    {
+        return mesh;
     }
 
 }
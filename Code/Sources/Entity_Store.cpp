@@ -0,0 +1,255 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Entity_Store.hpp"
+#include <algorithm>                        // fill
+#include <cassert>                          // assert
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Entity_Store.
+     */
+    Entity_Store::Entity_Store(Job_System & job_system)
+        : job_system(job_system), visible_count(0)
+    {
+    }
+
+    /**
+     * @brief Crea una entidad dibujable al final de los arrays.
+     *
+     * Nace marcada como movida para que el prximo update_bounds() calcule su esfera aunque su nodo
+     * no cambie.
+     */
+    Entity_Store::Entity Entity_Store::create(Transform_Hierarchy::Node node, const Mesh & mesh, std::uint32_t material, std::uint32_t object_id)
+    {
+        Entity entity;
+
+        if (free_entities.empty())
+        {
+            entity = Entity(positions.size());
+            positions.push_back(0);
+        }
+        else
+        {
+            entity = free_entities.back();
+            free_entities.pop_back();
+        }
+
+        positions[entity] = std::uint32_t(entities.size());
+
+        entities  .push_back(entity);
+        nodes     .push_back(node);
+        meshes    .push_back(mesh);
+        materials .push_back(material);
+        object_ids.push_back(object_id);
+        flags     .push_back(MOVED);
+
+        resize_spheres();
+
+        return entity;
+    }
+
+    /**
+     * @brief Reserva espacio en todos los arrays de componentes.
+     */
+    void Entity_Store::reserve(std::size_t count)
+    {
+        const std::size_t padded = (count + Frustum::SIMD_WIDTH - 1) / Frustum::SIMD_WIDTH * Frustum::SIMD_WIDTH;
+
+        entities     .reserve(count);
+        nodes        .reserve(count);
+        meshes       .reserve(count);
+        materials    .reserve(count);
+        object_ids   .reserve(count);
+        flags        .reserve(count);
+        positions    .reserve(count);
+        sphere_x     .reserve(padded);
+        sphere_y     .reserve(padded);
+        sphere_z     .reserve(padded);
+        sphere_radius.reserve(padded);
+        visibility   .reserve(padded);
+    }
+
+    /**
+     * @brief Destruye una entidad, ocupando su lugar con la ltima para que los arrays no tengan huecos.
+     */
+    void Entity_Store::destroy(Entity entity)
+    {
+        assert(entity < positions.size());
+
+        const std::size_t position = positions[entity];
+        const std::size_t last     = entities.size() - 1;
+
+        if (position != last)
+        {
+            entities     [position] = entities     [last];
+            nodes        [position] = nodes        [last];
+            meshes       [position] = meshes       [last];
+            materials    [position] = materials    [last];
+            object_ids   [position] = object_ids   [last];
+            flags        [position] = flags        [last];
+            sphere_x     [position] = sphere_x     [last];
+            sphere_y     [position] = sphere_y     [last];
+            sphere_z     [position] = sphere_z     [last];
+            sphere_radius[position] = sphere_radius[last];
+            visibility   [position] = visibility   [last];
+
+            positions[entities[position]] = std::uint32_t(position);
+        }
+
+        entities  .pop_back();
+        nodes     .pop_back();
+        meshes    .pop_back();
+        materials .pop_back();
+        object_ids.pop_back();
+        flags     .pop_back();
+
+        resize_spheres();
+
+        free_entities.push_back(entity);
+    }
+
+    /**
+     * @brief Muestra u oculta una entidad.
+     */
+    void Entity_Store::set_hidden(Entity entity, bool hidden)
+    {
+        std::uint8_t & entity_flags = flags[positions[entity]];
+
+        entity_flags = hidden ? entity_flags | HIDDEN : entity_flags & ~HIDDEN;
+    }
+
+    /**
+     * @brief Ajusta los arrays de las esferas al nmero de entidades, rellenando hasta un mltiplo
+     * de Frustum::SIMD_WIDTH con esferas que no se tienen en cuenta.
+     */
+    void Entity_Store::resize_spheres()
+    {
+        const std::size_t padded = (entities.size() + Frustum::SIMD_WIDTH - 1) / Frustum::SIMD_WIDTH * Frustum::SIMD_WIDTH;
+
+        sphere_x     .resize(padded, 0.f);
+        sphere_y     .resize(padded, 0.f);
+        sphere_z     .resize(padded, 0.f);
+        sphere_radius.resize(padded, 0.f);
+        visibility   .resize(padded, 0);
+    }
+
+    /**
+     * @brief Lleva al mundo la esfera de las entidades que se han movido.
+     *
+     * La esfera local de la malla se transforma con la matriz del mundo del nodo y el radio se
+     * escala por el mayor factor de escala, como en Render_Queue::cull().
+     */
+    void Entity_Store::update_bounds(const Transform_Hierarchy & transforms)
+    {
+        job_system.parallel_for
+        (
+            entities.size(), ENTITIES_PER_RANGE,
+            [this, &transforms] (std::size_t, std::size_t first, std::size_t end)
+            {
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    if (!(flags[i] & MOVED) && !transforms.was_updated(nodes[i]))
+                    {
+                        continue;
+                    }
+
+                    const glm::mat4 & world  = transforms.get_world(nodes[i]);
+                    const Bounds    & bounds = meshes[i].bounds;
+                    const glm::vec3   center = glm::vec3(world * glm::vec4(bounds.center, 1.f));
+
+                    const float scale = glm::sqrt(glm::max
+                    (
+                        glm::max(glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+                                 glm::dot(glm::vec3(world[1]), glm::vec3(world[1]))),
+                                 glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))
+                    ));
+
+                    sphere_x     [i] = center.x;
+                    sphere_y     [i] = center.y;
+                    sphere_z     [i] = center.z;
+                    sphere_radius[i] = bounds.radius * scale;
+
+                    flags[i] |= MOVED;
+                }
+            }
+        );
+    }
+
+    /**
+     * @brief Marca como visibles las entidades cuya esfera toca el volumen de visin.
+     *
+     * Cada tramo empieza en un mltiplo de Frustum::SIMD_WIDTH, de modo que cull_spheres() trabaja
+     * siempre con grupos completos.
+     */
+    void Entity_Store::cull(const Frustum & frustum)
+    {
+        constexpr std::size_t width = Frustum::SIMD_WIDTH;
+
+        job_system.parallel_for
+        (
+            visibility.size() / width, ENTITIES_PER_RANGE / width,
+            [this, &frustum] (std::size_t, std::size_t first_group, std::size_t end_group)
+            {
+                const std::size_t first = first_group * width;
+                const std::size_t end   = end_group   * width;
+
+                frustum.cull_spheres
+                (
+                    sphere_x.data() + first,
+                    sphere_y.data() + first,
+                    sphere_z.data() + first,
+                    sphere_radius.data() + first,
+                    end - first,
+                    visibility.data() + first
+                );
+            }
+        );
+    }
+
+    /**
+     * @brief Marca todas las entidades como visibles.
+     */
+    void Entity_Store::mark_all_visible()
+    {
+        std::fill(visibility.begin(), visibility.end(), std::uint8_t(1));
+    }
+
+    /**
+     * @brief Marca como visibles solo las entidades indicadas.
+     */
+    void Entity_Store::mark_visible(const std::vector<Entity> & visible_entities)
+    {
+        std::fill(visibility.begin(), visibility.end(), std::uint8_t(0));
+
+        for (Entity entity : visible_entities)
+        {
+            visibility[positions[entity]] = 1;
+        }
+    }
+
+    /**
+     * @brief Enva a la cola las entidades visibles que no estn ocultas.
+     *
+     * Es el ltimo sistema del frame, as que tambin borra las marcas de movimiento. La cola no
+     * admite envos concurrentes, de modo que este recorrido se hace en el hilo que la posee.
+     */
+    void Entity_Store::submit(Render_Queue & queue, const Material * material_table, const Transform_Hierarchy & transforms)
+    {
+        visible_count = 0;
+
+        for (std::size_t i = 0, count = entities.size(); i < count; ++i)
+        {
+            flags[i] &= ~MOVED;
+
+            if (!visibility[i] || (flags[i] & HIDDEN)) continue;
+
+            queue.submit(make_draw_item(material_table[materials[i]], meshes[i], transforms.get_world(nodes[i]), object_ids[i]));
+
+            visible_count++;
+        }
+    }
+
+}
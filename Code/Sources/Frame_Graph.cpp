@@ -0,0 +1,636 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Frame_Graph.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include <algorithm>     // find, sort
+#include <cassert>       // assert
+#include <iostream>      // cout, cerr
+
+namespace udit
+{
+
+    /**
+     * @brief Crea una textura transitoria que la pasada escribe.
+     */
+    Frame_Graph::Resource Frame_Graph::Builder::create(const std::string & name, const Texture_Description & description)
+    {
+        Virtual_Texture texture;
+
+        texture.name        = name;
+        texture.description = description;
+
+        graph.textures.push_back(std::move(texture));
+
+        return write(Resource(graph.textures.size() - 1));
+    }
+
+    /**
+     * @brief Declara que la pasada lee una textura.
+     */
+    Frame_Graph::Resource Frame_Graph::Builder::read(Resource resource)
+    {
+        assert(resource < graph.textures.size());
+
+        graph.passes[pass].reads.push_back(resource);
+
+        return resource;
+    }
+
+    /**
+     * @brief Declara que la pasada escribe una textura.
+     */
+    Frame_Graph::Resource Frame_Graph::Builder::write(Resource resource)
+    {
+        assert(resource < graph.textures.size());
+
+        graph.passes  [pass    ].writes .push_back(resource);
+        graph.textures[resource].writers.push_back(pass);
+
+        return resource;
+    }
+
+    /**
+     * @brief Marca la pasada como visible fuera del grafo.
+     */
+    void Frame_Graph::Builder::set_side_effect()
+    {
+        graph.passes[pass].side_effect = true;
+    }
+
+    /**
+     * @brief Textura de OpenGL asignada a un recurso del grafo.
+     */
+    GLuint Frame_Graph::Context::get_texture(Resource resource) const
+    {
+        const int physical = graph.textures[resource].physical;
+
+        assert(physical >= 0);
+
+        return graph.physical_textures[physical].texture_id;
+    }
+
+    /**
+     * @brief Framebuffer que tiene como nico adjunto la textura de un recurso.
+     */
+    GLuint Frame_Graph::Context::get_framebuffer(Resource resource) const
+    {
+        assert(graph.textures[resource].physical >= 0);
+
+        return graph.find_framebuffer({ graph.textures[resource].physical });
+    }
+
+    /**
+     * @brief Constructor de la clase Frame_Graph.
+     */
+    Frame_Graph::Frame_Graph()
+        : compiled(false)
+    {
+    }
+
+    /**
+     * @brief Destructor de la clase Frame_Graph.
+     */
+    Frame_Graph::~Frame_Graph()
+    {
+        release_framebuffers();
+
+        for (const Physical_Texture & texture : physical_textures)
+        {
+            glDeleteTextures(1, &texture.texture_id);
+        }
+    }
+
+    /**
+     * @brief Elimina todas las pasadas y recursos.
+     */
+    void Frame_Graph::clear()
+    {
+        passes  .clear();
+        textures.clear();
+        execution_order.clear();
+
+        compiled = false;
+    }
+
+    /**
+     * @brief Aade una pasada al grafo.
+     *
+     * @param name Nombre de la pasada.
+     * @param setup Funcin que declara los recursos de la pasada.
+     * @param execute Funcin que dibuja la pasada.
+     * @return Identificador de la pasada.
+     */
+    Frame_Graph::Pass_Id Frame_Graph::add_pass(const std::string & name, const Setup_Function & setup, Execute_Function execute)
+    {
+        const Pass_Id pass = Pass_Id(passes.size());
+
+        Pass new_pass;
+
+        new_pass.name    = name;
+        new_pass.execute = std::move(execute);
+
+        passes.push_back(std::move(new_pass));
+
+        Builder builder(*this, pass);
+
+        setup(builder);
+
+        compiled = false;
+
+        return pass;
+    }
+
+    /**
+     * @brief Activa o desactiva una pasada.
+     */
+    void Frame_Graph::set_enabled(Pass_Id pass, bool enabled)
+    {
+        if (passes[pass].enabled != enabled)
+        {
+            passes[pass].enabled = enabled;
+            compiled = false;
+        }
+    }
+
+    /**
+     * @brief Descarta, ordena y asigna las texturas de las pasadas.
+     *
+     * Se informa por consola del resultado, que permite comprobar cuntas texturas se comparten.
+     */
+    void Frame_Graph::compile()
+    {
+        cull_passes();
+        sort_passes();
+        allocate_textures();
+
+        std::size_t used_textures = 0;
+
+        for (const Virtual_Texture & texture : textures)
+        {
+            if (texture.physical >= 0) used_textures++;
+        }
+
+        std::cout << "Frame graph: " << execution_order.size() << " de " << passes.size() << " pasadas, "
+                  << used_textures << " texturas transitorias en " << physical_textures.size() << " texturas de OpenGL" << std::endl;
+
+        compiled = true;
+    }
+
+    /**
+     * @brief Descarta las pasadas desactivadas y las que no contribuyen a ningn efecto visible.
+     *
+     * Cada pasada cuenta las texturas que escribe y cada textura las pasadas vivas que la leen. Una
+     * textura sin lectores resta uno a cada pasada que la escribe, y las pasadas sin efectos visibles
+     * cuya cuenta llega a cero se descartan. Eso a su vez puede dejar sin lectores las texturas que
+     * lean y descartar a quienes las escriben.
+     */
+    void Frame_Graph::cull_passes()
+    {
+        for (Virtual_Texture & texture : textures) texture.reference_count = 0;
+
+        for (Pass & pass : passes)
+        {
+            pass.culled          = !pass.enabled;
+            pass.reference_count = unsigned(pass.writes.size());
+
+            if (pass.culled) continue;
+
+            for (Resource resource : pass.reads) textures[resource].reference_count++;
+        }
+
+        std::vector<Pass_Id> unreferenced;
+
+        // Cuando nadie lee una textura, sus escritores pierden la referencia que les daba:
+
+        auto release_writers = [this, &unreferenced] (Resource resource)
+        {
+            for (Pass_Id writer : textures[resource].writers)
+            {
+                Pass & writer_pass = passes[writer];
+
+                if (writer_pass.culled || writer_pass.reference_count == 0) continue;
+
+                if (--writer_pass.reference_count == 0 && !writer_pass.side_effect)
+                {
+                    unreferenced.push_back(writer);
+                }
+            }
+        };
+
+        for (Pass_Id id = 0; id < passes.size(); ++id)
+        {
+            if (!passes[id].culled && !passes[id].side_effect && passes[id].writes.empty()) unreferenced.push_back(id);
+        }
+
+        for (Resource resource = 0; resource < textures.size(); ++resource)
+        {
+            if (textures[resource].reference_count == 0) release_writers(resource);
+        }
+
+        while (!unreferenced.empty())
+        {
+            Pass & pass = passes[unreferenced.back()];
+
+            unreferenced.pop_back();
+
+            pass.culled = true;
+
+            for (Resource resource : pass.reads)
+            {
+                if (--textures[resource].reference_count == 0) release_writers(resource);
+            }
+        }
+
+        assert(all_live_passes_referenced());
+    }
+
+    /**
+     * @brief Comprueba el resultado del descarte: toda pasada viva tiene efectos visibles o escribe
+     * alguna textura que lee otra pasada viva.
+     */
+    bool Frame_Graph::all_live_passes_referenced() const
+    {
+        for (Pass_Id id = 0; id < passes.size(); ++id)
+        {
+            const Pass & pass = passes[id];
+
+            if (pass.culled || pass.side_effect) continue;
+
+            const bool read = std::any_of
+            (
+                pass.writes.begin(), pass.writes.end(), [this] (Resource resource)
+                {
+                    return std::any_of
+                    (
+                        passes.begin(), passes.end(), [resource] (const Pass & reader)
+                        {
+                            return !reader.culled && std::find(reader.reads.begin(), reader.reads.end(), resource) != reader.reads.end();
+                        }
+                    );
+                }
+            );
+
+            if (!read) return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Ordena topolgicamente las pasadas vivas.
+     *
+     * Quien lee una textura va despus de quienes la escribieron antes que l (o de todos sus
+     * escritores si se aadi antes que ellos), y los escritores de una misma textura mantienen el
+     * orden en que se aadieron. Entre las pasadas listas se elige siempre la aadida antes.
+     */
+    void Frame_Graph::sort_passes()
+    {
+        const std::size_t pass_count = passes.size();
+
+        std::vector<std::vector<Pass_Id>> successors(pass_count);
+        std::vector<unsigned>             predecessor_count(pass_count, 0);
+
+        auto add_edge = [&] (Pass_Id from, Pass_Id to)
+        {
+            if (from == to || passes[from].culled) return;
+
+            successors[from].push_back(to);
+            predecessor_count[to]++;
+        };
+
+        for (Pass_Id id = 0; id < pass_count; ++id)
+        {
+            const Pass & pass = passes[id];
+
+            if (pass.culled) continue;
+
+            for (Resource resource : pass.reads)
+            {
+                const std::vector<Pass_Id> & writers = textures[resource].writers;
+
+                const bool written_before = std::any_of(writers.begin(), writers.end(), [id] (Pass_Id writer) { return writer < id; });
+
+                for (Pass_Id writer : writers)
+                {
+                    if (!written_before || writer < id) add_edge(writer, id);
+                }
+            }
+
+            for (Resource resource : pass.writes)
+            {
+                for (Pass_Id writer : textures[resource].writers)
+                {
+                    if (writer < id) add_edge(writer, id);
+                }
+            }
+        }
+
+        execution_order.clear();
+
+        std::vector<bool> scheduled(pass_count, false);
+
+        for (;;)
+        {
+            Pass_Id next = Pass_Id(pass_count);
+
+            for (Pass_Id id = 0; id < pass_count; ++id)
+            {
+                if (!passes[id].culled && !scheduled[id] && predecessor_count[id] == 0) { next = id; break; }
+            }
+
+            if (next == pass_count) break;
+
+            scheduled[next] = true;
+            execution_order.push_back(next);
+
+            for (Pass_Id successor : successors[next]) predecessor_count[successor]--;
+        }
+
+        // Un ciclo deja pasadas sin programar; se aaden en el orden en que se declararon:
+
+        for (Pass_Id id = 0; id < pass_count; ++id)
+        {
+            if (!passes[id].culled && !scheduled[id])
+            {
+                std::cerr << "Error: dependencia circular en el frame graph (pasada " << passes[id].name << ")" << std::endl;
+
+                execution_order.push_back(id);
+            }
+        }
+    }
+
+    /**
+     * @brief Asigna texturas de OpenGL a las texturas transitorias de las pasadas vivas.
+     *
+     * Los recursos se recorren por orden de primer uso. Cada uno reutiliza una textura existente con
+     * su misma descripcin que haya quedado libre antes de ese primer uso; si no hay ninguna se crea.
+     * Las texturas existentes que no se asignan a ningn recurso se liberan.
+     */
+    void Frame_Graph::allocate_textures()
+    {
+        release_framebuffers();
+
+        for (Virtual_Texture & texture : textures)
+        {
+            texture.first_use = texture.last_use = texture.physical = -1;
+        }
+
+        for (int position = 0; position < int(execution_order.size()); ++position)
+        {
+            const Pass & pass = passes[execution_order[position]];
+
+            for (const std::vector<Resource> * accesses : { &pass.reads, &pass.writes })
+            {
+                for (Resource resource : *accesses)
+                {
+                    Virtual_Texture & texture = textures[resource];
+
+                    if (texture.first_use < 0) texture.first_use = position;
+
+                    texture.last_use = position;
+                }
+            }
+        }
+
+        std::vector<Resource> allocation_order;
+
+        for (Resource resource = 0; resource < textures.size(); ++resource)
+        {
+            if (textures[resource].first_use >= 0) allocation_order.push_back(resource);
+        }
+
+        std::sort
+        (
+            allocation_order.begin(), allocation_order.end(),
+            [this] (Resource a, Resource b) { return textures[a].first_use < textures[b].first_use; }
+        );
+
+        for (Physical_Texture & physical : physical_textures) physical.busy_until = -2;       // -2: sin asignar
+
+        for (Resource resource : allocation_order)
+        {
+            Virtual_Texture & texture = textures[resource];
+
+            for (int index = 0; index < int(physical_textures.size()); ++index)
+            {
+                Physical_Texture & physical = physical_textures[index];
+
+                if (physical.description == texture.description && physical.busy_until < texture.first_use)
+                {
+                    texture.physical    = index;
+                    physical.busy_until = texture.last_use;
+                    break;
+                }
+            }
+
+            if (texture.physical >= 0) continue;
+
+            // No hay ninguna libre, as que se crea una nueva:
+
+            const Texture_Description & description = texture.description;
+            const bool                  depth       = is_depth_format(description.internal_format);
+            const bool                  stencil     = description.internal_format == GL_DEPTH24_STENCIL8
+                                                   || description.internal_format == GL_DEPTH32F_STENCIL8;
+
+            GLuint texture_id;
+
+            glGenTextures(1, &texture_id);
+
+            OpenGL_State::instance().bind_texture(0, GL_TEXTURE_2D, texture_id);
+
+            glTexImage2D
+            (
+                GL_TEXTURE_2D, 0, GLint(description.internal_format), description.width, description.height, 0,
+                stencil ? GL_DEPTH_STENCIL     : depth ? GL_DEPTH_COMPONENT : GL_RGBA,
+                stencil ? GL_UNSIGNED_INT_24_8 : depth ? GL_FLOAT           : GL_UNSIGNED_BYTE,
+                nullptr
+            );
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+
+            texture.physical = int(physical_textures.size());
+
+            physical_textures.push_back({ description, texture_id, texture.last_use });
+        }
+
+        // Se liberan las texturas que ya no usa ninguna pasada y se renumeran las que quedan:
+
+        std::vector<int> new_index(physical_textures.size(), -1);
+        std::size_t      kept = 0;
+
+        for (std::size_t index = 0; index < physical_textures.size(); ++index)
+        {
+            if (physical_textures[index].busy_until == -2)
+            {
+                glDeleteTextures(1, &physical_textures[index].texture_id);
+                continue;
+            }
+
+            new_index[index] = int(kept);
+            physical_textures[kept++] = physical_textures[index];
+        }
+
+        physical_textures.resize(kept);
+
+        for (Virtual_Texture & texture : textures)
+        {
+            if (texture.physical >= 0) texture.physical = new_index[texture.physical];
+        }
+    }
+
+    /**
+     * @brief Ejecuta las pasadas vivas en orden.
+     */
+    void Frame_Graph::execute()
+    {
+        if (!compiled) compile();
+
+        for (Pass_Id id : execution_order)
+        {
+            const Pass & pass = passes[id];
+
+            attachments.clear();
+
+            for (Resource resource : pass.writes)
+            {
+                const int physical = textures[resource].physical;
+
+                if (std::find(attachments.begin(), attachments.end(), physical) == attachments.end())
+                {
+                    attachments.push_back(physical);
+                }
+            }
+
+            if (attachments.empty())
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            }
+            else
+            {
+                const Texture_Description & description = physical_textures[attachments.front()].description;
+
+                glBindFramebuffer(GL_FRAMEBUFFER, find_framebuffer(attachments));
+                glViewport(0, 0, description.width, description.height);
+            }
+
+            pass.execute(Context(*this));
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    /**
+     * @brief Libera los framebuffers, que se vuelven a crear cuando se necesitan.
+     */
+    void Frame_Graph::release_framebuffers()
+    {
+        for (const Framebuffer & framebuffer : framebuffers)
+        {
+            glDeleteFramebuffers(1, &framebuffer.framebuffer_id);
+        }
+
+        framebuffers.clear();
+    }
+
+    /**
+     * @brief Devuelve un framebuffer con las texturas indicadas adjuntas, crendolo la primera vez.
+     *
+     * Las texturas de color se adjuntan en orden a GL_COLOR_ATTACHMENT0, 1... y la de profundidad
+     * (si hay) a GL_DEPTH_ATTACHMENT o GL_DEPTH_STENCIL_ATTACHMENT.
+     */
+    GLuint Frame_Graph::find_framebuffer(const std::vector<int> & attachments)
+    {
+        for (const Framebuffer & framebuffer : framebuffers)
+        {
+            if (framebuffer.attachments == attachments) return framebuffer.framebuffer_id;
+        }
+
+        // Se puede llegar aqu desde una pasada, as que se conservan los framebuffers vinculados:
+
+        GLint draw_framebuffer_id, read_framebuffer_id;
+
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_framebuffer_id);
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer_id);
+
+        GLuint framebuffer_id;
+
+        glGenFramebuffers(1, &framebuffer_id);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+
+        GLenum draw_buffers[8];
+        GLsizei color_count = 0;
+
+        for (int physical : attachments)
+        {
+            const Physical_Texture & texture = physical_textures[physical];
+            const GLenum             format  = texture.description.internal_format;
+
+            if (is_depth_format(format))
+            {
+                const GLenum attachment = format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8
+                                        ? GL_DEPTH_STENCIL_ATTACHMENT
+                                        : GL_DEPTH_ATTACHMENT;
+
+                glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture.texture_id, 0);
+            }
+            else
+            {
+                assert(color_count < 8);
+
+                draw_buffers[color_count] = GL_COLOR_ATTACHMENT0 + color_count;
+
+                glFramebufferTexture2D(GL_FRAMEBUFFER, draw_buffers[color_count], GL_TEXTURE_2D, texture.texture_id, 0);
+
+                color_count++;
+            }
+        }
+
+        if (color_count > 0)
+        {
+            glDrawBuffers(color_count, draw_buffers);
+            glReadBuffer (GL_COLOR_ATTACHMENT0);
+        }
+        else
+        {
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "Error: framebuffer incompleto en el frame graph" << std::endl;
+        }
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GLuint(draw_framebuffer_id));
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, GLuint(read_framebuffer_id));
+
+        framebuffers.push_back({ attachments, framebuffer_id });
+
+        return framebuffer_id;
+    }
+
+    /**
+     * @brief Indica si un formato interno es de profundidad (con o sin stencil).
+     */
+    bool Frame_Graph::is_depth_format(GLenum internal_format)
+    {
+        switch (internal_format)
+        {
+            case GL_DEPTH_COMPONENT:
+            case GL_DEPTH_COMPONENT16:
+            case GL_DEPTH_COMPONENT24:
+            case GL_DEPTH_COMPONENT32:
+            case GL_DEPTH_COMPONENT32F:
+            case GL_DEPTH24_STENCIL8:
+            case GL_DEPTH32F_STENCIL8:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+}
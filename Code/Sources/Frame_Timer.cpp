@@ -0,0 +1,80 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Frame_Timer.hpp"
+#include <SDL.h>         // SDL_GetPerformanceCounter
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Frame_Timer.
+     */
+    Frame_Timer::Frame_Timer()
+        : query_pending{}, current_query(0), frame_start(0),
+          cpu_milliseconds(0), gpu_milliseconds(0), cpu_samples(0), gpu_samples(0)
+    {
+        glGenQueries(QUERY_COUNT, query_ids);
+    }
+
+    /**
+     * @brief Destructor de la clase Frame_Timer.
+     */
+    Frame_Timer::~Frame_Timer()
+    {
+        glDeleteQueries(QUERY_COUNT, query_ids);
+    }
+
+    /**
+     * @brief Empieza a medir el dibujo del frame.
+     *
+     * Antes de reutilizar la consulta ms antigua se recoge su resultado, que ya debera estar listo.
+     */
+    void Frame_Timer::begin_frame()
+    {
+        if (query_pending[current_query])
+        {
+            GLuint64 nanoseconds = 0;
+
+            glGetQueryObjectui64v(query_ids[current_query], GL_QUERY_RESULT, &nanoseconds);
+
+            gpu_milliseconds += double(nanoseconds) / 1000000.0;
+            gpu_samples++;
+
+            query_pending[current_query] = false;
+        }
+
+        glBeginQuery(GL_TIME_ELAPSED, query_ids[current_query]);
+
+        frame_start = SDL_GetPerformanceCounter();
+    }
+
+    /**
+     * @brief Termina de medir el dibujo del frame.
+     */
+    void Frame_Timer::end_frame()
+    {
+        const std::uint64_t frame_end = SDL_GetPerformanceCounter();
+
+        cpu_milliseconds += double(frame_end - frame_start) * 1000.0 / double(SDL_GetPerformanceFrequency());
+        cpu_samples++;
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        query_pending[current_query] = true;
+        current_query = (current_query + 1) % QUERY_COUNT;
+    }
+
+    /**
+     * @brief Devuelve los tiempos medios en milisegundos desde la ltima llamada y los reinicia.
+     */
+    void Frame_Timer::take_averages(double & cpu, double & gpu)
+    {
+        cpu = cpu_samples ? cpu_milliseconds / cpu_samples : 0.0;
+        gpu = gpu_samples ? gpu_milliseconds / gpu_samples : 0.0;
+
+        cpu_milliseconds = gpu_milliseconds = 0;
+        cpu_samples      = gpu_samples      = 0;
+    }
+
+}
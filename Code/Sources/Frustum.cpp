@@ -0,0 +1,154 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Frustum.hpp"
+#include <cassert>       // assert
+#include <xmmintrin.h>   // Intrnsecos de SSE
+
+namespace udit
+{
+
+    /**
+     * @brief Crea un volumen que lo contiene todo.
+     *
+     * Los planos tienen normal nula y distancia positiva, por lo que cualquier punto queda dentro.
+     */
+    Frustum::Frustum()
+    {
+        for (glm::vec4 & plane : planes) plane = glm::vec4(0.f, 0.f, 0.f, 1.f);
+    }
+
+    /**
+     * @brief Extrae los planos de la matriz de vista y proyeccin.
+     *
+     * Cada plano es la suma o la diferencia de la cuarta fila de la matriz con una de las otras
+     * tres (glm guarda las matrices por columnas, de ah que las filas se lean elemento a elemento).
+     *
+     * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+     */
+    void Frustum::extract(const glm::mat4 & view_projection_matrix)
+    {
+        const glm::mat4 & m = view_projection_matrix;
+
+        const glm::vec4 row_0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        const glm::vec4 row_1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        const glm::vec4 row_2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        const glm::vec4 row_3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        planes[0] = row_3 + row_0;          // Izquierdo
+        planes[1] = row_3 - row_0;          // Derecho
+        planes[2] = row_3 + row_1;          // Inferior
+        planes[3] = row_3 - row_1;          // Superior
+        planes[4] = row_3 + row_2;          // Cercano
+        planes[5] = row_3 - row_2;          // Lejano
+
+        for (glm::vec4 & plane : planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+    }
+
+    /**
+     * @brief Indica si una esfera est total o parcialmente dentro del volumen.
+     */
+    bool Frustum::intersects_sphere(const glm::vec3 & center, float radius) const
+    {
+        for (const glm::vec4 & plane : planes)
+        {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Clasifica una caja alineada con los ejes respecto al volumen.
+     *
+     * Para cada plano basta con mirar dos esquinas: la ms avanzada en la direccin de la normal
+     * (si queda detrs, toda la caja est fuera) y la ms retrasada (si queda detrs, el plano
+     * corta la caja).
+     */
+    Frustum::Containment Frustum::classify_box(const glm::vec3 & min, const glm::vec3 & max) const
+    {
+        Containment containment = INSIDE;
+
+        for (const glm::vec4 & plane : planes)
+        {
+            const glm::vec3 normal(plane);
+
+            const glm::vec3 farthest = glm::mix(min, max, glm::greaterThanEqual(normal, glm::vec3(0.f)));
+            const glm::vec3 nearest  = glm::mix(max, min, glm::greaterThanEqual(normal, glm::vec3(0.f)));
+
+            if (glm::dot(normal, farthest) + plane.w < 0.f) return OUTSIDE;
+            if (glm::dot(normal, nearest ) + plane.w < 0.f) containment = INTERSECTING;
+        }
+
+        return containment;
+    }
+
+    /**
+     * @brief Comprueba un conjunto de esferas guardadas como estructura de arrays.
+     *
+     * Una esfera queda fuera si su centro est a ms de un radio por detrs de algn plano. Para
+     * cada grupo de cuatro esferas se acumula con AND la comparacin de los seis planos y la
+     * mscara resultante da la visibilidad de las cuatro.
+     */
+    void Frustum::cull_spheres
+    (
+        const float  * x,
+        const float  * y,
+        const float  * z,
+        const float  * radius,
+        std::size_t    count,
+        std::uint8_t * visible
+    ) const
+    {
+        assert(count % SIMD_WIDTH == 0);
+
+        // Los coeficientes de cada plano se replican en los cuatro carriles una sola vez:
+
+        __m128 plane_x[PLANE_COUNT];
+        __m128 plane_y[PLANE_COUNT];
+        __m128 plane_z[PLANE_COUNT];
+        __m128 plane_w[PLANE_COUNT];
+
+        for (std::size_t p = 0; p < PLANE_COUNT; ++p)
+        {
+            plane_x[p] = _mm_set1_ps(planes[p].x);
+            plane_y[p] = _mm_set1_ps(planes[p].y);
+            plane_z[p] = _mm_set1_ps(planes[p].z);
+            plane_w[p] = _mm_set1_ps(planes[p].w);
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+
+        for (std::size_t i = 0; i < count; i += SIMD_WIDTH)
+        {
+            const __m128 center_x        = _mm_loadu_ps(x + i);
+            const __m128 center_y        = _mm_loadu_ps(y + i);
+            const __m128 center_z        = _mm_loadu_ps(z + i);
+            const __m128 negative_radius = _mm_sub_ps(zero, _mm_loadu_ps(radius + i));
+
+            __m128 inside = _mm_cmpeq_ps(zero, zero);          // Todos los bits a 1
+
+            for (std::size_t p = 0; p < PLANE_COUNT; ++p)
+            {
+                __m128 distance = _mm_mul_ps(center_x, plane_x[p]);
+
+                distance = _mm_add_ps(distance, _mm_mul_ps(center_y, plane_y[p]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(center_z, plane_z[p]));
+                distance = _mm_add_ps(distance, plane_w[p]);
+
+                inside   = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+            }
+
+            const int mask = _mm_movemask_ps(inside);
+
+            visible[i    ] = std::uint8_t( mask       & 1);
+            visible[i + 1] = std::uint8_t((mask >> 1) & 1);
+            visible[i + 2] = std::uint8_t((mask >> 2) & 1);
+            visible[i + 3] = std::uint8_t((mask >> 3) & 1);
+        }
+    }
+
+}
@@ -0,0 +1,503 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/GL_Capture.hpp"
+#include "../Headers/GL_Trace.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <cstddef>       // offsetof
+#include <cstdint>       // uint64_t, uintptr_t
+#include <cstring>       // memcpy, strlen
+#include <fstream>       // ofstream
+#include <iostream>      // cout, cerr
+#include <string>        // string
+#include <unordered_map> // unordered_map
+#include <vector>        // vector
+
+namespace udit
+{
+
+    /**
+     * @brief Funciones de GLAD sustituidas durante la grabacin.
+     */
+    struct Original_Functions
+    {
+        #define UDIT_GL_CAPTURE_ORIGINAL(NAME, ...) decltype(glad_gl##NAME) NAME;
+
+        UDIT_GL_TRACE_FUNCTIONS        (UDIT_GL_CAPTURE_ORIGINAL)
+        UDIT_GL_TRACE_SPECIAL_FUNCTIONS(UDIT_GL_CAPTURE_ORIGINAL)
+
+        #undef  UDIT_GL_CAPTURE_ORIGINAL
+
+        OpenGL_Extensions::Multi_Draw_Elements_Indirect_Function MultiDrawElementsIndirect;
+    };
+
+    /**
+     * @brief Zona de un buffer mapeada con glMapBufferRange pendiente de desmapear.
+     */
+    struct Mapped_Range
+    {
+        const char * pointer;
+        GLsizeiptr   length;
+        bool         written;                  ///< Se mape con GL_MAP_WRITE_BIT
+    };
+
+    static Original_Functions original;
+    static std::ofstream      trace_file;
+    static std::vector<char>  trace_buffer;    ///< Registros del frame actual, se escriben al terminarlo
+    static unsigned           frames_left    = 0;
+    static unsigned           frames_written = 0;
+    static bool               active         = false;
+
+    static std::unordered_map< GLenum, Mapped_Range > mapped_ranges;       ///< Por tipo de buffer
+
+    // Escritura de los registros:
+
+    template< typename TYPE >
+    static void write(const TYPE & value)
+    {
+        const char * bytes = reinterpret_cast<const char *>(&value);
+
+        trace_buffer.insert(trace_buffer.end(), bytes, bytes + sizeof(TYPE));
+    }
+
+    template< typename ...TYPES >
+    static void write_all(const TYPES & ...values)
+    {
+        (write(values), ...);
+    }
+
+    static void write_payload(const void * data, std::size_t size)
+    {
+        write(std::uint64_t(size));
+
+        if (size > 0)
+        {
+            const char * bytes = static_cast<const char *>(data);
+
+            trace_buffer.insert(trace_buffer.end(), bytes, bytes + size);
+        }
+    }
+
+    static std::uint64_t sync_id(GLsync sync)
+    {
+        return std::uint64_t(reinterpret_cast<std::uintptr_t>(sync));
+    }
+
+    static void flush()
+    {
+        trace_file.write(trace_buffer.data(), std::streamsize(trace_buffer.size()));
+
+        trace_buffer.clear();
+    }
+
+    /**
+     * @brief Bytes de una imagen que lee glTexImage2D o glTexImage3D de memoria.
+     *
+     * Solo se tienen en cuenta los formatos y tipos sin empaquetar que usa la aplicacin y la
+     * alineacin de las filas (GL_UNPACK_ALIGNMENT).
+     */
+    static std::size_t image_size(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type)
+    {
+        std::size_t component_count;
+        std::size_t component_size;
+
+        switch (format)
+        {
+            case GL_RED:
+            case GL_DEPTH_COMPONENT: component_count = 1; break;
+            case GL_RG:              component_count = 2; break;
+            case GL_RGB:
+            case GL_BGR:             component_count = 3; break;
+            default:                 component_count = 4; break;
+        }
+
+        switch (type)
+        {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE:   component_size = 1; break;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:      component_size = 2; break;
+            default:                 component_size = 4; break;
+        }
+
+        GLint alignment = 4;
+
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+
+        const std::size_t row_size = (std::size_t(width) * component_count * component_size + alignment - 1) / alignment * alignment;
+
+        return row_size * std::size_t(height) * std::size_t(depth);
+    }
+
+    // Funciones que solo reciben valores. Llaman a la funcin original y graban sus argumentos:
+
+    #define UDIT_GL_CAPTURE_RECORD(NAME, PARAMETERS, ARGUMENTS, REPLAY_TYPES) \
+        static void APIENTRY record_##NAME PARAMETERS                       \
+        {                                                                   \
+            original.NAME ARGUMENTS;                                        \
+            write(GL_Trace_Opcode::NAME);                                   \
+            write_all ARGUMENTS;                                            \
+        }
+
+    UDIT_GL_TRACE_FUNCTIONS(UDIT_GL_CAPTURE_RECORD)
+
+    #undef  UDIT_GL_CAPTURE_RECORD
+
+    // Creacin y eliminacin de objetos. Se graban los nombres que devuelve el driver:
+
+    #define UDIT_GL_CAPTURE_RECORD_NAMES(GEN, DELETE)                       \
+        static void APIENTRY record_##GEN (GLsizei n, GLuint * names)       \
+        {                                                                   \
+            original.GEN (n, names);                                        \
+            write(GL_Trace_Opcode::GEN);                                    \
+            write_payload(names, n * sizeof(GLuint));                       \
+        }                                                                   \
+        static void APIENTRY record_##DELETE (GLsizei n, const GLuint * names) \
+        {                                                                   \
+            write(GL_Trace_Opcode::DELETE);                                 \
+            write_payload(names, n * sizeof(GLuint));                       \
+            original.DELETE (n, names);                                     \
+        }
+
+    UDIT_GL_CAPTURE_RECORD_NAMES(GenBuffers,      DeleteBuffers     )
+    UDIT_GL_CAPTURE_RECORD_NAMES(GenTextures,     DeleteTextures    )
+    UDIT_GL_CAPTURE_RECORD_NAMES(GenVertexArrays, DeleteVertexArrays)
+    UDIT_GL_CAPTURE_RECORD_NAMES(GenFramebuffers, DeleteFramebuffers)
+    UDIT_GL_CAPTURE_RECORD_NAMES(GenQueries,      DeleteQueries     )
+
+    #undef  UDIT_GL_CAPTURE_RECORD_NAMES
+
+    static GLuint APIENTRY record_CreateShader(GLenum type)
+    {
+        const GLuint shader = original.CreateShader(type);
+
+        write    (GL_Trace_Opcode::CreateShader);
+        write_all(type, shader);
+
+        return shader;
+    }
+
+    static GLuint APIENTRY record_CreateProgram()
+    {
+        const GLuint program = original.CreateProgram();
+
+        write(GL_Trace_Opcode::CreateProgram);
+        write(program);
+
+        return program;
+    }
+
+    // Shaders y uniforms:
+
+    static void APIENTRY record_ShaderSource(GLuint shader, GLsizei count, const GLchar * const * strings, const GLint * lengths)
+    {
+        original.ShaderSource(shader, count, strings, lengths);
+
+        // Las cadenas se graban unidas en una sola:
+
+        std::string source;
+
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            if (lengths && lengths[i] >= 0) source.append(strings[i], std::size_t(lengths[i]));
+            else                            source.append(strings[i]);
+        }
+
+        write        (GL_Trace_Opcode::ShaderSource);
+        write        (shader);
+        write_payload(source.data(), source.size());
+    }
+
+    static GLint APIENTRY record_GetUniformLocation(GLuint program, const GLchar * name)
+    {
+        const GLint location = original.GetUniformLocation(program, name);
+
+        // Se graba la localizacin obtenida para poder traducir las que se usan despus:
+
+        write        (GL_Trace_Opcode::GetUniformLocation);
+        write        (program);
+        write_payload(name, std::strlen(name));
+        write        (location);
+
+        return location;
+    }
+
+    #define UDIT_GL_CAPTURE_RECORD_UNIFORM(NAME, SIZE)                      \
+        static void APIENTRY record_##NAME (GLint location, GLsizei count, const GLfloat * value) \
+        {                                                                   \
+            original.NAME (location, count, value);                         \
+            write(GL_Trace_Opcode::NAME);                                   \
+            write(location);                                                \
+            write_payload(value, count * SIZE * sizeof(GLfloat));           \
+        }
+
+    #define UDIT_GL_CAPTURE_RECORD_UNIFORM_MATRIX(NAME, SIZE)               \
+        static void APIENTRY record_##NAME (GLint location, GLsizei count, GLboolean transpose, const GLfloat * value) \
+        {                                                                   \
+            original.NAME (location, count, transpose, value);              \
+            write(GL_Trace_Opcode::NAME);                                   \
+            write_all(location, transpose);                                 \
+            write_payload(value, count * SIZE * sizeof(GLfloat));           \
+        }
+
+    UDIT_GL_CAPTURE_RECORD_UNIFORM       (Uniform2fv,        2)
+    UDIT_GL_CAPTURE_RECORD_UNIFORM       (Uniform3fv,        3)
+    UDIT_GL_CAPTURE_RECORD_UNIFORM       (Uniform4fv,        4)
+    UDIT_GL_CAPTURE_RECORD_UNIFORM_MATRIX(UniformMatrix3fv,  9)
+    UDIT_GL_CAPTURE_RECORD_UNIFORM_MATRIX(UniformMatrix4fv, 16)
+
+    #undef  UDIT_GL_CAPTURE_RECORD_UNIFORM
+    #undef  UDIT_GL_CAPTURE_RECORD_UNIFORM_MATRIX
+
+    // Datos de buffers y texturas:
+
+    static void APIENTRY record_BufferData(GLenum target, GLsizeiptr size, const void * data, GLenum usage)
+    {
+        original.BufferData(target, size, data, usage);
+
+        write        (GL_Trace_Opcode::BufferData);
+        write_all    (target, size, usage);
+        write_payload(data, data ? std::size_t(size) : 0);
+    }
+
+    static void APIENTRY record_BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void * data)
+    {
+        original.BufferSubData(target, offset, size, data);
+
+        write        (GL_Trace_Opcode::BufferSubData);
+        write_all    (target, offset);
+        write_payload(data, std::size_t(size));
+    }
+
+    static void * APIENTRY record_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        void * pointer = original.MapBufferRange(target, offset, length, access);
+
+        write    (GL_Trace_Opcode::MapBufferRange);
+        write_all(target, offset, length, access);
+
+        mapped_ranges[target] = { static_cast<const char *>(pointer), length, (access & GL_MAP_WRITE_BIT) != 0 };
+
+        return pointer;
+    }
+
+    static GLboolean APIENTRY record_UnmapBuffer(GLenum target)
+    {
+        // Lo escrito en la zona mapeada se graba antes de desmaparla, cuando an se puede leer:
+
+        const auto mapped_range = mapped_ranges.find(target);
+
+        write(GL_Trace_Opcode::UnmapBuffer);
+        write(target);
+
+        if (mapped_range != mapped_ranges.end() && mapped_range->second.written && mapped_range->second.pointer)
+        {
+            write_payload(mapped_range->second.pointer, std::size_t(mapped_range->second.length));
+        }
+        else
+            write_payload(nullptr, 0);
+
+        if (mapped_range != mapped_ranges.end()) mapped_ranges.erase(mapped_range);
+
+        return original.UnmapBuffer(target);
+    }
+
+    static void APIENTRY record_TexImage2D
+    (
+        GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border,
+        GLenum format, GLenum type, const void * pixels
+    )
+    {
+        original.TexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+
+        write        (GL_Trace_Opcode::TexImage2D);
+        write_all    (target, level, internal_format, width, height, border, format, type);
+        write_payload(pixels, pixels ? image_size(width, height, 1, format, type) : 0);
+    }
+
+    static void APIENTRY record_TexImage3D
+    (
+        GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLsizei depth,
+        GLint border, GLenum format, GLenum type, const void * pixels
+    )
+    {
+        original.TexImage3D(target, level, internal_format, width, height, depth, border, format, type, pixels);
+
+        write        (GL_Trace_Opcode::TexImage3D);
+        write_all    (target, level, internal_format, width, height, depth, border, format, type);
+        write_payload(pixels, pixels ? image_size(width, height, depth, format, type) : 0);
+    }
+
+    static void APIENTRY record_DrawBuffers(GLsizei n, const GLenum * buffers)
+    {
+        original.DrawBuffers(n, buffers);
+
+        write        (GL_Trace_Opcode::DrawBuffers);
+        write_payload(buffers, n * sizeof(GLenum));
+    }
+
+    // Sincronizacin. Los objetos se identifican por el valor del puntero que devolvi el driver:
+
+    static GLsync APIENTRY record_FenceSync(GLenum condition, GLbitfield flags)
+    {
+        const GLsync sync = original.FenceSync(condition, flags);
+
+        write    (GL_Trace_Opcode::FenceSync);
+        write_all(condition, flags, sync_id(sync));
+
+        return sync;
+    }
+
+    static GLenum APIENTRY record_ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+    {
+        write    (GL_Trace_Opcode::ClientWaitSync);
+        write_all(sync_id(sync), flags, timeout);
+
+        return original.ClientWaitSync(sync, flags, timeout);
+    }
+
+    static void APIENTRY record_DeleteSync(GLsync sync)
+    {
+        write    (GL_Trace_Opcode::DeleteSync);
+        write    (sync_id(sync));
+
+        original.DeleteSync(sync);
+    }
+
+    // Los comandos indirectos siempre se leen del GL_DRAW_INDIRECT_BUFFER vinculado, por lo que
+    // indirect es un desplazamiento y se graba como tal:
+
+    static void APIENTRY record_MultiDrawElementsIndirect(GLenum mode, GLenum type, const void * indirect, GLsizei draw_count, GLsizei stride)
+    {
+        original.MultiDrawElementsIndirect(mode, type, indirect, draw_count, stride);
+
+        write    (GL_Trace_Opcode::MultiDrawElementsIndirect);
+        write_all(mode, type, indirect, draw_count, stride);
+    }
+
+    /**
+     * @brief Empieza a grabar.
+     *
+     * @param path Ruta del archivo de la traza.
+     * @param frame_count Frames que se graban.
+     * @param width Ancho de la ventana.
+     * @param height Alto de la ventana.
+     * @return true si se ha podido crear el archivo.
+     */
+    bool GL_Capture::start(const std::string & path, unsigned frame_count, unsigned width, unsigned height)
+    {
+        if (active || frame_count == 0) return false;
+
+        trace_file.open(path, std::ios::binary | std::ios::trunc);
+
+        if (!trace_file)
+        {
+            std::cerr << "Error al crear la traza " << path << std::endl;
+            return false;
+        }
+
+        // La cabecera se reescribe al terminar con los frames que se hayan grabado realmente:
+
+        GL_Trace::Header header{};
+
+        std::memcpy(header.magic, GL_Trace::MAGIC, sizeof(header.magic));
+
+        header.version      = GL_Trace::VERSION;
+        header.pointer_size = sizeof(void *);
+        header.width        = width;
+        header.height       = height;
+        header.frame_count  = frame_count;
+
+        trace_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        // Se sustituyen las funciones de OpenGL por las que graban:
+
+        #define UDIT_GL_CAPTURE_HOOK(NAME, ...) original.NAME = glad_gl##NAME; glad_gl##NAME = record_##NAME;
+
+        UDIT_GL_TRACE_FUNCTIONS        (UDIT_GL_CAPTURE_HOOK)
+        UDIT_GL_TRACE_SPECIAL_FUNCTIONS(UDIT_GL_CAPTURE_HOOK)
+
+        #undef  UDIT_GL_CAPTURE_HOOK
+
+        original.MultiDrawElementsIndirect = OpenGL_Extensions::multi_draw_elements_indirect;
+
+        if (original.MultiDrawElementsIndirect)
+        {
+            OpenGL_Extensions::multi_draw_elements_indirect = record_MultiDrawElementsIndirect;
+        }
+
+        OpenGL_Extensions::disable_buffer_storage();
+
+        frames_left    = frame_count;
+        frames_written = 0;
+        active         = true;
+
+        std::cout << "Grabando " << frame_count << " frames en " << path << std::endl;
+
+        return true;
+    }
+
+    /**
+     * @brief Marca el final de un frame y termina la grabacin si ya se han grabado todos.
+     */
+    void GL_Capture::end_frame()
+    {
+        if (!active) return;
+
+        write(GL_Trace_Opcode::END_FRAME);
+        flush();
+
+        ++frames_written;
+
+        if (--frames_left == 0) stop();
+    }
+
+    /**
+     * @brief Termina la grabacin y restaura las funciones originales.
+     */
+    void GL_Capture::stop()
+    {
+        if (!active) return;
+
+        #define UDIT_GL_CAPTURE_UNHOOK(NAME, ...) glad_gl##NAME = original.NAME;
+
+        UDIT_GL_TRACE_FUNCTIONS        (UDIT_GL_CAPTURE_UNHOOK)
+        UDIT_GL_TRACE_SPECIAL_FUNCTIONS(UDIT_GL_CAPTURE_UNHOOK)
+
+        #undef  UDIT_GL_CAPTURE_UNHOOK
+
+        if (original.MultiDrawElementsIndirect)
+        {
+            OpenGL_Extensions::multi_draw_elements_indirect = original.MultiDrawElementsIndirect;
+        }
+
+        // Las llamadas del frame que no lleg a terminar se descartan:
+
+        trace_buffer.clear();
+
+        write(GL_Trace_Opcode::END_TRACE);
+        flush();
+
+        const std::uint32_t frame_count = frames_written;
+
+        trace_file.seekp(offsetof(GL_Trace::Header, frame_count));
+        trace_file.write(reinterpret_cast<const char *>(&frame_count), sizeof(frame_count));
+        trace_file.close();
+
+        mapped_ranges.clear();
+
+        active = false;
+
+        std::cout << "Traza terminada: " << frames_written << " frames grabados" << std::endl;
+    }
+
+    /**
+     * @brief Indica si se est grabando.
+     */
+    bool GL_Capture::is_active()
+    {
+        return active;
+    }
+
+}
@@ -0,0 +1,256 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/GPU_Culling.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <cstring>                          // memcpy
+
+namespace udit
+{
+
+    static_assert(sizeof(GPU_Culling::Instance_Bounds) % 16 == 0, "Instance_Bounds debe ocupar un multiplo de 16 bytes");
+
+    // Los comandos se leen como un array de uint (5 por comando, en el orden de Draw_Elements_Indirect_Command):
+    // el nmero de instancias es el segundo y baseInstance el quinto.
+
+    const std::string GPU_Culling::cull_shader_code =
+
+        "#version 430\n"
+        ""
+        "layout (local_size_x = 64) in;"
+        ""
+        "struct Instance"
+        "{"
+        "   mat4 model_matrix;"
+        "   vec4 material;"
+        "};"
+        ""
+        "struct Instance_Bounds"
+        "{"
+        "   vec4  sphere;"
+        "   uvec4 info;"
+        "};"
+        ""
+        "layout (std430, binding = 0) readonly  buffer Input_Instances  { Instance        input_instances [];  };"
+        "layout (std430, binding = 1) readonly  buffer Bounds           { Instance_Bounds bounds          [];  };"
+        "layout (std430, binding = 2)           buffer Commands         { uint            commands        [];  };"
+        "layout (std430, binding = 3) writeonly buffer Output_Instances { Instance        output_instances[];  };"
+        ""
+        "layout (binding = 0) uniform sampler2D hi_z;"
+        ""
+        "uniform mat4 view_projection_matrix;"
+        "uniform mat4 hi_z_matrix;"
+        "uniform int  hi_z_level_count;"
+        "uniform int  instance_count;"
+        ""
+        "bool is_outside_frustum(vec3 center, float radius)"
+        "{"
+        "   mat4 rows = transpose(view_projection_matrix);"
+        ""
+        "   vec4 planes[6] = vec4[6]"
+        "   ("
+        "       rows[3] + rows[0], rows[3] - rows[0],"
+        "       rows[3] + rows[1], rows[3] - rows[1],"
+        "       rows[3] + rows[2], rows[3] - rows[2]"
+        "   );"
+        ""
+        "   for (int i = 0; i < 6; ++i)"
+        "   {"
+        "       if (dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz)) return true;"
+        "   }"
+        ""
+        "   return false;"
+        "}"
+        ""
+        // La caja de la esfera se proyecta con la matriz del frame anterior. Se elige el nivel en el
+        // que el rectngulo que ocupa cubre como mucho dos texels por eje y se toma lo ms lejano de
+        // los texels que toca. Si la caja cruza el plano cercano no se puede proyectar y se da por visible:
+        "bool is_occluded(vec3 center, float radius)"
+        "{"
+        "   if (hi_z_level_count == 0) return false;"
+        ""
+        "   vec2  rect_min = vec2( 1.0);"
+        "   vec2  rect_max = vec2(-1.0);"
+        "   float nearest  = 1.0;"
+        ""
+        "   for (int corner = 0; corner < 8; ++corner)"
+        "   {"
+        "       vec3 offset = vec3"
+        "       ("
+        "           (corner & 1) != 0 ? radius : -radius,"
+        "           (corner & 2) != 0 ? radius : -radius,"
+        "           (corner & 4) != 0 ? radius : -radius"
+        "       );"
+        ""
+        "       vec4 clip = hi_z_matrix * vec4(center + offset, 1.0);"
+        ""
+        "       if (clip.w <= 1e-5 || clip.z < -clip.w) return false;"
+        ""
+        "       vec3 ndc = clip.xyz / clip.w;"
+        ""
+        "       rect_min = min(rect_min, ndc.xy);"
+        "       rect_max = max(rect_max, ndc.xy);"
+        "       nearest  = min(nearest,  ndc.z );"
+        "   }"
+        ""
+        "   vec2 uv_min = clamp(rect_min * 0.5 + 0.5, 0.0, 1.0);"
+        "   vec2 uv_max = clamp(rect_max * 0.5 + 0.5, 0.0, 1.0);"
+        "   vec2 size   = (uv_max - uv_min) * vec2(textureSize(hi_z, 0));"
+        ""
+        "   int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, hi_z_level_count - 1);"
+        ""
+        "   ivec2 level_size = textureSize(hi_z, level);"
+        "   ivec2 first      = clamp(ivec2(uv_min * vec2(level_size)), ivec2(0), level_size - 1);"
+        "   ivec2 last       = clamp(ivec2(uv_max * vec2(level_size)), ivec2(0), level_size - 1);"
+        ""
+        "   float farthest = 0.0;"
+        ""
+        "   for (int y = first.y; y <= last.y; ++y)"
+        "   for (int x = first.x; x <= last.x; ++x)"
+        "   {"
+        "       farthest = max(farthest, texelFetch(hi_z, ivec2(x, y), level).r);"
+        "   }"
+        ""
+        "   return nearest * 0.5 + 0.5 > farthest;"
+        "}"
+        ""
+        "void main()"
+        "{"
+        "   uint index = gl_GlobalInvocationID.x;"
+        ""
+        "   if (index >= uint(instance_count)) return;"
+        ""
+        "   Instance_Bounds instance_bounds = bounds[index];"
+        ""
+        "   if (instance_bounds.info.y == 0u)"
+        "   {"
+        "       output_instances[index] = input_instances[index];"
+        "       return;"
+        "   }"
+        ""
+        "   mat4  model_matrix = input_instances[index].model_matrix;"
+        "   vec3  center       = (model_matrix * vec4(instance_bounds.sphere.xyz, 1.0)).xyz;"
+        "   float scale        = sqrt(max(max(dot(model_matrix[0].xyz, model_matrix[0].xyz),"
+        "                                     dot(model_matrix[1].xyz, model_matrix[1].xyz)),"
+        "                                     dot(model_matrix[2].xyz, model_matrix[2].xyz)));"
+        "   float radius       = instance_bounds.sphere.w * scale;"
+        ""
+        "   if (is_outside_frustum(center, radius) || is_occluded(center, radius)) return;"
+        ""
+        "   uint command = instance_bounds.info.x * 5u;"
+        "   uint slot    = atomicAdd(commands[command + 1u], 1u);"
+        ""
+        "   output_instances[commands[command + 4u] + slot] = input_instances[index];"
+        "}";
+
+    /**
+     * @brief Constructor de la clase GPU_Culling.
+     *
+     * El buffer de Instance_Bounds se alinea a 256 bytes para poder vincular cada segmento como SSBO.
+     */
+    GPU_Culling::GPU_Culling()
+        : cull_program(cull_shader_code), bounds_buffer(GL_SHADER_STORAGE_BUFFER, 1024 * sizeof(Instance_Bounds), 256),
+          output_buffer_id(0), output_capacity(0), view_projection_matrix(1.f), tested_count(0)
+    {
+        view_projection_uniform  = cull_program.get_uniform< glm::mat4 >("view_projection_matrix");
+        hi_z_matrix_uniform      = cull_program.get_uniform< glm::mat4 >("hi_z_matrix");
+        hi_z_level_count_uniform = cull_program.get_uniform< GLint     >("hi_z_level_count");
+        instance_count_uniform   = cull_program.get_uniform< GLint     >("instance_count");
+
+        glGenBuffers(1, &output_buffer_id);
+    }
+
+    /**
+     * @brief Destructor de la clase GPU_Culling.
+     */
+    GPU_Culling::~GPU_Culling()
+    {
+        glDeleteBuffers(1, &output_buffer_id);
+    }
+
+    /**
+     * @brief Empieza un frame.
+     * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+     */
+    void GPU_Culling::begin_frame(const glm::mat4 & view_projection_matrix)
+    {
+        this->view_projection_matrix = view_projection_matrix;
+
+        tested_count = 0;
+    }
+
+    /**
+     * @brief Descarta las instancias del frame y escribe las que sobreviven en el buffer de salida.
+     *
+     * Si el buffer de salida se queda pequeo se recrea con el doble de lo necesario. Al terminar,
+     * una barrera hace visibles las escrituras del compute shader a la lectura de los comandos
+     * indirectos y de los atributos por instancia.
+     */
+    void GPU_Culling::dispatch
+    (
+        const Instance_Buffer & instances,
+        const std::vector<Instance_Bounds> & bounds,
+        GLuint commands_buffer_id,
+        std::size_t commands_offset,
+        std::size_t command_count
+    )
+    {
+        const std::size_t instance_count = bounds.size();
+
+        tested_count = instance_count;
+
+        if (instance_count == 0) return;
+
+        if (instance_count > output_capacity)
+        {
+            output_capacity = instance_count * 2;
+
+            glBindBuffer(GL_ARRAY_BUFFER, output_buffer_id);
+            glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(output_capacity * sizeof(Instance_Data)), nullptr, GL_DYNAMIC_COPY);
+        }
+
+        const std::size_t bounds_size = instance_count * sizeof(Instance_Bounds);
+
+        std::memcpy(bounds_buffer.begin_segment(bounds_size), bounds.data(), bounds_size);
+
+        bounds_buffer.end_segment();
+
+        // Buffers que lee y escribe el compute shader:
+
+        instances.bind_storage(INPUT_INSTANCES_BINDING, instance_count);
+
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, BOUNDS_BINDING,           bounds_buffer.get_id(), GLintptr(bounds_buffer.get_segment_offset()), GLsizeiptr(bounds_size));
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING,         commands_buffer_id,     GLintptr(commands_offset), GLsizeiptr(command_count * 5 * sizeof(GLuint)));
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, OUTPUT_INSTANCES_BINDING, output_buffer_id,       0, GLsizeiptr(instance_count * sizeof(Instance_Data)));
+
+        // Sin pirmide (el primer frame) solo se descarta contra el volumen de visin:
+
+        if (hi_z_pyramid.get_level_count() > 0)
+        {
+            OpenGL_State::instance().bind_texture(Hi_Z_Pyramid::TEXTURE_UNIT, GL_TEXTURE_2D, hi_z_pyramid.get_texture_id());
+        }
+
+        cull_program.set(view_projection_uniform,  view_projection_matrix);
+        cull_program.set(hi_z_matrix_uniform,      hi_z_pyramid.get_view_projection_matrix());
+        cull_program.set(hi_z_level_count_uniform, GLint(hi_z_pyramid.get_level_count()));
+        cull_program.set(instance_count_uniform,   GLint(instance_count));
+
+        cull_program.use();
+
+        OpenGL_Extensions::dispatch_compute(GLuint((instance_count + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE), 1, 1);
+
+        bounds_buffer.fence_segment();
+
+        OpenGL_Extensions::memory_barrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+
+    /**
+     * @brief Construye la pirmide Hi-Z con la profundidad del frame actual.
+     */
+    void GPU_Culling::build_hi_z(GLuint depth_texture_id, GLsizei width, GLsizei height)
+    {
+        hi_z_pyramid.build(depth_texture_id, width, height, view_projection_matrix);
+    }
+
+}
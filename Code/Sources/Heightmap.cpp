@@ -3,60 +3,43 @@
 
 #include "../Headers/Heightmap.hpp"   // Incluir el encabezado de la clase Heightmap
 #include <iostream>                    // Incluir la biblioteca para manejar la salida de errores
+#include <cstring>                     // Incluir memcpy
+#include <algorithm>                   // Incluir min y max
+#include "../Headers/OpenGL_State.hpp" // Incluir la cach del estado de OpenGL
 
 /**
  * @brief Constructor de la clase Heightmap.
  *
  * Este constructor carga el heightmap desde un archivo, genera la malla correspondiente
- * y crea los buffers de OpenGL para renderizar el terreno.
+ * y la sube a la arena de mallas para renderizar el terreno.
  *
+ * @param arena Arena de mallas en la que se guarda la geometra del terreno.
  * @param heightmap_path Ruta del archivo del heightmap.
  * @param width Ancho de la malla generada.
  * @param depth Profundidad de la malla generada.
  * @param max_height Altura mxima para escalar los valores de intensidad del heightmap.
  */
-Heightmap::Heightmap(const std::string& heightmap_path, float width, float depth, float max_height) {
+Heightmap::Heightmap(udit::Mesh_Arena& arena, const std::string& heightmap_path, float width, float depth, float max_height)
+    : arena(arena) {
     // Cargar el heightmap y generar la malla
     load_heightmap(heightmap_path, max_height);
     generate_mesh(width, depth);
 
-    // Crear y configurar buffers de OpenGL
-    glGenVertexArrays(1, &vao_id);  // Crear el VAO (Vertex Array Object)
-    glGenBuffers(1, &vbo_id);       // Crear el VBO (Vertex Buffer Object)
-    glGenBuffers(1, &ebo_id);       // Crear el EBO (Element Buffer Object)
+    // Subir la malla a la arena. Los vrtices ya tienen el formato entrelazado de la arena
+    // (posicin, normal y UV), por lo que se copian tal cual:
+    std::vector<udit::Mesh_Arena::Vertex> mesh_vertices(vertices.size() / 8);
+    std::memcpy(mesh_vertices.data(), vertices.data(), mesh_vertices.size() * sizeof(udit::Mesh_Arena::Vertex));
 
-    glBindVertexArray(vao_id);  // Vincular el VAO para configurar sus buffers
-
-    // Enviar datos de vrtices al VBO
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-
-    // Configurar los atributos de los vrtices (posicin, normal y UV)
-    glEnableVertexAttribArray(0);  // Activar el atributo para la posicin
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)0);  // Puntero a las posiciones
-
-    glEnableVertexAttribArray(1);  // Activar el atributo para las normales
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));  // Puntero a las normales
-
-    glEnableVertexAttribArray(2);  // Activar el atributo para las coordenadas UV
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void*)(6 * sizeof(GLfloat)));  // Puntero a las coordenadas UV
-
-    // Enviar datos de ndices al EBO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
-    glBindVertexArray(0);  // Desvincular el VAO despus de configurarlo
+    mesh = arena.allocate(mesh_vertices, indices, GL_FILL, true);
 }
 
 /**
  * @brief Destructor de la clase Heightmap.
  *
- * Elimina los recursos de OpenGL utilizados, como el VAO, VBO y EBO.
+ * Devuelve a la arena de mallas el espacio ocupado por el terreno.
  */
 Heightmap::~Heightmap() {
-    glDeleteVertexArrays(1, &vao_id);  // Eliminar el VAO
-    glDeleteBuffers(1, &vbo_id);       // Eliminar el VBO
-    glDeleteBuffers(1, &ebo_id);       // Eliminar el EBO
+    arena.release(mesh);  // Liberar el rango de la arena
 }
 
 /**
@@ -162,10 +145,77 @@ void Heightmap::generate_mesh(float width, float depth) {
 /**
  * @brief Renderiza el heightmap en la escena.
  *
- * Este mtodo dibuja la malla generada utilizando los datos almacenados en los buffers de OpenGL.
+ * Este mtodo dibuja la malla generada utilizando el rango que ocupa dentro de la arena de mallas.
  */
 void Heightmap::render() {
-    glBindVertexArray(vao_id);  // Vincular el VAO
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);  // Dibujar los tringulos
-    glBindVertexArray(0);  // Desvincular el VAO
+    udit::OpenGL_State::instance().bind_vertex_array(mesh.vao_id);  // Vincular el VAO de la arena (se queda vinculado)
+    udit::Mesh_Arena::draw(mesh);    // Dibujar los tringulos
+}
+
+/**
+ * @brief Devuelve la descripcin de la malla del terreno.
+ *
+ * El terreno se dibuja relleno y con el culling activado: sus tringulos miran hacia arriba.
+ *
+ * @return udit::Mesh La descripcin de la malla.
+ */
+udit::Mesh Heightmap::get_mesh() const {
+    return mesh;
+}
+
+/**
+ * @brief Genera una versin simplificada del terreno para usarla como oclusor.
+ *
+ * Cada vrtice de la rejilla toma la altura mnima de los vrtices del terreno que caen en las
+ * celdas que lo rodean. As los tringulos de la rejilla, que interpolan entre vrtices, no
+ * quedan por encima del terreno en ningn punto de esas celdas.
+ *
+ * @param cells Nmero de celdas por lado.
+ * @param occluder_vertices Recibe las posiciones de los vrtices.
+ * @param occluder_indices Recibe los ndices de los tringulos.
+ */
+void Heightmap::build_occluder(int cells, std::vector<glm::vec3>& occluder_vertices, std::vector<std::uint32_t>& occluder_indices) const {
+    occluder_vertices.clear();
+    occluder_indices.clear();
+
+    if (rows < 2 || cols < 2 || cells < 1) return;
+
+    const int cells_x = std::min(cells, cols - 1);
+    const int cells_z = std::min(cells, rows - 1);
+
+    for (int j = 0; j <= cells_z; ++j) {
+        for (int i = 0; i <= cells_x; ++i) {
+            // Vrtice del terreno ms cercano y ventana de vrtices de las celdas vecinas
+            const int center_x = i * (cols - 1) / cells_x;
+            const int center_z = j * (rows - 1) / cells_z;
+            const int first_x = std::max((i - 1) * (cols - 1) / cells_x, 0);
+            const int last_x = std::min((i + 1) * (cols - 1) / cells_x, cols - 1);
+            const int first_z = std::max((j - 1) * (rows - 1) / cells_z, 0);
+            const int last_z = std::min((j + 1) * (rows - 1) / cells_z, rows - 1);
+
+            float min_height = vertices[(center_z * cols + center_x) * 8 + 1];
+
+            for (int z = first_z; z <= last_z; ++z) {
+                for (int x = first_x; x <= last_x; ++x) {
+                    min_height = std::min(min_height, vertices[(z * cols + x) * 8 + 1]);
+                }
+            }
+
+            const int vertex_index = (center_z * cols + center_x) * 8;
+
+            occluder_vertices.emplace_back(vertices[vertex_index + 0], min_height, vertices[vertex_index + 2]);
+        }
+    }
+
+    // Dos tringulos por celda, con el mismo orden que la malla del terreno
+    for (int j = 0; j < cells_z; ++j) {
+        for (int i = 0; i < cells_x; ++i) {
+            const std::uint32_t top_left = std::uint32_t(j * (cells_x + 1) + i);
+            const std::uint32_t top_right = top_left + 1;
+            const std::uint32_t bottom_left = top_left + std::uint32_t(cells_x + 1);
+            const std::uint32_t bottom_right = bottom_left + 1;
+
+            occluder_indices.insert(occluder_indices.end(), { top_left, bottom_left, top_right, top_right, bottom_left, bottom_right });
+        }
+    }
 }
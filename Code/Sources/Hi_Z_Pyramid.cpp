@@ -0,0 +1,162 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Hi_Z_Pyramid.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <algorithm>                        // max
+
+namespace udit
+{
+
+    // Cada grupo de trabajo calcula un bloque de 8x8 texels del nivel de destino:
+
+    const std::string Hi_Z_Pyramid::copy_shader_code =
+
+        "#version 430\n"
+        ""
+        "layout (local_size_x = 8, local_size_y = 8) in;"
+        ""
+        "layout (binding = 0)       uniform sampler2D depth_texture;"
+        "layout (binding = 1, r32f) uniform writeonly image2D target_level;"
+        ""
+        "void main()"
+        "{"
+        "   ivec2 texel = ivec2(gl_GlobalInvocationID.xy);"
+        ""
+        "   if (any(greaterThanEqual(texel, imageSize(target_level)))) return;"
+        ""
+        "   imageStore(target_level, texel, vec4(texelFetch(depth_texture, texel, 0).r));"
+        "}";
+
+    const std::string Hi_Z_Pyramid::reduce_shader_code =
+
+        "#version 430\n"
+        ""
+        "layout (local_size_x = 8, local_size_y = 8) in;"
+        ""
+        "layout (binding = 0, r32f) uniform readonly  image2D source_level;"
+        "layout (binding = 1, r32f) uniform writeonly image2D target_level;"
+        ""
+        "void main()"
+        "{"
+        "   ivec2 texel       = ivec2(gl_GlobalInvocationID.xy);"
+        "   ivec2 target_size = imageSize(target_level);"
+        "   ivec2 source_size = imageSize(source_level);"
+        ""
+        "   if (any(greaterThanEqual(texel, target_size))) return;"
+        ""
+        // Con un tamao impar, el ltimo texel de la fila o columna recoge tambin el que sobra:
+        "   ivec2 first = texel * 2;"
+        "   ivec2 last  = min(first + 1 + ivec2(equal(texel, target_size - 1)) * (source_size & 1), source_size - 1);"
+        ""
+        "   float farthest = 0.0;"
+        ""
+        "   for (int y = first.y; y <= last.y; ++y)"
+        "   for (int x = first.x; x <= last.x; ++x)"
+        "   {"
+        "       farthest = max(farthest, imageLoad(source_level, ivec2(x, y)).r);"
+        "   }"
+        ""
+        "   imageStore(target_level, texel, vec4(farthest));"
+        "}";
+
+    /**
+     * @brief Constructor de la clase Hi_Z_Pyramid.
+     */
+    Hi_Z_Pyramid::Hi_Z_Pyramid()
+        : copy_program(copy_shader_code), reduce_program(reduce_shader_code),
+          texture_id(0), width(0), height(0), level_count(0), view_projection_matrix(1.f)
+    {
+    }
+
+    /**
+     * @brief Destructor de la clase Hi_Z_Pyramid.
+     */
+    Hi_Z_Pyramid::~Hi_Z_Pyramid()
+    {
+        if (texture_id) glDeleteTextures(1, &texture_id);
+    }
+
+    /**
+     * @brief Crea la textura con todos los niveles de la pirmide para un tamao dado.
+     *
+     * Los niveles se leen con texelFetch, sin filtrar, pero el filtro de reduccin con mipmaps
+     * hace falta para que la textura est completa con todos sus niveles.
+     */
+    void Hi_Z_Pyramid::create_texture(GLsizei width, GLsizei height)
+    {
+        if (texture_id) glDeleteTextures(1, &texture_id);
+
+        glGenTextures(1, &texture_id);
+
+        OpenGL_State::instance().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, texture_id);
+
+        level_count = 1;
+
+        while ((std::max(width, height) >> level_count) > 0) level_count++;
+
+        for (GLint level = 0; level < level_count; ++level)
+        {
+            glTexImage2D
+            (
+                GL_TEXTURE_2D, level, GL_R32F,
+                std::max(width  >> level, 1),
+                std::max(height >> level, 1),
+                0, GL_RED, GL_FLOAT, nullptr
+            );
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  level_count - 1);
+
+        this->width  = width;
+        this->height = height;
+    }
+
+    /**
+     * @brief Construye todos los niveles a partir de un buffer de profundidad.
+     *
+     * Cada nivel se calcula con un dispatch que lee el anterior como imagen. Entre dos dispatches
+     * una barrera hace visibles las escrituras del primero a las lecturas del segundo.
+     */
+    void Hi_Z_Pyramid::build(GLuint depth_texture_id, GLsizei width, GLsizei height, const glm::mat4 & view_projection_matrix)
+    {
+        if (width != this->width || height != this->height || texture_id == 0) create_texture(width, height);
+
+        // Nivel 0: copia de la profundidad de la escena, que no se puede vincular como imagen:
+
+        OpenGL_State::instance().bind_texture(TEXTURE_UNIT, GL_TEXTURE_2D, depth_texture_id);
+
+        copy_program.use();
+
+        OpenGL_Extensions::bind_image_texture(1, texture_id, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        OpenGL_Extensions::dispatch_compute  (GLuint(width + 7) / 8, GLuint(height + 7) / 8, 1);
+
+        // Resto de niveles, cada uno a partir del anterior:
+
+        reduce_program.use();
+
+        for (GLint level = 1; level < level_count; ++level)
+        {
+            const GLsizei level_width  = std::max(width  >> level, 1);
+            const GLsizei level_height = std::max(height >> level, 1);
+
+            OpenGL_Extensions::memory_barrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+            OpenGL_Extensions::bind_image_texture(0, texture_id, level - 1, GL_FALSE, 0, GL_READ_ONLY,  GL_R32F);
+            OpenGL_Extensions::bind_image_texture(1, texture_id, level,     GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            OpenGL_Extensions::dispatch_compute  (GLuint(level_width + 7) / 8, GLuint(level_height + 7) / 8, 1);
+        }
+
+        // Quien consulte la pirmide la leer como textura:
+
+        OpenGL_Extensions::memory_barrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+        this->view_projection_matrix = view_projection_matrix;
+    }
+
+}
@@ -0,0 +1,121 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Instance_Buffer.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <cstring>       // memcpy
+
+namespace udit
+{
+
+    static_assert(sizeof(Instance_Data) % 16 == 0, "Instance_Data debe ocupar un multiplo de 16 bytes");
+
+    /**
+     * @brief Constructor de la clase Instance_Buffer.
+     *
+     * Los segmentos se alinean a 256 bytes, el mximo que exige OpenGL para el desplazamiento al
+     * vincular un rango como SSBO (GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT).
+     *
+     * @param initial_capacity Nmero de instancias que caben inicialmente en cada frame.
+     */
+    Instance_Buffer::Instance_Buffer(std::size_t initial_capacity)
+        : ring(GL_ARRAY_BUFFER, initial_capacity * sizeof(Instance_Data), 256)
+    {
+    }
+
+    /**
+     * @brief Escribe en el segmento del frame los datos de todas las instancias.
+     *
+     * Si no caben en el segmento el Ring_Buffer se recrea con el doble de lo necesario, para que
+     * deje de crecer tras los primeros frames.
+     *
+     * @param instances Datos de las instancias.
+     */
+    void Instance_Buffer::upload(const std::vector<Instance_Data> & instances)
+    {
+        const std::size_t size = instances.size() * sizeof(Instance_Data);
+
+        std::memcpy(ring.begin_segment(size), instances.data(), size);
+
+        ring.end_segment();
+    }
+
+    /**
+     * @brief Marca el final de los dibujos que leen los datos del frame.
+     */
+    void Instance_Buffer::end_frame()
+    {
+        ring.fence_segment();
+    }
+
+    /**
+     * @brief Activa los atributos por instancia en el VAO vinculado.
+     *
+     * Con divisor 1 cada atributo avanza una vez por instancia en lugar de una vez por vrtice.
+     */
+    void Instance_Buffer::enable_attributes() const
+    {
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glEnableVertexAttribArray(MODEL_MATRIX_ATTRIBUTE + column);
+            glVertexAttribDivisor    (MODEL_MATRIX_ATTRIBUTE + column, 1);
+        }
+
+        glEnableVertexAttribArray(MATERIAL_ATTRIBUTE);
+        glVertexAttribDivisor    (MATERIAL_ATTRIBUTE, 1);
+    }
+
+    /**
+     * @brief Apunta los atributos por instancia del VAO vinculado al registro indicado.
+     *
+     * @param first_instance ndice del primer registro que usar el siguiente dibujo.
+     */
+    void Instance_Buffer::bind_attributes(std::size_t first_instance) const
+    {
+        bind_attributes(ring.get_id(), ring.get_segment_offset() + first_instance * sizeof(Instance_Data));
+    }
+
+    /**
+     * @brief Apunta los atributos por instancia del VAO vinculado a registros de otro buffer.
+     *
+     * @param buffer_id Buffer con registros Instance_Data.
+     * @param offset Desplazamiento en bytes del primer registro.
+     */
+    void Instance_Buffer::bind_attributes(GLuint buffer_id, std::size_t offset)
+    {
+        const GLsizei stride = sizeof(Instance_Data);
+        const char  * base   = reinterpret_cast<const char *>(offset);
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer_id);
+
+        // Una mat4 ocupa 4 localizaciones consecutivas, una por columna:
+
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glVertexAttribPointer(MODEL_MATRIX_ATTRIBUTE + column, 4, GL_FLOAT, GL_FALSE, stride, base + column * sizeof(glm::vec4));
+        }
+
+        glVertexAttribPointer(MATERIAL_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, stride, base + offsetof(Instance_Data, texture_layer));
+    }
+
+    /**
+     * @brief Vincula el segmento del frame como buffer de almacenamiento para los shaders.
+     *
+     * @param binding Punto de enlace del bloque buffer en el shader.
+     * @param instance_count Nmero de registros subidos en el frame.
+     */
+    void Instance_Buffer::bind_storage(GLuint binding, std::size_t instance_count) const
+    {
+        if (instance_count == 0) return;
+
+        glBindBufferRange
+        (
+            GL_SHADER_STORAGE_BUFFER,
+            binding,
+            ring.get_id(),
+            GLintptr  (ring.get_segment_offset()),
+            GLsizeiptr(instance_count * sizeof(Instance_Data))
+        );
+    }
+
+}
@@ -0,0 +1,157 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Job_System.hpp"
+#include <algorithm>     // min, max
+#include <atomic>        // Contador de subrangos pendientes
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Job_System.
+     *
+     * @param worker_count Nmero de hilos adems del que llama.
+     */
+    Job_System::Job_System(unsigned worker_count)
+        : stopping(false)
+    {
+        workers.reserve(worker_count);
+
+        for (unsigned i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back(&Job_System::work, this);
+        }
+    }
+
+    /**
+     * @brief Destructor de la clase Job_System.
+     */
+    Job_System::~Job_System()
+    {
+        {
+            std::lock_guard< std::mutex > lock(jobs_mutex);
+
+            stopping = true;
+        }
+
+        job_available.notify_all();
+
+        for (std::thread & worker : workers) worker.join();
+    }
+
+    /**
+     * @brief Nmero de subrangos en que parallel_for() divide un rango.
+     */
+    std::size_t Job_System::get_range_count(std::size_t count, std::size_t min_range_size) const
+    {
+        const std::size_t range_size = std::max< std::size_t >(min_range_size, 1);
+
+        return std::min< std::size_t >((count + range_size - 1) / range_size, get_thread_count());
+    }
+
+    /**
+     * @brief Procesa en paralelo los elementos [0, count) y espera a que terminen.
+     *
+     * El primer subrango lo procesa el hilo que llama. Despus, en lugar de bloquearse, ejecuta
+     * trabajos de la cola (de esta llamada o de otras) hasta que no queda ningn subrango pendiente.
+     */
+    void Job_System::parallel_for(std::size_t count, std::size_t min_range_size, const Range_Function & function)
+    {
+        const std::size_t range_count = get_range_count(count, min_range_size);
+
+        if (range_count <= 1)
+        {
+            if (count > 0) function(0, 0, count);
+            return;
+        }
+
+        // Los elementos sobrantes de la divisin se reparten uno a uno entre los primeros subrangos:
+
+        const std::size_t range_size = count / range_count;
+        const std::size_t remainder  = count % range_count;
+
+        auto range_begin = [&] (std::size_t range)
+        {
+            return range * range_size + std::min(range, remainder);
+        };
+
+        std::atomic< std::size_t > pending(range_count - 1);
+
+        {
+            std::lock_guard< std::mutex > lock(jobs_mutex);
+
+            for (std::size_t range = 1; range < range_count; ++range)
+            {
+                const std::size_t first = range_begin(range);
+                const std::size_t end   = range_begin(range + 1);
+
+                jobs.emplace_back
+                (
+                    [&function, &pending, range, first, end] ()
+                    {
+                        function(range, first, end);
+
+                        pending.fetch_sub(1, std::memory_order_release);
+                    }
+                );
+            }
+        }
+
+        job_available.notify_all();
+
+        function(0, 0, range_begin(1));
+
+        while (pending.load(std::memory_order_acquire) > 0)
+        {
+            if (!run_pending_job()) std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Ejecuta un trabajo de la cola si hay alguno.
+     * @return true si se ha ejecutado un trabajo.
+     */
+    bool Job_System::run_pending_job()
+    {
+        std::function<void()> job;
+
+        {
+            std::lock_guard< std::mutex > lock(jobs_mutex);
+
+            if (jobs.empty()) return false;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        job();
+
+        return true;
+    }
+
+    /**
+     * @brief Bucle de los hilos de trabajo: esperan a que haya trabajos y los ejecutan.
+     */
+    void Job_System::work()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+
+            {
+                std::unique_lock< std::mutex > lock(jobs_mutex);
+
+                job_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+                if (jobs.empty()) return;            // Solo se sale cuando no queda trabajo
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            job();
+        }
+    }
+
+}
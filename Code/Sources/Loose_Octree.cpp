@@ -0,0 +1,542 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Loose_Octree.hpp"
+#include <algorithm>                        // min, sort
+#include <cassert>                          // assert
+
+namespace udit
+{
+
+    // Una rama pendiente por cada hermano que falta por visitar en cada nivel, ms los hijos del nodo actual:
+
+    static constexpr std::size_t STACK_SIZE = (Loose_Octree::MAX_DEPTH + 1) * 8;
+
+    /**
+     * @brief Indica si dos cajas se solapan.
+     */
+    static bool boxes_overlap(const glm::vec3 & min_a, const glm::vec3 & max_a, const glm::vec3 & min_b, const glm::vec3 & max_b)
+    {
+        return glm::all(glm::lessThanEqual(min_a, max_b)) && glm::all(glm::lessThanEqual(min_b, max_a));
+    }
+
+    /**
+     * @brief Indica si la caja a est entera dentro de la caja b.
+     */
+    static bool box_contains(const glm::vec3 & min_b, const glm::vec3 & max_b, const glm::vec3 & min_a, const glm::vec3 & max_a)
+    {
+        return glm::all(glm::lessThanEqual(min_b, min_a)) && glm::all(glm::lessThanEqual(max_a, max_b));
+    }
+
+    /**
+     * @brief Corta un rayo con una caja por el mtodo de las franjas (slabs).
+     *
+     * @param inverse_direction Inverso de cada componente de la direccin (infinito en las nulas).
+     * @param entry Recibe la distancia a la que el rayo entra en la caja (0 si empieza dentro).
+     * @return true si el rayo corta la caja entre 0 y max_distance.
+     */
+    static bool intersect_ray_box
+    (
+        const glm::vec3 & origin,
+        const glm::vec3 & inverse_direction,
+        const glm::vec3 & min,
+        const glm::vec3 & max,
+        float             max_distance,
+        float           & entry
+    )
+    {
+        const glm::vec3 t0 = (min - origin) * inverse_direction;
+        const glm::vec3 t1 = (max - origin) * inverse_direction;
+
+        const glm::vec3 near_t = glm::min(t0, t1);
+        const glm::vec3 far_t  = glm::max(t0, t1);
+
+        const float t_enter = std::max(std::max(near_t.x, near_t.y), std::max(near_t.z, 0.f));
+        const float t_exit  = std::min(std::min(far_t .x, far_t .y), std::min(far_t .z, max_distance));
+
+        entry = t_enter;
+
+        return t_enter <= t_exit;
+    }
+
+    /**
+     * @brief Constructor de la clase Loose_Octree.
+     */
+    Loose_Octree::Loose_Octree(const glm::vec3 & center, float half_size, unsigned max_depth)
+        : max_depth(std::min(max_depth, MAX_DEPTH)), object_count(0)
+    {
+        Node root;
+
+        root.center        = center;
+        root.half_size     = half_size;
+        root.parent        = INVALID;
+        root.first_object  = INVALID;
+        root.subtree_count = 0;
+        root.depth         = 0;
+
+        std::fill(std::begin(root.children), std::end(root.children), INVALID);
+
+        nodes.push_back(root);
+    }
+
+    /**
+     * @brief Aade un objeto.
+     */
+    std::uint32_t Loose_Octree::insert(const glm::vec3 & min, const glm::vec3 & max, std::uint32_t value)
+    {
+        std::uint32_t handle;
+
+        if (free_objects.empty())
+        {
+            handle = std::uint32_t(objects.size());
+            objects.emplace_back();
+        }
+        else
+        {
+            handle = free_objects.back();
+            free_objects.pop_back();
+        }
+
+        Object & object = objects[handle];
+
+        object.min   = min;
+        object.max   = max;
+        object.value = value;
+
+        link(handle, find_node(min, max));
+
+        object_count++;
+
+        return handle;
+    }
+
+    /**
+     * @brief Quita un objeto.
+     */
+    void Loose_Octree::remove(std::uint32_t handle)
+    {
+        assert(handle < objects.size() && objects[handle].node != INVALID);
+
+        unlink(handle);
+
+        objects[handle].node = INVALID;
+
+        free_objects.push_back(handle);
+
+        object_count--;
+    }
+
+    /**
+     * @brief Cambia la caja de un objeto que se ha movido.
+     *
+     * Lo habitual es que un objeto que se mueve poco siga en el mismo nodo, y entonces no se toca
+     * ninguna lista.
+     */
+    void Loose_Octree::update(std::uint32_t handle, const glm::vec3 & min, const glm::vec3 & max)
+    {
+        assert(handle < objects.size() && objects[handle].node != INVALID);
+
+        Object & object = objects[handle];
+
+        object.min = min;
+        object.max = max;
+
+        if (!fits_node(object.node, min, max))
+        {
+            unlink(handle);
+            link  (handle, find_node(min, max));
+        }
+    }
+
+    /**
+     * @brief Profundidad del nodo que corresponde a una caja por su tamao.
+     *
+     * Es la ms profunda en la que la mitad del lado de la celda sigue siendo al menos la mitad del
+     * mayor lado de la caja, de modo que la caja cabe en los lmites holgados de la celda que
+     * contiene su centro.
+     */
+    unsigned Loose_Octree::get_depth(const glm::vec3 & min, const glm::vec3 & max) const
+    {
+        const glm::vec3 half_extent = (max - min) * 0.5f;
+        const float     extent      = std::max(std::max(half_extent.x, half_extent.y), half_extent.z);
+
+        unsigned depth     = 0;
+        float    half_size = nodes[0].half_size;
+
+        while (depth < max_depth && half_size * 0.5f >= extent)
+        {
+            half_size *= 0.5f;
+            depth++;
+        }
+
+        return depth;
+    }
+
+    /**
+     * @brief Busca (crendolo si hace falta) el nodo que corresponde a una caja.
+     */
+    std::uint32_t Loose_Octree::find_node(const glm::vec3 & min, const glm::vec3 & max)
+    {
+        const glm::vec3 center = (min + max) * 0.5f;
+
+        // Lo que cae fuera del cubo raz se queda en la raz:
+
+        if (glm::any(glm::greaterThan(glm::abs(center - nodes[0].center), glm::vec3(nodes[0].half_size)))) return 0;
+
+        const unsigned depth = get_depth(min, max);
+
+        std::uint32_t node_index = 0;
+
+        while (nodes[node_index].depth < depth)
+        {
+            const Node & node = nodes[node_index];
+
+            const unsigned octant = (center.x >= node.center.x ? 1u : 0u)
+                                  | (center.y >= node.center.y ? 2u : 0u)
+                                  | (center.z >= node.center.z ? 4u : 0u);
+
+            if (node.children[octant] == INVALID)
+            {
+                const float quarter = node.half_size * 0.5f;
+
+                Node child;
+
+                child.center        = node.center + glm::vec3
+                                      (
+                                          octant & 1 ? quarter : -quarter,
+                                          octant & 2 ? quarter : -quarter,
+                                          octant & 4 ? quarter : -quarter
+                                      );
+                child.half_size     = quarter;
+                child.parent        = node_index;
+                child.first_object  = INVALID;
+                child.subtree_count = 0;
+                child.depth         = node.depth + 1;
+
+                std::fill(std::begin(child.children), std::end(child.children), INVALID);
+
+                // El push_back puede mover los nodos, as que se enlaza por ndice:
+
+                const std::uint32_t child_index = std::uint32_t(nodes.size());
+
+                nodes.push_back(child);
+
+                nodes[node_index].children[octant] = child_index;
+            }
+
+            node_index = nodes[node_index].children[octant];
+        }
+
+        return node_index;
+    }
+
+    /**
+     * @brief Indica si una caja sigue correspondiendo a un nodo.
+     */
+    bool Loose_Octree::fits_node(std::uint32_t node_index, const glm::vec3 & min, const glm::vec3 & max) const
+    {
+        const glm::vec3 center = (min + max) * 0.5f;
+
+        if (glm::any(glm::greaterThan(glm::abs(center - nodes[0].center), glm::vec3(nodes[0].half_size)))) return node_index == 0;
+
+        const Node & node = nodes[node_index];
+
+        return node.depth == get_depth(min, max)
+            && glm::all(glm::lessThanEqual(glm::abs(center - node.center), glm::vec3(node.half_size)));
+    }
+
+    /**
+     * @brief Aade un objeto a la lista de un nodo y lo cuenta en el subrbol de sus antecesores.
+     */
+    void Loose_Octree::link(std::uint32_t handle, std::uint32_t node_index)
+    {
+        Object & object = objects[handle];
+        Node   & node   = nodes[node_index];
+
+        object.node     = node_index;
+        object.previous = INVALID;
+        object.next     = node.first_object;
+
+        if (object.next != INVALID) objects[object.next].previous = handle;
+
+        node.first_object = handle;
+
+        for (std::uint32_t i = node_index; i != INVALID; i = nodes[i].parent) nodes[i].subtree_count++;
+    }
+
+    /**
+     * @brief Saca un objeto de la lista de su nodo y lo descuenta del subrbol de sus antecesores.
+     */
+    void Loose_Octree::unlink(std::uint32_t handle)
+    {
+        Object & object = objects[handle];
+
+        if (object.previous != INVALID) objects[object.previous].next = object.next;
+        else                            nodes[object.node].first_object = object.next;
+
+        if (object.next != INVALID) objects[object.next].previous = object.previous;
+
+        for (std::uint32_t i = object.node; i != INVALID; i = nodes[i].parent) nodes[i].subtree_count--;
+    }
+
+    /**
+     * @brief Aade los valores de todos los objetos de un subrbol sin comprobarlos.
+     */
+    void Loose_Octree::collect(std::uint32_t node_index, std::vector<std::uint32_t> & values) const
+    {
+        std::uint32_t stack[STACK_SIZE];
+        std::size_t   stack_size = 0;
+
+        stack[stack_size++] = node_index;
+
+        while (stack_size > 0)
+        {
+            const Node & node = nodes[stack[--stack_size]];
+
+            for (std::uint32_t i = node.first_object; i != INVALID; i = objects[i].next)
+            {
+                values.push_back(objects[i].value);
+            }
+
+            for (std::uint32_t child : node.children)
+            {
+                if (child != INVALID && nodes[child].subtree_count > 0) stack[stack_size++] = child;
+            }
+        }
+    }
+
+    /**
+     * @brief Recorrido comn a las consultas por regin.
+     *
+     * classify_node clasifica los lmites holgados de un nodo respecto a la regin; test_object
+     * dice si la caja de un objeto la toca. La raz nunca se clasifica, porque puede guardar
+     * objetos que quedan fuera de sus lmites.
+     */
+    template< typename CLASSIFY_NODE, typename TEST_OBJECT >
+    void Loose_Octree::query(CLASSIFY_NODE classify_node, TEST_OBJECT test_object, std::vector<std::uint32_t> & values) const
+    {
+        std::uint32_t stack[STACK_SIZE];
+        std::size_t   stack_size = 0;
+
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const std::uint32_t node_index = stack[--stack_size];
+            const Node        & node       = nodes[node_index];
+
+            if (node.subtree_count == 0) continue;
+
+            if (node_index != 0)
+            {
+                const Frustum::Containment containment = classify_node(get_loose_min(node), get_loose_max(node));
+
+                if (containment == Frustum::OUTSIDE) continue;
+
+                if (containment == Frustum::INSIDE)
+                {
+                    collect(node_index, values);
+                    continue;
+                }
+            }
+
+            for (std::uint32_t i = node.first_object; i != INVALID; i = objects[i].next)
+            {
+                if (test_object(objects[i])) values.push_back(objects[i].value);
+            }
+
+            for (std::uint32_t child : node.children)
+            {
+                if (child != INVALID) stack[stack_size++] = child;
+            }
+        }
+    }
+
+    /**
+     * @brief Valores de los objetos cuya caja toca el volumen de visin.
+     */
+    void Loose_Octree::query_frustum(const Frustum & frustum, std::vector<std::uint32_t> & values) const
+    {
+        query
+        (
+            [&frustum] (const glm::vec3 & min, const glm::vec3 & max)
+            {
+                return frustum.classify_box(min, max);
+            },
+            [&frustum] (const Object & object)
+            {
+                return frustum.classify_box(object.min, object.max) != Frustum::OUTSIDE;
+            },
+            values
+        );
+    }
+
+    /**
+     * @brief Valores de los objetos cuya caja toca una esfera.
+     *
+     * Una caja toca la esfera si su punto ms cercano al centro est a menos de un radio, y queda
+     * dentro si tambin lo est su esquina ms lejana.
+     */
+    void Loose_Octree::query_sphere(const glm::vec3 & center, float radius, std::vector<std::uint32_t> & values) const
+    {
+        const float radius_squared = radius * radius;
+
+        auto touches = [&center, radius_squared] (const glm::vec3 & min, const glm::vec3 & max)
+        {
+            const glm::vec3 offset = glm::clamp(center, min, max) - center;
+
+            return glm::dot(offset, offset) <= radius_squared;
+        };
+
+        query
+        (
+            [&center, radius_squared, &touches] (const glm::vec3 & min, const glm::vec3 & max)
+            {
+                if (!touches(min, max)) return Frustum::OUTSIDE;
+
+                const glm::vec3 farthest = glm::max(glm::abs(min - center), glm::abs(max - center));
+
+                return glm::dot(farthest, farthest) <= radius_squared ? Frustum::INSIDE : Frustum::INTERSECTING;
+            },
+            [&touches] (const Object & object)
+            {
+                return touches(object.min, object.max);
+            },
+            values
+        );
+    }
+
+    /**
+     * @brief Valores de los objetos cuya caja se solapa con otra caja.
+     */
+    void Loose_Octree::query_box(const glm::vec3 & min, const glm::vec3 & max, std::vector<std::uint32_t> & values) const
+    {
+        query
+        (
+            [&min, &max] (const glm::vec3 & node_min, const glm::vec3 & node_max)
+            {
+                if (!boxes_overlap(min, max, node_min, node_max)) return Frustum::OUTSIDE;
+
+                return box_contains(min, max, node_min, node_max) ? Frustum::INSIDE : Frustum::INTERSECTING;
+            },
+            [&min, &max] (const Object & object)
+            {
+                return boxes_overlap(min, max, object.min, object.max);
+            },
+            values
+        );
+    }
+
+    /**
+     * @brief Valores de los objetos cuya caja atraviesa un rayo.
+     *
+     * Un rayo nunca contiene un nodo entero, as que todos los nodos que corta se recorren.
+     */
+    void Loose_Octree::query_ray(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance, std::vector<std::uint32_t> & values) const
+    {
+        const glm::vec3 inverse_direction = 1.f / direction;
+
+        query
+        (
+            [&origin, &inverse_direction, max_distance] (const glm::vec3 & min, const glm::vec3 & max)
+            {
+                float entry;
+
+                return intersect_ray_box(origin, inverse_direction, min, max, max_distance, entry) ? Frustum::INTERSECTING : Frustum::OUTSIDE;
+            },
+            [&origin, &inverse_direction, max_distance] (const Object & object)
+            {
+                float entry;
+
+                return intersect_ray_box(origin, inverse_direction, object.min, object.max, max_distance, entry);
+            },
+            values
+        );
+    }
+
+    /**
+     * @brief Objeto cuya caja corta antes un rayo.
+     *
+     * Los hijos de cada nodo se apilan de ms lejano a ms cercano, de modo que se visita primero el
+     * ms cercano, y cada nodo se vuelve a comprobar al sacarlo de la pila contra el mejor corte
+     * encontrado hasta entonces.
+     */
+    std::uint32_t Loose_Octree::pick(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance, float & distance) const
+    {
+        const glm::vec3 inverse_direction = 1.f / direction;
+
+        std::uint32_t best_value    = INVALID;
+        float         best_distance = max_distance;
+
+        std::uint32_t stack[STACK_SIZE];
+        std::size_t   stack_size = 0;
+
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const std::uint32_t node_index = stack[--stack_size];
+            const Node        & node       = nodes[node_index];
+
+            float entry;
+
+            if (node.subtree_count == 0) continue;
+
+            if (node_index != 0 && !intersect_ray_box(origin, inverse_direction, get_loose_min(node), get_loose_max(node), best_distance, entry)) continue;
+
+            for (std::uint32_t i = node.first_object; i != INVALID; i = objects[i].next)
+            {
+                if (intersect_ray_box(origin, inverse_direction, objects[i].min, objects[i].max, best_distance, entry))
+                {
+                    best_value    = objects[i].value;
+                    best_distance = entry;
+                }
+            }
+
+            struct Pending
+            {
+                std::uint32_t node_index;
+                float         entry;
+            };
+
+            Pending     pending[8];
+            std::size_t pending_count = 0;
+
+            for (std::uint32_t child : node.children)
+            {
+                if (child == INVALID || nodes[child].subtree_count == 0) continue;
+
+                if (intersect_ray_box(origin, inverse_direction, get_loose_min(nodes[child]), get_loose_max(nodes[child]), best_distance, entry))
+                {
+                    pending[pending_count++] = { child, entry };
+                }
+            }
+
+            std::sort(pending, pending + pending_count, [] (const Pending & a, const Pending & b) { return a.entry > b.entry; });
+
+            for (std::size_t i = 0; i < pending_count; ++i) stack[stack_size++] = pending[i].node_index;
+        }
+
+        if (best_value != INVALID) distance = best_distance;
+
+        return best_value;
+    }
+
+    /**
+     * @brief Calcula la caja en el espacio del mundo de una malla transformada.
+     */
+    void Loose_Octree::transform_box(const Bounds & bounds, const glm::mat4 & model_matrix, glm::vec3 & min, glm::vec3 & max)
+    {
+        const glm::vec3 local_center = (bounds.min + bounds.max) * 0.5f;
+        const glm::vec3 local_half   = (bounds.max - bounds.min) * 0.5f;
+
+        const glm::vec3 center = glm::vec3(model_matrix * glm::vec4(local_center, 1.f));
+        const glm::vec3 half   = glm::abs(glm::vec3(model_matrix[0])) * local_half.x
+                               + glm::abs(glm::vec3(model_matrix[1])) * local_half.y
+                               + glm::abs(glm::vec3(model_matrix[2])) * local_half.z;
+
+        min = center - half;
+        max = center + half;
+    }
+
+}
@@ -0,0 +1,154 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Material_Textures.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/stb_image.h"
+#include <algorithm>     // fill, min
+#include <cstring>       // memcpy
+#include <iostream>      // cerr
+
+namespace udit
+{
+
+    /**
+     * @brief Reescala una imagen RGBA con filtrado bilineal.
+     *
+     * Se muestrea en el centro de cada pxel de destino. Al reducir mucho una imagen se pierde
+     * detalle, pero las texturas de la escena son como mucho del tamao de las capas.
+     */
+    static void resample
+    (
+        const unsigned char * source, int source_width, int source_height,
+              unsigned char * target, int target_width, int target_height
+    )
+    {
+        const float x_scale = float(source_width ) / float(target_width );
+        const float y_scale = float(source_height) / float(target_height);
+
+        for (int y = 0; y < target_height; ++y)
+        {
+            const float source_y = std::max((float(y) + .5f) * y_scale - .5f, 0.f);
+            const int   y0       = std::min(int(source_y), source_height - 1);
+            const int   y1       = std::min(y0 + 1,        source_height - 1);
+            const float fy       = source_y - float(y0);
+
+            for (int x = 0; x < target_width; ++x)
+            {
+                const float source_x = std::max((float(x) + .5f) * x_scale - .5f, 0.f);
+                const int   x0       = std::min(int(source_x), source_width - 1);
+                const int   x1       = std::min(x0 + 1,        source_width - 1);
+                const float fx       = source_x - float(x0);
+
+                const unsigned char * p00 = source + (y0 * source_width + x0) * 4;
+                const unsigned char * p10 = source + (y0 * source_width + x1) * 4;
+                const unsigned char * p01 = source + (y1 * source_width + x0) * 4;
+                const unsigned char * p11 = source + (y1 * source_width + x1) * 4;
+
+                unsigned char * pixel = target + (y * target_width + x) * 4;
+
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    const float top    = p00[channel] + (p10[channel] - p00[channel]) * fx;
+                    const float bottom = p01[channel] + (p11[channel] - p01[channel]) * fx;
+
+                    pixel[channel] = static_cast<unsigned char>(top + (bottom - top) * fy + .5f);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Constructor de la clase Material_Textures.
+     *
+     * @param layer_width Ancho en pxeles de cada capa.
+     * @param layer_height Alto en pxeles de cada capa.
+     */
+    Material_Textures::Material_Textures(GLsizei layer_width, GLsizei layer_height)
+        : layer_width(layer_width), layer_height(layer_height), texture_id(0), layer_count(0)
+    {
+    }
+
+    /**
+     * @brief Destructor de la clase Material_Textures.
+     */
+    Material_Textures::~Material_Textures()
+    {
+        if (texture_id) glDeleteTextures(1, &texture_id);
+    }
+
+    /**
+     * @brief Carga una imagen en una capa nueva.
+     *
+     * @param path Ruta del archivo de imagen.
+     * @return ndice de la capa.
+     */
+    unsigned Material_Textures::load(const std::string & path)
+    {
+        const std::size_t layer_size = std::size_t(layer_width) * std::size_t(layer_height) * 4;
+        const std::size_t offset     = pixels.size();
+
+        pixels.resize(offset + layer_size);
+
+        unsigned char * layer = pixels.data() + offset;
+
+        // Siempre se piden 4 canales para que todas las capas tengan el mismo formato:
+
+        int width, height, channels;
+        unsigned char * data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+
+        if (!data)
+        {
+            std::cerr << "Error: No se pudo cargar la textura " << path << std::endl;
+
+            std::fill(layer, layer + layer_size, static_cast<unsigned char>(255));
+        }
+        else
+        {
+            if (width == layer_width && height == layer_height)
+            {
+                std::memcpy(layer, data, layer_size);
+            }
+            else
+                resample(data, width, height, layer, layer_width, layer_height);
+
+            stbi_image_free(data);
+        }
+
+        return layer_count++;
+    }
+
+    /**
+     * @brief Crea el array de texturas con todas las capas cargadas y genera sus mipmaps.
+     */
+    void Material_Textures::upload()
+    {
+        if (layer_count == 0) return;
+
+        if (texture_id) glDeleteTextures(1, &texture_id);
+
+        glGenTextures(1, &texture_id);
+
+        OpenGL_State::instance().bind_texture(0, GL_TEXTURE_2D_ARRAY, texture_id);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S,     GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T,     GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        glTexImage3D
+        (
+            GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8,
+            layer_width, layer_height, GLsizei(layer_count), 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()
+        );
+
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+        pixels.clear();
+        pixels.shrink_to_fit();
+    }
+
+}
@@ -0,0 +1,340 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Mesh_Arena.hpp"
+#include <algorithm>     // copy, max
+#include <cmath>         // sqrt
+#include <cstddef>       // offsetof
+#include <cstdint>       // uintptr_t
+
+namespace udit
+{
+
+    static_assert(sizeof(Mesh_Arena::Vertex) == 8 * sizeof(GLfloat), "Mesh_Arena::Vertex no debe tener relleno");
+
+    /**
+     * @brief Busca el primer rango libre en el que quepa el tamao pedido.
+     *
+     * Si no hay ninguno se reserva a continuacin de la zona usada.
+     *
+     * @param size Nmero de elementos que se quieren reservar.
+     * @return La posicin del primer elemento reservado.
+     */
+    std::size_t Mesh_Arena::Range_Allocator::allocate(std::size_t size)
+    {
+        for (std::size_t i = 0; i < free_ranges.size(); ++i)
+        {
+            Range & range = free_ranges[i];
+
+            if (range.size >= size)
+            {
+                std::size_t offset = range.offset;
+
+                range.offset += size;
+                range.size   -= size;
+
+                if (range.size == 0) free_ranges.erase(free_ranges.begin() + i);
+
+                return offset;
+            }
+        }
+
+        std::size_t offset = end;
+        end += size;
+        return offset;
+    }
+
+    /**
+     * @brief Marca un rango como libre, fusionndolo con los rangos libres contiguos.
+     *
+     * @param offset Posicin del primer elemento del rango.
+     * @param size Nmero de elementos del rango.
+     */
+    void Mesh_Arena::Range_Allocator::release(std::size_t offset, std::size_t size)
+    {
+        if (size == 0) return;
+
+        std::size_t i = 0;
+
+        while (i < free_ranges.size() && free_ranges[i].offset < offset) ++i;
+
+        free_ranges.insert(free_ranges.begin() + i, { offset, size });
+
+        // Fusionar con el rango siguiente y con el anterior si son contiguos:
+
+        if (i + 1 < free_ranges.size() && free_ranges[i].offset + free_ranges[i].size == free_ranges[i + 1].offset)
+        {
+            free_ranges[i].size += free_ranges[i + 1].size;
+            free_ranges.erase(free_ranges.begin() + i + 1);
+        }
+
+        if (i > 0 && free_ranges[i - 1].offset + free_ranges[i - 1].size == free_ranges[i].offset)
+        {
+            free_ranges[i - 1].size += free_ranges[i].size;
+            free_ranges.erase(free_ranges.begin() + i);
+            --i;
+        }
+
+        // Un rango libre al final de la zona usada se devuelve a la zona sin usar:
+
+        if (free_ranges[i].offset + free_ranges[i].size == end)
+        {
+            end = free_ranges[i].offset;
+            free_ranges.erase(free_ranges.begin() + i);
+        }
+    }
+
+    /**
+     * @brief Constructor de la clase Mesh_Arena.
+     *
+     * Crea el VAO compartido y configura sus atributos de vrtice sobre el VBO entrelazado,
+     * del mismo modo que lo haca cada primitiva con su propio VAO.
+     *
+     * @param initial_vertices Nmero de vrtices que caben inicialmente.
+     * @param initial_indices Nmero de ndices que caben inicialmente.
+     */
+    Mesh_Arena::Mesh_Arena(std::size_t initial_vertices, std::size_t initial_indices)
+        : vertex_capacity(0), index_capacity(0), next_mesh_id(0)
+    {
+        glGenVertexArrays(1, &vao_id);
+        glGenBuffers     (1, &vbo_id);
+        glGenBuffers     (1, &ebo_id);
+
+        glBindVertexArray(vao_id);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+
+        glEnableVertexAttribArray(0);  // Posicin
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+
+        glEnableVertexAttribArray(1);  // Color
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
+
+        glEnableVertexAttribArray(2);  // Coordenadas UV
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+
+        // El EBO vinculado forma parte del estado del VAO:
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_id);
+
+        glBindVertexArray(0);
+
+        reserve_vertices(initial_vertices);
+        reserve_indices (initial_indices);
+    }
+
+    /**
+     * @brief Destructor de la clase Mesh_Arena.
+     */
+    Mesh_Arena::~Mesh_Arena()
+    {
+        glDeleteVertexArrays(1, &vao_id);
+        glDeleteBuffers     (1, &vbo_id);
+        glDeleteBuffers     (1, &ebo_id);
+    }
+
+    /**
+     * @brief Reserva una malla y sube su geometra a los buffers compartidos.
+     *
+     * @return Mesh El registro que describe la malla dentro de la arena.
+     */
+    Mesh Mesh_Arena::allocate(const std::vector<Vertex> & mesh_vertices, const std::vector<GLuint> & mesh_indices, GLenum polygon_mode, bool cull_face)
+    {
+        std::size_t base_vertex = vertex_ranges.allocate(mesh_vertices.size());
+        std::size_t first_index =  index_ranges.allocate(mesh_indices .size());
+
+        // Si la reserva queda fuera de la capacidad actual los buffers crecen al doble:
+
+        if (vertex_ranges.end > vertex_capacity) reserve_vertices(vertex_ranges.end * 2);
+        if ( index_ranges.end >  index_capacity) reserve_indices ( index_ranges.end * 2);
+
+        if (vertices.size() < vertex_ranges.end) vertices.resize(vertex_ranges.end);
+        if (indices .size() <  index_ranges.end) indices .resize( index_ranges.end);
+
+        std::copy(mesh_vertices.begin(), mesh_vertices.end(), vertices.begin() + base_vertex);
+        std::copy(mesh_indices .begin(), mesh_indices .end(), indices .begin() + first_index);
+
+        glBindBuffer   (GL_ARRAY_BUFFER, vbo_id);
+        glBufferSubData(GL_ARRAY_BUFFER, base_vertex * sizeof(Vertex), mesh_vertices.size() * sizeof(Vertex), mesh_vertices.data());
+
+        // El EBO se vincula como GL_COPY_WRITE_BUFFER para no alterar el VAO que est vinculado:
+
+        glBindBuffer   (GL_COPY_WRITE_BUFFER, ebo_id);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, first_index * sizeof(GLuint), mesh_indices.size() * sizeof(GLuint), mesh_indices.data());
+
+        Mesh mesh;
+
+        mesh.vao_id       = vao_id;
+        mesh.mesh_id      = next_mesh_id++;
+        mesh.index_count  = GLsizei(mesh_indices .size());
+        mesh.first_index  = GLuint (first_index);
+        mesh.base_vertex  = GLint  (base_vertex);
+        mesh.vertex_count = GLsizei(mesh_vertices.size());
+        mesh.polygon_mode = polygon_mode;
+        mesh.cull_face    = cull_face;
+        mesh.bounds       = compute_bounds(mesh_vertices);
+
+        return mesh;
+    }
+
+    /**
+     * @brief Reserva una malla a partir de arrays separados de coordenadas, colores y UVs.
+     *
+     * Se entrelazan los datos en el formato de vrtice de la arena antes de subirlos.
+     *
+     * @return Mesh El registro que describe la malla dentro de la arena.
+     */
+    Mesh Mesh_Arena::allocate
+    (
+        const GLfloat * coordinates,
+        const GLfloat * colors,
+        const GLfloat * uvs,
+        std::size_t     vertex_count,
+        const std::vector<GLuint> & mesh_indices,
+        GLenum          polygon_mode,
+        bool            cull_face
+    )
+    {
+        std::vector<Vertex> mesh_vertices(vertex_count);
+
+        for (std::size_t i = 0; i < vertex_count; ++i)
+        {
+            Vertex & vertex = mesh_vertices[i];
+
+            vertex.position[0] = coordinates[i * 3 + 0];
+            vertex.position[1] = coordinates[i * 3 + 1];
+            vertex.position[2] = coordinates[i * 3 + 2];
+
+            vertex.color[0] = colors ? colors[i * 3 + 0] : 0.f;
+            vertex.color[1] = colors ? colors[i * 3 + 1] : 0.f;
+            vertex.color[2] = colors ? colors[i * 3 + 2] : 0.f;
+
+            vertex.uv[0] = uvs ? uvs[i * 2 + 0] : 0.f;
+            vertex.uv[1] = uvs ? uvs[i * 2 + 1] : 0.f;
+        }
+
+        return allocate(mesh_vertices, mesh_indices, polygon_mode, cull_face);
+    }
+
+    /**
+     * @brief Devuelve a la arena el espacio ocupado por una malla.
+     *
+     * El contenido de los buffers no se toca: el rango simplemente queda disponible para la prxima reserva.
+     *
+     * @param mesh Malla reservada previamente con allocate().
+     */
+    void Mesh_Arena::release(const Mesh & mesh)
+    {
+        vertex_ranges.release(std::size_t(mesh.base_vertex), std::size_t(mesh.vertex_count));
+         index_ranges.release(std::size_t(mesh.first_index), std::size_t(mesh.index_count ));
+    }
+
+    /**
+     * @brief Copia la geometra de una malla desde la copia en CPU de la arena.
+     *
+     * Permite trabajar con la geometra (por ejemplo para combinar mallas) sin leer de la GPU.
+     *
+     * @param mesh Malla reservada previamente con allocate().
+     * @param mesh_vertices Recibe los vrtices de la malla.
+     * @param mesh_indices Recibe los ndices de la malla, relativos a su primer vrtice.
+     */
+    void Mesh_Arena::read(const Mesh & mesh, std::vector<Vertex> & mesh_vertices, std::vector<GLuint> & mesh_indices) const
+    {
+        auto first_vertex = vertices.begin() + mesh.base_vertex;
+        auto first_index  = indices .begin() + mesh.first_index;
+
+        mesh_vertices.assign(first_vertex, first_vertex + mesh.vertex_count);
+        mesh_indices .assign(first_index,  first_index  + mesh.index_count );
+    }
+
+    /**
+     * @brief Dibuja una malla de la arena.
+     *
+     * El VAO de la arena debe estar vinculado. El vrtice base desplaza los ndices de la malla,
+     * que estn guardados en relacin a su primer vrtice.
+     *
+     * @param mesh Malla que se dibuja.
+     */
+    void Mesh_Arena::draw(const Mesh & mesh)
+    {
+        glDrawElementsBaseVertex
+        (
+            GL_TRIANGLES,
+            mesh.index_count,
+            GL_UNSIGNED_INT,
+            reinterpret_cast<void *>(std::uintptr_t(mesh.first_index) * sizeof(GLuint)),
+            mesh.base_vertex
+        );
+    }
+
+    /**
+     * @brief Hace crecer el VBO hasta la capacidad indicada conservando su contenido.
+     *
+     * Se reutiliza el mismo nombre de buffer, de modo que el VAO no necesita reconfigurarse.
+     *
+     * @param capacity Nmero de vrtices que deben caber en el VBO.
+     */
+    void Mesh_Arena::reserve_vertices(std::size_t capacity)
+    {
+        vertex_capacity = capacity;
+
+        glBindBuffer   (GL_ARRAY_BUFFER, vbo_id);
+        glBufferData   (GL_ARRAY_BUFFER, vertex_capacity * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+    }
+
+    /**
+     * @brief Hace crecer el EBO hasta la capacidad indicada conservando su contenido.
+     *
+     * @param capacity Nmero de ndices que deben caber en el EBO.
+     */
+    void Mesh_Arena::reserve_indices(std::size_t capacity)
+    {
+        index_capacity = capacity;
+
+        glBindBuffer   (GL_COPY_WRITE_BUFFER, ebo_id);
+        glBufferData   (GL_COPY_WRITE_BUFFER, index_capacity * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+    }
+
+    /**
+     * @brief Calcula la caja y la esfera envolventes de los vrtices de una malla.
+     *
+     * Lo hace la arena al reservar cada malla, de modo que todas las primitivas (Plane, Cone,
+     * Cylinder, Cube, Heightmap) y los lotes estticos tienen sus volmenes desde que se construyen.
+     */
+    Bounds Mesh_Arena::compute_bounds(const std::vector<Vertex> & mesh_vertices)
+    {
+        Bounds bounds;
+
+        if (mesh_vertices.empty()) return bounds;
+
+        bounds.min = bounds.max = glm::vec3(mesh_vertices[0].position[0], mesh_vertices[0].position[1], mesh_vertices[0].position[2]);
+
+        for (const Vertex & vertex : mesh_vertices)
+        {
+            const glm::vec3 position(vertex.position[0], vertex.position[1], vertex.position[2]);
+
+            bounds.min = glm::min(bounds.min, position);
+            bounds.max = glm::max(bounds.max, position);
+        }
+
+        // El radio se mide desde el centro de la caja hasta el vrtice ms alejado:
+
+        bounds.center = (bounds.min + bounds.max) * 0.5f;
+
+        float squared_radius = 0.f;
+
+        for (const Vertex & vertex : mesh_vertices)
+        {
+            const glm::vec3 offset = glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]) - bounds.center;
+
+            squared_radius = std::max(squared_radius, glm::dot(offset, offset));
+        }
+
+        bounds.radius = std::sqrt(squared_radius);
+
+        return bounds;
+    }
+
+}
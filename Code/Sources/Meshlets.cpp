@@ -0,0 +1,326 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Meshlets.hpp"
+#include <algorithm>                        // min, max, fill
+#include <cmath>                            // sqrt
+
+namespace udit
+{
+
+    static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFF;
+
+    static glm::vec3 get_position(const Mesh_Arena::Vertex & vertex)
+    {
+        return glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]);
+    }
+
+    /**
+     * @brief Reparte una malla en meshlets y reordena sus ndices.
+     *
+     * Para no recorrer en cada paso todos los tringulos vecinos del meshlet, los candidatos a
+     * aadirse son los vecinos del ltimo tringulo aadido; solo si ninguno cabe se buscan entre
+     * los vecinos de todos sus vrtices. Un meshlet se cierra cuando llega a uno de los lmites o
+     * cuando no le queda ningn vecino libre que quepa, y el siguiente empieza en el primer
+     * tringulo libre en el orden original.
+     */
+    void Meshlets::build(const std::vector<Mesh_Arena::Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        meshlets.clear();
+
+        const std::size_t vertex_count   = vertices.size();
+        const std::size_t triangle_count = indices.size() / 3;
+
+        // Tringulos de cada vrtice, en formato compacto (offsets y lista):
+
+        std::vector<std::uint32_t> adjacency_offsets(vertex_count + 1, 0);
+        std::vector<std::uint32_t> adjacency(triangle_count * 3);
+
+        for (std::size_t i = 0; i < triangle_count * 3; ++i) adjacency_offsets[indices[i] + 1]++;
+
+        for (std::size_t v = 0; v < vertex_count; ++v) adjacency_offsets[v + 1] += adjacency_offsets[v];
+
+        {
+            std::vector<std::uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+
+            for (std::size_t i = 0; i < triangle_count * 3; ++i) adjacency[cursor[indices[i]]++] = std::uint32_t(i / 3);
+        }
+
+        std::vector<std::uint8_t>  used (triangle_count, 0);
+        std::vector<std::uint32_t> slots(vertex_count, NO_SLOT);     // Posicin del vrtice en el meshlet actual
+        std::vector<std::uint32_t> meshlet_vertices;
+        std::vector<std::uint32_t> candidates;
+        std::vector<GLuint>        reordered;
+
+        meshlet_vertices.reserve(MAX_VERTICES);
+        reordered       .reserve(triangle_count * 3);
+
+        // Vrtices nuevos que aadira un tringulo al meshlet actual:
+
+        auto new_vertices = [&] (std::uint32_t triangle)
+        {
+            return std::uint32_t(slots[indices[triangle * 3 + 0]] == NO_SLOT)
+                 + std::uint32_t(slots[indices[triangle * 3 + 1]] == NO_SLOT)
+                 + std::uint32_t(slots[indices[triangle * 3 + 2]] == NO_SLOT);
+        };
+
+        std::size_t seed = 0;
+
+        while (true)
+        {
+            while (seed < triangle_count && used[seed]) ++seed;
+
+            if (seed == triangle_count) break;
+
+            Meshlet meshlet{};
+
+            meshlet.first_index = GLuint(reordered.size());
+
+            glm::vec3     position_sum(0.f);
+            std::uint32_t triangle = std::uint32_t(seed);
+
+            meshlet_vertices.clear();
+
+            while (triangle != NO_SLOT)
+            {
+                // Se aade el tringulo y sus vrtices nuevos:
+
+                used[triangle] = 1;
+
+                for (unsigned corner = 0; corner < 3; ++corner)
+                {
+                    const GLuint index = indices[triangle * 3 + corner];
+
+                    reordered.push_back(index);
+
+                    if (slots[index] == NO_SLOT)
+                    {
+                        slots[index] = std::uint32_t(meshlet_vertices.size());
+                        meshlet_vertices.push_back(index);
+                        position_sum += get_position(vertices[index]);
+                    }
+                }
+
+                meshlet.index_count += 3;
+
+                if (std::size_t(meshlet.index_count) / 3 == MAX_TRIANGLES) break;
+
+                // Candidatos: los vecinos libres del tringulo recin aadido.
+
+                candidates.clear();
+
+                for (unsigned corner = 0; corner < 3; ++corner)
+                {
+                    const GLuint index = indices[triangle * 3 + corner];
+
+                    for (std::uint32_t a = adjacency_offsets[index]; a < adjacency_offsets[index + 1]; ++a)
+                    {
+                        if (!used[adjacency[a]]) candidates.push_back(adjacency[a]);
+                    }
+                }
+
+                const glm::vec3 centroid = position_sum / float(meshlet_vertices.size());
+
+                auto choose = [&] ()
+                {
+                    std::uint32_t best       = NO_SLOT;
+                    std::uint32_t best_added = 4;
+                    float         best_distance = 0.f;
+
+                    for (std::uint32_t candidate : candidates)
+                    {
+                        const std::uint32_t added = new_vertices(candidate);
+
+                        if (meshlet_vertices.size() + added > MAX_VERTICES || added > best_added) continue;
+
+                        const glm::vec3 offset = (get_position(vertices[indices[candidate * 3 + 0]])
+                                               +  get_position(vertices[indices[candidate * 3 + 1]])
+                                               +  get_position(vertices[indices[candidate * 3 + 2]])) / 3.f - centroid;
+
+                        const float distance = glm::dot(offset, offset);
+
+                        if (added < best_added || distance < best_distance)
+                        {
+                            best          = candidate;
+                            best_added    = added;
+                            best_distance = distance;
+                        }
+                    }
+
+                    return best;
+                };
+
+                triangle = choose();
+
+                // Si ninguno cabe, se buscan entre los vecinos de todo el meshlet:
+
+                if (triangle == NO_SLOT)
+                {
+                    candidates.clear();
+
+                    for (std::uint32_t index : meshlet_vertices)
+                    {
+                        for (std::uint32_t a = adjacency_offsets[index]; a < adjacency_offsets[index + 1]; ++a)
+                        {
+                            if (!used[adjacency[a]]) candidates.push_back(adjacency[a]);
+                        }
+                    }
+
+                    triangle = choose();
+                }
+            }
+
+            meshlet.vertex_count = std::uint32_t(meshlet_vertices.size());
+
+            for (std::uint32_t index : meshlet_vertices) slots[index] = NO_SLOT;
+
+            meshlets.push_back(meshlet);
+        }
+
+        indices.swap(reordered);
+
+        // Volmenes de cada meshlet y esferas como estructura de arrays:
+
+        const std::size_t padded = (meshlets.size() + Frustum::SIMD_WIDTH - 1) / Frustum::SIMD_WIDTH * Frustum::SIMD_WIDTH;
+
+        sphere_x     .assign(padded, 0.f);
+        sphere_y     .assign(padded, 0.f);
+        sphere_z     .assign(padded, 0.f);
+        sphere_radius.assign(padded, 0.f);
+        visibility   .assign(padded, 0);
+
+        for (std::size_t i = 0; i < meshlets.size(); ++i)
+        {
+            compute_bounds(meshlets[i], vertices, indices);
+
+            sphere_x     [i] = meshlets[i].center.x;
+            sphere_y     [i] = meshlets[i].center.y;
+            sphere_z     [i] = meshlets[i].center.z;
+            sphere_radius[i] = meshlets[i].radius;
+        }
+    }
+
+    /**
+     * @brief Calcula la esfera y el cono de normales de un meshlet.
+     *
+     * La esfera se centra en su caja. El eje del cono es la media de las normales unitarias de sus
+     * tringulos (con la cara delantera en sentido antihorario, como la de OpenGL) y su apertura la
+     * de la normal ms alejada del eje. Se guarda el seno del complementario de esa apertura: si
+     * el ngulo entre el eje y la direccin de la cmara al meshlet tiene un coseno mayor, la cmara
+     * ve todos los tringulos por detrs. Si alguna normal se aleja 90 grados o ms del eje el
+     * meshlet nunca se descarta por orientacin.
+     */
+    void Meshlets::compute_bounds(Meshlet & meshlet, const std::vector<Mesh_Arena::Vertex> & vertices, const std::vector<GLuint> & indices) const
+    {
+        const std::size_t first = meshlet.first_index;
+        const std::size_t end   = first + std::size_t(meshlet.index_count);
+
+        glm::vec3 min = get_position(vertices[indices[first]]);
+        glm::vec3 max = min;
+
+        for (std::size_t i = first; i < end; ++i)
+        {
+            min = glm::min(min, get_position(vertices[indices[i]]));
+            max = glm::max(max, get_position(vertices[indices[i]]));
+        }
+
+        meshlet.center = (min + max) * 0.5f;
+
+        float squared_radius = 0.f;
+
+        for (std::size_t i = first; i < end; ++i)
+        {
+            const glm::vec3 offset = get_position(vertices[indices[i]]) - meshlet.center;
+
+            squared_radius = std::max(squared_radius, glm::dot(offset, offset));
+        }
+
+        meshlet.radius = std::sqrt(squared_radius);
+
+        // Cono de normales (los tringulos degenerados no cuentan):
+
+        glm::vec3 normal_sum(0.f);
+
+        for (std::size_t i = first; i < end; i += 3)
+        {
+            const glm::vec3 a = get_position(vertices[indices[i + 0]]);
+            const glm::vec3 normal = glm::cross(get_position(vertices[indices[i + 1]]) - a, get_position(vertices[indices[i + 2]]) - a);
+            const float     length = glm::length(normal);
+
+            if (length > 0.f) normal_sum += normal / length;
+        }
+
+        const float sum_length = glm::length(normal_sum);
+
+        meshlet.cone_axis   = sum_length > 0.f ? normal_sum / sum_length : glm::vec3(0.f, 1.f, 0.f);
+        meshlet.cone_cutoff = 1.f;
+
+        if (sum_length == 0.f) return;
+
+        float min_cosine = 1.f;
+
+        for (std::size_t i = first; i < end; i += 3)
+        {
+            const glm::vec3 a = get_position(vertices[indices[i + 0]]);
+            const glm::vec3 normal = glm::cross(get_position(vertices[indices[i + 1]]) - a, get_position(vertices[indices[i + 2]]) - a);
+            const float     length = glm::length(normal);
+
+            if (length > 0.f) min_cosine = std::min(min_cosine, glm::dot(normal / length, meshlet.cone_axis));
+        }
+
+        if (min_cosine > 0.f) meshlet.cone_cutoff = std::sqrt(1.f - min_cosine * min_cosine);
+    }
+
+    /**
+     * @brief Calcula qu meshlets pueden verse.
+     *
+     * La prueba de orientacin usa el centro y el radio de la esfera, de modo que vale para cualquier
+     * punto del meshlet: se descarta si dot(centro - cmara, eje) >= corte * |centro - cmara| + radio.
+     */
+    std::size_t Meshlets::cull
+    (
+        const Frustum & frustum,
+        const glm::vec3 & camera_position,
+        bool back_face_culling,
+        std::vector<Index_Range> & ranges
+    )
+    {
+        ranges.clear();
+
+        frustum.cull_spheres
+        (
+            sphere_x.data(),
+            sphere_y.data(),
+            sphere_z.data(),
+            sphere_radius.data(),
+            visibility.size(),
+            visibility.data()
+        );
+
+        std::size_t visible_count = 0;
+
+        for (std::size_t i = 0; i < meshlets.size(); ++i)
+        {
+            if (!visibility[i]) continue;
+
+            const Meshlet & meshlet = meshlets[i];
+
+            if (back_face_culling)
+            {
+                const glm::vec3 offset = meshlet.center - camera_position;
+
+                if (glm::dot(offset, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(offset) + meshlet.radius) continue;
+            }
+
+            visible_count++;
+
+            if (!ranges.empty() && ranges.back().first_index + GLuint(ranges.back().index_count) == meshlet.first_index)
+                ranges.back().index_count += meshlet.index_count;
+            else
+                ranges.push_back({ meshlet.first_index, meshlet.index_count });
+        }
+
+        return visible_count;
+    }
+
+}
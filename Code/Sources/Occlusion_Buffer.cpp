@@ -0,0 +1,309 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Occlusion_Buffer.hpp"
+#include <algorithm>     // fill, min, max, swap
+#include <cmath>         // floor, ceil
+#include <xmmintrin.h>   // Intrnsecos de SSE
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Occlusion_Buffer.
+     *
+     * @param job_system Hilos entre los que se reparte la rasterizacin.
+     * @param width Ancho en pxeles.
+     * @param height Alto en pxeles.
+     */
+    Occlusion_Buffer::Occlusion_Buffer(Job_System & job_system, unsigned width, unsigned height)
+        : job_system(job_system), width((std::max(width, 4u) + 3) / 4 * 4), height(std::max(height, 1u)),
+          view_projection_matrix(1.f)
+    {
+        depth.assign(std::size_t(this->width) * this->height, 1.f);
+    }
+
+    /**
+     * @brief Aade un oclusor, guardando sus vrtices ya transformados al espacio del mundo.
+     */
+    void Occlusion_Buffer::add_occluder(const std::vector<glm::vec3> & vertices, const std::vector<std::uint32_t> & indices, const glm::mat4 & model_matrix)
+    {
+        const std::uint32_t base = std::uint32_t(occluder_vertices.size());
+
+        for (const glm::vec3 & vertex : vertices)
+        {
+            occluder_vertices.push_back(glm::vec3(model_matrix * glm::vec4(vertex, 1.f)));
+        }
+
+        for (std::uint32_t index : indices)
+        {
+            occluder_indices.push_back(base + index);
+        }
+    }
+
+    /**
+     * @brief Quita todos los oclusores.
+     */
+    void Occlusion_Buffer::clear_occluders()
+    {
+        occluder_vertices.clear();
+        occluder_indices .clear();
+    }
+
+    /**
+     * @brief Borra el buffer y rasteriza los oclusores.
+     *
+     * Primero se proyectan los vrtices (en paralelo por tramos) y despus cada hilo rasteriza una
+     * franja de filas completa.
+     *
+     * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+     */
+    void Occlusion_Buffer::render(const glm::mat4 & view_projection_matrix)
+    {
+        this->view_projection_matrix = view_projection_matrix;
+
+        screen_vertices.resize(occluder_vertices.size());
+
+        const float half_width  = 0.5f * float(width );
+        const float half_height = 0.5f * float(height);
+
+        job_system.parallel_for
+        (
+            occluder_vertices.size(), 1024,
+            [this, half_width, half_height] (std::size_t, std::size_t first, std::size_t end)
+            {
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    const glm::vec4 clip = this->view_projection_matrix * glm::vec4(occluder_vertices[i], 1.f);
+
+                    Screen_Vertex & vertex = screen_vertices[i];
+
+                    // Los vrtices por detrs del plano cercano invalidan sus tringulos:
+
+                    vertex.valid = clip.w > 1e-5f && clip.z >= -clip.w;
+
+                    if (vertex.valid)
+                    {
+                        const float inverse_w = 1.f / clip.w;
+
+                        vertex.x = (clip.x * inverse_w + 1.f) * half_width;
+                        vertex.y = (clip.y * inverse_w + 1.f) * half_height;
+                        vertex.z =  clip.z * inverse_w;
+                    }
+                }
+            }
+        );
+
+        const std::size_t band_count = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+        job_system.parallel_for
+        (
+            band_count, 1,
+            [this] (std::size_t, std::size_t first_band, std::size_t end_band)
+            {
+                for (std::size_t band = first_band; band < end_band; ++band)
+                {
+                    const unsigned first_row = unsigned(band) * BAND_HEIGHT;
+
+                    rasterize_band(first_row, std::min(first_row + BAND_HEIGHT, height));
+                }
+            }
+        );
+    }
+
+    /**
+     * @brief Borra las filas [first_row, end_row) y rasteriza en ellas todos los tringulos.
+     */
+    void Occlusion_Buffer::rasterize_band(unsigned first_row, unsigned end_row)
+    {
+        std::fill(depth.begin() + std::size_t(first_row) * width, depth.begin() + std::size_t(end_row) * width, 1.f);
+
+        for (std::size_t i = 0; i + 2 < occluder_indices.size(); i += 3)
+        {
+            const Screen_Vertex & a = screen_vertices[occluder_indices[i    ]];
+            const Screen_Vertex & b = screen_vertices[occluder_indices[i + 1]];
+            const Screen_Vertex & c = screen_vertices[occluder_indices[i + 2]];
+
+            if (a.valid && b.valid && c.valid)
+            {
+                rasterize_triangle(a, b, c, first_row, end_row);
+            }
+        }
+    }
+
+    /**
+     * @brief Rasteriza un tringulo en las filas [first_row, end_row) de cuatro en cuatro pxeles.
+     *
+     * Un pxel est cubierto si su centro est dentro de las tres aristas. La profundidad es la del
+     * plano del tringulo en el centro del pxel y se queda la menor (la ms cercana). Se rasterizan
+     * las dos caras, as que el tringulo se orienta antes en sentido antihorario.
+     */
+    void Occlusion_Buffer::rasterize_triangle(const Screen_Vertex & a, const Screen_Vertex & b_in, const Screen_Vertex & c_in, unsigned first_row, unsigned end_row)
+    {
+        const Screen_Vertex * b = &b_in;
+        const Screen_Vertex * c = &c_in;
+
+        float area = (b->x - a.x) * (c->y - a.y) - (b->y - a.y) * (c->x - a.x);
+
+        if (area == 0.f) return;
+
+        if (area < 0.f)
+        {
+            std::swap(b, c);
+            area = -area;
+        }
+
+        // Rectngulo de pxeles candidatos, recortado a la franja y al buffer:
+
+        const float min_x = std::min({ a.x, b->x, c->x });
+        const float max_x = std::max({ a.x, b->x, c->x });
+        const float min_y = std::min({ a.y, b->y, c->y });
+        const float max_y = std::max({ a.y, b->y, c->y });
+
+        const int first_x = std::max(int(std::floor(min_x)), 0);
+        const int end_x   = std::min(int(std::ceil (max_x)), int(width));
+        const int first_y = std::max(int(std::floor(min_y)), int(first_row));
+        const int end_y   = std::min(int(std::ceil (max_y)), int(end_row));
+
+        if (first_x >= end_x || first_y >= end_y) return;
+
+        // Funciones de arista E(x, y) = Ax + By + C, positivas dentro del tringulo. C se calcula
+        // con la suma de los dos extremos para que, en una arista compartida, la funcin de un
+        // tringulo sea exactamente la opuesta de la del otro y no queden pxeles sin cubrir entre ellos:
+
+        const Screen_Vertex * vertices[3] = { &a, b, c };
+
+        float edge_a[3], edge_b[3], edge_c[3];
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const Screen_Vertex & from = *vertices[i];
+            const Screen_Vertex & to   = *vertices[(i + 1) % 3];
+
+            edge_a[i] = from.y - to.y;
+            edge_b[i] = to.x - from.x;
+            edge_c[i] = -0.5f * (edge_a[i] * (from.x + to.x) + edge_b[i] * (from.y + to.y));
+        }
+
+        // Plano de la profundidad: z = z0 + dz/dx(x - x0) + dz/dy(y - y0)
+
+        const float dz1 = b->z - a.z;
+        const float dz2 = c->z - a.z;
+        const float depth_dx = (dz1 * (c->y - a.y) - dz2 * (b->y - a.y)) / area;
+        const float depth_dy = (dz2 * (b->x - a.x) - dz1 * (c->x - a.x)) / area;
+
+        const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);   // Centros de los cuatro pxeles
+        const __m128 zero         = _mm_setzero_ps();
+
+        const int aligned_first_x = first_x & ~3;
+
+        for (int y = first_y; y < end_y; ++y)
+        {
+            const float center_y = float(y) + 0.5f;
+
+            float * row = depth.data() + std::size_t(y) * width;
+
+            for (int x = aligned_first_x; x < end_x; x += 4)
+            {
+                const __m128 center_x = _mm_add_ps(_mm_set1_ps(float(x)), lane_offsets);
+
+                __m128 inside = _mm_cmpeq_ps(zero, zero);
+
+                for (int i = 0; i < 3; ++i)
+                {
+                    const __m128 edge = _mm_add_ps
+                    (
+                        _mm_mul_ps(_mm_set1_ps(edge_a[i]), center_x),
+                        _mm_set1_ps(edge_b[i] * center_y + edge_c[i])
+                    );
+
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, zero));
+                }
+
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                const __m128 pixel_depth = _mm_add_ps
+                (
+                    _mm_set1_ps(a.z + depth_dy * (center_y - a.y)),
+                    _mm_mul_ps(_mm_set1_ps(depth_dx), _mm_sub_ps(center_x, _mm_set1_ps(a.x)))
+                );
+
+                const __m128 old_depth = _mm_loadu_ps(row + x);
+                const __m128 new_depth = _mm_min_ps(old_depth, pixel_depth);
+
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+            }
+        }
+    }
+
+    /**
+     * @brief Indica si alguna parte de una caja puede verse por delante de los oclusores.
+     *
+     * Se proyectan las ocho esquinas y se busca en el rectngulo de pxeles que cubren alguno cuyo
+     * oclusor no est ms cerca que la esquina ms cercana. Los pxeles se comparan de cuatro en
+     * cuatro y la bsqueda termina en cuanto aparece uno.
+     */
+    bool Occlusion_Buffer::is_visible(const glm::vec3 & min, const glm::vec3 & max, const glm::mat4 & model_matrix) const
+    {
+        const glm::mat4 matrix = view_projection_matrix * model_matrix;
+
+        float min_x =  1e30f, min_y =  1e30f, nearest = 1e30f;
+        float max_x = -1e30f, max_y = -1e30f;
+
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec4 clip = matrix * glm::vec4
+            (
+                corner & 1 ? max.x : min.x,
+                corner & 2 ? max.y : min.y,
+                corner & 4 ? max.z : min.z,
+                1.f
+            );
+
+            // Si la caja cruza el plano cercano no se puede proyectar de forma fiable:
+
+            if (clip.w <= 1e-5f || clip.z < -clip.w) return true;
+
+            const float inverse_w = 1.f / clip.w;
+            const float x = (clip.x * inverse_w + 1.f) * 0.5f * float(width );
+            const float y = (clip.y * inverse_w + 1.f) * 0.5f * float(height);
+
+            min_x   = std::min(min_x, x);
+            max_x   = std::max(max_x, x);
+            min_y   = std::min(min_y, y);
+            max_y   = std::max(max_y, y);
+            nearest = std::min(nearest, clip.z * inverse_w);
+        }
+
+        const int first_x = std::max(int(std::floor(min_x)), 0);
+        const int end_x   = std::min(int(std::ceil (max_x)), int(width ));
+        const int first_y = std::max(int(std::floor(min_y)), 0);
+        const int end_y   = std::min(int(std::ceil (max_y)), int(height));
+
+        if (first_x >= end_x || first_y >= end_y) return false;         // Fuera de la pantalla
+
+        const __m128 lane_x       = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+        const __m128 box_depth    = _mm_set1_ps(nearest);
+        const __m128 column_first = _mm_set1_ps(float(first_x));
+        const __m128 column_end   = _mm_set1_ps(float(end_x));
+
+        const int aligned_first_x = first_x & ~3;
+
+        for (int y = first_y; y < end_y; ++y)
+        {
+            const float * row = depth.data() + std::size_t(y) * width;
+
+            for (int x = aligned_first_x; x < end_x; x += 4)
+            {
+                const __m128 column  = _mm_add_ps(_mm_set1_ps(float(x)), lane_x);
+                const __m128 covered = _mm_and_ps(_mm_cmpge_ps(column, column_first), _mm_cmplt_ps(column, column_end));
+                const __m128 behind  = _mm_cmpge_ps(_mm_loadu_ps(row + x), box_depth);
+
+                if (_mm_movemask_ps(_mm_and_ps(covered, behind)) != 0) return true;
+            }
+        }
+
+        return false;
+    }
+
+}
@@ -0,0 +1,192 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Occlusion_Queries.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include "../Headers/Mesh_Arena.hpp"
+#include <gtc/matrix_transform.hpp>         // translate, scale
+
+namespace udit
+{
+
+    // Las cajas solo escriben en las consultas, as que el fragment shader no produce nada:
+
+    const std::string Occlusion_Queries::vertex_shader_code =
+
+        "#version 330\n"
+        ""
+        "layout (location = 0) in vec3 vertex_coordinates;"
+        ""
+        "uniform mat4 clip_matrix;"
+        ""
+        "void main()"
+        "{"
+        "   gl_Position = clip_matrix * vec4(vertex_coordinates, 1.0);"
+        "}";
+
+    const std::string Occlusion_Queries::fragment_shader_code =
+
+        "#version 330\n"
+        ""
+        "void main()"
+        "{"
+        "}";
+
+    /**
+     * @brief Constructor de la clase Occlusion_Queries.
+     *
+     * El contador de frames empieza en 1 para que ninguna consulta sin emitir (frame 0) parezca
+     * del frame anterior.
+     *
+     * @param box_mesh Cubo de -1 a 1 guardado en la arena de mallas.
+     */
+    Occlusion_Queries::Occlusion_Queries(const Mesh & box_mesh)
+        : program(vertex_shader_code, fragment_shader_code), box_mesh(box_mesh),
+          query_target(OpenGL_Extensions::supports_conservative_occlusion() ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED),
+          view_projection_matrix(1.f), frame(1), hit_count(0), miss_count(0), pending_count(0)
+    {
+        clip_matrix_uniform = program.get_uniform< glm::mat4 >("clip_matrix");
+    }
+
+    /**
+     * @brief Destructor de la clase Occlusion_Queries.
+     */
+    Occlusion_Queries::~Occlusion_Queries()
+    {
+        for (Object_State & object : objects)
+        {
+            if (object.query_ids[0]) glDeleteQueries(2, object.query_ids);
+        }
+    }
+
+    /**
+     * @brief Empieza un frame.
+     * @param view_projection_matrix Producto de la proyeccin por la vista de la cmara.
+     */
+    void Occlusion_Queries::begin_frame(const glm::mat4 & view_projection_matrix)
+    {
+        this->view_projection_matrix = view_projection_matrix;
+
+        frame++;
+
+        boxes.clear();
+
+        hit_count = miss_count = pending_count = 0;
+    }
+
+    /**
+     * @brief Pide la consulta de un objeto para el frame actual.
+     *
+     * Si el objeto no se consult en el frame anterior (estaba fuera del volumen de visin o su caja
+     * cruzaba el plano cercano) no se sabe si est tapado y se da por visible. Si la consulta del
+     * frame anterior an no ha terminado se conserva la visibilidad que tena.
+     */
+    GLuint Occlusion_Queries::request(std::uint32_t object_id, const Bounds & bounds, const glm::mat4 & model_matrix, bool & hidden)
+    {
+        if (object_id >= objects.size()) objects.resize(std::size_t(object_id) + 1);
+
+        Object_State & object = objects[object_id];
+
+        const unsigned current  = unsigned( frame      & 1);
+        const unsigned previous = unsigned((frame - 1) & 1);
+
+        if (object.issued_frame[previous] == frame - 1)
+        {
+            GLuint available = GL_FALSE;
+
+            glGetQueryObjectuiv(object.query_ids[previous], GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if (available)
+            {
+                GLuint any_samples_passed = GL_FALSE;
+
+                glGetQueryObjectuiv(object.query_ids[previous], GL_QUERY_RESULT, &any_samples_passed);
+
+                object.visible = any_samples_passed != GL_FALSE;
+
+                if (object.visible) hit_count++; else miss_count++;
+            }
+            else
+                pending_count++;
+        }
+        else
+            object.visible = true;
+
+        // La caja de la malla se lleva al cubo de -1 a 1 de la arena:
+
+        const glm::vec3 box_center = (bounds.min + bounds.max) * 0.5f;
+        const glm::vec3 box_half   = glm::max((bounds.max - bounds.min) * 0.5f, glm::vec3(1e-4f));
+
+        const glm::mat4 clip_matrix = glm::scale(glm::translate(view_projection_matrix * model_matrix, box_center), box_half);
+
+        // Si alguna esquina queda detrs del plano cercano la caja se recortara y la consulta podra
+        // no ver un objeto que rodea a la cmara:
+
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec4 clip = clip_matrix * glm::vec4
+            (
+                corner & 1 ? 1.f : -1.f,
+                corner & 2 ? 1.f : -1.f,
+                corner & 4 ? 1.f : -1.f,
+                1.f
+            );
+
+            if (clip.w <= 1e-5f || clip.z < -clip.w)
+            {
+                object.visible = true;
+                hidden         = false;
+                return 0;
+            }
+        }
+
+        if (object.query_ids[0] == 0) glGenQueries(2, object.query_ids);
+
+        object.issued_frame[current] = frame;
+
+        boxes.push_back({ object.query_ids[current], clip_matrix });
+
+        hidden = !object.visible;
+
+        return object.query_ids[current];
+    }
+
+    /**
+     * @brief Emite las consultas pedidas en el frame.
+     *
+     * Las cajas se dibujan rellenas y sin descartar caras (el sentido de los tringulos del cubo de
+     * la arena no es uniforme), sin escribir color ni profundidad para que no tapen nada. Los cambios de estado pasan
+     * por la cach de OpenGL, por lo que la cola que dibuja a continuacin los restablece.
+     */
+    void Occlusion_Queries::issue()
+    {
+        if (boxes.empty()) return;
+
+        OpenGL_State & state = OpenGL_State::instance();
+
+        program.use();
+
+        state.bind_vertex_array(box_mesh.vao_id);
+        state.set_polygon_mode (GL_FILL);
+        state.set_cull_face    (false);
+        state.set_blend        (false);
+        state.set_color_write  (false);
+        state.set_depth_write  (false);
+
+        for (const Box & box : boxes)
+        {
+            program.set(clip_matrix_uniform, box.clip_matrix);
+
+            glBeginQuery(query_target, box.query_id);
+
+            Mesh_Arena::draw(box_mesh);
+
+            glEndQuery(query_target);
+        }
+
+        state.set_color_write(true);
+        state.set_depth_write(true);
+    }
+
+}
@@ -0,0 +1,104 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <cstring>       // strcmp
+#include <iostream>      // cout
+#include <SDL.h>         // SDL_GL_GetProcAddress
+
+namespace udit
+{
+
+    OpenGL_Extensions::Buffer_Storage_Function              OpenGL_Extensions::buffer_storage               = nullptr;
+    OpenGL_Extensions::Multi_Draw_Elements_Indirect_Function OpenGL_Extensions::multi_draw_elements_indirect = nullptr;
+    OpenGL_Extensions::Dispatch_Compute_Function            OpenGL_Extensions::dispatch_compute             = nullptr;
+    OpenGL_Extensions::Memory_Barrier_Function              OpenGL_Extensions::memory_barrier               = nullptr;
+    OpenGL_Extensions::Bind_Image_Texture_Function          OpenGL_Extensions::bind_image_texture           = nullptr;
+
+    GLint OpenGL_Extensions::context_major_version    = 0;
+    GLint OpenGL_Extensions::context_minor_version    = 0;
+    bool  OpenGL_Extensions::buffer_storage_supported = false;
+    bool  OpenGL_Extensions::multi_draw_indirect_supported = false;
+    bool  OpenGL_Extensions::shader_storage_supported      = false;
+    bool  OpenGL_Extensions::conservative_occlusion_supported = false;
+    bool  OpenGL_Extensions::compute_supported                = false;
+
+    /**
+     * @brief Obtiene un puntero a funcin de OpenGL del contexto actual.
+     */
+    template< typename FUNCTION >
+    static bool load_function(FUNCTION & function, const char * name)
+    {
+        function = reinterpret_cast< FUNCTION >(SDL_GL_GetProcAddress(name));
+
+        return function != nullptr;
+    }
+
+    /**
+     * @brief Carga las funciones disponibles en el contexto actual.
+     *
+     * Se informa por consola de la versin del contexto y de qu caminos opcionales se usarn.
+     */
+    void OpenGL_Extensions::load()
+    {
+        glGetIntegerv(GL_MAJOR_VERSION, &context_major_version);
+        glGetIntegerv(GL_MINOR_VERSION, &context_minor_version);
+
+        buffer_storage_supported =
+            (has_version(4, 4) || has_extension("GL_ARB_buffer_storage")) &&
+            load_function(buffer_storage, "glBufferStorage");
+
+        multi_draw_indirect_supported =
+            (has_version(4, 3) || (has_extension("GL_ARB_multi_draw_indirect") && has_extension("GL_ARB_base_instance"))) &&
+            load_function(multi_draw_elements_indirect, "glMultiDrawElementsIndirect");
+
+        shader_storage_supported = has_version(4, 3);
+
+        conservative_occlusion_supported = has_version(4, 3) || has_extension("GL_ARB_ES3_compatibility");
+
+        compute_supported =
+            has_version(4, 3) &&
+            load_function(dispatch_compute,   "glDispatchCompute" ) &&
+            load_function(memory_barrier,     "glMemoryBarrier"   ) &&
+            load_function(bind_image_texture, "glBindImageTexture");
+
+        std::cout << "Contexto OpenGL " << context_major_version << "." << context_minor_version
+                  << (buffer_storage_supported      ? " con" : " sin") << " buffers persistentes,"
+                  << (multi_draw_indirect_supported ? " con" : " sin") << " multi-draw indirect,"
+                  << (shader_storage_supported      ? " con" : " sin") << " SSBOs,"
+                  << (conservative_occlusion_supported ? " con" : " sin") << " consultas de oclusion conservadoras,"
+                  << (compute_supported             ? " con" : " sin") << " compute shaders" << std::endl;
+    }
+
+    /**
+     * @brief Indica si el contexto es al menos de la versin indicada.
+     */
+    bool OpenGL_Extensions::has_version(GLint major, GLint minor)
+    {
+        return context_major_version > major || (context_major_version == major && context_minor_version >= minor);
+    }
+
+    /**
+     * @brief Indica si el contexto anuncia una extensin.
+     *
+     * En el perfil core la lista de extensiones se recorre una a una con glGetStringi.
+     *
+     * @param name Nombre completo de la extensin.
+     */
+    bool OpenGL_Extensions::has_extension(const char * name)
+    {
+        GLint extension_count = 0;
+
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+
+        for (GLint i = 0; i < extension_count; ++i)
+        {
+            const GLubyte * extension = glGetStringi(GL_EXTENSIONS, GLuint(i));
+
+            if (extension && std::strcmp(reinterpret_cast<const char *>(extension), name) == 0) return true;
+        }
+
+        return false;
+    }
+
+}
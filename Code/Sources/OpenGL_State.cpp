@@ -0,0 +1,204 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/OpenGL_State.hpp"
+#include <cassert>       // assert
+
+namespace udit
+{
+
+    /**
+     * @brief Devuelve la copia del estado del contexto de OpenGL.
+     *
+     * Se crea la primera vez que se pide, con todo el estado marcado como desconocido.
+     */
+    OpenGL_State & OpenGL_State::instance()
+    {
+        static OpenGL_State state;
+        return state;
+    }
+
+    /**
+     * @brief Constructor de la clase OpenGL_State.
+     */
+    OpenGL_State::OpenGL_State()
+        : issued_calls(0), skipped_calls(0), last_issued_calls(0), last_skipped_calls(0)
+    {
+        invalidate();
+    }
+
+    /**
+     * @brief Marca todo el estado como desconocido.
+     */
+    void OpenGL_State::invalidate()
+    {
+        program_id          = UNKNOWN_NAME;
+        vao_id              = UNKNOWN_NAME;
+        active_texture_unit = UNKNOWN_ENUM;
+
+        for (auto & unit : texture_ids)
+        {
+            for (GLuint & texture_id : unit) texture_id = UNKNOWN_NAME;
+        }
+
+        cull_face           = UNKNOWN_FLAG;
+        blend               = UNKNOWN_FLAG;
+        depth_test          = UNKNOWN_FLAG;
+        color_write         = UNKNOWN_FLAG;
+        depth_write         = UNKNOWN_FLAG;
+        blend_source        = UNKNOWN_ENUM;
+        blend_destination   = UNKNOWN_ENUM;
+        depth_func          = UNKNOWN_ENUM;
+        polygon_mode        = UNKNOWN_ENUM;
+    }
+
+    /**
+     * @brief Cierra la cuenta de llamadas del frame anterior y empieza la del nuevo.
+     */
+    void OpenGL_State::begin_frame()
+    {
+        last_issued_calls  = issued_calls;
+        last_skipped_calls = skipped_calls;
+        issued_calls       = 0;
+        skipped_calls      = 0;
+    }
+
+    /**
+     * @brief Activa un programa de shaders si no es el activo.
+     */
+    void OpenGL_State::use_program(GLuint new_program_id)
+    {
+        if (change(program_id, new_program_id)) glUseProgram(new_program_id);
+    }
+
+    /**
+     * @brief Vincula un VAO si no es el vinculado.
+     */
+    void OpenGL_State::bind_vertex_array(GLuint new_vao_id)
+    {
+        if (change(vao_id, new_vao_id)) glBindVertexArray(new_vao_id);
+    }
+
+    /**
+     * @brief Vincula una textura a una unidad de textura si no lo est ya.
+     *
+     * La unidad activa solo se cambia cuando hay que vincular algo en ella.
+     *
+     * @param unit Unidad de textura.
+     * @param target Tipo de textura.
+     * @param texture_id Textura que se vincula.
+     */
+    void OpenGL_State::bind_texture(unsigned unit, GLenum target, GLuint texture_id)
+    {
+        assert(unit < TEXTURE_UNIT_COUNT);
+
+        int target_index;
+
+        switch (target)
+        {
+            case GL_TEXTURE_2D:       target_index = TEXTURE_2D_TARGET;       break;
+            case GL_TEXTURE_2D_ARRAY: target_index = TEXTURE_2D_ARRAY_TARGET; break;
+            case GL_TEXTURE_CUBE_MAP: target_index = TEXTURE_CUBE_MAP_TARGET; break;
+            default:
+                assert(false);
+                return;
+        }
+
+        if (texture_ids[unit][target_index] == texture_id)
+        {
+            skipped_calls++;
+            return;
+        }
+
+        if (change(active_texture_unit, GLenum(GL_TEXTURE0 + unit))) glActiveTexture(GL_TEXTURE0 + unit);
+
+        texture_ids[unit][target_index] = texture_id;
+        issued_calls++;
+
+        glBindTexture(target, texture_id);
+    }
+
+    /**
+     * @brief Activa o desactiva una capacidad de OpenGL (glEnable/glDisable) si es necesario.
+     */
+    void OpenGL_State::set_capability(int & current, GLenum capability, bool enabled)
+    {
+        if (change(current, int(enabled)))
+        {
+            if (enabled) glEnable(capability); else glDisable(capability);
+        }
+    }
+
+    void OpenGL_State::set_cull_face(bool enabled)
+    {
+        set_capability(cull_face, GL_CULL_FACE, enabled);
+    }
+
+    void OpenGL_State::set_blend(bool enabled)
+    {
+        set_capability(blend, GL_BLEND, enabled);
+    }
+
+    void OpenGL_State::set_depth_test(bool enabled)
+    {
+        set_capability(depth_test, GL_DEPTH_TEST, enabled);
+    }
+
+    /**
+     * @brief Cambia la funcin de mezcla si no es la actual.
+     */
+    void OpenGL_State::set_blend_func(GLenum source, GLenum destination)
+    {
+        if (blend_source == source && blend_destination == destination)
+        {
+            skipped_calls++;
+            return;
+        }
+
+        blend_source      = source;
+        blend_destination = destination;
+        issued_calls++;
+
+        glBlendFunc(source, destination);
+    }
+
+    /**
+     * @brief Cambia la funcin del test de profundidad si no es la actual.
+     */
+    void OpenGL_State::set_depth_func(GLenum function)
+    {
+        if (change(depth_func, function)) glDepthFunc(function);
+    }
+
+    /**
+     * @brief Activa o desactiva la escritura de color si es necesario.
+     */
+    void OpenGL_State::set_color_write(bool enabled)
+    {
+        if (change(color_write, int(enabled)))
+        {
+            const GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+
+            glColorMask(mask, mask, mask, mask);
+        }
+    }
+
+    /**
+     * @brief Activa o desactiva la escritura de profundidad si es necesario.
+     */
+    void OpenGL_State::set_depth_write(bool enabled)
+    {
+        if (change(depth_write, int(enabled))) glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+
+    /**
+     * @brief Cambia el modo de relleno de los polgonos si no es el actual.
+     *
+     * Solo se sigue el modo de GL_FRONT_AND_BACK, que es el nico que admite el perfil core.
+     */
+    void OpenGL_State::set_polygon_mode(GLenum mode)
+    {
+        if (change(polygon_mode, mode)) glPolygonMode(GL_FRONT_AND_BACK, mode);
+    }
+
+}
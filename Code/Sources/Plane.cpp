@@ -2,6 +2,7 @@
 // davidbercialblazquez@gmail.com
 
 #include "../Headers/Plane.hpp"
+#include "../Headers/OpenGL_State.hpp"
 
 namespace udit
 {
@@ -17,7 +18,8 @@ namespace udit
      * @param width El nmero de segmentos en el eje X (ancho) del plano.
      * @param height El nmero de segmentos en el eje Y (alto) del plano.
      */
-    Plane::Plane(int width, int height)
+    Plane::Plane(Mesh_Arena & arena, int width, int height)
+        : arena(arena)
     {
         // Generar los vrtices del plano y sus colores:
         for (int y = 0; y <= height; ++y)  // Itera a lo largo del eje Y
@@ -63,65 +65,52 @@ namespace udit
             }
         }
 
-        // Crear y configurar los buffers de OpenGL:
-        glGenBuffers(VBO_COUNT, vbo_ids);  // Crear los VBOs
-        glGenVertexArrays(1, &vao_id);     // Crear el VAO (Vertex Array Object)
-
-        glBindVertexArray(vao_id);  // Vincular el VAO
-
-        // Coordenadas de los vrtices (VBO)
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[COORDINATES_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, coordinates.size() * sizeof(GLfloat), coordinates.data(), GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(0);  // Activar el atributo para las coordenadas
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);  // Establecer el puntero a las coordenadas
-
-        // Colores (VBO)
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[COLORS_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(GLfloat), colors.data(), GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(1);  // Activar el atributo para los colores
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);  // Establecer el puntero a los colores
-
-        // Coordenadas UV (VBO)
-        glBindBuffer(GL_ARRAY_BUFFER, vbo_ids[UVS_VBO]);
-        glBufferData(GL_ARRAY_BUFFER, uvs.size() * sizeof(GLfloat), uvs.data(), GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(2);  // Activar el atributo para las coordenadas UV
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);  // Establecer el puntero a las coordenadas UV
-
-        // ndices (EBO)
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_ids[INDICES_EBO]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLubyte), indices.data(), GL_STATIC_DRAW);
-
-        glBindVertexArray(0);  // Desvincular el VAO
+        // Subir la geometra a la arena de mallas compartida:
+        mesh = arena.allocate
+        (
+            coordinates.data(), colors.data(), uvs.data(), coordinates.size() / 3,
+            indices, GL_FILL, false
+        );
     }
 
     /**
      * @brief Destructor de la clase Plane.
      *
-     * Elimina los buffers de OpenGL (VAO, VBOs, EBO) cuando el objeto Plane es destruido.
+     * Devuelve a la arena de mallas el espacio ocupado por el plano.
      */
     Plane::~Plane()
     {
-        glDeleteVertexArrays(1, &vao_id);  // Eliminar el VAO
-        glDeleteBuffers(VBO_COUNT, vbo_ids);  // Eliminar los VBOs y EBO
+        arena.release(mesh);  // Devolver a la arena el espacio ocupado por el plano
     }
 
     /**
      * @brief Renderiza el plano en la escena.
      *
-     * Este mtodo utiliza los buffers de OpenGL (VAO, VBOs, EBO) para dibujar el plano en la escena.
+     * Este mtodo utiliza el rango de la arena de mallas que ocupa el plano para dibujarlo en la escena.
      * Los ndices de los tringulos son usados para renderizar la malla del plano.
      */
     void Plane::render()
     {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);  // Dibujar el plano con relleno (no contornos)
-        glDisable(GL_CULL_FACE);  // Desactivar el culling para que el plano sea visible desde ambos lados
+        OpenGL_State & state = OpenGL_State::instance();
 
-        glBindVertexArray(vao_id);  // Vincular el VAO
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_BYTE, 0);  // Dibujar los tringulos usando los ndices
-        glBindVertexArray(0);  // Desvincular el VAO
+        state.set_polygon_mode(GL_FILL);  // Dibujar el plano con relleno (no contornos)
+        state.set_cull_face(false);  // Desactivar el culling para que el plano sea visible desde ambos lados
+
+        state.bind_vertex_array(mesh.vao_id);  // Vincular el VAO de la arena (se queda vinculado)
+        Mesh_Arena::draw(mesh);  // Dibujar los tringulos de la malla con su vrtice base
+    }
+
+    /**
+     * @brief Devuelve la descripcin de la malla del plano.
+     *
+     * Recoge el mismo estado que establece render() para que la cola de render pueda dibujar el plano
+     * sin llamar a este mtodo.
+     *
+     * @return Mesh La descripcin de la malla.
+     */
+    Mesh Plane::get_mesh() const
+    {
+        return mesh;
     }
 
 }
@@ -0,0 +1,889 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Render_Queue.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <algorithm>                        // copy, fill_n, find
+#include <bit>                              // bit_cast
+#include <cstddef>                          // ptrdiff_t
+#include <cstdint>                          // uintptr_t
+#include <cstring>                          // memcpy
+#include <utility>                          // swap
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Render_Queue.
+     *
+     * El buffer indirecto solo se crea si se pide y el contexto admite multi-draw indirect; si no,
+     * la cola emite una llamada instanciada por grupo como en OpenGL 3.3.
+     *
+     * @param job_system Hilos entre los que se reparte el trabajo de CPU de cada frame.
+     * @param use_multi_draw_indirect Indica si se quiere usar multi-draw indirect cuando est disponible.
+     */
+    Render_Queue::Render_Queue(Job_System & job_system, bool use_multi_draw_indirect)
+        : job_system(job_system), pulling_program(nullptr), pulling_vertex_buffer_id(0),
+          visible_count(0), culled_count(0), occluded_count(0), small_count(0), draw_call_count(0),
+          occlusion_queries(nullptr), query_batch(0), gpu_culling(nullptr)
+    {
+        // Los segmentos del buffer indirecto se alinean a 256 bytes para que el descarte en la GPU
+        // pueda vincular los comandos del frame como SSBO:
+
+        if (use_multi_draw_indirect && OpenGL_Extensions::supports_multi_draw_indirect())
+        {
+            indirect_buffer = std::make_unique< Ring_Buffer >
+            (
+                GL_DRAW_INDIRECT_BUFFER,
+                256 * sizeof(Draw_Elements_Indirect_Command),
+                256
+            );
+        }
+    }
+
+    /**
+     * @brief Hace que los dibujos con el programa indicado lean sus vrtices con vertex pulling.
+     *
+     * Los dibujos indirectos no pueden indicar al shader su instancia base, por lo que con vertex
+     * pulling se prescinde del buffer indirecto.
+     *
+     * @param program Programa de shaders con vertex pulling.
+     * @param vertex_buffer_id Buffer con los vrtices.
+     */
+    void Render_Queue::enable_vertex_pulling(Shader_Program & program, GLuint vertex_buffer_id)
+    {
+        pulling_program          = &program;
+        pulling_vertex_buffer_id = vertex_buffer_id;
+        base_instance_uniform    = program.get_uniform< GLint >("base_instance");
+
+        indirect_buffer.reset();
+    }
+
+    /**
+     * @brief Empaqueta pasada, programa, textura, malla y profundidad en una clave de 64 bits.
+     *
+     * @return La clave con la que se ordena el dibujo.
+     */
+    std::uint64_t Render_Queue::make_sort_key(Render_Pass pass, GLuint program_id, GLuint texture_id, std::uint32_t mesh_id, float depth)
+    {
+        // Los flotantes positivos conservan su orden si se comparan como enteros, as que basta con
+        // quedarse con los bits altos de su representacin. Lo que queda detrs de la cmara va al principio.
+        std::uint32_t depth_bits = depth > 0.f ? std::bit_cast<std::uint32_t>(depth) >> 6 : 0u;
+
+        const std::uint64_t pass_bits  = (std::uint64_t(static_cast<std::uint8_t>(pass)) & 0xF) << 60;
+        const std::uint64_t state_bits = (std::uint64_t(program_id) & 0x3FF) << 24
+                                       | (std::uint64_t(texture_id) & 0xFFF) << 12
+                                       | (std::uint64_t(mesh_id)    & 0xFFF);
+
+        // Los transparentes se ordenan primero por profundidad invertida (de atrs hacia delante):
+
+        if (pass == Render_Pass::TRANSPARENT_PASS)
+        {
+            return pass_bits | (std::uint64_t(~depth_bits & 0x3FFFFFF) << 34) | state_bits;
+        }
+
+        return pass_bits | (state_bits << 26) | (std::uint64_t(depth_bits) & 0x3FFFFFF);
+    }
+
+    /**
+     * @brief Vaca la cola al comienzo del frame.
+     *
+     * Se conservan las reservas de memoria de los vectores para no volver a pedir memoria cada frame.
+     *
+     * @param view_matrix Matriz de vista del frame.
+     */
+    void Render_Queue::begin_frame(const glm::mat4 & view_matrix)
+    {
+        this->view_matrix = view_matrix;
+
+        items.clear();
+        keys .clear();
+
+        occluded_count    = 0;
+        small_count       = 0;
+        occlusion_queries = nullptr;
+        gpu_culling       = nullptr;
+    }
+
+    /**
+     * @brief Aade un dibujo a la cola.
+     *
+     * @param item Dibujo que se aade.
+     */
+    void Render_Queue::submit(const Draw_Item & item)
+    {
+        items.push_back(item);
+    }
+
+    /**
+     * @brief Quita de la cola los dibujos que quedan fuera del volumen de visin.
+     *
+     * Las esferas se calculan y se comprueban en paralelo por tramos de grupos de cuatro dibujos,
+     * de modo que cada tramo empieza en un mltiplo de Frustum::SIMD_WIDTH. Los arrays se rellenan
+     * hasta ese mltiplo con esferas que no se tienen en cuenta.
+     *
+     * @param frustum Volumen de visin de la cmara en este frame.
+     */
+    void Render_Queue::cull(const Frustum & frustum)
+    {
+        constexpr std::size_t width = Frustum::SIMD_WIDTH;
+
+        const std::size_t count       = items.size();
+        const std::size_t group_count = (count + width - 1) / width;
+        const std::size_t padded      = group_count * width;
+
+        sphere_x     .resize(padded);
+        sphere_y     .resize(padded);
+        sphere_z     .resize(padded);
+        sphere_radius.resize(padded);
+        visibility   .resize(padded);
+
+        job_system.parallel_for
+        (
+            group_count, ITEMS_PER_RANGE / width,
+            [this, &frustum, count] (std::size_t, std::size_t first_group, std::size_t end_group)
+            {
+                const std::size_t first = first_group * width;
+                const std::size_t end   = end_group   * width;
+
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    if (i >= count)
+                    {
+                        sphere_x[i] = sphere_y[i] = sphere_z[i] = sphere_radius[i] = 0.f;
+                        continue;
+                    }
+
+                    const Draw_Item & item   = items[i];
+                    const Bounds    & bounds = item.mesh.bounds;
+                    const glm::vec3   center = glm::vec3(item.model_matrix * glm::vec4(bounds.center, 1.f));
+
+                    const float scale = glm::sqrt(glm::max
+                    (
+                        glm::max(glm::dot(glm::vec3(item.model_matrix[0]), glm::vec3(item.model_matrix[0])),
+                                 glm::dot(glm::vec3(item.model_matrix[1]), glm::vec3(item.model_matrix[1]))),
+                                 glm::dot(glm::vec3(item.model_matrix[2]), glm::vec3(item.model_matrix[2]))
+                    ));
+
+                    sphere_x     [i] = center.x;
+                    sphere_y     [i] = center.y;
+                    sphere_z     [i] = center.z;
+                    sphere_radius[i] = bounds.radius * scale;
+                }
+
+                frustum.cull_spheres
+                (
+                    sphere_x.data() + first,
+                    sphere_y.data() + first,
+                    sphere_z.data() + first,
+                    sphere_radius.data() + first,
+                    end - first,
+                    visibility.data() + first
+                );
+            }
+        );
+
+        culled_count  = remove_invisible();
+        visible_count = items.size();
+    }
+
+    /**
+     * @brief Anota el descarte por volumen de visin hecho antes de enviar los dibujos.
+     */
+    void Render_Queue::accept_culled(std::size_t culled_count)
+    {
+        this->culled_count  = culled_count;
+        this->visible_count = items.size();
+    }
+
+    /**
+     * @brief Quita de la cola los dibujos que ocupan demasiado pocos pxeles en pantalla.
+     *
+     * El tamao proyectado se estima con la profundidad del centro de la esfera, sin tener en cuenta
+     * que fuera del centro de la pantalla la proyeccin la estira; basta para decidir si un objeto
+     * ocupa unos pocos pxeles.
+     *
+     * @param projection_matrix Proyeccin de la cmara en este frame.
+     * @param viewport_height Alto de la ventana en pxeles.
+     * @param min_pixels Dimetro en pxeles por debajo del que se quita un dibujo.
+     * @param fade_pixels Margen por encima de min_pixels en el que se desvanece.
+     */
+    void Render_Queue::cull_small(const glm::mat4 & projection_matrix, float viewport_height, float min_pixels, float fade_pixels)
+    {
+        // Pxeles que ocupa una unidad del espacio de vista a una unidad de distancia:
+
+        const float pixels_per_unit = projection_matrix[1][1] * viewport_height;
+
+        visibility.resize(items.size());
+
+        job_system.parallel_for
+        (
+            items.size(), ITEMS_PER_RANGE,
+            [this, pixels_per_unit, min_pixels, fade_pixels] (std::size_t, std::size_t first, std::size_t end)
+            {
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    Draw_Item    & item   = items[i];
+                    const Bounds & bounds = item.mesh.bounds;
+
+                    const glm::mat4 model_view = view_matrix * item.model_matrix;
+                    const float     depth      = -(model_view * glm::vec4(bounds.center, 1.f)).z;
+
+                    const float scale = glm::sqrt(glm::max
+                    (
+                        glm::max(glm::dot(glm::vec3(model_view[0]), glm::vec3(model_view[0])),
+                                 glm::dot(glm::vec3(model_view[1]), glm::vec3(model_view[1]))),
+                                 glm::dot(glm::vec3(model_view[2]), glm::vec3(model_view[2]))
+                    ));
+
+                    const float radius = bounds.radius * scale;
+
+                    item.fade = 1.f;
+
+                    if (depth <= radius)
+                    {
+                        visibility[i] = 1;
+                        continue;
+                    }
+
+                    const float pixels = radius * pixels_per_unit / depth;
+
+                    visibility[i] = pixels >= min_pixels;
+
+                    if (fade_pixels > 0.f) item.fade = glm::clamp((pixels - min_pixels) / fade_pixels, 0.f, 1.f);
+                }
+            }
+        );
+
+        small_count += remove_invisible();
+    }
+
+    /**
+     * @brief Quita de la cola los dibujos tapados por los oclusores.
+     *
+     * @param occlusion_buffer Buffer de profundidad con los oclusores del frame.
+     */
+    void Render_Queue::cull_occluded(const Occlusion_Buffer & occlusion_buffer)
+    {
+        visibility.resize(items.size());
+
+        job_system.parallel_for
+        (
+            items.size(), ITEMS_PER_RANGE,
+            [this, &occlusion_buffer] (std::size_t, std::size_t first, std::size_t end)
+            {
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    const Draw_Item & item = items[i];
+
+                    visibility[i] = occlusion_buffer.is_visible(item.mesh.bounds.min, item.mesh.bounds.max, item.model_matrix);
+                }
+            }
+        );
+
+        occluded_count += remove_invisible();
+    }
+
+    /**
+     * @brief Pide consultas de oclusin para los opacos con identificador y condiciona los tapados.
+     *
+     * Los dibujos no se quitan de la cola: los que estaban tapados se siguen enviando, pero es la GPU
+     * la que decide si dibujarlos segn la consulta de este frame.
+     *
+     * @param occlusion_queries Consultas de oclusin del frame.
+     */
+    void Render_Queue::cull_occluded(Occlusion_Queries & occlusion_queries)
+    {
+        this->occlusion_queries = &occlusion_queries;
+
+        for (Draw_Item & item : items)
+        {
+            if (item.pass != Render_Pass::OPAQUE_PASS || item.object_id == Draw_Item::NO_OBJECT) continue;
+
+            bool hidden = false;
+
+            const GLuint query_id = occlusion_queries.request(item.object_id, item.mesh.bounds, item.model_matrix, hidden);
+
+            if (hidden)
+            {
+                item.pass            = Render_Pass::CONDITIONAL_PASS;
+                item.occlusion_query = query_id;
+
+                occluded_count++;
+            }
+        }
+    }
+
+    /**
+     * @brief Deja en manos de la GPU el descarte de los dibujos del frame.
+     *
+     * Como la CPU no llega a saber qu se descarta, todos los dibujos cuentan como visibles.
+     *
+     * @param gpu_culling Descarte en la GPU del frame.
+     */
+    void Render_Queue::cull_on_gpu(GPU_Culling & gpu_culling)
+    {
+        if (!indirect_buffer) return;
+
+        this->gpu_culling = &gpu_culling;
+
+        visible_count = items.size();
+        culled_count  = 0;
+    }
+
+    /**
+     * @brief Compacta los dibujos marcados como visibles conservando su orden de envo.
+     * @return Nmero de dibujos quitados.
+     */
+    std::size_t Render_Queue::remove_invisible()
+    {
+        const std::size_t count = items.size();
+
+        std::size_t kept = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (visibility[i])
+            {
+                if (kept != i) items[kept] = items[i];
+                ++kept;
+            }
+        }
+
+        items.resize(kept);
+
+        return count - kept;
+    }
+
+    /**
+     * @brief Calcula las claves de los dibujos de la cola y los ordena por ellas.
+     *
+     * Las claves se calculan en paralelo por tramos de dibujos. La profundidad que se codifica en
+     * cada clave es la distancia a la cmara del centro de la esfera envolvente del objeto, como en
+     * cull_small(): los lotes estticos tienen la matriz identidad y su origen no dice dnde estn.
+     *
+     * Radix sort LSD con dgitos de 8 bits. Se ordena una permutacin de ndices en lugar de los propios
+     * dibujos para mover solo 12 bytes por elemento. Las pasadas en las que todas las claves comparten
+     * el mismo dgito (muy habitual en los bits de pasada y de programa) se saltan sin mover nada.
+     */
+    void Render_Queue::sort()
+    {
+        const std::size_t count = items.size();
+
+        keys.resize(count);
+
+        job_system.parallel_for
+        (
+            count, ITEMS_PER_RANGE,
+            [this] (std::size_t, std::size_t first, std::size_t end)
+            {
+                for (std::size_t i = first; i < end; ++i)
+                {
+                    const Draw_Item & item  = items[i];
+                    const float       depth = -(view_matrix * (item.model_matrix * glm::vec4(item.mesh.bounds.center, 1.f))).z;
+
+                    keys[i] = make_sort_key(item.pass, item.program_id, item.texture_id, item.mesh.mesh_id, depth);
+                }
+            }
+        );
+
+        order        .resize(count);
+        keys_scratch .resize(count);
+        order_scratch.resize(count);
+
+        for (std::uint32_t i = 0; i < count; ++i) order[i] = i;
+
+        std::uint64_t * source_keys  = keys.data();
+        std::uint32_t * source_order = order.data();
+        std::uint64_t * target_keys  = keys_scratch.data();
+        std::uint32_t * target_order = order_scratch.data();
+
+        for (unsigned shift = 0; shift < 64; shift += 8)
+        {
+            std::size_t histogram[256] = {};
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                ++histogram[(source_keys[i] >> shift) & 0xFF];
+            }
+
+            // Si todas las claves caen en el mismo cubo esta pasada no cambiara el orden:
+
+            if (count == 0 || histogram[(source_keys[0] >> shift) & 0xFF] == count) continue;
+
+            std::size_t offset = 0;
+
+            for (std::size_t & bucket : histogram)
+            {
+                std::size_t bucket_size = bucket;
+                bucket  = offset;
+                offset += bucket_size;
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                std::size_t position = histogram[(source_keys[i] >> shift) & 0xFF]++;
+
+                target_keys [position] = source_keys [i];
+                target_order[position] = source_order[i];
+            }
+
+            std::swap(source_keys,  target_keys );
+            std::swap(source_order, target_order);
+        }
+
+        // Tras un nmero impar de pasadas efectivas el resultado est en la memoria auxiliar:
+
+        if (source_order != order.data())
+        {
+            std::copy(source_order, source_order + count, order.data());
+            std::copy(source_keys,  source_keys  + count, keys .data());
+        }
+    }
+
+    /**
+     * @brief Indica si dos dibujos se emiten con el mismo estado (programa, textura, pasada, VAO,
+     * estado de rasterizacin y consulta de oclusin), aunque usen mallas distintas.
+     *
+     * Los dibujos condicionados a consultas distintas nunca comparten llamada.
+     */
+    static bool can_share_state(const Draw_Item & a, const Draw_Item & b)
+    {
+        return a.pass              == b.pass
+            && a.occlusion_query   == b.occlusion_query
+            && a.program_id        == b.program_id
+            && a.texture_id        == b.texture_id
+            && a.mesh.vao_id       == b.mesh.vao_id
+            && a.mesh.polygon_mode == b.mesh.polygon_mode
+            && a.mesh.cull_face    == b.mesh.cull_face;
+    }
+
+    /**
+     * @brief Indica si dos dibujos pueden emitirse en la misma llamada instanciada.
+     *
+     * Deben coincidir en todo salvo en los datos por instancia (transformacin y material). Los
+     * dibujos de distintos rangos de meshlets de una misma malla no comparten llamada.
+     */
+    static bool can_share_batch(const Draw_Item & a, const Draw_Item & b)
+    {
+        return can_share_state(a, b)
+            && a.mesh.mesh_id     == b.mesh.mesh_id
+            && a.mesh.first_index == b.mesh.first_index
+            && a.mesh.index_count == b.mesh.index_count;
+    }
+
+    /**
+     * @brief Emite los dibujos de la cola en orden.
+     *
+     * Primero se agrupan los dibujos consecutivos que comparten estado y malla. Como las instancias
+     * se guardan en el orden de emisin, el primer registro de cada grupo es su posicin en el orden.
+     *
+     * Despus los grupos se reparten en tramos entre los hilos, que escriben los datos por instancia
+     * y los comandos indirectos de sus grupos y graban una lista de comandos por tramo. Si hay
+     * consultas de oclusin, la lista del tramo con el primer grupo que no es opaco visible graba
+     * antes de l el comando que las emite (o se emiten al final si todos lo son). Por ltimo
+     * este hilo sube los datos de todas las instancias de una vez y reproduce las listas en orden.
+     * Los uniforms de cada programa (vista, sampler) los asigna quien los posee antes de ejecutar
+     * la cola, a travs de los handles de su Shader_Program.
+     */
+    void Render_Queue::execute()
+    {
+        batches.clear();
+
+        draw_call_count = 0;
+
+        for (std::size_t position = 0; position < order.size(); ++position)
+        {
+            const Draw_Item & item = items[order[position]];
+
+            if (batches.empty() || !can_share_batch(items[batches.back().item_index], item))
+            {
+                batches.push_back({ order[position], position, 0 });
+            }
+
+            batches.back().instance_count++;
+        }
+
+        // Primer grupo que no pertenece a la pasada de opacos visibles (los opacos se ordenan primero):
+
+        query_batch = 0;
+
+        while (query_batch < batches.size() && items[batches[query_batch].item_index].pass == Render_Pass::OPAQUE_PASS)
+        {
+            query_batch++;
+        }
+
+        if (batches.empty())
+        {
+            if (occlusion_queries) occlusion_queries->issue();
+            return;
+        }
+
+        instances.resize(order.size());
+
+        if (gpu_culling) instance_bounds.resize(order.size());
+
+        if (indirect_buffer) commands.resize(batches.size());
+
+        const std::size_t range_count = job_system.get_range_count(batches.size(), BATCHES_PER_RANGE);
+
+        if (command_lists.size() < range_count) command_lists.resize(range_count);
+
+        job_system.parallel_for
+        (
+            batches.size(), BATCHES_PER_RANGE,
+            [this] (std::size_t range, std::size_t first, std::size_t end)
+            {
+                record_range(command_lists[range], first, end);
+            }
+        );
+
+        // A partir de aqu solo trabaja el hilo que posee el contexto de OpenGL:
+
+        instance_buffer.upload(instances);
+
+        if (pulling_program)
+        {
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VERTEX_STORAGE_BINDING, pulling_vertex_buffer_id);
+
+            instance_buffer.bind_storage(INSTANCE_STORAGE_BINDING, instances.size());
+        }
+
+        if (indirect_buffer)
+        {
+            const std::size_t commands_size = commands.size() * sizeof(Draw_Elements_Indirect_Command);
+
+            std::memcpy(indirect_buffer->begin_segment(commands_size), commands.data(), commands_size);
+
+            indirect_buffer->end_segment();
+
+            // El compute shader completa los comandos y escribe las instancias que se dibujan:
+
+            if (gpu_culling)
+            {
+                gpu_culling->dispatch(instance_buffer, instance_bounds, indirect_buffer->get_id(), indirect_buffer->get_segment_offset(), commands.size());
+            }
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer->get_id());
+        }
+
+        for (std::size_t range = 0; range < range_count; ++range)
+        {
+            replay(command_lists[range]);
+        }
+
+        if (occlusion_queries && query_batch == batches.size()) occlusion_queries->issue();
+
+        if (indirect_buffer) indirect_buffer->fence_segment();
+
+        OpenGL_State::instance().set_blend(false);
+
+        // Los datos de las instancias del frame no se sobrescriben hasta que la GPU termine estos dibujos:
+
+        instance_buffer.end_frame();
+    }
+
+    /**
+     * @brief Prepara los grupos [first_batch, end_batch) y graba sus comandos (en cualquier hilo).
+     *
+     * Con descarte en la GPU, los grupos opacos dejan a 0 el nmero de instancias de su comando
+     * para que lo cuente el compute shader, y el resto conservan todas las suyas.
+     *
+     * Sin multi-draw indirect se graba un dibujo instanciado por grupo. Con l, cada tramo de grupos
+     * consecutivos que comparten estado se graba como un solo dibujo indirecto mltiple; un tramo
+     * nunca se extiende ms all de la lista, as que el reparto entre hilos aade como mucho una
+     * llamada por hilo.
+     */
+    void Render_Queue::record_range(Command_List & list, std::size_t first_batch, std::size_t end_batch)
+    {
+        list.clear();
+
+        // Datos por instancia y comandos indirectos de los grupos:
+
+        for (std::size_t b = first_batch; b < end_batch; ++b)
+        {
+            const Batch & batch    = batches[b];
+            const Mesh  & mesh     = items[batch.item_index].mesh;
+            const bool    cullable = gpu_culling && items[batch.item_index].pass == Render_Pass::OPAQUE_PASS;
+
+            for (std::size_t i = batch.first_instance, end = batch.first_instance + batch.instance_count; i < end; ++i)
+            {
+                const Draw_Item & item = items[order[i]];
+
+                instances[i] = { item.model_matrix, item.texture_layer, item.transparency, item.fade, 0.f };
+            }
+
+            if (gpu_culling)
+            {
+                const GPU_Culling::Instance_Bounds bounds
+                {
+                    glm::vec4(mesh.bounds.center, mesh.bounds.radius),
+                    std::uint32_t(b),
+                    cullable ? 1u : 0u,
+                    { 0u, 0u }
+                };
+
+                std::fill_n(instance_bounds.begin() + std::ptrdiff_t(batch.first_instance), batch.instance_count, bounds);
+            }
+
+            if (indirect_buffer)
+            {
+                commands[b] =
+                {
+                    GLuint(mesh.index_count),
+                    cullable ? 0u : GLuint(batch.instance_count),
+                    mesh.first_index,
+                    mesh.base_vertex,
+                    GLuint(batch.first_instance)
+                };
+            }
+        }
+
+        // Comandos de dibujo:
+
+        const Draw_Item * previous = nullptr;
+
+        if (!indirect_buffer)
+        {
+            for (std::size_t b = first_batch; b < end_batch; ++b)
+            {
+                const Batch     & batch = batches[b];
+                const Draw_Item & item  = items[batch.item_index];
+
+                if (b == query_batch) record_queries(list, previous);
+
+                record_state(list, previous, item);
+
+                list.record(Command_List::Bind_Instances{ std::uint32_t(batch.first_instance) });
+
+                if (item.occlusion_query) list.record(Command_List::Begin_Conditional_Render{ item.occlusion_query });
+
+                list.record(Command_List::Draw_Indexed
+                {
+                    std::uint32_t(item.mesh.index_count),
+                    item.mesh.first_index,
+                    item.mesh.base_vertex,
+                    std::uint32_t(batch.instance_count)
+                });
+
+                if (item.occlusion_query) list.record(Command_List::End_Conditional_Render{});
+
+                previous = &item;
+            }
+
+            return;
+        }
+
+        std::size_t run_start = first_batch;
+
+        for (std::size_t b = first_batch + 1; b <= end_batch; ++b)
+        {
+            // Un tramo termina cuando se acaban los grupos o el siguiente grupo necesita otro estado:
+
+            const Draw_Item & item = items[batches[run_start].item_index];
+
+            if (b < end_batch && can_share_state(item, items[batches[b].item_index]))
+            {
+                continue;
+            }
+
+            if (run_start == query_batch) record_queries(list, previous);
+
+            record_state(list, previous, item);
+
+            list.record(Command_List::Bind_Instances{ 0 });
+
+            if (item.occlusion_query) list.record(Command_List::Begin_Conditional_Render{ item.occlusion_query });
+
+            list.record(Command_List::Multi_Draw_Indexed_Indirect{ std::uint32_t(run_start), std::uint32_t(b - run_start) });
+
+            if (item.occlusion_query) list.record(Command_List::End_Conditional_Render{});
+
+            previous  = &item;
+            run_start = b;
+        }
+    }
+
+    /**
+     * @brief Graba la emisin de las consultas de oclusin del frame, si las hay.
+     *
+     * Las consultas cambian el estado de OpenGL, as que el siguiente dibujo de la lista tiene que
+     * grabar todo su estado de nuevo.
+     */
+    void Render_Queue::record_queries(Command_List & list, const Draw_Item * & previous) const
+    {
+        if (!occlusion_queries) return;
+
+        list.record(Command_List::Issue_Occlusion_Queries{});
+
+        previous = nullptr;
+    }
+
+    /**
+     * @brief Graba los cambios de estado necesarios para pasar del dibujo previous al dibujo item.
+     *
+     * Si no hay dibujo previo en la lista se graba todo el estado. Los cambios redundantes entre
+     * listas consecutivas los descarta la cach de estado de OpenGL al reproducirlas.
+     */
+    void Render_Queue::record_state(Command_List & list, const Draw_Item * previous, const Draw_Item & item) const
+    {
+        const bool transparent = item.pass == Render_Pass::TRANSPARENT_PASS;
+
+        if (!previous || previous->pass != item.pass)
+            list.record(Command_List::Set_Blend{ transparent });
+
+        if (!previous || previous->program_id != item.program_id)
+            list.record(Command_List::Bind_Program{ item.program_id });
+
+        if (!previous || previous->texture_id != item.texture_id)
+            list.record(Command_List::Bind_Texture{ 0, GL_TEXTURE_2D_ARRAY, item.texture_id });
+
+        if (!previous || previous->mesh.polygon_mode != item.mesh.polygon_mode)
+            list.record(Command_List::Set_Polygon_Mode{ item.mesh.polygon_mode });
+
+        if (!previous || previous->mesh.cull_face != item.mesh.cull_face)
+            list.record(Command_List::Set_Cull_Face{ item.mesh.cull_face });
+
+        if (!previous || previous->mesh.vao_id != item.mesh.vao_id)
+            list.record(Command_List::Bind_Vertex_Array{ item.mesh.vao_id });
+    }
+
+    /**
+     * @brief Reproduce una lista de comandos contra OpenGL (solo en el hilo del contexto).
+     *
+     * Los cambios de estado pasan por la cach de estado de OpenGL, que solo los enva al driver
+     * cuando difieren del estado actual.
+     */
+    void Render_Queue::replay(const Command_List & list)
+    {
+        struct Replayer
+        {
+            Render_Queue & queue;
+            OpenGL_State & state;
+            GLuint         program_id;
+
+            void operator () (const Command_List::Bind_Program & command)
+            {
+                program_id = command.program_id;
+                state.use_program(command.program_id);
+            }
+
+            void operator () (const Command_List::Bind_Texture & command)
+            {
+                state.bind_texture(command.unit, command.target, command.texture_id);
+            }
+
+            void operator () (const Command_List::Bind_Vertex_Array & command)
+            {
+                state.bind_vertex_array(command.vertex_array_id);
+
+                // La primera vez que se usa un VAO se le activan los atributos por instancia (con vertex
+                // pulling el shader no los lee, pero tenerlos activados no afecta al dibujo):
+
+                std::vector<GLuint> & configured_vaos = queue.configured_vaos;
+
+                if (std::find(configured_vaos.begin(), configured_vaos.end(), command.vertex_array_id) == configured_vaos.end())
+                {
+                    queue.instance_buffer.enable_attributes();
+                    configured_vaos.push_back(command.vertex_array_id);
+                }
+            }
+
+            void operator () (const Command_List::Set_Blend & command)
+            {
+                state.set_blend(command.enabled);
+
+                if (command.enabled) state.set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            }
+
+            void operator () (const Command_List::Set_Cull_Face & command)
+            {
+                state.set_cull_face(command.enabled);
+            }
+
+            void operator () (const Command_List::Set_Polygon_Mode & command)
+            {
+                state.set_polygon_mode(command.mode);
+            }
+
+            void operator () (const Command_List::Bind_Instances & command)
+            {
+                // Como no hay instancia base en los dibujos directos, los atributos por instancia se
+                // apuntan al primer registro del grupo. Con vertex pulling ese registro se indica al
+                // shader mediante el uniform base_instance.
+
+                if (queue.pulling_program && program_id == queue.pulling_program->get_id())
+                {
+                    queue.pulling_program->set(queue.base_instance_uniform, GLint(command.first_instance));
+                }
+                else if (queue.gpu_culling)
+                {
+                    // Las instancias que sobreviven al descarte en la GPU estn en su propio buffer:
+
+                    Instance_Buffer::bind_attributes(queue.gpu_culling->get_output_buffer_id(), command.first_instance * sizeof(Instance_Data));
+                }
+                else
+                    queue.instance_buffer.bind_attributes(command.first_instance);
+            }
+
+            void operator () (const Command_List::Draw_Indexed & command)
+            {
+                // Cada malla ocupa un rango de la arena: el primer ndice se pasa como desplazamiento en
+                // bytes dentro del EBO y el vrtice base desplaza los ndices, relativos a la malla.
+
+                glDrawElementsInstancedBaseVertex
+                (
+                    GL_TRIANGLES,
+                    GLsizei(command.index_count),
+                    GL_UNSIGNED_INT,
+                    reinterpret_cast<void *>(std::uintptr_t(command.first_index) * sizeof(GLuint)),
+                    GLsizei(command.instance_count),
+                    command.base_vertex
+                );
+
+                queue.draw_call_count++;
+            }
+
+            void operator () (const Command_List::Issue_Occlusion_Queries & )
+            {
+                queue.occlusion_queries->issue();
+            }
+
+            void operator () (const Command_List::Begin_Conditional_Render & command)
+            {
+                // La GPU espera al resultado de la consulta, emitida poco antes, sin detener a la CPU:
+
+                glBeginConditionalRender(command.query_id, GL_QUERY_WAIT);
+            }
+
+            void operator () (const Command_List::End_Conditional_Render & )
+            {
+                glEndConditionalRender();
+            }
+
+            void operator () (const Command_List::Multi_Draw_Indexed_Indirect & command)
+            {
+                // Los atributos por instancia apuntan al comienzo del segmento de instancias del frame y el
+                // baseInstance de cada comando los desplaza hasta los registros de su grupo:
+
+                const std::size_t offset = queue.indirect_buffer->get_segment_offset()
+                                         + command.first_command * sizeof(Draw_Elements_Indirect_Command);
+
+                OpenGL_Extensions::multi_draw_elements_indirect
+                (
+                    GL_TRIANGLES,
+                    GL_UNSIGNED_INT,
+                    reinterpret_cast<const void *>(offset),
+                    GLsizei(command.command_count),
+                    0
+                );
+
+                queue.draw_call_count++;
+            }
+        };
+
+        list.for_each(Replayer{ *this, OpenGL_State::instance(), 0 });
+    }
+
+}
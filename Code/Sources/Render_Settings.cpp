@@ -0,0 +1,142 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Render_Settings.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <algorithm>     // max
+#include <cstdlib>       // strtoul, strtof
+#include <cstring>       // strcmp
+#include <iostream>      // cout, cerr
+#include <thread>        // hardware_concurrency
+
+namespace udit
+{
+
+    /**
+     * @brief Lee las opciones de los argumentos del programa.
+     *
+     * @param argc Nmero de argumentos.
+     * @param argv Argumentos.
+     * @return Las opciones ledas.
+     */
+    Render_Settings Render_Settings::parse(int argc, char * argv[])
+    {
+        Render_Settings settings;
+
+        // Por defecto se usa un hilo por ncleo contando el principal (hardware_concurrency puede devolver 0):
+
+        settings.worker_threads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            if      (std::strcmp(argv[i], "--no-mdi"        ) == 0) settings.multi_draw_indirect = false;
+            else if (std::strcmp(argv[i], "--vertex-pulling") == 0) settings.vertex_pulling      = true;
+            else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            {
+                // N es el total de hilos que trabajan, contando el principal:
+
+                settings.worker_threads = std::max(unsigned(std::strtoul(argv[++i], nullptr, 10)), 1u) - 1;
+            }
+            else if (std::strcmp(argv[i], "--occlusion") == 0 && i + 1 < argc)
+            {
+                const char * mode = argv[++i];
+
+                if      (std::strcmp(mode, "none"    ) == 0) settings.occlusion = Occlusion_Mode::NONE;
+                else if (std::strcmp(mode, "software") == 0) settings.occlusion = Occlusion_Mode::SOFTWARE;
+                else if (std::strcmp(mode, "hardware") == 0) settings.occlusion = Occlusion_Mode::HARDWARE;
+                else if (std::strcmp(mode, "gpu"     ) == 0) settings.occlusion = Occlusion_Mode::GPU;
+                else
+                    std::cerr << "Aviso: modo de oclusion desconocido " << mode << std::endl;
+            }
+            else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            {
+                settings.scene_path = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--capture") == 0 && i + 2 < argc)
+            {
+                settings.capture_path   = argv[++i];
+                settings.capture_frames = unsigned(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--min-pixels") == 0 && i + 1 < argc)
+            {
+                settings.min_pixels = std::max(std::strtof(argv[++i], nullptr), 0.f);
+            }
+            else if (std::strcmp(argv[i], "--fade-pixels") == 0 && i + 1 < argc)
+            {
+                settings.fade_pixels = std::max(std::strtof(argv[++i], nullptr), 0.f);
+            }
+            else
+                std::cerr << "Aviso: opcion desconocida " << argv[i] << std::endl;
+        }
+
+        return settings;
+    }
+
+    /**
+     * @brief Nombre de un modo de descarte de objetos tapados, como se escribe en la lnea de comandos.
+     */
+    const char * get_occlusion_name(Occlusion_Mode mode)
+    {
+        switch (mode)
+        {
+            case Occlusion_Mode::SOFTWARE: return "software";
+            case Occlusion_Mode::HARDWARE: return "hardware";
+            case Occlusion_Mode::GPU:      return "gpu";
+            default:                       return "none";
+        }
+    }
+
+    /**
+     * @brief Desactiva las opciones que el contexto de OpenGL actual no admite.
+     */
+    void Render_Settings::validate()
+    {
+        if (vertex_pulling && !OpenGL_Extensions::supports_shader_storage())
+        {
+            std::cerr << "Aviso: el contexto no admite SSBOs, se usaran los atributos del VAO" << std::endl;
+
+            vertex_pulling = false;
+        }
+
+        // Sin gl_BaseInstance (GLSL 4.60 o ARB_shader_draw_parameters) el vertex shader no puede saber
+        // desde qu registro leer las instancias de cada comando indirecto, as que con vertex pulling
+        // se emite un dibujo por grupo indicando el primer registro en un uniform:
+
+        if (vertex_pulling) multi_draw_indirect = false;
+
+        if (multi_draw_indirect && !OpenGL_Extensions::supports_multi_draw_indirect())
+        {
+            multi_draw_indirect = false;
+        }
+
+        // El descarte en la GPU escribe el nmero de instancias de los comandos indirectos, y GL_Capture
+        // no sabe grabar los compute shaders que lo hacen:
+
+        if (occlusion == Occlusion_Mode::GPU)
+        {
+            const char * reason = nullptr;
+
+            if      (!OpenGL_Extensions::supports_compute()) reason = "el contexto no admite compute shaders";
+            else if (!multi_draw_indirect                  ) reason = "necesita multi-draw indirect";
+            else if (!capture_path.empty()                 ) reason = "la captura no graba los compute shaders";
+
+            if (reason)
+            {
+                std::cerr << "Aviso: descarte en la GPU desactivado (" << reason << "), se usara el de software" << std::endl;
+
+                occlusion = Occlusion_Mode::SOFTWARE;
+            }
+        }
+
+        std::cout << "Vertices: " << (vertex_pulling ? "vertex pulling (SSBO)" : "atributos del VAO")
+                  << ", envio: "  << (multi_draw_indirect ? "multi-draw indirect" : "un dibujo por grupo")
+                  << ", hilos: "  << worker_threads + 1
+                  << ", oclusion: " << get_occlusion_name(occlusion)
+                  << ", tamano minimo: " << min_pixels << " px";
+
+        if (fade_pixels > 0.f) std::cout << " (desvanecido en " << fade_pixels << " px)";
+
+        std::cout << std::endl;
+    }
+
+}
@@ -0,0 +1,170 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Ring_Buffer.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <cassert>       // assert
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Ring_Buffer.
+     *
+     * @param target Tipo de buffer al que se vincula.
+     * @param initial_segment_size Bytes que caben inicialmente en cada segmento.
+     * @param alignment Alineacin en bytes del comienzo de cada segmento.
+     */
+    Ring_Buffer::Ring_Buffer(GLenum target, std::size_t initial_segment_size, std::size_t alignment)
+        : target(target), buffer_id(0), segment_size(0), alignment(alignment), current_segment(0),
+          persistent(false), persistent_pointer(nullptr), fences{}
+    {
+        create(initial_segment_size);
+    }
+
+    /**
+     * @brief Destructor de la clase Ring_Buffer.
+     */
+    Ring_Buffer::~Ring_Buffer()
+    {
+        destroy();
+    }
+
+    /**
+     * @brief Crea el buffer con segmentos del tamao indicado (redondeado a la alineacin).
+     */
+    void Ring_Buffer::create(std::size_t new_segment_size)
+    {
+        segment_size = (new_segment_size + alignment - 1) / alignment * alignment;
+        persistent   = OpenGL_Extensions::supports_buffer_storage();
+
+        const GLsizeiptr buffer_size = GLsizeiptr(segment_size * SEGMENT_COUNT);
+
+        glGenBuffers(1, &buffer_id);
+        glBindBuffer(target, buffer_id);
+
+        if (persistent)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+            OpenGL_Extensions::buffer_storage(target, buffer_size, nullptr, flags);
+
+            persistent_pointer = static_cast<char *>(glMapBufferRange(target, 0, buffer_size, flags));
+
+            assert(persistent_pointer != nullptr);
+        }
+        else
+        {
+            glBufferData(target, buffer_size, nullptr, GL_STREAM_DRAW);
+
+            persistent_pointer = nullptr;
+        }
+    }
+
+    /**
+     * @brief Espera a que la GPU termine con todos los segmentos y libera el buffer.
+     */
+    void Ring_Buffer::destroy()
+    {
+        for (unsigned segment = 0; segment < SEGMENT_COUNT; ++segment)
+        {
+            wait_fence(segment);
+        }
+
+        if (persistent)
+        {
+            glBindBuffer  (target, buffer_id);
+            glUnmapBuffer (target);
+        }
+
+        glDeleteBuffers(1, &buffer_id);
+
+        buffer_id          = 0;
+        persistent_pointer = nullptr;
+    }
+
+    /**
+     * @brief Espera a que se cumpla el fence de un segmento y lo elimina.
+     *
+     * La primera espera no bloquea; si el fence an no se ha cumplido se vuelve a esperar pidiendo
+     * al driver que enve los comandos pendientes, para no esperar a algo que nunca llega a la GPU.
+     */
+    void Ring_Buffer::wait_fence(unsigned segment)
+    {
+        GLsync & fence = fences[segment];
+
+        if (fence == nullptr) return;
+
+        GLenum result = glClientWaitSync(fence, 0, 0);
+
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);     // 1 ms
+        }
+
+        glDeleteSync(fence);
+
+        fence = nullptr;
+    }
+
+    /**
+     * @brief Prepara el segmento del frame actual para escribir en l.
+     *
+     * @param size Bytes que se van a escribir.
+     * @return Puntero en el que escribir los datos del frame.
+     */
+    void * Ring_Buffer::begin_segment(std::size_t size)
+    {
+        // Si los datos no caben se recrea el buffer con el doble de lo necesario. La memoria antigua
+        // puede estar an en uso por la GPU, por lo que destroy() espera a todos los fences:
+
+        if (size > segment_size)
+        {
+            destroy();
+            create (size * 2);
+        }
+
+        wait_fence(current_segment);
+
+        if (persistent)
+        {
+            return persistent_pointer + get_segment_offset();
+        }
+
+        glBindBuffer(target, buffer_id);
+
+        return glMapBufferRange
+        (
+            target,
+            GLintptr  (get_segment_offset()),
+            GLsizeiptr(segment_size),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+        );
+    }
+
+    /**
+     * @brief Termina la escritura del segmento actual.
+     *
+     * Con el mapeado persistente y coherente no hay nada que hacer: los datos escritos son visibles
+     * para los comandos emitidos despus.
+     */
+    void Ring_Buffer::end_segment()
+    {
+        if (!persistent)
+        {
+            glBindBuffer (target, buffer_id);
+            glUnmapBuffer(target);
+        }
+    }
+
+    /**
+     * @brief Coloca el fence del segmento actual y pasa al siguiente.
+     */
+    void Ring_Buffer::fence_segment()
+    {
+        fences[current_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        current_segment = (current_segment + 1) % SEGMENT_COUNT;
+    }
+
+}
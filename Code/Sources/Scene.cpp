@@ -6,14 +6,16 @@
 #pragma once
 
 #include "../Headers/Scene.hpp"
+#include "../Headers/OpenGL_State.hpp"
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>                        // max
+#include <limits>                           // numeric_limits
 
 #include <glm.hpp>                          // vec3, vec4, ivec4, mat4
 #include <gtc/matrix_transform.hpp>         // translate, rotate, scale, perspective
 #include <gtc/type_ptr.hpp>                 // value_ptr
-#include "../Headers/stb_image.h"
 
 
 namespace udit
@@ -25,22 +27,82 @@ namespace udit
 
         "#version 330\n"
         ""
-        "uniform mat4 model_view_matrix;"
-        "uniform mat4 projection_matrix;"
+        "layout (std140) uniform Camera"                           // Datos de la cmara del frame
+        "{"
+        "   mat4 view_matrix;"
+        "   mat4 projection_matrix;"
+        "   mat4 view_projection_matrix;"
+        "   vec4 camera_position;"
+        "};"
         ""
         "layout (location = 0) in vec3 vertex_coordinates;"
         "layout (location = 1) in vec3 vertex_color;"
         "layout(location = 2) in vec2 vertex_uv;"
         ""
+        "layout (location = 3) in mat4 instance_model_matrix;"     // Atributos por instancia
+        "layout (location = 7) in vec3 instance_material;"         // (capa de textura, transparencia, desvanecimiento)
         ""
         "out vec3 front_color;"
         "out vec2 tex_coord;"
+        "out float transparency;"
+        "flat out float texture_layer;"
+        "flat out float fade;"
         ""
         "void main()"
         "{"
-        "   gl_Position = projection_matrix * model_view_matrix * vec4(vertex_coordinates, 1.0);"
+        "   gl_Position = view_projection_matrix * instance_model_matrix * vec4(vertex_coordinates, 1.0);"
         "   front_color = vertex_color;"
         "   tex_coord = vertex_uv;"
+        "   transparency = instance_material.y;"
+        "   texture_layer = instance_material.x;"
+        "   fade = instance_material.z;"
+        "}";
+
+    // Variante del vertex shader para vertex pulling: no tiene atributos, lee los vrtices de la arena
+    // (8 floats por vrtice: posicin, color y coordenadas de textura) y los datos de las instancias
+    // de buffers de almacenamiento. gl_VertexID ya incluye el vrtice base de la malla.
+
+    const string Scene::pulling_vertex_shader_code =
+
+        "#version 430\n"
+        ""
+        "layout (std140) uniform Camera"
+        "{"
+        "   mat4 view_matrix;"
+        "   mat4 projection_matrix;"
+        "   mat4 view_projection_matrix;"
+        "   vec4 camera_position;"
+        "};"
+        ""
+        "struct Instance"
+        "{"
+        "   mat4 model_matrix;"
+        "   vec4 material;"                                          // (capa de textura, transparencia, desvanecimiento, -)
+        "};"
+        ""
+        "layout (std430, binding = 0) readonly buffer Vertices  { float    vertex_data[]; };"
+        "layout (std430, binding = 1) readonly buffer Instances { Instance instance_data[]; };"
+        ""
+        "uniform int base_instance;"                                 // Primer registro del grupo
+        ""
+        "out vec3 front_color;"
+        "out vec2 tex_coord;"
+        "out float transparency;"
+        "flat out float texture_layer;"
+        "flat out float fade;"
+        ""
+        "void main()"
+        "{"
+        "   int      v        = gl_VertexID * 8;"
+        "   Instance instance = instance_data[base_instance + gl_InstanceID];"
+        "   vec3     position = vec3(vertex_data[v    ], vertex_data[v + 1], vertex_data[v + 2]);"
+        ""
+        "   gl_Position  = view_projection_matrix * instance.model_matrix * vec4(position, 1.0);"
+        "   front_color  = vec3(vertex_data[v + 3], vertex_data[v + 4], vertex_data[v + 5]);"
+        "   tex_coord    = vec2(vertex_data[v + 6], vertex_data[v + 7]);"
+        "   transparency = instance.material.y;"
+        "   texture_layer = instance.material.x;"
+        "   fade = instance.material.z;"
         "}";
 
     const string Scene::fragment_shader_code =
@@ -49,28 +111,49 @@ namespace udit
         ""
         "in  vec3    front_color;"
         "in vec2 tex_coord;"
-        "uniform sampler2D texture_sampler;"
-        "uniform float transparency;"
+        "in float transparency;"
+        "flat in float texture_layer;"
+        "flat in float fade;"                                      // Fraccin de los pxeles que se dibujan
+        "uniform sampler2DArray texture_sampler;"                  // Texturas de todos los materiales
         "out vec4 fragment_color;"
         ""
+        // Umbrales de una matriz de Bayer de 4x4: al desvanecerse un objeto se descartan sus pxeles
+        // en un patrn de tramado fijo en pantalla, sin necesidad de mezclarlo con lo que tiene detrs
+        "const float dither[16] = float[16]"
+        "("
+        "    0.0 / 16.0,  8.0 / 16.0,  2.0 / 16.0, 10.0 / 16.0,"
+        "   12.0 / 16.0,  4.0 / 16.0, 14.0 / 16.0,  6.0 / 16.0,"
+        "    3.0 / 16.0, 11.0 / 16.0,  1.0 / 16.0,  9.0 / 16.0,"
+        "   15.0 / 16.0,  7.0 / 16.0, 13.0 / 16.0,  5.0 / 16.0"
+        ");"
+        ""
         "void main()"
         "{"
-        "   vec4 texture_color = texture(texture_sampler, tex_coord);"
+        "   ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;"
+        "   if (fade <= dither[pixel.y * 4 + pixel.x]) discard;"
+        "   vec4 texture_color = texture(texture_sampler, vec3(tex_coord, texture_layer));"
         "   fragment_color = vec4(texture_color.rgb, texture_color.a * transparency);"
         "}";
 
     const std::string Scene::skybox_vertex_shader =
         "#version 330 core\n"
         ""
+        "layout (std140) uniform Camera"
+        "{"
+        "   mat4 view_matrix;"
+        "   mat4 projection_matrix;"
+        "   mat4 view_projection_matrix;"
+        "   vec4 camera_position;"
+        "};"
+        ""
         "layout (location = 0) in vec3 aPos;"
         "out vec3 TexCoords;"
-        "uniform mat4 projection;"
-        "uniform mat4 view;"
+        "uniform mat4 projection;"                                  // La skybox usa su propia proyeccin
         ""
         "void main()"
         "{"
         "   TexCoords = aPos;"
-        "   vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0);"
+        "   vec4 pos = projection * mat4(mat3(view_matrix)) * vec4(aPos, 1.0);"
         "   gl_Position = pos.xyww;"
         "}";
 
@@ -86,434 +169,450 @@ namespace udit
         "   FragColor = texture(skybox, TexCoords);"
         "}";
 
-    Scene::Scene(unsigned width, unsigned height)
+    Scene::Scene(unsigned width, unsigned height, const Render_Settings & settings, const Scene_File & scene_file)
         :
-        angle(0), plane(12,6), cylinder(10,1,1,3), cone(10,1.4,3),
-        camera(glm::vec3(0.f, 3.f, 8.f), glm::vec3(0.f, 1.f, 0.f), -90.f, 0.f),
-        skybox({ "../Textures/sky-cube-map-0.png",
-            "../Textures/sky-cube-map-1.png",
-            "../Textures/sky-cube-map-2.png",
-            "../Textures/sky-cube-map-3.png",
-            "../Textures/sky-cube-map-4.png",
-            "../Textures/sky-cube-map-5.png" }),
-        terrain("../Texturas_map/Pavement_Heightmap.jpg", 20.0f, 20.0f, 0.5f) // Ancho, profundidad, altura mxima
+        cube(mesh_arena),
+        camera
+        (
+            glm::vec3(scene_file.get_header().camera_position[0], scene_file.get_header().camera_position[1], scene_file.get_header().camera_position[2]),
+            glm::vec3(0.f, 1.f, 0.f),
+            scene_file.get_header().camera_yaw,
+            scene_file.get_header().camera_pitch
+        ),
+        scene_program(settings.vertex_pulling ? pulling_vertex_shader_code : vertex_shader_code, fragment_shader_code),
+        skybox(scene_file.get_skybox_faces()),
+        skybox_program(skybox_vertex_shader, skybox_fragment_shader),
+        static_batcher(mesh_arena),
+        job_system(settings.worker_threads),
+        occlusion_buffer(job_system),
+        occlusion_queries(cube.get_mesh()),
+        occlusion_mode(settings.occlusion),
+        render_queue(job_system, settings.multi_draw_indirect),
+        animations(job_system),
+        entities(job_system),
+        spatial_index(glm::vec3(0.f), 1.f),         // El cubo raz se ajusta a las entidades al cargarlas
+        min_pixels(settings.min_pixels),
+        fade_pixels(settings.fade_pixels)
 
     {
         
 
         // Se establece la configuracin bsica:
 
-        glEnable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
-        glClearColor(.2f, .2f, .2f, 1.f);
-
-        // Se compilan y se activan los shaders:
-
-        program_id = compile_shaders();
+        OpenGL_State & state = OpenGL_State::instance();
 
-        glUseProgram(program_id);
+        state.set_cull_face (true);
+        state.set_depth_test(true);
+        const float * clear_color = scene_file.get_header().clear_color;
 
-        // Compilar los shaders para el Skybox
-        skybox_shader_program = compile_skybox_shaders();
+        glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
 
-        // Cargar las texturas para la skybox
-        GLuint skybox_texture_id = load_skybox_texture({
-            "../Textures/sky-cube-map-3.png",//Laterales
-            "../Textures/sky-cube-map-1.png",//Posicion cara izquierda
-            "../Textures/sky-cube-map-4.png",//Posicion cara inferior
-            "../Textures/sky-cube-map-5.png",//Posicion cara superior
-            "../Textures/sky-cube-map-2.png",//Laterales
-            "../Textures/sky-cube-map-0.png"//Laterales
-            });
+        // Se resuelven una sola vez los uniforms de los programas (compilados al construirlos):
 
-        skybox.set_texture(skybox_texture_id);
+        texture_sampler_uniform   = scene_program .get_uniform< GLint     >("texture_sampler");
+        skybox_projection_uniform = skybox_program.get_uniform< glm::mat4 >("projection");
+        skybox_sampler_uniform    = skybox_program.get_uniform< GLint     >("skybox");
 
-        model_view_matrix_id = glGetUniformLocation(program_id, "model_view_matrix");
-        projection_matrix_id = glGetUniformLocation(program_id, "projection_matrix");
+        // Las texturas siempre se leen de la unidad 0:
 
-        resize(width, height);
-
-        textureLoader("../Textures/wood_texture.jpg");
-        textureLoader("../Textures/cylinder_texture.jpg");
-        textureLoader("../Textures/cono_textura.jpg");
-        textureLoader("../Texturas_map/Pavement_Albedo.jpg");
-        textureLoader("../Textures/hielo_texture.jpg");
-        textureLoader("../Textures/purpura.jpg");
-    }
-
-    void Scene::process_input(const Uint8* keystate, float delta_time)
-    {
-        camera.process_keyboard(keystate, delta_time);
-    }
+        scene_program .set(texture_sampler_uniform, 0);
+        skybox_program.set(skybox_sampler_uniform,  0);
 
-    void Scene::process_mouse_motion(float x_offset, float y_offset)
-    {
-        camera.process_mouse_motion(x_offset, y_offset);
-    }
+        // Ambos programas leen la vista y la proyeccin del mismo bloque de uniforms:
 
-    void Scene::update()
-    {
-        angle += 0.01f;
-        movement_Speed += 0.2f;
-    }
+        scene_program .bind_uniform_block(Camera_Buffer::BLOCK_NAME, Camera_Buffer::BINDING);
+        skybox_program.bind_uniform_block(Camera_Buffer::BLOCK_NAME, Camera_Buffer::BINDING);
 
-    void Scene::render()
-    {
-        // Parmetros del movimiento circular
-        float radius = 7.0f; // Radio de la circunferencia
-        float speed = 1.0f;  // Velocidad angular
+        if (settings.vertex_pulling)
+        {
+            render_queue.enable_vertex_pulling(scene_program, mesh_arena.get_vertex_buffer_id());
+        }
 
-        // Rotacion entorno a una posicion prestablecida
-        float center_x = 2.0f;
-        float center_z = -6.0f;
+        // Los programas del descarte en la GPU solo compilan con compute shaders, as que solo se crean si se usan:
 
-        // Calcular la posicin en la circunferencia
-        float x = center_x + radius * cos(angle * speed); // Coordenada X
-        float z = center_z + radius * sin(angle * speed); // Coordenada Z
+        if (occlusion_mode == Occlusion_Mode::GPU)
+        {
+            gpu_culling = std::make_unique< GPU_Culling >();
+        }
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        resize(width, height);
 
-        // Renderizar el Skybox
-        glUseProgram(skybox_shader_program);
+        // Las texturas de los materiales se cargan como capas de un nico array de texturas, de modo
+        // que todos los objetos usan la misma textura y solo se distinguen por la capa que leen. La
+        // opacidad de cada material decide en qu pasada se dibujan sus objetos:
 
-        // Obtener la matriz de vista de la cmara
-        glm::mat4 view_matrix = camera.get_view_matrix();
-        glm::mat4 projection_matrix = glm::perspective(glm::radians(45.0f), 1024.0f / 768.0f, 0.1f, 100.0f);
-        
-        glUniformMatrix4fv(glGetUniformLocation(skybox_shader_program, "view"), 1, GL_FALSE, glm::value_ptr(view_matrix));
-        glUniformMatrix4fv(glGetUniformLocation(skybox_shader_program, "projection"), 1, GL_FALSE, glm::value_ptr(projection_matrix));
-
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skybox.get_texture_id());
-        skybox.render();
-
-        // Volver a usar el shader normal para los otros objetos
-        glUseProgram(program_id);
-        glm::mat4 view_matrix_full = camera.get_view_matrix();
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(view_matrix_full));
-
-        texture_id = 3;
-        // Dibujar el plano
-        glActiveTexture(GL_TEXTURE0); // Activar la unidad de textura 0
-        glBindTexture(GL_TEXTURE_2D, texture_id); // Vincular la textura
-        glUniform1i(glGetUniformLocation(program_id, "texture_sampler"), 0);
-
-        glm::mat4 plane_model_matrix(1.0f);
-        plane_model_matrix = glm::translate(plane_model_matrix, glm::vec3(-4.f, -0.73f, -9.f));
-        plane_model_matrix = glm::rotate(plane_model_matrix, glm::radians(0.f), glm::vec3(1.f, 0.f, 0.f));
-        glm::mat4 plane_mvp_matrix = view_matrix * plane_model_matrix;
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(plane_mvp_matrix));
-        plane.render();
-
-        texture_id++;
-
-        // Dibujar el cilindro
-
-        glActiveTexture(GL_TEXTURE0); // Activar la unidad de textura 0
-        glBindTexture(GL_TEXTURE_2D, texture_id); // Vincular la textura
-        glUniform1i(glGetUniformLocation(program_id, "texture_sampler"), 0);
-
-        glm::mat4 cylinder_model_matrix(1.0f);
-        cylinder_model_matrix = glm::translate(cylinder_model_matrix, glm::vec3(-2.f, -0.72f, -6.f));
-        cylinder_model_matrix = glm::rotate(cylinder_model_matrix, glm::radians(0.f), glm::vec3(1.f, 0.f, 0.f));
-        glm::mat4 cylinder_mvp_matrix = view_matrix * cylinder_model_matrix;
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(cylinder_mvp_matrix));
-        cylinder.render();
-
-        texture_id++;
-        // Dibujar el cono 1
-        
-        glActiveTexture(GL_TEXTURE0); // Activar la unidad de textura 0
-        glBindTexture(GL_TEXTURE_2D, texture_id); // Vincular la textura
-        glUniform1i(glGetUniformLocation(program_id, "texture_sampler"), 0); // Enviar la textura al shader
+        const std::size_t material_count = scene_file.get_count(Scene_Format::MATERIALS);
+        const auto      * material_records = scene_file.get_records< Scene_Format::Material_Record >(Scene_Format::MATERIALS);
 
-        glm::mat4 cone_model_matrix(1.0f);
-        cone_model_matrix = glm::translate(cone_model_matrix, glm::vec3(2.f, -0.72f, -6.f));
-        cone_model_matrix = glm::rotate(cone_model_matrix, glm::radians(0.f), glm::vec3(1.f, 0.f, 0.f));
-        cone_model_matrix = glm::rotate(cone_model_matrix, angle, glm::vec3(0.f, 1.f, 0.f));
-        glm::mat4 cone_mvp_matrix = view_matrix * cone_model_matrix;
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(cone_mvp_matrix));
-        cone.render();
+        materials.resize(material_count);
 
-        texture_id++;
+        for (std::size_t i = 0; i < material_count; ++i)
+        {
+            materials[i].texture_layer = float(material_textures.load(scene_file.get_string(material_records[i].texture)));
+            materials[i].transparency  = material_records[i].transparency;
+        }
 
+        material_textures.upload();
 
-        //Dibujar el terreno
-        glActiveTexture(GL_TEXTURE0); // Activar la unidad de textura 0
-        glBindTexture(GL_TEXTURE_2D, texture_id); // Vincular la textura
-        glUniform1i(glGetUniformLocation(program_id, "texture_sampler"), 0); // Enviar la textura al shader
+        for (Material & material : materials)
+        {
+            material.program_id = scene_program.get_id();
+            material.texture_id = material_textures.get_id();
+        }
 
-        glm::mat4 terrain_model_matrix(1.0f);
-        terrain_model_matrix = glm::translate(terrain_model_matrix, glm::vec3(-8.f, -1.12f, -16.f)); // Ajustar posicin
-        glm::mat4 terrain_mvp_matrix = view_matrix * terrain_model_matrix;
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(terrain_mvp_matrix));
+        // Las mallas se generan en la arena con los parmetros de cada registro:
 
-        terrain.render();
+        const std::size_t mesh_count   = scene_file.get_count(Scene_Format::MESHES);
+        const auto      * mesh_records = scene_file.get_records< Scene_Format::Mesh_Record >(Scene_Format::MESHES);
 
-        texture_id++;
+        meshes       .reserve(mesh_count);
+        mesh_terrains.resize (mesh_count, nullptr);
 
-        // Dibujar el cono 2
-        // Habilitar blending para transparencia
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        for (std::size_t i = 0; i < mesh_count; ++i)
+        {
+            const float * parameters = mesh_records[i].parameters;
+
+            switch (mesh_records[i].generator)
+            {
+                case Scene_Format::PLANE:
+                    planes.push_back(std::make_unique< Plane >(mesh_arena, int(parameters[0]), int(parameters[1])));
+                    meshes.push_back(planes.back()->get_mesh());
+                    break;
+
+                case Scene_Format::CYLINDER:
+                    cylinders.push_back(std::make_unique< Cylinder >(mesh_arena, int(parameters[0]), int(parameters[1]), parameters[2], parameters[3]));
+                    meshes.push_back(cylinders.back()->get_mesh());
+                    break;
+
+                case Scene_Format::CONE:
+                    cones.push_back(std::make_unique< Cone >(mesh_arena, int(parameters[0]), parameters[1], parameters[2]));
+                    meshes.push_back(cones.back()->get_mesh());
+                    break;
+
+                case Scene_Format::HEIGHTMAP:
+                    terrains.push_back(std::make_unique< Heightmap >(mesh_arena, scene_file.get_string(mesh_records[i].path), parameters[0], parameters[1], parameters[2]));
+                    meshes.push_back(terrains.back()->get_mesh());
+                    mesh_terrains[i] = terrains.back().get();
+                    break;
+            }
+        }
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture_id);
-        glUniform1i(glGetUniformLocation(program_id, "texture_sampler"), 0);
+        // Los nodos se aaden de una vez a la jerarqua, directamente desde los arrays del archivo:
 
-        // Establecer transparencia
-        GLint transparency_location = glGetUniformLocation(program_id, "transparency");
-        glUniform1f(transparency_location, 0.7f); // Ajusta la transparencia (0.0 = totalmente transparente, 1.0 = opaco)
+        const Transform_Hierarchy::Node first_node = transforms.add
+        (
+            scene_file.get_records< std::uint32_t >(Scene_Format::NODE_PARENTS),
+            scene_file.get_records< Transform     >(Scene_Format::NODE_TRANSFORMS),
+            scene_file.get_count(Scene_Format::NODE_PARENTS)
+        );
 
-        glm::mat4 cone1_model_matrix(1.0f);
-        cone1_model_matrix = glm::translate(cone1_model_matrix, glm::vec3(6.f, 2.3f, -6.f));
-        cone1_model_matrix = glm::rotate(cone1_model_matrix, glm::radians(180.f), glm::vec3(1.f, 0.f, 0.f));
-        cone1_model_matrix = glm::rotate(cone1_model_matrix, angle, glm::vec3(0.f, 1.f, 0.f));
-        glm::mat4 cone1_mvp_matrix = view_matrix * cone1_model_matrix;
+        transforms.update();
 
-        // Enviar la matriz al shader
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(cone1_mvp_matrix));
-        cone.render();
+        // Los animadores toman como reposo la transformacin que tienen los nodos en el archivo (por
+        // ejemplo, los conos invertidos con la punta hacia abajo giran as alrededor de su eje):
 
-        // Deshabilitar blending despus de renderizar
-        glDisable(GL_BLEND);
+        const std::size_t animator_count   = scene_file.get_count(Scene_Format::ANIMATORS);
+        const auto      * animator_records = scene_file.get_records< Scene_Format::Animator_Record >(Scene_Format::ANIMATORS);
+        const Keyframe  * keyframes        = scene_file.get_records< Keyframe >(Scene_Format::KEYFRAMES);
 
-        texture_id++;
+        for (std::size_t i = 0; i < animator_count; ++i)
+        {
+            const Scene_Format::Animator_Record & record = animator_records[i];
+            const Transform_Hierarchy::Node     node   = first_node + record.node;
+            const glm::vec3                     vector(record.vector[0], record.vector[1], record.vector[2]);
+
+            switch (record.type)
+            {
+                case Scene_Format::SPIN:  animations.add_spin (transforms, node, vector, record.speed, record.phase); break;
+                case Scene_Format::ORBIT: animations.add_orbit(transforms, node, vector, record.radius, record.speed, record.phase); break;
+                case Scene_Format::BOB:   animations.add_bob  (transforms, node, vector, record.speed, record.phase); break;
+                case Scene_Format::TRACK: animations.add_track(node, keyframes + record.first_key, record.key_count, record.speed); break;
+            }
+        }
 
-        //Dibuja un tercer cono (peonza)
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // Las entidades estticas se registran una sola vez en el Static_Batcher con su matriz del mundo,
+        // y las que tapan lo que tienen detrs tambin como oclusores del descarte en CPU (los terrenos
+        // con una versin simplificada, por debajo de su superficie real). Las que se mueven pasan al
+        // almacn de entidades y al ndice espacial, que se usa para las consultas y la seleccin. El
+        // cubo raz del ndice abarca las cajas de todas las entidades, as que sus cajas se calculan
+        // antes de aadir las que se mueven:
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture_id);
-        glUniform1i(glGetUniformLocation(program_id, "texture_sampler"), 0);
+        const std::size_t entity_count   = scene_file.get_count(Scene_Format::ENTITIES);
+        const auto      * entity_records = scene_file.get_records< Scene_Format::Entity_Record >(Scene_Format::ENTITIES);
 
-        glm::mat4 cone2_model_matrix(1.0f);
-        cone2_model_matrix = glm::translate(cone2_model_matrix, glm::vec3(x, 2.3f, z));
-        cone2_model_matrix = glm::rotate(cone2_model_matrix, glm::radians(180.f), glm::vec3(1.f, 0.f, 0.f));
-        cone2_model_matrix = glm::rotate(cone2_model_matrix, movement_Speed, glm::vec3(0.f, -1.f, 0.f));
-        glm::mat4 cone2_mvp_matrix = view_matrix * cone2_model_matrix;
+        entities.reserve(entity_count);
 
-        // Enviar la matriz al shader
-        glUniformMatrix4fv(model_view_matrix_id, 1, GL_FALSE, glm::value_ptr(cone2_mvp_matrix));
-        cone.render();
-        
-        
-
-    }
+        std::vector<glm::vec3> entity_boxes(entity_count * 2);     // Esquinas mnima y mxima de cada entidad
+        glm::vec3              scene_min(std::numeric_limits<float>::max());
+        glm::vec3              scene_max(std::numeric_limits<float>::lowest());
 
+        for (std::size_t i = 0; i < entity_count; ++i)
+        {
+            const Scene_Format::Entity_Record & record = entity_records[i];
 
-    void Scene::resize(unsigned width, unsigned height)
-    {
-        glm::mat4 projection_matrix = glm::perspective(20.f, GLfloat(width) / height, 1.f, 5000.f);
+            Loose_Octree::transform_box(meshes[record.mesh].bounds, transforms.get_world(first_node + record.node), entity_boxes[i * 2], entity_boxes[i * 2 + 1]);
 
-        glUniformMatrix4fv(projection_matrix_id, 1, GL_FALSE, glm::value_ptr(projection_matrix));
+            scene_min = glm::min(scene_min, entity_boxes[i * 2    ]);
+            scene_max = glm::max(scene_max, entity_boxes[i * 2 + 1]);
+        }
 
-        glViewport(0, 0, width, height);
-    }
+        if (entity_count > 0)
+        {
+            const glm::vec3 half_extent = (scene_max - scene_min) * 0.5f;
 
-    void Scene::textureLoader(std::string route)
-    {
-        int width, height, channels;
-        unsigned char* data = stbi_load(route.c_str(), &width, &height, &channels, 0);
+            spatial_index = Loose_Octree(scene_min + half_extent, std::max({ half_extent.x, half_extent.y, half_extent.z, 1.f }));
+        }
 
-        if (!data)
+        for (std::size_t i = 0; i < entity_count; ++i)
         {
-            cerr << "Error: No se pudo cargar la textura." << endl;
-            return; // En lugar de detener el programa
-        }
+            const Scene_Format::Entity_Record & record = entity_records[i];
+            const Transform_Hierarchy::Node     node   = first_node + record.node;
+            const glm::mat4                   & world  = transforms.get_world(node);
+            const Mesh                        & mesh   = meshes[record.mesh];
 
-        GLuint texture_id;
-        glGenTextures(1, &texture_id);
-        glBindTexture(GL_TEXTURE_2D, texture_id);
+            if (record.flags & Scene_Format::DYNAMIC)
+            {
+                const Entity_Store::Entity entity = entities.create(node, mesh, record.material, record.object_id);
 
-        // Configuracin de la textura
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                if (entity >= entity_handles.size()) entity_handles.resize(std::size_t(entity) + 1);
 
-        // Cargar los datos en OpenGL
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
-            channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+                entity_handles[entity] = spatial_index.insert(entity_boxes[i * 2], entity_boxes[i * 2 + 1], entity);
+            }
+            else
+            {
+                static_batcher.add(make_draw_item(materials[record.material], mesh, world));
 
-        // Liberar la memoria de la textura cargada
-        stbi_image_free(data);
+                if (!(record.flags & Scene_Format::OCCLUDER)) continue;
 
-        // Guardar el ID de la textura para usarlo despus
-        this->texture_id = texture_id;
+                if (const Heightmap * terrain = mesh_terrains[record.mesh])
+                {
+                    std::vector<glm::vec3>     terrain_occluder_vertices;
+                    std::vector<std::uint32_t> terrain_occluder_indices;
 
-    }
+                    terrain->build_occluder(32, terrain_occluder_vertices, terrain_occluder_indices);
 
-    GLuint Scene::load_skybox_texture(std::vector<std::string> faces) {
-        GLuint texture_id;
-        glGenTextures(1, &texture_id);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
-
-        int width, height, nr_channels;
-        for (GLuint i = 0; i < faces.size(); i++) {
-            unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nr_channels, 0);
-            if (data) {
-                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-                stbi_image_free(data);
-            }
-            else {
-                std::cerr << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-                stbi_image_free(data);
+                    occlusion_buffer.add_occluder(terrain_occluder_vertices, terrain_occluder_indices, world);
+                }
+                else
+                    add_occluder(mesh, world);
             }
         }
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-        return texture_id;
     }
 
-    GLuint Scene::compile_shaders()
+    void Scene::process_input(const Uint8* keystate, float delta_time)
     {
-        GLint succeeded = GL_FALSE;
-
-        // Se crean objetos para los shaders:
-
-        GLuint   vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
-        GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
-
-        // Se carga el cdigo de los shaders:
-
-        const char* vertex_shaders_code[] = { vertex_shader_code.c_str() };
-        const char* fragment_shaders_code[] = { fragment_shader_code.c_str() };
-        const GLint    vertex_shaders_size[] = { (GLint)vertex_shader_code.size() };
-        const GLint  fragment_shaders_size[] = { (GLint)fragment_shader_code.size() };
-
-        glShaderSource(vertex_shader_id, 1, vertex_shaders_code, vertex_shaders_size);
-        glShaderSource(fragment_shader_id, 1, fragment_shaders_code, fragment_shaders_size);
-
-        // Se compilan los shaders:
-
-        glCompileShader(vertex_shader_id);
-        glCompileShader(fragment_shader_id);
-
-        // Se comprueba que si la compilacin ha tenido xito:
-
-        glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &succeeded);
-        if (!succeeded) show_compilation_error(vertex_shader_id);
-
-        glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &succeeded);
-        if (!succeeded) show_compilation_error(fragment_shader_id);
+        camera.process_keyboard(keystate, delta_time);
+    }
 
-        // Se crea un objeto para un programa:
+    void Scene::process_mouse_motion(float x_offset, float y_offset)
+    {
+        camera.process_mouse_motion(x_offset, y_offset);
+    }
 
-        GLuint program_id = glCreateProgram();
+    void Scene::update()
+    {
+        // Los animadores avanzan un paso por frame y escriben las transformaciones locales; las matrices
+        // del mundo se recalculan despus en un nico recorrido:
 
-        // Se cargan los shaders compilados en el programa:
+        animations.update(transforms, 1.f);
 
-        glAttachShader(program_id, vertex_shader_id);
-        glAttachShader(program_id, fragment_shader_id);
+        transforms.update();
+    }
 
-        // Se linkan los shaders:
+    void Scene::render()
+    {
+        // Obtener la matriz de vista de la cmara y escribir los datos de la cmara una vez para todo el frame
+        glm::mat4 view_matrix = camera.get_view_matrix();
 
-        glLinkProgram(program_id);
+        glm::mat4 view_projection_matrix = projection_matrix * view_matrix;
 
-        // Se comprueba si el linkage ha tenido xito:
+        camera_buffer.upload({ view_matrix, projection_matrix, view_projection_matrix, glm::vec4(camera.get_position(), 1.f) });
 
-        glGetProgramiv(program_id, GL_LINK_STATUS, &succeeded);
-        if (!succeeded) show_linkage_error(program_id);
+        // Los planos del volumen de visin se extraen de la misma matriz con la que se dibuja
+        frustum.extract(view_projection_matrix);
 
-        // Se liberan los shaders compilados una vez se han linkado:
+        // Los oclusores se rasterizan en los hilos de trabajo antes de descartar los objetos tapados
+        if (occlusion_mode == Occlusion_Mode::SOFTWARE) occlusion_buffer.render(view_projection_matrix);
 
-        glDeleteShader(vertex_shader_id);
-        glDeleteShader(fragment_shader_id);
+        // Con consultas de la GPU, las cajas se consultan este frame y sus resultados se leen en el siguiente
+        if (occlusion_mode == Occlusion_Mode::HARDWARE) occlusion_queries.begin_frame(view_projection_matrix);
 
-        return (program_id);
-    }
+        // Con descarte en la GPU, la pirmide Hi-Z de este frame se construye con esta misma matriz
+        if (gpu_culling) gpu_culling->begin_frame(view_projection_matrix);
 
-    GLuint Scene::compile_skybox_shaders() {
-        GLint succeeded = GL_FALSE;
+        // El Skybox usa su propia proyeccin, que solo se sube la primera vez
+        skybox_program.set(skybox_projection_uniform, glm::perspective(glm::radians(45.0f), 1024.0f / 768.0f, 0.1f, 100.0f));
 
-        // Crear los objetos de shader (vrtices y fragmentos).
-        GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
-        GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
-        
-        // Preparar el cdigo fuente para los shaders.
-        const char* vertex_shader_code[] = { skybox_vertex_shader.c_str() };
-        const char* fragment_shader_code[] = { skybox_fragment_shader.c_str() };
-        const GLint vertex_shader_size[] = { (GLint)skybox_vertex_shader.size() };
-        const GLint fragment_shader_size[] = { (GLint)skybox_fragment_shader.size() };
+        // El resto de objetos se envan a la cola de render, que los ordena por estado antes de dibujarlos
+        // y agrupa las copias de una misma malla (como los conos) en dibujos instanciados
+        render_queue.begin_frame(view_matrix);
 
-        // Cargar el cdigo fuente en los shaders.
-        glShaderSource(vertex_shader_id, 1, vertex_shader_code, vertex_shader_size);
-        glShaderSource(fragment_shader_id, 1, fragment_shader_code, fragment_shader_size);
+        // Objetos estticos (plano, cilindro y terreno), ya combinados por material en el espacio del mundo.
+        // Solo se envan los meshlets que quedan dentro del volumen de visin y de cara a la cmara
+        static_batcher.submit(render_queue, frustum, camera.get_position());
 
-        // Compilar los shaders.
-        glCompileShader(vertex_shader_id);
-        glCompileShader(fragment_shader_id);
+        // Primero se llevan al mundo las esferas de las entidades que se han movido y sus cajas se
+        // actualizan en el ndice espacial
+        entities.update_bounds(transforms);
 
-        // Comprobar si la compilacin fue exitosa para el shader de vrtices.
-        glGetShaderiv(vertex_shader_id, GL_COMPILE_STATUS, &succeeded);
-        if (!succeeded) show_compilation_error(vertex_shader_id);
+        for (std::size_t position = 0, count = entities.size(); position < count; ++position)
+        {
+            if (!entities.is_moved(position)) continue;
 
-        // Comprobar si la compilacin fue exitosa para el shader de fragmentos
-        glGetShaderiv(fragment_shader_id, GL_COMPILE_STATUS, &succeeded);
-        if (!succeeded) show_compilation_error(fragment_shader_id);
+            glm::vec3 min, max;
 
-        // Crear un programa de shaders y asociar los shaders de vrtices y fragmentos.
-        GLuint program_id = glCreateProgram();
+            Loose_Octree::transform_box(entities.get_mesh(position).bounds, transforms.get_world(entities.get_node(position)), min, max);
 
-        glAttachShader(program_id, vertex_shader_id);
-        glAttachShader(program_id, fragment_shader_id);
+            spatial_index.update(entity_handles[entities.get_entity(position)], min, max);
+        }
 
-        // Enlazar los shaders en un programa.
-        glLinkProgram(program_id);
+        // Las entidades visibles son las que devuelve el ndice espacial para el volumen de visin, que
+        // descarta de una vez las ramas enteras que quedan fuera. Con descarte en la GPU se marcan todas
+        // como visibles y lo decide el compute shader
+        if (gpu_culling)
+        {
+            entities.mark_all_visible();
+        }
+        else
+        {
+            visible_entities.clear();
 
-        glGetProgramiv(program_id, GL_LINK_STATUS, &succeeded);
-        if (!succeeded) show_linkage_error(program_id);
+            spatial_index.query_frustum(frustum, visible_entities);
 
-        glDeleteShader(vertex_shader_id);
-        glDeleteShader(fragment_shader_id);
+            entities.mark_visible(visible_entities);
+        }
 
-        return program_id;
+        // Todos los conos usan el array de texturas de los materiales y solo cambian de capa, as que
+        // los opacos se dibujan juntos con una sola llamada instanciada. La pasada de cada cono la
+        // decide la opacidad de su material
+        entities.submit(render_queue, materials.data(), transforms);
+
+        // Antes que nada se quitan los dibujos demasiado pequeos en pantalla para merecer una llamada,
+        // y se desvanecen los que estn a punto de serlo
+        render_queue.cull_small(projection_matrix, viewport_height, min_pixels, fade_pixels);
+
+        // Los meshlets estticos y las entidades ya se han descartado contra el volumen de visin antes de
+        // enviarlos, as que la cola solo anota cuntas entidades quedaron fuera. Con descarte en la GPU
+        // se deja que lo haga un compute shader al ejecutar la cola
+        if (gpu_culling)
+            render_queue.cull_on_gpu(*gpu_culling);
+        else
+            render_queue.accept_culled(entities.size() - visible_entities.size());
+
+        // De los que quedan, se descartan los que tapan por completo los oclusores, o con consultas de la
+        // GPU se condicionan los que estaban tapados en el frame anterior
+        if (occlusion_mode == Occlusion_Mode::SOFTWARE) render_queue.cull_occluded(occlusion_buffer);
+        if (occlusion_mode == Occlusion_Mode::HARDWARE) render_queue.cull_occluded(occlusion_queries);
+
+        // Se ordenan los dibujos por su clave (opacos por estado y de delante hacia atrs, despus los
+        // transparentes de atrs hacia delante) y se emiten con el mnimo de cambios de estado
+        render_queue.sort();
+
+        // Las pasadas del frame graph dibujan el Skybox y la cola en texturas intermedias y las copian a la ventana
+        frame_graph.execute();
+
+        // Los datos de la cmara del frame no se sobrescriben hasta que la GPU termine estos dibujos
+        camera_buffer.end_frame();
     }
 
 
-    void Scene::show_compilation_error(GLuint shader_id)
+    void Scene::resize(unsigned width, unsigned height)
     {
-        string info_log;
-        GLint  info_log_length;
-
-        glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
+        // La proyeccin se sube con el resto de datos de la cmara al comienzo de cada frame
+        projection_matrix = glm::perspective(20.f, GLfloat(width) / height, 1.f, 5000.f);
+        viewport_height   = float(height);
 
-        info_log.resize(info_log_length);
+        glViewport(0, 0, width, height);
 
-        glGetShaderInfoLog(shader_id, info_log_length, NULL, &info_log.front());
+        // Las texturas intermedias dependen del tamao de la ventana
+        build_frame_graph(width, height);
+    }
 
-        cerr << info_log.c_str() << endl;
+    void Scene::build_frame_graph(unsigned width, unsigned height)
+    {
+        frame_graph.clear();
+
+        const GLsizei frame_width  = GLsizei(width );
+        const GLsizei frame_height = GLsizei(height);
+
+        Frame_Graph::Resource scene_color = 0;
+        Frame_Graph::Resource scene_depth = 0;
+
+        // Pasada de escena: el Skybox y los objetos de la cola, en una textura de color y otra de profundidad
+        frame_graph.add_pass
+        (
+            "Escena",
+            [&] (Frame_Graph::Builder & builder)
+            {
+                scene_color = builder.create("Color de la escena",       { frame_width, frame_height, GL_RGBA8 });
+                scene_depth = builder.create("Profundidad de la escena", { frame_width, frame_height, GL_DEPTH_COMPONENT24 });
+            },
+            [this] (const Frame_Graph::Context & )
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                skybox_program.use();
+                skybox.render();
+
+                render_queue.execute();
+            }
+        );
 
-#ifdef _MSC_VER
-        //OutputDebugStringA (info_log.c_str ());
-#endif
+        // Pasada de la pirmide Hi-Z: reduce la profundidad de la escena para el descarte en la GPU del siguiente frame
+        if (gpu_culling)
+        {
+            frame_graph.add_pass
+            (
+                "Piramide Hi-Z",
+                [&] (Frame_Graph::Builder & builder)
+                {
+                    builder.read(scene_depth);
+                    builder.set_side_effect();
+                },
+                [this, scene_depth, frame_width, frame_height] (const Frame_Graph::Context & context)
+                {
+                    gpu_culling->build_hi_z(context.get_texture(scene_depth), frame_width, frame_height);
+                }
+            );
+        }
 
-        assert(false);
+        // Pasada de presentacin: copia el color de la escena a la ventana
+        frame_graph.add_pass
+        (
+            "Presentar",
+            [&] (Frame_Graph::Builder & builder)
+            {
+                builder.read(scene_color);
+                builder.set_side_effect();
+            },
+            [scene_color, frame_width, frame_height] (const Frame_Graph::Context & context)
+            {
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, context.get_framebuffer(scene_color));
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+                glBlitFramebuffer(0, 0, frame_width, frame_height, 0, 0, frame_width, frame_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            }
+        );
     }
 
-    void Scene::show_linkage_error(GLuint program_id)
+    void Scene::add_occluder(const Mesh & mesh, const glm::mat4 & model_matrix)
     {
-        string info_log;
-        GLint  info_log_length;
+        // La geometra se lee de la copia en CPU de la arena
+        std::vector<Mesh_Arena::Vertex> mesh_vertices;
+        std::vector<GLuint>             mesh_indices;
 
-        glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &info_log_length);
+        mesh_arena.read(mesh, mesh_vertices, mesh_indices);
 
-        info_log.resize(info_log_length);
+        std::vector<glm::vec3> positions;
 
-        glGetProgramInfoLog(program_id, info_log_length, NULL, &info_log.front());
+        positions.reserve(mesh_vertices.size());
 
-        cerr << info_log.c_str() << endl;
-
-#ifdef _MSC_VER
-        //OutputDebugStringA (info_log.c_str ());
-#endif
+        for (const Mesh_Arena::Vertex & vertex : mesh_vertices)
+        {
+            positions.emplace_back(vertex.position[0], vertex.position[1], vertex.position[2]);
+        }
 
-        assert(false);
+        occlusion_buffer.add_occluder(positions, std::vector<std::uint32_t>(mesh_indices.begin(), mesh_indices.end()), model_matrix);
     }
 
 }
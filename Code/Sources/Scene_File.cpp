@@ -0,0 +1,351 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Scene_File.hpp"
+#include <cmath>                            // isfinite
+#include <cstring>                          // memcmp, strcmp
+#include <iostream>                         // cerr
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>                    // CreateFileMapping, MapViewOfFile
+#else
+    #include <fcntl.h>                      // open
+    #include <sys/mman.h>                   // mmap, munmap
+    #include <sys/stat.h>                   // fstat
+    #include <unistd.h>                     // close
+#endif
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Scene_File. No abre ningn archivo.
+     */
+    Scene_File::Scene_File()
+        : data(nullptr), size(0)
+    {
+        #ifdef _WIN32
+            file_handle    = INVALID_HANDLE_VALUE;
+            mapping_handle = nullptr;
+        #endif
+    }
+
+    /**
+     * @brief Destructor de la clase Scene_File. Deshace el mapeo si lo hay.
+     */
+    Scene_File::~Scene_File()
+    {
+        close();
+    }
+
+    /**
+     * @brief Mapea un archivo de escena completo en memoria de solo lectura y lo valida.
+     */
+    bool Scene_File::open(const std::string & path)
+    {
+        close();
+
+        #ifdef _WIN32
+
+            file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+            LARGE_INTEGER file_size;
+
+            if (file_handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart < LONGLONG(sizeof(Scene_Format::Header)))
+            {
+                std::cerr << "Error: no se pudo abrir el archivo de escena " << path << std::endl;
+                close();
+                return false;
+            }
+
+            mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+            const void * view = mapping_handle ? MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+            if (!view)
+            {
+                std::cerr << "Error: no se pudo mapear el archivo de escena " << path << std::endl;
+                close();
+                return false;
+            }
+
+            data = static_cast< const std::uint8_t * >(view);
+            size = std::size_t(file_size.QuadPart);
+
+        #else
+
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+
+            struct stat file_status;
+
+            if (descriptor < 0 || fstat(descriptor, &file_status) != 0 || file_status.st_size < off_t(sizeof(Scene_Format::Header)))
+            {
+                std::cerr << "Error: no se pudo abrir el archivo de escena " << path << std::endl;
+                if (descriptor >= 0) ::close(descriptor);
+                return false;
+            }
+
+            // El mapeo sigue siendo vlido despus de cerrar el descriptor:
+
+            void * view = mmap(nullptr, std::size_t(file_status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+            ::close(descriptor);
+
+            if (view == MAP_FAILED)
+            {
+                std::cerr << "Error: no se pudo mapear el archivo de escena " << path << std::endl;
+                return false;
+            }
+
+            data = static_cast< const std::uint8_t * >(view);
+            size = std::size_t(file_status.st_size);
+
+        #endif
+
+        if (const char * error = validate())
+        {
+            std::cerr << "Error: el archivo de escena " << path << " no es valido (" << error << ")" << std::endl;
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Deshace el mapeo y cierra el archivo.
+     */
+    void Scene_File::close()
+    {
+        #ifdef _WIN32
+
+            if (data                               ) UnmapViewOfFile(data);
+            if (mapping_handle                     ) CloseHandle(mapping_handle);
+            if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+
+            file_handle    = INVALID_HANDLE_VALUE;
+            mapping_handle = nullptr;
+
+        #else
+
+            if (data) munmap(const_cast< std::uint8_t * >(data), size);
+
+        #endif
+
+        data = nullptr;
+        size = 0;
+    }
+
+    /**
+     * @brief Comprueba la cabecera, los lmites de las secciones y las referencias entre registros.
+     *
+     * Es la nica pasada sobre los registros al cargar la escena; despus se usan sin comprobar nada.
+     *
+     * @return nullptr si el archivo es vlido o una descripcin del problema.
+     */
+    const char * Scene_File::validate() const
+    {
+        const Scene_Format::Header & header = get_header();
+
+        if (std::memcmp(header.magic, Scene_Format::MAGIC, sizeof(header.magic)) != 0) return "no es un archivo de escena";
+        if (header.version   != Scene_Format::VERSION) return "version distinta";
+        if (header.file_size != size                 ) return "tamano incorrecto";
+
+        // Cada seccin debe caber en el archivo y empezar alineada para poder leer sus registros en el sitio:
+
+        static constexpr std::size_t record_sizes[Scene_Format::SECTION_COUNT] =
+        {
+            sizeof(char),
+            sizeof(Scene_Format::Material_Record),
+            sizeof(Scene_Format::Mesh_Record),
+            sizeof(std::uint32_t),
+            sizeof(Transform),
+            sizeof(std::uint32_t),
+            sizeof(Scene_Format::Entity_Record),
+            sizeof(Scene_Format::Animator_Record),
+            sizeof(Keyframe),
+        };
+
+        for (unsigned section = 0; section < Scene_Format::SECTION_COUNT; ++section)
+        {
+            const Scene_Format::Section_Range & range = header.sections[section];
+
+            if (range.offset % 4 != 0 || range.offset < sizeof(Scene_Format::Header)) return "seccion desalineada";
+
+            if (std::uint64_t(range.offset) + std::uint64_t(range.count) * record_sizes[section] > size) return "seccion fuera del archivo";
+        }
+
+        // Los textos tienen que estar terminados en cero y las referencias apuntar dentro de la seccin:
+
+        const std::size_t string_bytes = get_count(Scene_Format::STRINGS);
+
+        if (string_bytes > 0 && get_records< char >(Scene_Format::STRINGS)[string_bytes - 1] != '\0') return "textos sin terminar";
+
+        auto valid_string = [string_bytes] (std::uint32_t string)
+        {
+            return string == Scene_Format::NO_INDEX || string < string_bytes;
+        };
+
+        for (std::uint32_t face : header.skybox_faces)
+        {
+            if (!valid_string(face)) return "texto inexistente";
+        }
+
+        const std::size_t material_count = get_count(Scene_Format::MATERIALS);
+        const std::size_t mesh_count     = get_count(Scene_Format::MESHES);
+        const std::size_t node_count     = get_count(Scene_Format::NODE_PARENTS);
+        const std::size_t entity_count   = get_count(Scene_Format::ENTITIES);
+        const std::size_t animator_count = get_count(Scene_Format::ANIMATORS);
+        const std::size_t key_count      = get_count(Scene_Format::KEYFRAMES);
+
+        const auto * materials = get_records< Scene_Format::Material_Record >(Scene_Format::MATERIALS);
+        const auto * meshes    = get_records< Scene_Format::Mesh_Record     >(Scene_Format::MESHES);
+        const auto * parents   = get_records< std::uint32_t                 >(Scene_Format::NODE_PARENTS);
+        const auto * names     = get_records< std::uint32_t                 >(Scene_Format::NODE_NAMES);
+        const auto * entities  = get_records< Scene_Format::Entity_Record   >(Scene_Format::ENTITIES);
+        const auto * animators = get_records< Scene_Format::Animator_Record >(Scene_Format::ANIMATORS);
+        const auto * keyframes = get_records< Keyframe                      >(Scene_Format::KEYFRAMES);
+
+        for (std::size_t i = 0; i < material_count; ++i)
+        {
+            if (!valid_string(materials[i].texture)) return "texto inexistente";
+        }
+
+        for (std::size_t i = 0; i < mesh_count; ++i)
+        {
+            if (meshes[i].generator >= Scene_Format::GENERATOR_COUNT) return "generador de malla desconocido";
+            if (!valid_string(meshes[i].path)) return "texto inexistente";
+            if (meshes[i].generator == Scene_Format::HEIGHTMAP && meshes[i].path == Scene_Format::NO_INDEX) return "heightmap sin imagen";
+
+            for (unsigned parameter = 0; parameter < Scene_Format::PARAMETER_COUNTS[meshes[i].generator]; ++parameter)
+            {
+                const float value    = meshes[i].parameters[parameter];
+                const bool  segments = parameter < Scene_Format::SEGMENT_PARAMETER_COUNTS[meshes[i].generator];
+                const float minimum  = segments ? 1.f : 0.f;
+                const float maximum  = segments ? Scene_Format::MAX_MESH_SEGMENTS : Scene_Format::MAX_MESH_SIZE;
+
+                if (!std::isfinite(value) || value <= 0.f || value < minimum || value > maximum) return "parametro de malla fuera de rango";
+            }
+        }
+
+        if (get_count(Scene_Format::NODE_TRANSFORMS) != node_count || get_count(Scene_Format::NODE_NAMES) != node_count) return "secciones de nodos distintas";
+
+        for (std::size_t i = 0; i < node_count; ++i)
+        {
+            if (parents[i] != Scene_Format::NO_INDEX && parents[i] >= i) return "padre despues del hijo";
+            if (!valid_string(names[i])) return "texto inexistente";
+        }
+
+        // Entidades estticas (bit 0) y que se mueven (bit 1) de cada nodo y de sus descendientes:
+
+        std::vector< std::uint8_t > subtree_entities(node_count, 0);
+
+        for (std::size_t i = 0; i < entity_count; ++i)
+        {
+            if (entities[i].node >= node_count || entities[i].mesh >= mesh_count || entities[i].material >= material_count) return "entidad con referencias inexistentes";
+
+            const bool dynamic = (entities[i].flags & Scene_Format::DYNAMIC) != 0;
+
+            // El Static_Batcher solo combina dibujos opacos:
+
+            if (!dynamic && materials[entities[i].material].transparency < 1.f) return "entidad estatica transparente";
+
+            subtree_entities[entities[i].node] |= dynamic ? 2 : 1;
+
+            // Los identificadores de objeto indexan tablas por objeto (consultas de oclusin, seleccin):
+
+            if ((entities[i].flags & Scene_Format::DYNAMIC) && entities[i].object_id != Scene_Format::NO_INDEX && entities[i].object_id >= entity_count) return "identificador de objeto fuera de rango";
+        }
+
+        for (std::size_t i = node_count; i-- > 0; )
+        {
+            if (parents[i] != Scene_Format::NO_INDEX) subtree_entities[parents[i]] |= subtree_entities[i];
+        }
+
+        std::vector< std::uint8_t > animated_types(node_count, 0);      // Bit de cada tipo de animador de cada nodo
+
+        for (std::size_t i = 0; i < animator_count; ++i)
+        {
+            const Scene_Format::Animator_Record & animator = animators[i];
+
+            if (animator.node >= node_count) return "animador de un nodo inexistente";
+            if (animator.type >= Scene_Format::ANIMATOR_TYPE_COUNT) return "tipo de animador desconocido";
+
+            // Las entidades estticas se combinan con su matriz del mundo al cargar la escena, as que
+            // un animador solo puede mover nodos de los que cuelgan entidades que se mueven:
+
+            if (subtree_entities[animator.node] & 1) return "animador de un nodo con entidades estaticas";
+            if (subtree_entities[animator.node] == 0) return "animador de un nodo sin entidades";
+
+            // Animation_System evala a la vez los animadores de un mismo tipo, as que un nodo no puede tener dos:
+
+            std::uint8_t & types = animated_types[animator.node];
+
+            if (types & (1u << animator.type)) return "nodo con dos animadores del mismo tipo";
+
+            types |= std::uint8_t(1u << animator.type);
+
+            if (animator.type == Scene_Format::SPIN || animator.type == Scene_Format::ORBIT)
+            {
+                const float length = animator.vector[0] * animator.vector[0] + animator.vector[1] * animator.vector[1] + animator.vector[2] * animator.vector[2];
+
+                if (!std::isfinite(length) || length == 0.f) return "animador con eje nulo";
+            }
+
+            if (animator.type == Scene_Format::TRACK)
+            {
+                if (animator.key_count == 0 || std::uint64_t(animator.first_key) + animator.key_count > key_count) return "pista con fotogramas inexistentes";
+
+                // La bsqueda del tramo de cada fotograma necesita los tiempos en orden creciente:
+
+                const Keyframe * keys = keyframes + animator.first_key;
+
+                if (!std::isfinite(keys[0].time)) return "pista con tiempos desordenados";
+
+                for (std::uint32_t key = 1; key < animator.key_count; ++key)
+                {
+                    if (!std::isfinite(keys[key].time) || !(keys[key].time > keys[key - 1].time)) return "pista con tiempos desordenados";
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Rutas de las imgenes de las caras de la skybox.
+     */
+    std::vector< std::string > Scene_File::get_skybox_faces() const
+    {
+        std::vector< std::string > faces;
+
+        for (std::uint32_t face : get_header().skybox_faces)
+        {
+            faces.emplace_back(get_string(face));
+        }
+
+        return faces;
+    }
+
+    /**
+     * @brief Busca un nodo por su nombre recorriendo los nombres de los nodos.
+     */
+    std::uint32_t Scene_File::find_node(const char * name) const
+    {
+        const std::size_t     node_count = get_count(Scene_Format::NODE_NAMES);
+        const std::uint32_t * names      = get_records< std::uint32_t >(Scene_Format::NODE_NAMES);
+
+        for (std::size_t i = 0; i < node_count; ++i)
+        {
+            if (names[i] != Scene_Format::NO_INDEX && std::strcmp(get_string(names[i]), name) == 0)
+            {
+                return std::uint32_t(i);
+            }
+        }
+
+        return Scene_Format::NO_INDEX;
+    }
+
+}
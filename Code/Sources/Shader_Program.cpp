@@ -0,0 +1,289 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Shader_Program.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <cassert>       // assert
+#include <iostream>      // cerr
+
+namespace udit
+{
+
+    using namespace std;
+
+    /**
+     * @brief Constructor de la clase Shader_Program.
+     *
+     * Compila los dos shaders, los enlaza en un programa y recoge la informacin de sus uniforms
+     * y bloques de uniforms activos. Los errores de compilacin y enlazado se muestran por la
+     * salida de error.
+     *
+     * @param vertex_shader_code Cdigo fuente del vertex shader.
+     * @param fragment_shader_code Cdigo fuente del fragment shader.
+     */
+    Shader_Program::Shader_Program(const string & vertex_shader_code, const string & fragment_shader_code)
+    {
+        GLint succeeded = GL_FALSE;
+
+        // Se crean objetos para los shaders:
+
+        GLuint   vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+        GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+
+        // Se carga el cdigo de los shaders:
+
+        const char  *   vertex_shaders_code[] = {          vertex_shader_code.c_str () };
+        const char  * fragment_shaders_code[] = {        fragment_shader_code.c_str () };
+        const GLint     vertex_shaders_size[] = { (GLint)  vertex_shader_code.size  () };
+        const GLint   fragment_shaders_size[] = { (GLint)fragment_shader_code.size  () };
+
+        glShaderSource  (  vertex_shader_id, 1,   vertex_shaders_code,   vertex_shaders_size);
+        glShaderSource  (fragment_shader_id, 1, fragment_shaders_code, fragment_shaders_size);
+
+        // Se compilan los shaders y se comprueba si la compilacin ha tenido xito:
+
+        glCompileShader (  vertex_shader_id);
+        glCompileShader (fragment_shader_id);
+
+        glGetShaderiv   (  vertex_shader_id, GL_COMPILE_STATUS, &succeeded);
+        if (!succeeded) show_compilation_error (  vertex_shader_id);
+
+        glGetShaderiv   (fragment_shader_id, GL_COMPILE_STATUS, &succeeded);
+        if (!succeeded) show_compilation_error (fragment_shader_id);
+
+        // Se crea el programa y se linkan los shaders:
+
+        program_id = glCreateProgram ();
+
+        glAttachShader  (program_id,   vertex_shader_id);
+        glAttachShader  (program_id, fragment_shader_id);
+
+        glLinkProgram   (program_id);
+
+        glGetProgramiv  (program_id, GL_LINK_STATUS, &succeeded);
+        if (!succeeded) show_linkage_error ();
+
+        // Se liberan los shaders compilados una vez se han linkado:
+
+        glDeleteShader  (  vertex_shader_id);
+        glDeleteShader  (fragment_shader_id);
+
+        reflect ();
+    }
+
+    /**
+     * @brief Constructor de la clase Shader_Program para un compute shader.
+     *
+     * Igual que el de vertex y fragment shader, pero con una sola etapa.
+     *
+     * @param compute_shader_code Cdigo fuente del compute shader.
+     */
+    Shader_Program::Shader_Program(const string & compute_shader_code)
+    {
+        GLint succeeded = GL_FALSE;
+
+        GLuint compute_shader_id = glCreateShader(GL_COMPUTE_SHADER);
+
+        const char  * compute_shaders_code[] = {         compute_shader_code.c_str () };
+        const GLint   compute_shaders_size[] = { (GLint) compute_shader_code.size  () };
+
+        glShaderSource  (compute_shader_id, 1, compute_shaders_code, compute_shaders_size);
+        glCompileShader (compute_shader_id);
+
+        glGetShaderiv   (compute_shader_id, GL_COMPILE_STATUS, &succeeded);
+        if (!succeeded) show_compilation_error (compute_shader_id);
+
+        program_id = glCreateProgram ();
+
+        glAttachShader  (program_id, compute_shader_id);
+        glLinkProgram   (program_id);
+
+        glGetProgramiv  (program_id, GL_LINK_STATUS, &succeeded);
+        if (!succeeded) show_linkage_error ();
+
+        glDeleteShader  (compute_shader_id);
+
+        reflect ();
+    }
+
+    /**
+     * @brief Destructor de la clase Shader_Program.
+     */
+    Shader_Program::~Shader_Program()
+    {
+        glDeleteProgram (program_id);
+    }
+
+    /**
+     * @brief Activa el programa a travs de la cach de estado de OpenGL.
+     */
+    void Shader_Program::use() const
+    {
+        OpenGL_State::instance ().use_program (program_id);
+    }
+
+    /**
+     * @brief Recorre los uniforms y bloques de uniforms activos del programa.
+     *
+     * Los uniforms que pertenecen a un bloque no tienen localizacin propia (se leen del buffer
+     * del bloque), por lo que no se aaden a la tabla de uniforms sueltos.
+     */
+    void Shader_Program::reflect()
+    {
+        GLint uniform_count    = 0;
+        GLint max_name_length  = 0;
+
+        glGetProgramiv (program_id, GL_ACTIVE_UNIFORMS,           &uniform_count  );
+        glGetProgramiv (program_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+        string name(size_t(max_name_length > 0 ? max_name_length : 1), '\0');
+
+        for (GLint i = 0; i < uniform_count; ++i)
+        {
+            GLsizei name_length = 0;
+            GLint   size        = 0;
+            GLenum  type        = 0;
+
+            glGetActiveUniform (program_id, GLuint(i), GLsizei(name.size ()), &name_length, &size, &type, &name.front ());
+
+            Uniform_Info info;
+
+            info.name     = name.substr (0, size_t(name_length));
+            info.location = glGetUniformLocation (program_id, info.name.c_str ());
+            info.type     = type;
+            info.size     = size;
+            info.cached   = false;
+
+            if (info.location < 0) continue;
+
+            // Los arrays se publican como "nombre[0]":
+
+            if (info.name.size () > 3 && info.name.compare (info.name.size () - 3, 3, "[0]") == 0)
+            {
+                info.name.resize (info.name.size () - 3);
+            }
+
+            uniforms.push_back (info);
+        }
+
+        GLint block_count = 0;
+
+        glGetProgramiv (program_id, GL_ACTIVE_UNIFORM_BLOCKS,                     &block_count    );
+        glGetProgramiv (program_id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH,      &max_name_length);
+
+        name.assign (size_t(max_name_length > 0 ? max_name_length : 1), '\0');
+
+        for (GLint i = 0; i < block_count; ++i)
+        {
+            GLsizei name_length = 0;
+            GLint   data_size   = 0;
+
+            glGetActiveUniformBlockName (program_id, GLuint(i), GLsizei(name.size ()), &name_length, &name.front ());
+            glGetActiveUniformBlockiv   (program_id, GLuint(i), GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+
+            uniform_blocks.push_back ({ name.substr (0, size_t(name_length)), GLuint(i), data_size });
+        }
+    }
+
+    /**
+     * @brief Busca un uniform en la tabla obtenida por reflexin.
+     *
+     * @param name Nombre del uniform.
+     * @param matches Funcin que indica si el tipo GLSL del uniform es compatible con el pedido.
+     * @return La posicin del uniform en la tabla o -1 si no existe.
+     */
+    int Shader_Program::find_uniform(const string & name, bool (*matches)(GLenum)) const
+    {
+        for (size_t i = 0; i < uniforms.size (); ++i)
+        {
+            if (uniforms[i].name == name)
+            {
+                assert(matches (uniforms[i].type));
+                return int(i);
+            }
+        }
+
+        cerr << "Aviso: el programa " << program_id << " no tiene el uniform activo " << name << endl;
+
+        return -1;
+    }
+
+    /**
+     * @brief ndice de un bloque de uniforms o GL_INVALID_INDEX si no existe.
+     */
+    GLuint Shader_Program::get_uniform_block_index(const string & name) const
+    {
+        for (const Uniform_Block_Info & block : uniform_blocks)
+        {
+            if (block.name == name) return block.index;
+        }
+
+        return GL_INVALID_INDEX;
+    }
+
+    /**
+     * @brief Tamao en bytes de un bloque de uniforms o 0 si no existe.
+     */
+    GLint Shader_Program::get_uniform_block_size(const string & name) const
+    {
+        for (const Uniform_Block_Info & block : uniform_blocks)
+        {
+            if (block.name == name) return block.data_size;
+        }
+
+        return 0;
+    }
+
+    /**
+     * @brief Asocia un bloque de uniforms a un punto de enlace de buffers.
+     *
+     * @param name Nombre del bloque.
+     * @param binding Punto de enlace.
+     */
+    void Shader_Program::bind_uniform_block(const string & name, GLuint binding) const
+    {
+        GLuint index = get_uniform_block_index (name);
+
+        if (index == GL_INVALID_INDEX)
+        {
+            cerr << "Aviso: el programa " << program_id << " no tiene el bloque de uniforms " << name << endl;
+            return;
+        }
+
+        glUniformBlockBinding (program_id, index, binding);
+    }
+
+    void Shader_Program::show_compilation_error(GLuint shader_id) const
+    {
+        string info_log;
+        GLint  info_log_length;
+
+        glGetShaderiv (shader_id, GL_INFO_LOG_LENGTH, &info_log_length);
+
+        info_log.resize (info_log_length);
+
+        glGetShaderInfoLog (shader_id, info_log_length, NULL, &info_log.front ());
+
+        cerr << info_log.c_str () << endl;
+
+        assert(false);
+    }
+
+    void Shader_Program::show_linkage_error() const
+    {
+        string info_log;
+        GLint  info_log_length;
+
+        glGetProgramiv (program_id, GL_INFO_LOG_LENGTH, &info_log_length);
+
+        info_log.resize (info_log_length);
+
+        glGetProgramInfoLog (program_id, info_log_length, NULL, &info_log.front ());
+
+        cerr << info_log.c_str () << endl;
+
+        assert(false);
+    }
+
+}
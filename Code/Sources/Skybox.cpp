@@ -3,6 +3,7 @@
 
 #include "../Headers/Skybox.hpp"  // Incluir el encabezado de la clase Skybox
 #include <iostream>  // Incluir para poder imprimir mensajes de error y xito
+#include "../Headers/OpenGL_State.hpp"  // Incluir la cach del estado de OpenGL
 
 /**
  * @brief Constructor de la clase Skybox.
@@ -38,7 +39,7 @@ Skybox::~Skybox() {
  */
 void Skybox::load_textures() {
     glGenTextures(1, &texture_id);  // Crear una textura de OpenGL
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);  // Vincular la textura como un cubemap
+    udit::OpenGL_State::instance().bind_texture(0, GL_TEXTURE_CUBE_MAP, texture_id);  // Vincular la textura como un cubemap
 
     int width, height, channels;
     for (GLuint i = 0; i < faces.size(); ++i) {
@@ -168,14 +169,15 @@ GLuint Skybox::get_texture_id()
  * siempre se dibuje detrs de todos los objetos.
  */
 void Skybox::render() {
-    glDepthFunc(GL_LEQUAL);  // Cambiar la funcin de profundidad para asegurar que la skybox est en el fondo
+    udit::OpenGL_State & state = udit::OpenGL_State::instance();
 
-    glBindVertexArray(vao_id);  // Vincular el VAO
-    glActiveTexture(GL_TEXTURE0);  // Activar la primera unidad de textura
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);  // Vincular la textura del cubemap
-    glDisable(GL_CULL_FACE);  // Desactivar el culling para que todas las caras del cubo sean visibles
+    state.set_depth_func(GL_LEQUAL);  // Cambiar la funcin de profundidad para asegurar que la skybox est en el fondo
+
+    state.bind_vertex_array(vao_id);  // Vincular el VAO
+    state.bind_texture(0, GL_TEXTURE_CUBE_MAP, texture_id);  // Vincular la textura del cubemap a la primera unidad
+    state.set_cull_face(false);  // Desactivar el culling para que todas las caras del cubo sean visibles
+    state.set_polygon_mode(GL_FILL);  // Dibujar con relleno aunque el ltimo objeto fuese en alambre
     glDrawArrays(GL_TRIANGLES, 0, 36);  // Dibujar las 36 caras del cubo (6 caras * 2 tringulos * 3 vrtices)
 
-    glBindVertexArray(0);  // Desvincular el VAO
-    glDepthFunc(GL_LESS);  // Restaurar la funcin de profundidad estndar
+    state.set_depth_func(GL_LESS);  // Restaurar la funcin de profundidad estndar
 }
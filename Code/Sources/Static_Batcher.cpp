@@ -0,0 +1,197 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Static_Batcher.hpp"
+#include <cassert>       // assert
+
+namespace udit
+{
+
+    /**
+     * @brief Indica si dos dibujos usan el mismo material y pueden compartir malla combinada.
+     */
+    static bool same_material(const Draw_Item & a, const Draw_Item & b)
+    {
+        return a.pass              == b.pass
+            && a.program_id        == b.program_id
+            && a.texture_id        == b.texture_id
+            && a.mesh.polygon_mode == b.mesh.polygon_mode
+            && a.mesh.cull_face    == b.mesh.cull_face
+            && a.texture_layer     == b.texture_layer
+            && a.transparency      == b.transparency;
+    }
+
+    /**
+     * @brief Constructor de la clase Static_Batcher.
+     *
+     * @param arena Arena de las mallas de los objetos y de las mallas combinadas.
+     */
+    Static_Batcher::Static_Batcher(Mesh_Arena & arena)
+        : arena(arena), meshlet_count(0), visible_meshlet_count(0), next_id(0), dirty(false)
+    {
+    }
+
+    /**
+     * @brief Destructor de la clase Static_Batcher.
+     */
+    Static_Batcher::~Static_Batcher()
+    {
+        release_batches();
+    }
+
+    /**
+     * @brief Registra un objeto esttico.
+     *
+     * @param item Dibujo del objeto.
+     * @return Identificador con el que se puede quitar el objeto.
+     */
+    Static_Batcher::Object_Id Static_Batcher::add(const Draw_Item & item)
+    {
+        assert(item.pass == Render_Pass::OPAQUE_PASS);
+
+        objects.push_back({ next_id, item });
+
+        dirty = true;
+
+        return next_id++;
+    }
+
+    /**
+     * @brief Quita un objeto esttico registrado previamente.
+     *
+     * @param id Identificador devuelto por add().
+     */
+    void Static_Batcher::remove(Object_Id id)
+    {
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            if (objects[i].id == id)
+            {
+                objects.erase(objects.begin() + i);
+                dirty = true;
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Enva a la cola los meshlets visibles de cada material.
+     *
+     * @param queue Cola de render del frame.
+     * @param frustum Volumen de visin de la cmara en este frame.
+     * @param camera_position Posicin de la cmara en el espacio del mundo.
+     */
+    void Static_Batcher::submit(Render_Queue & queue, const Frustum & frustum, const glm::vec3 & camera_position)
+    {
+        if (dirty) rebuild();
+
+        visible_meshlet_count = 0;
+
+        for (std::size_t i = 0; i < batches.size(); ++i)
+        {
+            const Draw_Item & batch = batches[i];
+
+            visible_meshlet_count += batch_meshlets[i].cull(frustum, camera_position, batch.mesh.cull_face, ranges);
+
+            for (const Meshlets::Index_Range & range : ranges)
+            {
+                Draw_Item item = batch;
+
+                item.mesh.first_index = batch.mesh.first_index + range.first_index;
+                item.mesh.index_count = range.index_count;
+
+                queue.submit(item);
+            }
+        }
+    }
+
+    /**
+     * @brief Devuelve a la arena las mallas combinadas actuales.
+     */
+    void Static_Batcher::release_batches()
+    {
+        for (const Draw_Item & batch : batches)
+        {
+            arena.release(batch.mesh);
+        }
+
+        batches       .clear();
+        batch_meshlets.clear();
+
+        meshlet_count = 0;
+    }
+
+    /**
+     * @brief Reconstruye las mallas combinadas a partir de los objetos registrados.
+     *
+     * Los objetos se agrupan por material. Las posiciones de cada objeto se transforman con su matriz
+     * de modelo y sus ndices se desplazan para que apunten a sus vrtices dentro de la malla combinada.
+     * Antes de subirlos, los ndices se reordenan por meshlets.
+     */
+    void Static_Batcher::rebuild()
+    {
+        release_batches();
+
+        std::vector<bool> merged(objects.size(), false);
+
+        std::vector<Mesh_Arena::Vertex> batch_vertices;
+        std::vector<GLuint>             batch_indices;
+        std::vector<Mesh_Arena::Vertex> mesh_vertices;
+        std::vector<GLuint>             mesh_indices;
+
+        for (std::size_t first = 0; first < objects.size(); ++first)
+        {
+            if (merged[first]) continue;
+
+            const Draw_Item & material = objects[first].item;
+
+            batch_vertices.clear();
+            batch_indices .clear();
+
+            for (std::size_t i = first; i < objects.size(); ++i)
+            {
+                const Draw_Item & item = objects[i].item;
+
+                if (merged[i] || !same_material(material, item)) continue;
+
+                merged[i] = true;
+
+                arena.read(item.mesh, mesh_vertices, mesh_indices);
+
+                const GLuint index_offset = GLuint(batch_vertices.size());
+
+                for (Mesh_Arena::Vertex vertex : mesh_vertices)
+                {
+                    glm::vec4 position = item.model_matrix * glm::vec4(vertex.position[0], vertex.position[1], vertex.position[2], 1.f);
+
+                    vertex.position[0] = position.x;
+                    vertex.position[1] = position.y;
+                    vertex.position[2] = position.z;
+
+                    batch_vertices.push_back(vertex);
+                }
+
+                for (GLuint index : mesh_indices)
+                {
+                    batch_indices.push_back(index + index_offset);
+                }
+            }
+
+            batch_meshlets.emplace_back();
+            batch_meshlets.back().build(batch_vertices, batch_indices);
+
+            meshlet_count += batch_meshlets.back().size();
+
+            Draw_Item batch = material;
+
+            batch.mesh         = arena.allocate(batch_vertices, batch_indices, material.mesh.polygon_mode, material.mesh.cull_face);
+            batch.model_matrix = glm::mat4(1.f);
+            batch.object_id    = Draw_Item::NO_OBJECT;     // La malla combinada no es ninguno de los objetos
+
+            batches.push_back(batch);
+        }
+
+        dirty = false;
+    }
+
+}
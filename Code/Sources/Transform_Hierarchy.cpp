@@ -0,0 +1,112 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+#include "../Headers/Transform_Hierarchy.hpp"
+#include <cassert>                          // assert
+
+namespace udit
+{
+
+    /**
+     * @brief Constructor de la clase Transform_Hierarchy.
+     */
+    Transform_Hierarchy::Transform_Hierarchy()
+        : updated_count(0)
+    {
+    }
+
+    /**
+     * @brief Aade un nodo al final de la jerarqua.
+     *
+     * El nodo nace marcado, de modo que su matriz del mundo se calcula en el prximo update().
+     */
+    Transform_Hierarchy::Node Transform_Hierarchy::add(const Transform & local, Node parent)
+    {
+        assert(parent == NO_PARENT || parent < parents.size());
+
+        parents.push_back(parent);
+        locals .push_back(local);
+        worlds .push_back(glm::mat4(1.f));
+        dirty  .push_back(1);
+        updated.push_back(0);
+
+        return Node(parents.size() - 1);
+    }
+
+    /**
+     * @brief Aade un bloque de nodos de una vez.
+     *
+     * Las transformaciones se copian en bloque; solo los padres se recorren para pasarlos de
+     * ndices dentro del bloque a identificadores de la jerarqua.
+     */
+    Transform_Hierarchy::Node Transform_Hierarchy::add(const Node * block_parents, const Transform * block_locals, std::size_t count)
+    {
+        const Node first = Node(parents.size());
+
+        parents.reserve(first + count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            assert(block_parents[i] == NO_PARENT || block_parents[i] < i);
+
+            parents.push_back(block_parents[i] == NO_PARENT ? NO_PARENT : first + block_parents[i]);
+        }
+
+        locals .insert(locals.end(), block_locals, block_locals + count);
+        worlds .resize(first + count, glm::mat4(1.f));
+        dirty  .resize(first + count, 1);
+        updated.resize(first + count, 0);
+
+        return first;
+    }
+
+    /**
+     * @brief Recalcula las matrices del mundo de los nodos marcados y de sus descendientes.
+     *
+     * Como cada padre va antes que sus hijos, al llegar a un nodo ya se sabe si su padre se ha
+     * recalculado en este recorrido.
+     */
+    void Transform_Hierarchy::update()
+    {
+        const std::size_t count = parents.size();
+
+        updated_count = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const Node parent = parents[i];
+
+            if (!dirty[i] && (parent == NO_PARENT || !updated[parent]))
+            {
+                updated[i] = 0;
+                continue;
+            }
+
+            worlds[i] = parent == NO_PARENT ? make_matrix(locals[i]) : worlds[parent] * make_matrix(locals[i]);
+
+            dirty  [i] = 0;
+            updated[i] = 1;
+
+            updated_count++;
+        }
+    }
+
+    /**
+     * @brief Matriz de una transformacin local.
+     *
+     * Se construye directamente a partir de la rotacin, escalando sus columnas y poniendo la
+     * traslacin en la ltima, sin multiplicar matrices.
+     */
+    glm::mat4 Transform_Hierarchy::make_matrix(const Transform & transform)
+    {
+        glm::mat4 matrix = glm::mat4_cast(transform.rotation);
+
+        matrix[0] *= transform.scale.x;
+        matrix[1] *= transform.scale.y;
+        matrix[2] *= transform.scale.z;
+        matrix[3]  = glm::vec4(transform.translation, 1.f);
+
+        return matrix;
+    }
+
+}
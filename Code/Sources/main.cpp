@@ -6,13 +6,47 @@
 #include <SDL.h>
 #include "../Headers/Scene.hpp"
 #include "../Headers/Camera.hpp"
+#include "../Headers/OpenGL_State.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include "../Headers/Render_Settings.hpp"
+#include "../Headers/Frame_Timer.hpp"
+#include "../Headers/GL_Capture.hpp"
+#include "../Headers/Scene_File.hpp"
 #include <Window.hpp>
 
 using udit::Scene;
 using udit::Window;
-
-int main(int, char* [])
+using udit::OpenGL_State;
+using udit::Frame_Timer;
+using udit::Render_Settings;
+using udit::GL_Capture;
+using udit::Scene_File;
+using udit::Loose_Octree;
+
+int main(int argc, char* argv[])
 {
+    // El camino de dibujo se elige al arrancar para poder compararlos sobre la misma escena:
+    //   --vertex-pulling  los vértices se leen de SSBOs en el vertex shader en lugar de del VAO
+    //   --no-mdi          se emite un dibujo por grupo aunque haya multi-draw indirect
+    //   --threads N       número de hilos que preparan los dibujos de cada frame
+    //   --occlusion M     descarte de objetos tapados: none, software (en CPU), hardware (consultas en GPU)
+    //                     o gpu (compute shader con pirámide Hi-Z)
+    //   --capture F N     graba en el archivo F las llamadas a OpenGL de los N primeros frames
+    //   --min-pixels P    descarta los objetos que ocupan menos de P píxeles de alto en pantalla
+    //   --fade-pixels P   desvanece con un tramado los objetos a menos de P píxeles del umbral
+    //   --scene F         carga la escena del archivo binario F (generado con Scene_Converter)
+
+    Render_Settings settings = Render_Settings::parse(argc, argv);
+
+    // La descripción de la escena se mapea antes de crear la ventana para no abrirla si falta:
+
+    Scene_File scene_file;
+
+    if (!scene_file.open(settings.scene_path))
+    {
+        return -1;
+    }
+
     constexpr unsigned viewport_width = 1024;
     constexpr unsigned viewport_height = 576;
 
@@ -24,6 +58,9 @@ int main(int, char* [])
 
     SDL_SetRelativeMouseMode(SDL_TRUE);
 
+    // Se pide OpenGL 4.3 para poder usar multi-draw indirect. Si el driver no lo admite la ventana
+    // crea un contexto 3.3 y la escena usa el camino de dibujo de OpenGL 3.3:
+
     Window window
     (
         "OpenGL example",
@@ -31,13 +68,33 @@ int main(int, char* [])
         Window::Position::CENTERED,
         viewport_width,
         viewport_height,
-        { 3, 3 }
+        { 4, 3 }
     );
 
-    Scene scene(viewport_width, viewport_height);
+    // Se cargan las funciones de OpenGL posteriores a la 3.3 que el contexto tenga disponibles:
+
+    udit::OpenGL_Extensions::load();
+
+    settings.validate();
+
+    // La grabación empieza antes de crear la escena para que la traza incluya la carga de mallas,
+    // texturas y shaders:
+
+    if (!settings.capture_path.empty())
+    {
+        GL_Capture::start(settings.capture_path, settings.capture_frames, viewport_width, viewport_height);
+    }
+
+    Scene scene(viewport_width, viewport_height, settings, scene_file);
+
+    scene_file.close();
+
+    OpenGL_State & gl_state = OpenGL_State::instance();
+    Frame_Timer    frame_timer;
 
     bool exit = false;
     Uint32 last_time = SDL_GetTicks();
+    Uint32 last_report_time = last_time;
 
     do
     {
@@ -53,6 +110,18 @@ int main(int, char* [])
             {
                 scene.process_mouse_motion(event.motion.xrel, -event.motion.yrel);
             }
+
+            if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT)
+            {
+                float distance;
+
+                std::uint32_t object_id = scene.pick_aimed_object(distance);
+
+                if (object_id != Loose_Octree::INVALID)
+                    std::cout << "Objeto seleccionado: " << object_id << " a " << distance << std::endl;
+                else
+                    std::cout << "Ningun objeto seleccionado" << std::endl;
+            }
         }
 
         const Uint8* keystate = SDL_GetKeyboardState(NULL);
@@ -63,11 +132,61 @@ int main(int, char* [])
 
         scene.process_input(keystate, delta_time);
         scene.update();
+
+        gl_state.begin_frame();
+        frame_timer.begin_frame();
         scene.render();
+        frame_timer.end_frame();
 
         window.swap_buffers();
+
+        GL_Capture::end_frame();
+
+        // Una vez por segundo se informa del coste medio de dibujar la escena y de cuántos cambios
+        // de estado llegaron al driver:
+
+        if (current_time - last_report_time >= 1000)
+        {
+            double cpu_milliseconds, gpu_milliseconds;
+
+            frame_timer.take_averages(cpu_milliseconds, gpu_milliseconds);
+
+            std::cout << (settings.vertex_pulling ? "Vertex pulling" : "VAO")
+                      << (settings.multi_draw_indirect ? " + MDI" : "")
+                      << ": CPU " << cpu_milliseconds << " ms, GPU " << gpu_milliseconds << " ms, "
+                      << scene.get_draw_call_count() << " dibujos por frame" << std::endl;
+
+            std::cout << "Descarte por volumen de vision: " << scene.get_visible_count() << " visibles, "
+                      << scene.get_culled_count() << " descartados, "
+                      << scene.get_occluded_count() << " tapados, "
+                      << scene.get_small_count() << " demasiado pequenos" << std::endl;
+
+            std::cout << "Meshlets: " << scene.get_visible_meshlet_count() << " de "
+                      << scene.get_meshlet_count() << " enviados" << std::endl;
+
+            std::cout << "Entidades: " << scene.get_visible_entity_count() << " de "
+                      << scene.get_entity_count() << " enviadas" << std::endl;
+
+            if (settings.occlusion == udit::Occlusion_Mode::HARDWARE)
+            {
+                std::cout << "Consultas de oclusion: " << scene.get_query_hit_count() << " visibles, "
+                          << scene.get_query_miss_count() << " tapadas" << std::endl;
+            }
+
+            if (settings.occlusion == udit::Occlusion_Mode::GPU)
+            {
+                std::cout << "Descarte en la GPU: " << scene.get_gpu_tested_count() << " instancias comprobadas" << std::endl;
+            }
+
+            std::cout << "Estado GL: " << gl_state.get_issued_count() << " llamadas enviadas, "
+                      << gl_state.get_skipped_count() << " evitadas por frame" << std::endl;
+
+            last_report_time = current_time;
+        }
     } while (!exit);
 
+    GL_Capture::stop();
+
     SDL_Quit();
 
     return 0;
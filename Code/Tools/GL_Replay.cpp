@@ -0,0 +1,701 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+// Herramienta que reproduce una traza grabada con GL_Capture (--capture archivo N) tan rpido como
+// puede (sin sincronizar con el refresco vertical) e informa del tiempo de CPU que cuesta enviar
+// al driver las llamadas de cada frame. Sirve para medir el coste de envo del renderizado sin el
+// trabajo de la aplicacin (entrada, actualizacin de la escena, preparacin de los dibujos...).
+//
+// Uso: GL_Replay traza
+//
+// En una mquina sin pantalla se puede usar el driver de vdeo sin ventana de SDL con Mesa
+// (SDL_VIDEODRIVER=offscreen).
+
+#include <algorithm>     // min, max
+#include <cstdint>       // uint16_t, uint64_t
+#include <cstring>       // memcmp, memcpy
+#include <fstream>       // ifstream
+#include <iterator>      // istreambuf_iterator
+#include <iostream>      // cout, cerr
+#include <string>        // string
+#include <tuple>         // tuple, apply
+#include <unordered_map> // unordered_map
+#include <vector>        // vector
+#include <SDL.h>
+#include "../Headers/GL_Trace.hpp"
+#include "../Headers/OpenGL_Extensions.hpp"
+#include <Window.hpp>
+
+namespace udit
+{
+
+    template< typename TYPE >
+    struct Argument;
+
+    /**
+     * @class Trace_Replayer
+     * @brief Ejecuta los registros de una traza cargada en memoria.
+     *
+     * Los objetos se crean de nuevo y los nombres, localizaciones y objetos de sincronizacin que
+     * aparecen en la traza se traducen a los obtenidos al reproducirla.
+     */
+    class Trace_Replayer
+    {
+    public:
+
+        /**
+         * @brief Resultado de ejecutar los registros de un frame.
+         */
+        enum Result
+        {
+            FRAME_ENDED,
+            TRACE_ENDED,
+            TRACE_ERROR
+        };
+
+    private:
+
+        const std::vector<char> & trace;
+        std::size_t               position;
+
+        std::unordered_map< GLuint, GLuint > names[GL_Trace::NAME_SPACE_COUNT];
+
+        std::unordered_map< GLuint, std::unordered_map< GLint, GLint > > locations;   ///< Por programa
+
+        std::unordered_map< std::uint64_t, GLsync > syncs;
+        std::unordered_map< GLenum, void *        > mapped_pointers;                   ///< Por tipo de buffer
+
+        GLuint                    current_program;
+        std::vector< GLuint >     new_names;
+        bool                      truncated;                                            ///< Algn registro se sale de la traza
+
+    public:
+
+        /**
+         * @param trace Contenido de la traza a partir de la cabecera.
+         * @param start Posicin del primer registro.
+         */
+        Trace_Replayer(const std::vector<char> & trace, std::size_t start)
+            : trace(trace), position(start), current_program(0), truncated(false)
+        {
+        }
+
+        /**
+         * @brief Ejecuta los registros hasta el final del frame actual.
+         */
+        Result replay_frame();
+
+    private:
+
+        // Lectura de la traza. Antes de cada lectura se comprueba que los datos estn dentro de la
+        // traza; si no, se marca como truncada, se devuelve cero y el registro no se ejecuta:
+
+        template< typename TYPE >
+        TYPE read()
+        {
+            TYPE value{};
+
+            if (trace.size() - position < sizeof(TYPE))
+            {
+                truncated = true;
+                position  = trace.size();
+                return value;
+            }
+
+            std::memcpy(&value, trace.data() + position, sizeof(TYPE));
+
+            position += sizeof(TYPE);
+
+            return value;
+        }
+
+        template< typename TYPE >
+        TYPE peek() const
+        {
+            TYPE value{};
+
+            if (trace.size() - position >= sizeof(TYPE))
+            {
+                std::memcpy(&value, trace.data() + position, sizeof(TYPE));
+            }
+
+            return value;
+        }
+
+        /**
+         * @brief Lee unos datos precedidos de su tamao.
+         * @return Puntero a los datos dentro de la traza o nullptr si no hay datos o no caben en la traza.
+         */
+        const char * read_payload(std::size_t & size)
+        {
+            const std::uint64_t recorded_size = read<std::uint64_t>();
+
+            if (recorded_size > trace.size() - position)
+            {
+                truncated = true;
+                position  = trace.size();
+                size      = 0;
+                return nullptr;
+            }
+
+            size = std::size_t(recorded_size);
+
+            const char * data = size > 0 ? trace.data() + position : nullptr;
+
+            position += size;
+
+            return data;
+        }
+
+        // Traduccin de lo grabado a lo obtenido al reproducir:
+
+        GLuint translate(GL_Trace::Name_Space name_space, GLuint name) const
+        {
+            if (name == 0) return 0;
+
+            const auto translation = names[name_space].find(name);
+
+            return translation != names[name_space].end() ? translation->second : name;
+        }
+
+        GLint translate_location(GLint location) const
+        {
+            const auto program = locations.find(current_program);
+
+            if (program == locations.end()) return location;
+
+            const auto translation = program->second.find(location);
+
+            return translation != program->second.end() ? translation->second : location;
+        }
+
+        template< typename TYPE >
+        friend struct Argument;
+
+        /**
+         * @brief Lee los argumentos de una funcin y la llama.
+         *
+         * La lista entre llaves garantiza que los argumentos se leen en orden.
+         */
+        template< typename ...TYPES, typename FUNCTION >
+        void replay_call(FUNCTION function)
+        {
+            std::tuple< decltype(Argument<TYPES>::read(*this))... > arguments{ Argument<TYPES>::read(*this)... };
+
+            if (!truncated) std::apply(function, arguments);
+        }
+
+        void replay_gen   (void (APIENTRYP function)(GLsizei, GLuint *),       GL_Trace::Name_Space name_space);
+        void replay_delete(void (APIENTRYP function)(GLsizei, const GLuint *), GL_Trace::Name_Space name_space);
+
+    };
+
+    // Lectura de los argumentos de las funciones de UDIT_GL_TRACE_FUNCTIONS segn su tipo:
+
+    template< typename TYPE >
+    struct Argument
+    {
+        static TYPE read(Trace_Replayer & replayer) { return replayer.read<TYPE>(); }
+    };
+
+    template< GL_Trace::Name_Space NAME_SPACE >
+    struct Argument< GL_Trace::Name< NAME_SPACE > >
+    {
+        static GLuint read(Trace_Replayer & replayer) { return replayer.translate(NAME_SPACE, replayer.read<GLuint>()); }
+    };
+
+    template< >
+    struct Argument< GL_Trace::Location >
+    {
+        static GLint read(Trace_Replayer & replayer) { return replayer.translate_location(replayer.read<GLint>()); }
+    };
+
+    /**
+     * @brief Crea los objetos de un registro glGen* y guarda la traduccin de sus nombres.
+     */
+    void Trace_Replayer::replay_gen(void (APIENTRYP function)(GLsizei, GLuint *), GL_Trace::Name_Space name_space)
+    {
+        std::size_t  size;
+        const char * recorded_names = read_payload(size);
+        GLsizei      count          = GLsizei(size / sizeof(GLuint));
+
+        if (truncated) return;
+
+        new_names.resize(count);
+
+        function(count, new_names.data());
+
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            GLuint recorded_name;
+
+            std::memcpy(&recorded_name, recorded_names + i * sizeof(GLuint), sizeof(GLuint));
+
+            names[name_space][recorded_name] = new_names[i];
+        }
+    }
+
+    /**
+     * @brief Elimina los objetos de un registro glDelete* y olvida la traduccin de sus nombres.
+     */
+    void Trace_Replayer::replay_delete(void (APIENTRYP function)(GLsizei, const GLuint *), GL_Trace::Name_Space name_space)
+    {
+        std::size_t  size;
+        const char * recorded_names = read_payload(size);
+        GLsizei      count          = GLsizei(size / sizeof(GLuint));
+
+        if (truncated) return;
+
+        new_names.resize(count);
+
+        for (GLsizei i = 0; i < count; ++i)
+        {
+            GLuint recorded_name;
+
+            std::memcpy(&recorded_name, recorded_names + i * sizeof(GLuint), sizeof(GLuint));
+
+            new_names[i] = translate(name_space, recorded_name);
+
+            names[name_space].erase(recorded_name);
+        }
+
+        function(count, new_names.data());
+    }
+
+    /**
+     * @brief Ejecuta los registros hasta el final del frame actual.
+     */
+    Trace_Replayer::Result Trace_Replayer::replay_frame()
+    {
+        std::size_t size;                           // Tamao de los datos que acompaan al registro
+
+        while (position + sizeof(GL_Trace_Opcode) <= trace.size())
+        {
+            const GL_Trace_Opcode opcode = read<GL_Trace_Opcode>();
+
+            // El programa activo determina cmo se traducen las localizaciones de los uniforms:
+
+            if (opcode == GL_Trace_Opcode::UseProgram)
+            {
+                current_program = translate(GL_Trace::PROGRAM, peek<GLuint>());
+            }
+
+            switch (opcode)
+            {
+                #define UDIT_GL_REPLAY_UNPACK(...) __VA_ARGS__
+
+                #define UDIT_GL_REPLAY_CALL(NAME, PARAMETERS, ARGUMENTS, REPLAY_TYPES) \
+                    case GL_Trace_Opcode::NAME: replay_call< UDIT_GL_REPLAY_UNPACK REPLAY_TYPES >(glad_gl##NAME); break;
+
+                UDIT_GL_TRACE_FUNCTIONS(UDIT_GL_REPLAY_CALL)
+
+                #undef  UDIT_GL_REPLAY_CALL
+                #undef  UDIT_GL_REPLAY_UNPACK
+
+                case GL_Trace_Opcode::GenBuffers:         replay_gen   (glGenBuffers,         GL_Trace::BUFFER      ); break;
+                case GL_Trace_Opcode::GenTextures:        replay_gen   (glGenTextures,        GL_Trace::TEXTURE     ); break;
+                case GL_Trace_Opcode::GenVertexArrays:    replay_gen   (glGenVertexArrays,    GL_Trace::VERTEX_ARRAY); break;
+                case GL_Trace_Opcode::GenFramebuffers:    replay_gen   (glGenFramebuffers,    GL_Trace::FRAMEBUFFER ); break;
+                case GL_Trace_Opcode::GenQueries:         replay_gen   (glGenQueries,         GL_Trace::QUERY       ); break;
+                case GL_Trace_Opcode::DeleteBuffers:      replay_delete(glDeleteBuffers,      GL_Trace::BUFFER      ); break;
+                case GL_Trace_Opcode::DeleteTextures:     replay_delete(glDeleteTextures,     GL_Trace::TEXTURE     ); break;
+                case GL_Trace_Opcode::DeleteVertexArrays: replay_delete(glDeleteVertexArrays, GL_Trace::VERTEX_ARRAY); break;
+                case GL_Trace_Opcode::DeleteFramebuffers: replay_delete(glDeleteFramebuffers, GL_Trace::FRAMEBUFFER ); break;
+                case GL_Trace_Opcode::DeleteQueries:      replay_delete(glDeleteQueries,      GL_Trace::QUERY       ); break;
+
+                case GL_Trace_Opcode::CreateShader:
+                {
+                    const GLenum type   = read<GLenum>();
+                    const GLuint shader = read<GLuint>();
+
+                    if (truncated) break;
+
+                    names[GL_Trace::SHADER][shader] = glCreateShader(type);
+                    break;
+                }
+
+                case GL_Trace_Opcode::CreateProgram:
+                {
+                    const GLuint program = read<GLuint>();
+
+                    if (truncated) break;
+
+                    names[GL_Trace::PROGRAM][program] = glCreateProgram();
+                    break;
+                }
+
+                case GL_Trace_Opcode::ShaderSource:
+                {
+                    const GLuint   shader = translate(GL_Trace::SHADER, read<GLuint>());
+                    const GLchar * source = read_payload(size);
+                    const GLint    length = GLint(size);
+
+                    if (truncated) break;
+
+                    glShaderSource(shader, 1, &source, &length);
+                    break;
+                }
+
+                case GL_Trace_Opcode::GetUniformLocation:
+                {
+                    const GLuint       program = translate(GL_Trace::PROGRAM, read<GLuint>());
+                    const char       * name    = read_payload(size);
+                    const std::string  name_string(name, size);
+                    const GLint        location = read<GLint>();
+
+                    if (truncated) break;
+
+                    locations[program][location] = glGetUniformLocation(program, name_string.c_str());
+                    break;
+                }
+
+                case GL_Trace_Opcode::BufferData:
+                {
+                    const GLenum     target = read<GLenum    >();
+                    const GLsizeiptr length = read<GLsizeiptr>();
+                    const GLenum     usage  = read<GLenum    >();
+                    const char     * data   = read_payload(size);
+
+                    if (truncated) break;
+
+                    glBufferData(target, length, data, usage);
+                    break;
+                }
+
+                case GL_Trace_Opcode::BufferSubData:
+                {
+                    const GLenum   target = read<GLenum  >();
+                    const GLintptr offset = read<GLintptr>();
+                    const char   * data   = read_payload(size);
+
+                    if (truncated) break;
+
+                    glBufferSubData(target, offset, GLsizeiptr(size), data);
+                    break;
+                }
+
+                case GL_Trace_Opcode::MapBufferRange:
+                {
+                    const GLenum     target = read<GLenum    >();
+                    const GLintptr   offset = read<GLintptr  >();
+                    const GLsizeiptr length = read<GLsizeiptr>();
+                    const GLbitfield access = read<GLbitfield>();
+
+                    if (truncated) break;
+
+                    mapped_pointers[target] = glMapBufferRange(target, offset, length, access);
+                    break;
+                }
+
+                case GL_Trace_Opcode::UnmapBuffer:
+                {
+                    const GLenum target = read<GLenum>();
+                    const char * data   = read_payload(size);
+                    if (truncated) break;
+
+                    void       * mapped = mapped_pointers[target];
+
+                    if (data && mapped) std::memcpy(mapped, data, size);
+
+                    mapped_pointers.erase(target);
+
+                    glUnmapBuffer(target);
+                    break;
+                }
+
+                case GL_Trace_Opcode::TexImage2D:
+                {
+                    const GLenum  target          = read<GLenum >();
+                    const GLint   level           = read<GLint  >();
+                    const GLint   internal_format = read<GLint  >();
+                    const GLsizei width           = read<GLsizei>();
+                    const GLsizei height          = read<GLsizei>();
+                    const GLint   border          = read<GLint  >();
+                    const GLenum  format          = read<GLenum >();
+                    const GLenum  type            = read<GLenum >();
+                    const char  * pixels          = read_payload(size);
+
+                    if (truncated) break;
+
+                    glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+                    break;
+                }
+
+                case GL_Trace_Opcode::TexImage3D:
+                {
+                    const GLenum  target          = read<GLenum >();
+                    const GLint   level           = read<GLint  >();
+                    const GLint   internal_format = read<GLint  >();
+                    const GLsizei width           = read<GLsizei>();
+                    const GLsizei height          = read<GLsizei>();
+                    const GLsizei depth           = read<GLsizei>();
+                    const GLint   border          = read<GLint  >();
+                    const GLenum  format          = read<GLenum >();
+                    const GLenum  type            = read<GLenum >();
+                    const char  * pixels          = read_payload(size);
+
+                    if (truncated) break;
+
+                    glTexImage3D(target, level, internal_format, width, height, depth, border, format, type, pixels);
+                    break;
+                }
+
+                case GL_Trace_Opcode::DrawBuffers:
+                {
+                    const char * buffers = read_payload(size);
+
+                    if (truncated) break;
+
+                    glDrawBuffers(GLsizei(size / sizeof(GLenum)), reinterpret_cast<const GLenum *>(buffers));
+                    break;
+                }
+
+                #define UDIT_GL_REPLAY_UNIFORM(NAME, SIZE)                                          \
+                    case GL_Trace_Opcode::NAME:                                                     \
+                    {                                                                               \
+                        const GLint location = translate_location(read<GLint>());                   \
+                        const char * value   = read_payload(size);                                  \
+                        if (truncated) break;                                                       \
+                        gl##NAME (location, GLsizei(size / (SIZE * sizeof(GLfloat))), reinterpret_cast<const GLfloat *>(value)); \
+                        break;                                                                      \
+                    }
+
+                #define UDIT_GL_REPLAY_UNIFORM_MATRIX(NAME, SIZE)                                   \
+                    case GL_Trace_Opcode::NAME:                                                     \
+                    {                                                                               \
+                        const GLint     location  = translate_location(read<GLint>());              \
+                        const GLboolean transpose = read<GLboolean>();                              \
+                        const char    * value     = read_payload(size);                             \
+                        if (truncated) break;                                                       \
+                        gl##NAME (location, GLsizei(size / (SIZE * sizeof(GLfloat))), transpose, reinterpret_cast<const GLfloat *>(value)); \
+                        break;                                                                      \
+                    }
+
+                UDIT_GL_REPLAY_UNIFORM       (Uniform2fv,        2)
+                UDIT_GL_REPLAY_UNIFORM       (Uniform3fv,        3)
+                UDIT_GL_REPLAY_UNIFORM       (Uniform4fv,        4)
+                UDIT_GL_REPLAY_UNIFORM_MATRIX(UniformMatrix3fv,  9)
+                UDIT_GL_REPLAY_UNIFORM_MATRIX(UniformMatrix4fv, 16)
+
+                #undef  UDIT_GL_REPLAY_UNIFORM
+                #undef  UDIT_GL_REPLAY_UNIFORM_MATRIX
+
+                case GL_Trace_Opcode::FenceSync:
+                {
+                    const GLenum        condition = read<GLenum       >();
+                    const GLbitfield    flags     = read<GLbitfield   >();
+                    const std::uint64_t sync      = read<std::uint64_t>();
+
+                    if (truncated) break;
+
+                    syncs[sync] = glFenceSync(condition, flags);
+                    break;
+                }
+
+                case GL_Trace_Opcode::ClientWaitSync:
+                {
+                    const std::uint64_t sync = read<std::uint64_t>();
+
+                    read<GLbitfield>();
+                    read<GLuint64  >();
+
+                    // Al grabar se esper hasta que se cumpli (quiz con varias llamadas). Aqu se
+                    // espera hasta que se cumpla en la primera, ya que de ello depende que se pueda
+                    // escribir en la zona del buffer que protege:
+
+                    if (truncated) break;
+
+                    const auto found = syncs.find(sync);
+
+                    if (found != syncs.end())
+                    {
+                        while (glClientWaitSync(found->second, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+                    }
+                    break;
+                }
+
+                case GL_Trace_Opcode::DeleteSync:
+                {
+                    const auto found = syncs.find(read<std::uint64_t>());
+
+                    if (!truncated && found != syncs.end())
+                    {
+                        glDeleteSync(found->second);
+                        syncs.erase (found);
+                    }
+                    break;
+                }
+
+                case GL_Trace_Opcode::MultiDrawElementsIndirect:
+                {
+                    const GLenum  mode       = read<GLenum      >();
+                    const GLenum  type       = read<GLenum      >();
+                    const void  * indirect   = read<const void *>();
+                    const GLsizei draw_count = read<GLsizei     >();
+                    const GLsizei stride     = read<GLsizei     >();
+
+                    if (truncated) break;
+
+                    if (!OpenGL_Extensions::multi_draw_elements_indirect)
+                    {
+                        std::cerr << "Error: la traza usa glMultiDrawElementsIndirect y el contexto no lo admite" << std::endl;
+                        return TRACE_ERROR;
+                    }
+
+                    OpenGL_Extensions::multi_draw_elements_indirect(mode, type, indirect, draw_count, stride);
+                    break;
+                }
+
+                case GL_Trace_Opcode::END_FRAME: return FRAME_ENDED;
+                case GL_Trace_Opcode::END_TRACE: return TRACE_ENDED;
+
+                default:
+                {
+                    std::cerr << "Error: codigo de operacion desconocido " << unsigned(opcode) << std::endl;
+                    return TRACE_ERROR;
+                }
+            }
+
+            if (truncated)
+            {
+                std::cerr << "Error: la traza termina en mitad de un registro" << std::endl;
+                return TRACE_ERROR;
+            }
+        }
+
+        return TRACE_ENDED;
+    }
+
+}
+
+using udit::Trace_Replayer;
+using udit::Window;
+
+int main(int argc, char * argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Uso: GL_Replay traza" << std::endl;
+        return -1;
+    }
+
+    // La traza se carga entera en memoria para que leerla del disco no cuente en los tiempos:
+
+    std::ifstream trace_file(argv[1], std::ios::binary);
+
+    if (!trace_file)
+    {
+        std::cerr << "Error al abrir la traza " << argv[1] << std::endl;
+        return -1;
+    }
+
+    std::vector<char> trace((std::istreambuf_iterator<char>(trace_file)), std::istreambuf_iterator<char>());
+
+    udit::GL_Trace::Header header;
+
+    if (trace.size() < sizeof(header))
+    {
+        std::cerr << "Error: la traza esta incompleta" << std::endl;
+        return -1;
+    }
+
+    std::memcpy(&header, trace.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, udit::GL_Trace::MAGIC, sizeof(header.magic)) != 0 || header.version != udit::GL_Trace::VERSION)
+    {
+        std::cerr << "Error: " << argv[1] << " no es una traza compatible" << std::endl;
+        return -1;
+    }
+
+    if (header.pointer_size != sizeof(void *))
+    {
+        std::cerr << "Error: la traza se grabo con punteros de " << header.pointer_size << " bytes" << std::endl;
+        return -1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) < 0)
+    {
+        std::cerr << "Error al inicializar SDL: " << SDL_GetError() << std::endl;
+        return -1;
+    }
+
+    // Se pide el mismo contexto que la aplicacin pero sin sincronizar con el refresco vertical:
+
+    Window::OpenGL_Context_Settings context_settings;
+
+    context_settings.version_major = 4;
+    context_settings.version_minor = 3;
+    context_settings.enable_vsync  = false;
+
+    Window window
+    (
+        "GL replay",
+        Window::Position::CENTERED,
+        Window::Position::CENTERED,
+        header.width,
+        header.height,
+        context_settings
+    );
+
+    udit::OpenGL_Extensions::load();
+
+    // El primer frame incluye la carga de la escena (se grab desde antes de crearla), por lo que
+    // se informa de l aparte:
+
+    Trace_Replayer         replayer(trace, sizeof(header));
+    Trace_Replayer::Result result = Trace_Replayer::FRAME_ENDED;
+    std::vector<double>    frame_milliseconds;
+
+    const double ticks_per_millisecond = double(SDL_GetPerformanceFrequency()) / 1000.0;
+
+    while (result == Trace_Replayer::FRAME_ENDED)
+    {
+        const Uint64 start_ticks = SDL_GetPerformanceCounter();
+
+        result = replayer.replay_frame();
+
+        const Uint64 end_ticks = SDL_GetPerformanceCounter();
+
+        if (result != Trace_Replayer::FRAME_ENDED) break;
+
+        frame_milliseconds.push_back(double(end_ticks - start_ticks) / ticks_per_millisecond);
+
+        window.swap_buffers();
+
+        SDL_Event event;
+
+        while (SDL_PollEvent(&event) > 0)
+        {
+            if (event.type == SDL_QUIT) result = Trace_Replayer::TRACE_ENDED;
+        }
+    }
+
+    if (!frame_milliseconds.empty())
+    {
+        std::cout << "Frame 1 (incluye la carga): " << frame_milliseconds[0] << " ms" << std::endl;
+    }
+
+    if (frame_milliseconds.size() > 1)
+    {
+        double minimum = frame_milliseconds[1];
+        double maximum = frame_milliseconds[1];
+        double total   = 0.0;
+
+        for (std::size_t i = 1; i < frame_milliseconds.size(); ++i)
+        {
+            std::cout << "Frame " << i + 1 << ": " << frame_milliseconds[i] << " ms" << std::endl;
+
+            minimum  = std::min(minimum, frame_milliseconds[i]);
+            maximum  = std::max(maximum, frame_milliseconds[i]);
+            total   += frame_milliseconds[i];
+        }
+
+        std::cout << "Envio por frame (" << frame_milliseconds.size() - 1 << " frames): minimo " << minimum
+                  << " ms, medio " << total / double(frame_milliseconds.size() - 1)
+                  << " ms, maximo " << maximum << " ms" << std::endl;
+    }
+
+    SDL_Quit();
+
+    return result == Trace_Replayer::TRACE_ERROR ? -1 : 0;
+}
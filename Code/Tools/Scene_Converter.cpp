@@ -0,0 +1,489 @@
+// Este cdigo es de dominio pblico
+// davidbercialblazquez@gmail.com
+
+// Herramienta que convierte la descripcin de una escena en texto al formato binario que carga la
+// aplicacin (ver Scene_Format.hpp). Todo el trabajo de leer y comprobar el texto se hace aqu una
+// vez, de modo que al arrancar la aplicacin solo tiene que mapear el archivo binario.
+//
+// Uso: Scene_Converter escena.txt escena.scene
+//
+// El texto tiene una orden por lnea; lo que sigue a # es un comentario. Los nombres y las rutas no
+// pueden tener espacios. Las referencias a materiales, mallas y nodos se hacen por su nombre, y lo
+// referenciado tiene que estar definido antes.
+//
+//   camera   x y z yaw pitch                       Posicin y orientacin inicial (grados)
+//   clear    r g b a                               Color de fondo
+//   skybox   +x -x +y -y +z -z                     Imgenes de las caras del cubemap
+//   material nombre textura [opacidad]             Opacidad 1 por defecto
+//   mesh     nombre plane columnas filas
+//   mesh     nombre cylinder segmentos_radiales segmentos_altura radio altura
+//   mesh     nombre cone segmentos_radiales radio altura
+//   mesh     nombre heightmap imagen ancho profundidad altura_maxima
+//   node     nombre padre|- tx ty tz rx ry rz sx sy sz   Rotacin en ngulos de Euler (grados)
+//   entity   nodo malla material [dynamic] [occluder]
+//   spin     nodo ex ey ez velocidad [fase]        Giro sobre el eje (radianes por fotograma)
+//   orbit    nodo ex ey ez radio velocidad [fase]  rbita alrededor de la posicin del nodo
+//   bob      nodo dx dy dz velocidad [fase]        Vaivn a lo largo del desplazamiento
+//   track    nodo velocidad                        Pista de fotogramas clave, que siguen en rdenes key
+//   key      tiempo tx ty tz rx ry rz              Fotograma de la ltima pista (tiempos crecientes)
+//
+// Las entidades dinmicas reciben identificadores de objeto consecutivos en el orden del archivo.
+
+#include <cstdint>       // uint32_t
+#include <cstring>       // memcpy
+#include <fstream>       // ifstream, ofstream
+#include <iostream>      // cout, cerr
+#include <sstream>       // istringstream
+#include <set>           // set
+#include <string>        // string
+#include <unordered_map> // unordered_map
+#include <vector>        // vector
+#include "../Headers/Scene_Format.hpp"
+
+namespace udit
+{
+
+    /**
+     * @class Scene_Converter
+     * @brief Lee una descripcin de escena en texto y la escribe en el formato binario.
+     */
+    class Scene_Converter
+    {
+    private:
+
+        Scene_Format::Header                            header;
+        std::vector< char >                             strings;
+        std::vector< Scene_Format::Material_Record >    materials;
+        std::vector< Scene_Format::Mesh_Record     >    meshes;
+        std::vector< std::uint32_t                 >    node_parents;
+        std::vector< Transform                     >    node_transforms;
+        std::vector< std::uint32_t                 >    node_names;
+        std::vector< Scene_Format::Entity_Record   >    entities;
+        std::vector< Scene_Format::Animator_Record >    animators;
+        std::vector< Keyframe                      >    keyframes;
+
+        std::unordered_map< std::string, std::uint32_t > string_offsets;   ///< Cada texto se guarda una sola vez
+        std::unordered_map< std::string, std::uint32_t > material_indices;
+        std::unordered_map< std::string, std::uint32_t > mesh_indices;
+        std::unordered_map< std::string, std::uint32_t > node_indices;
+
+        std::set< std::pair< std::uint32_t, std::uint32_t > > animated_nodes;   ///< Nodo y tipo de cada animador
+
+        std::uint32_t next_object_id;
+
+    public:
+
+        Scene_Converter() : header{}, next_object_id(0)
+        {
+            std::memcpy(header.magic, Scene_Format::MAGIC, sizeof(header.magic));
+
+            header.version = Scene_Format::VERSION;
+
+            header.camera_yaw     = -90.f;
+            header.clear_color[3] =   1.f;
+
+            for (std::uint32_t & face : header.skybox_faces) face = Scene_Format::NO_INDEX;
+        }
+
+        /**
+         * @brief Lee la descripcin en texto.
+         * @return true si no hay errores. Los errores se indican por la salida de error con su lnea.
+         */
+        bool read(std::istream & input)
+        {
+            std::string line;
+            unsigned    line_number = 0;
+            bool        success     = true;
+
+            while (std::getline(input, line))
+            {
+                line_number++;
+
+                const std::size_t comment = line.find('#');
+
+                if (comment != std::string::npos) line.erase(comment);
+
+                std::istringstream words(line);
+                std::string        command;
+
+                if (!(words >> command)) continue;
+
+                if (const char * error = read_command(command, words))
+                {
+                    std::cerr << "Linea " << line_number << ": " << error << std::endl;
+                    success = false;
+                }
+            }
+
+            // Entidades estticas (bit 0) y que se mueven (bit 1) de cada nodo y de sus descendientes.
+            // Las estticas se combinan con su matriz del mundo al cargar la escena, as que un animador
+            // solo puede mover nodos de los que cuelgan entidades que se mueven:
+
+            std::vector< std::uint8_t > subtree_entities(node_parents.size(), 0);
+
+            for (const Scene_Format::Entity_Record & entity : entities)
+            {
+                subtree_entities[entity.node] |= (entity.flags & Scene_Format::DYNAMIC) ? 2 : 1;
+            }
+
+            for (std::size_t i = node_parents.size(); i-- > 0; )
+            {
+                if (node_parents[i] != Scene_Format::NO_INDEX) subtree_entities[node_parents[i]] |= subtree_entities[i];
+            }
+
+            for (const Scene_Format::Animator_Record & animator : animators)
+            {
+                if (animator.type == Scene_Format::TRACK && animator.key_count == 0)
+                {
+                    std::cerr << "Pista sin fotogramas" << std::endl;
+                    success = false;
+                }
+
+                if (subtree_entities[animator.node] & 1)
+                {
+                    std::cerr << "Animador de un nodo con entidades estaticas" << std::endl;
+                    success = false;
+                }
+                else if (subtree_entities[animator.node] == 0)
+                {
+                    std::cerr << "Animador de un nodo sin entidades" << std::endl;
+                    success = false;
+                }
+            }
+
+            return success;
+        }
+
+        /**
+         * @brief Escribe el archivo binario: cabecera y secciones, cada una alineada a 4 bytes.
+         */
+        bool write(std::ostream & output)
+        {
+            std::vector< char > file(sizeof(Scene_Format::Header));
+
+            add_section(file, Scene_Format::STRINGS,         strings        );
+            add_section(file, Scene_Format::MATERIALS,       materials      );
+            add_section(file, Scene_Format::MESHES,          meshes         );
+            add_section(file, Scene_Format::NODE_PARENTS,    node_parents   );
+            add_section(file, Scene_Format::NODE_TRANSFORMS, node_transforms);
+            add_section(file, Scene_Format::NODE_NAMES,      node_names     );
+            add_section(file, Scene_Format::ENTITIES,        entities       );
+            add_section(file, Scene_Format::ANIMATORS,       animators      );
+            add_section(file, Scene_Format::KEYFRAMES,       keyframes      );
+
+            header.file_size = std::uint32_t(file.size());
+
+            std::memcpy(file.data(), &header, sizeof(header));
+
+            return bool(output.write(file.data(), std::streamsize(file.size())));
+        }
+
+        /**
+         * @brief Nmero de entidades ledas.
+         */
+        std::size_t get_entity_count() const
+        {
+            return entities.size();
+        }
+
+        /**
+         * @brief Nmero de animadores ledos.
+         */
+        std::size_t get_animator_count() const
+        {
+            return animators.size();
+        }
+
+        /**
+         * @brief Nmero de nodos ledos.
+         */
+        std::size_t get_node_count() const
+        {
+            return node_parents.size();
+        }
+
+    private:
+
+        /**
+         * @return nullptr si la orden es correcta o una descripcin del error.
+         */
+        const char * read_command(const std::string & command, std::istringstream & words)
+        {
+            if (command == "camera")
+            {
+                float * position = header.camera_position;
+
+                if (!(words >> position[0] >> position[1] >> position[2] >> header.camera_yaw >> header.camera_pitch)) return "camera necesita x y z yaw pitch";
+            }
+            else if (command == "clear")
+            {
+                float * color = header.clear_color;
+
+                if (!(words >> color[0] >> color[1] >> color[2] >> color[3])) return "clear necesita r g b a";
+            }
+            else if (command == "skybox")
+            {
+                for (std::uint32_t & face : header.skybox_faces)
+                {
+                    std::string path;
+
+                    if (!(words >> path)) return "skybox necesita seis imagenes";
+
+                    face = add_string(path);
+                }
+            }
+            else if (command == "material")
+            {
+                std::string name, texture;
+                float       transparency = 1.f;
+
+                if (!(words >> name >> texture)) return "material necesita nombre y textura";
+
+                if (!(words >> transparency)) transparency = 1.f;
+
+                if (!material_indices.emplace(name, std::uint32_t(materials.size())).second) return "material repetido";
+
+                materials.push_back({ add_string(texture), transparency });
+            }
+            else if (command == "mesh")
+            {
+                std::string name, generator;
+
+                if (!(words >> name >> generator)) return "mesh necesita nombre y generador";
+
+                Scene_Format::Mesh_Record mesh{ 0, Scene_Format::NO_INDEX, { 0.f, 0.f, 0.f, 0.f } };
+
+                if      (generator == "plane"    ) mesh.generator = Scene_Format::PLANE;
+                else if (generator == "cylinder" ) mesh.generator = Scene_Format::CYLINDER;
+                else if (generator == "cone"     ) mesh.generator = Scene_Format::CONE;
+                else if (generator == "heightmap")
+                {
+                    std::string path;
+
+                    if (!(words >> path)) return "heightmap necesita una imagen";
+
+                    mesh.generator = Scene_Format::HEIGHTMAP;
+                    mesh.path      = add_string(path);
+                }
+                else
+                    return "generador de malla desconocido";
+
+                for (unsigned i = 0; i < Scene_Format::PARAMETER_COUNTS[mesh.generator]; ++i)
+                {
+                    float & value = mesh.parameters[i];
+
+                    if (!(words >> value)) return "faltan parametros de la malla";
+
+                    const bool segments = i < Scene_Format::SEGMENT_PARAMETER_COUNTS[mesh.generator];
+
+                    if (!(value > 0.f) || (segments && value < 1.f) || value > (segments ? Scene_Format::MAX_MESH_SEGMENTS : Scene_Format::MAX_MESH_SIZE)) return "parametro de malla fuera de rango";
+                }
+
+                if (!mesh_indices.emplace(name, std::uint32_t(meshes.size())).second) return "malla repetida";
+
+                meshes.push_back(mesh);
+            }
+            else if (command == "node")
+            {
+                std::string name, parent;
+                glm::vec3   translation, angles, scale;
+
+                if (!(words >> name >> parent
+                            >> translation.x >> translation.y >> translation.z
+                            >> angles.x >> angles.y >> angles.z
+                            >> scale.x >> scale.y >> scale.z)) return "node necesita nombre, padre, traslacion, rotacion y escala";
+
+                std::uint32_t parent_index = Scene_Format::NO_INDEX;
+
+                if (parent != "-")
+                {
+                    auto found = node_indices.find(parent);
+
+                    if (found == node_indices.end()) return "el padre no esta definido antes";
+
+                    parent_index = found->second;
+                }
+
+                if (!node_indices.emplace(name, std::uint32_t(node_parents.size())).second) return "nodo repetido";
+
+                Transform transform;
+
+                transform.translation = translation;
+                transform.rotation    = glm::quat(glm::radians(angles));
+                transform.scale       = scale;
+
+                node_parents   .push_back(parent_index);
+                node_transforms.push_back(transform);
+                node_names     .push_back(add_string(name));
+            }
+            else if (command == "entity")
+            {
+                std::string node, mesh, material, option;
+
+                if (!(words >> node >> mesh >> material)) return "entity necesita nodo, malla y material";
+
+                auto found_node     = node_indices    .find(node    );
+                auto found_mesh     = mesh_indices    .find(mesh    );
+                auto found_material = material_indices.find(material);
+
+                if (found_node     == node_indices    .end()) return "nodo no definido";
+                if (found_mesh     == mesh_indices    .end()) return "malla no definida";
+                if (found_material == material_indices.end()) return "material no definido";
+
+                Scene_Format::Entity_Record entity{ found_node->second, found_mesh->second, found_material->second, 0, Scene_Format::NO_INDEX };
+
+                while (words >> option)
+                {
+                    if      (option == "dynamic" ) entity.flags |= Scene_Format::DYNAMIC;
+                    else if (option == "occluder") entity.flags |= Scene_Format::OCCLUDER;
+                    else
+                        return "opcion de entidad desconocida";
+                }
+
+                // El Static_Batcher solo combina dibujos opacos:
+
+                if (!(entity.flags & Scene_Format::DYNAMIC) && materials[entity.material].transparency < 1.f) return "una entidad estatica no puede ser transparente";
+
+                if (entity.flags & Scene_Format::DYNAMIC) entity.object_id = next_object_id++;
+
+                entities.push_back(entity);
+            }
+            else if (command == "spin" || command == "orbit" || command == "bob" || command == "track")
+            {
+                std::string node;
+
+                if (!(words >> node)) return "el animador necesita un nodo";
+
+                auto found_node = node_indices.find(node);
+
+                if (found_node == node_indices.end()) return "nodo no definido";
+
+                Scene_Format::Animator_Record animator{ found_node->second, 0, { 0.f, 0.f, 0.f }, 0.f, 0.f, 0.f, 0, 0 };
+
+                if (command == "track")
+                {
+                    if (!(words >> animator.speed)) return "track necesita nodo y velocidad";
+
+                    animator.type      = Scene_Format::TRACK;
+                    animator.first_key = std::uint32_t(keyframes.size());
+                }
+                else
+                {
+                    float * vector = animator.vector;
+
+                    if (!(words >> vector[0] >> vector[1] >> vector[2])) return "el animador necesita un vector";
+
+                    if (command == "orbit" && !(words >> animator.radius)) return "orbit necesita un radio";
+
+                    if (!(words >> animator.speed)) return "el animador necesita una velocidad";
+
+                    if (!(words >> animator.phase)) animator.phase = 0.f;
+
+                    animator.type = command == "spin" ? Scene_Format::SPIN : command == "orbit" ? Scene_Format::ORBIT : Scene_Format::BOB;
+
+                    if (animator.type != Scene_Format::BOB && vector[0] == 0.f && vector[1] == 0.f && vector[2] == 0.f) return "eje nulo";
+                }
+
+                // Los animadores de un mismo tipo se evalan a la vez, as que un nodo no puede tener dos:
+
+                if (!animated_nodes.emplace(animator.node, animator.type).second) return "el nodo ya tiene un animador de ese tipo";
+
+                animators.push_back(animator);
+            }
+            else if (command == "key")
+            {
+                if (animators.empty() || animators.back().type != Scene_Format::TRACK) return "key tiene que seguir a un track";
+
+                glm::vec3 angles;
+                Keyframe  key;
+
+                if (!(words >> key.time
+                            >> key.translation.x >> key.translation.y >> key.translation.z
+                            >> angles.x >> angles.y >> angles.z)) return "key necesita tiempo, traslacion y rotacion";
+
+                Scene_Format::Animator_Record & track = animators.back();
+
+                if (track.key_count > 0 && key.time <= keyframes.back().time) return "los tiempos de los fotogramas tienen que crecer";
+
+                key.rotation = glm::quat(glm::radians(angles));
+
+                keyframes.push_back(key);
+                track.key_count++;
+            }
+            else
+                return "orden desconocida";
+
+            return nullptr;
+        }
+
+        /**
+         * @brief Posicin de un texto en la seccin de textos, aadindolo si an no est.
+         */
+        std::uint32_t add_string(const std::string & text)
+        {
+            auto found = string_offsets.find(text);
+
+            if (found != string_offsets.end()) return found->second;
+
+            const std::uint32_t offset = std::uint32_t(strings.size());
+
+            strings.insert(strings.end(), text.begin(), text.end());
+            strings.push_back('\0');
+
+            string_offsets.emplace(text, offset);
+
+            return offset;
+        }
+
+        /**
+         * @brief Aade los registros de una seccin al final del archivo y anota su posicin en la cabecera.
+         */
+        template< typename RECORD >
+        void add_section(std::vector< char > & file, Scene_Format::Section section, const std::vector< RECORD > & records)
+        {
+            file.resize((file.size() + 3) & ~std::size_t(3), '\0');
+
+            header.sections[section].offset = std::uint32_t(file.size());
+            header.sections[section].count  = std::uint32_t(records.size());
+
+            const char * bytes = reinterpret_cast< const char * >(records.data());
+
+            file.insert(file.end(), bytes, bytes + records.size() * sizeof(RECORD));
+        }
+
+    };
+
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Uso: Scene_Converter escena.txt escena.scene" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+
+    if (!input)
+    {
+        std::cerr << "No se pudo abrir " << argv[1] << std::endl;
+        return 1;
+    }
+
+    udit::Scene_Converter converter;
+
+    if (!converter.read(input)) return 1;
+
+    std::ofstream output(argv[2], std::ios::binary);
+
+    if (!output || !converter.write(output))
+    {
+        std::cerr << "No se pudo escribir " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << argv[2] << ": " << converter.get_node_count() << " nodos, " << converter.get_entity_count() << " entidades, " << converter.get_animator_count() << " animadores" << std::endl;
+
+    return 0;
+}
@@ -58,6 +58,16 @@ namespace udit
 
         opengl_context = SDL_GL_CreateContext (window_handle);
 
+        // Si no se puede crear un contexto de la versin pedida se intenta con OpenGL 3.3:
+
+        if (opengl_context == nullptr && context_details.version_major * 10 + context_details.version_minor > 33)
+        {
+            SDL_GL_SetAttribute (SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+            SDL_GL_SetAttribute (SDL_GL_CONTEXT_MINOR_VERSION, 3);
+
+            opengl_context = SDL_GL_CreateContext (window_handle);
+        }
+
         assert(opengl_context != nullptr);
 
         // Una vez se ha creado el contexto de OpenGL ya se puede inicializar GLAD: